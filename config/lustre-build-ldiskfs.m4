@@ -165,6 +165,27 @@ ext4_info_dquot, [
 ])
 ]) # LB_EXT4_HAVE_INFO_DQUOT
 
+#
+# LB_EXT4_GET_BLOCKS_UNWRIT
+#
+# 3.15 renamed EXT4_GET_BLOCKS_CREATE_UNINIT_EXT to
+# EXT4_GET_BLOCKS_CREATE_UNWRIT_EXT
+#
+AC_DEFUN([LB_EXT4_GET_BLOCKS_UNWRIT], [
+LB_CHECK_COMPILE([if ext4 has EXT4_GET_BLOCKS_CREATE_UNWRIT_EXT],
+ext4_get_blocks_unwrit, [
+	#include <linux/fs.h>
+	#include "$EXT4_SRC_DIR/ext4.h"
+],[
+	int flags = EXT4_GET_BLOCKS_CREATE_UNWRIT_EXT;
+
+	(void)flags;
+],[
+	AC_DEFINE(HAVE_EXT4_GET_BLOCKS_UNWRIT, 1,
+		[ext4 has EXT4_GET_BLOCKS_CREATE_UNWRIT_EXT])
+])
+]) # LB_EXT4_GET_BLOCKS_UNWRIT
+
 #
 # LDISKFS_AC_PATCH_PROGRAM
 #
@@ -246,6 +267,7 @@ AS_IF([test x$enable_ldiskfs != xno],[
 	LB_LDISKFS_MAP_BLOCKS
 	LB_EXT4_BREAD_4ARGS
 	LB_EXT4_HAVE_INFO_DQUOT
+	LB_EXT4_GET_BLOCKS_UNWRIT
 	AC_DEFINE(CONFIG_LDISKFS_FS_POSIX_ACL, 1, [posix acls for ldiskfs])
 	AC_DEFINE(CONFIG_LDISKFS_FS_SECURITY, 1, [fs security for ldiskfs])
 	AC_DEFINE(CONFIG_LDISKFS_FS_XATTR, 1, [extened attributes for ldiskfs])
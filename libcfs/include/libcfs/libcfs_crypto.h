@@ -205,6 +205,9 @@ int cfs_crypto_hash_update(struct cfs_crypto_hash_desc *desc, const void *buf,
 			   unsigned int buf_len);
 int cfs_crypto_hash_final(struct cfs_crypto_hash_desc *desc,
 			  unsigned char *hash, unsigned int *hash_len);
+int cfs_crypto_hash_combine(enum cfs_crypto_hash_alg hash_alg,
+			    unsigned char *hash, const unsigned char *hash2,
+			    unsigned int len2);
 int cfs_crypto_register(void);
 void cfs_crypto_unregister(void);
 int cfs_crypto_hash_speed(enum cfs_crypto_hash_alg hash_alg);
@@ -610,12 +610,31 @@ void cfs_hash_bd_move_locked(struct cfs_hash *hs, struct cfs_hash_bd *bd_old,
 			     struct cfs_hash_bd *bd_new,
 			     struct hlist_node *hnode);
 
+/**
+ * Decrement \a condition and lock bucket \a bd exclusively if it drops to
+ * zero, like atomic_dec_and_lock().
+ *
+ * \retval 1	\a condition dropped to zero, \a bd is locked
+ * \retval 0	\a condition is still positive, \a bd is not locked
+ */
 static inline int
 cfs_hash_bd_dec_and_lock(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 			 atomic_t *condition)
 {
-	LASSERT(cfs_hash_with_spin_bktlock(hs));
-	return atomic_dec_and_lock(condition, &bd->bd_bucket->hsb_lock.spin);
+	if (cfs_hash_with_spin_bktlock(hs))
+		return atomic_dec_and_lock(condition,
+					   &bd->bd_bucket->hsb_lock.spin);
+
+	LASSERT(cfs_hash_with_rw_bktlock(hs));
+	if (atomic_add_unless(condition, -1, 1))
+		return 0;
+
+	write_lock(&bd->bd_bucket->hsb_lock.rw);
+	if (atomic_dec_and_test(condition))
+		return 1;
+	write_unlock(&bd->bd_bucket->hsb_lock.rw);
+
+	return 0;
 }
 
 static inline struct hlist_head *
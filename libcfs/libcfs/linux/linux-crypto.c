@@ -27,6 +27,7 @@
  * Copyright (c) 2012, 2014, Intel Corporation.
  */
 
+#include <asm/unaligned.h>
 #include <crypto/hash.h>
 #include <linux/scatterlist.h>
 #include <libcfs/libcfs.h>
@@ -303,6 +304,139 @@ free:
 }
 EXPORT_SYMBOL(cfs_crypto_hash_final);
 
+/* polynomials of the reflected CRC32 and CRC32C, as in lib/crc32defs.h */
+#define CFS_CRC32_POLY_LE	0xedb88320
+#define CFS_CRC32C_POLY_LE	0x82f63b78
+#define CFS_ADLER32_BASE	65521U
+
+static __u32 cfs_gf2_matrix_times(const __u32 *mat, __u32 vec)
+{
+	__u32 sum = 0;
+
+	for (; vec != 0; vec >>= 1, mat++)
+		if (vec & 1)
+			sum ^= *mat;
+
+	return sum;
+}
+
+static void cfs_gf2_matrix_square(__u32 *square, const __u32 *mat)
+{
+	int n;
+
+	for (n = 0; n < 32; n++)
+		square[n] = cfs_gf2_matrix_times(mat, mat[n]);
+}
+
+/**
+ * Feed \a len zero bytes to the raw (not inverted) CRC register \a crc,
+ * in O(log(len)) time.
+ */
+static __u32 cfs_crc32_shift(__u32 poly, __u32 crc, unsigned int len)
+{
+	__u32 even[32];	/* even-power-of-two zeros operator */
+	__u32 odd[32];	/* odd-power-of-two zeros operator */
+	__u32 row = 1;
+	int n;
+
+	if (len == 0)
+		return crc;
+
+	/* operator for one zero bit */
+	odd[0] = poly;
+	for (n = 1; n < 32; n++, row <<= 1)
+		odd[n] = row;
+
+	cfs_gf2_matrix_square(even, odd);	/* two zero bits */
+	cfs_gf2_matrix_square(odd, even);	/* four zero bits */
+
+	/* apply len zero bytes, the first squaring gives one zero byte */
+	do {
+		cfs_gf2_matrix_square(even, odd);
+		if (len & 1)
+			crc = cfs_gf2_matrix_times(even, crc);
+		len >>= 1;
+		if (len == 0)
+			break;
+
+		cfs_gf2_matrix_square(odd, even);
+		if (len & 1)
+			crc = cfs_gf2_matrix_times(odd, crc);
+		len >>= 1;
+	} while (len != 0);
+
+	return crc;
+}
+
+static __u32 cfs_adler32_combine(__u32 adler1, __u32 adler2, unsigned int len2)
+{
+	__u32 rem = len2 % CFS_ADLER32_BASE;
+	__u32 sum1 = adler1 & 0xffff;
+	__u32 sum2 = (__u64)rem * sum1 % CFS_ADLER32_BASE;
+
+	sum1 += (adler2 & 0xffff) + CFS_ADLER32_BASE - 1;
+	sum2 += (adler1 >> 16) + (adler2 >> 16) + CFS_ADLER32_BASE - rem;
+	if (sum1 >= CFS_ADLER32_BASE)
+		sum1 -= CFS_ADLER32_BASE;
+	if (sum1 >= CFS_ADLER32_BASE)
+		sum1 -= CFS_ADLER32_BASE;
+	if (sum2 >= CFS_ADLER32_BASE << 1)
+		sum2 -= CFS_ADLER32_BASE << 1;
+	if (sum2 >= CFS_ADLER32_BASE)
+		sum2 -= CFS_ADLER32_BASE;
+
+	return sum1 | (sum2 << 16);
+}
+
+/**
+ * Combine the digests of two consecutive buffers into the digest of their
+ * concatenation, so that a large buffer can be hashed in pieces in parallel.
+ * Both digests must have been computed from the default key.
+ *
+ * \param[in]	hash_alg	hash algorithm id (CFS_HASH_ALG_*)
+ * \param[in,out] hash		digest of the first buffer, replaced by the
+ *				digest of both buffers
+ * \param[in]	hash2		digest of the second buffer
+ * \param[in]	len2		length of the second buffer
+ *
+ * \retval		0 for success
+ * \retval		-EOPNOTSUPP if digests of \a hash_alg can't be combined
+ */
+int cfs_crypto_hash_combine(enum cfs_crypto_hash_alg hash_alg,
+			    unsigned char *hash, const unsigned char *hash2,
+			    unsigned int len2)
+{
+	__u32 a;
+	__u32 b;
+
+	switch (hash_alg) {
+	case CFS_HASH_ALG_ADLER32:
+		/* adler32 digest is stored in CPU order */
+		memcpy(&a, hash, sizeof(a));
+		memcpy(&b, hash2, sizeof(b));
+		a = cfs_adler32_combine(a, b, len2);
+		memcpy(hash, &a, sizeof(a));
+		return 0;
+	case CFS_HASH_ALG_CRC32:
+		/* started from ~0, the register is not inverted at the end */
+		a = get_unaligned_le32(hash);
+		b = get_unaligned_le32(hash2);
+		a = cfs_crc32_shift(CFS_CRC32_POLY_LE, ~a, len2) ^ b;
+		put_unaligned_le32(a, hash);
+		return 0;
+	case CFS_HASH_ALG_CRC32C:
+		/* started from ~0 and inverted at the end */
+		a = get_unaligned_le32(hash);
+		b = get_unaligned_le32(hash2);
+		a = cfs_crc32_shift(CFS_CRC32C_POLY_LE, a, len2) ^ b;
+		put_unaligned_le32(a, hash);
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+EXPORT_SYMBOL(cfs_crypto_hash_combine);
+
 /**
  * Compute the speed of specified hash function
  *
@@ -2237,6 +2237,24 @@ inode_lock, [
 ])
 ]) # LC_HAVE_INODE_LOCK
 
+#
+# LC_HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+#
+# 4.5 added file_operations.copy_file_range
+#
+AC_DEFUN([LC_HAVE_FILE_OPERATIONS_COPY_FILE_RANGE], [
+LB_CHECK_COMPILE([if 'file_operations.copy_file_range' exists],
+file_copy_file_range, [
+	#include <linux/fs.h>
+],[
+	((struct file_operations *)NULL)->copy_file_range(NULL, 0, NULL, 0,
+							    0, 0);
+],[
+	AC_DEFINE(HAVE_FILE_OPERATIONS_COPY_FILE_RANGE, 1,
+		[file_operations.copy_file_range exists])
+])
+]) # LC_HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+
 #
 # LC_HAVE_IOP_GET_LINK
 #
@@ -2273,6 +2291,25 @@ in_compat_syscall, [
 ])
 ]) # LC_HAVE_IN_COMPAT_SYSCALL
 
+#
+# LC_HAVE_KMEM_CACHE_ALLOC_BULK
+#
+# 4.6 added kmem_cache_alloc_bulk to allocate several objects at once
+#
+AC_DEFUN([LC_HAVE_KMEM_CACHE_ALLOC_BULK], [
+LB_CHECK_COMPILE([if 'kmem_cache_alloc_bulk' is defined],
+kmem_cache_alloc_bulk, [
+	#include <linux/slab.h>
+],[
+	void *objs[2];
+
+	kmem_cache_alloc_bulk(NULL, GFP_NOFS, 2, objs);
+],[
+	AC_DEFINE(HAVE_KMEM_CACHE_ALLOC_BULK, 1,
+		[have kmem_cache_alloc_bulk])
+])
+]) # LC_HAVE_KMEM_CACHE_ALLOC_BULK
+
 #
 # LC_PROG_LINUX
 #
@@ -2456,10 +2493,12 @@ AC_DEFUN([LC_PROG_LINUX], [
 
 	# 4.5
 	LC_HAVE_INODE_LOCK
+	LC_HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
 	LC_HAVE_IOP_GET_LINK
 
 	# 4.6
 	LC_HAVE_IN_COMPAT_SYSCALL
+	LC_HAVE_KMEM_CACHE_ALLOC_BULK
 
 	#
 	AS_IF([test "x$enable_server" != xno], [
@@ -182,6 +182,7 @@ typedef enum {
   OST_QUOTACTL   = 19,
   OST_QUOTA_ADJUST_QUNIT = 20,
   OST_LADVISE = 21,
+  OST_COPY = 22,
   OST_LAST_OPC
 } ost_cmd_t ;
 
@@ -227,6 +228,7 @@ typedef enum {
 	MDS_HSM_CT_REGISTER	= 59,
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
+	MDS_BATCH_GETATTR	= 62,
 	MDS_LAST_OPC
 } mds_cmd_t;
 
@@ -1156,7 +1158,8 @@ const value_string lustre_op_codes[] = {
   {19 , "OST_QUOTACTL"},
   {20 , "OST_QUOTA_ADJUST_QUNIT"},
   {21 , "OST_LADVISE"},
-  {22 , "OST_LAST_OPC"},
+  {22 , "OST_COPY"},
+  {23 , "OST_LAST_OPC"},
   /*MDS Opcodes*/
   {33 , "MDS_GETATTR"},
   {34 , "MDS_GETATTR_NAME"},
@@ -1187,7 +1190,8 @@ const value_string lustre_op_codes[] = {
   {59 , "MDS_HSM_CT_REGISTER"},
   {60 , "MDS_HSM_CT_UNREGISTER"},
   {61 , "MDS_SWAP_LAYOUTS"},
-  {62 , "MDS_LAST_OPC"},
+  {62 , "MDS_BATCH_GETATTR"},
+  {63 , "MDS_LAST_OPC"},
   /*LDLM Opcodes*/
   {101 , "LDLM_ENQUEUE"},
   {102 , "LDLM_CONVERT"},
@@ -391,6 +391,13 @@ struct cl_object_operations {
 	int (*coo_fiemap)(const struct lu_env *env, struct cl_object *obj,
 			  struct ll_fiemap_info_key *fmkey,
 			  struct fiemap *fiemap, size_t *buflen);
+	/**
+	 * Copy an extent of object \a src into this object without moving
+	 * the data through the client. \a len is set to the bytes copied.
+	 */
+	int (*coo_copy)(const struct lu_env *env, struct cl_object *obj,
+			struct cl_object *src, loff_t src_off,
+			loff_t dst_off, size_t *len);
 	/**
 	 * Get layout and generation of the object.
 	 */
@@ -1641,10 +1648,19 @@ enum cl_enq_flags {
 	 * is known to exist.
 	 */
 	CEF_LOCK_MATCH  = 0x00000080,
+	/**
+	 * speculative lock (lock ahead): enqueue asynchronously and fail
+	 * rather than revoke the conflicting locks of other users.
+	 */
+	CEF_SPECULATIVE = 0x00000100,
+	/**
+	 * tell the server to grant exactly the requested extent.
+	 */
+	CEF_LOCK_NO_EXPAND = 0x00000200,
 	/**
 	 * mask of enq_flags.
 	 */
-	CEF_MASK         = 0x000000ff,
+	CEF_MASK         = 0x000003ff,
 };
 
 /**
@@ -2026,6 +2042,9 @@ int cl_object_getstripe(const struct lu_env *env, struct cl_object *obj,
 int cl_object_fiemap(const struct lu_env *env, struct cl_object *obj,
 		     struct ll_fiemap_info_key *fmkey, struct fiemap *fiemap,
 		     size_t *buflen);
+int cl_object_copy(const struct lu_env *env, struct cl_object *obj,
+		   struct cl_object *src, loff_t src_off, loff_t dst_off,
+		   size_t *len);
 int cl_object_layout_get(const struct lu_env *env, struct cl_object *obj,
 			 struct cl_layout *cl);
 loff_t cl_object_maxbytes(struct cl_object *obj);
@@ -557,16 +557,21 @@ struct fld;
 
 struct lu_site_bkt_data {
 	/**
-	 * number of object in this bucket on the lsb_lru list.
+	 * number of unreferenced objects in this bucket on the lsb_lru list.
+	 * Objects taken by a lookup stay on the list but are not counted,
+	 * see htable_lookup().
 	 */
-	long			lsb_lru_len;
+	atomic_long_t		lsb_lru_len;
 	/**
-	 * LRU list, updated on each access to object. Protected by
-	 * bucket lock of lu_site::ls_obj_hash.
+	 * LRU list, updated when the last reference on an object is released.
+	 * Protected by the bucket lock of lu_site::ls_obj_hash, held
+	 * exclusively.
 	 *
-	 * "Cold" end of LRU is lu_site::ls_lru.next. Accessed object are
+	 * "Cold" end of LRU is lu_site::ls_lru.next. Released objects are
 	 * moved to the lu_site::ls_lru.prev (this is due to the non-existence
-	 * of list_for_each_entry_safe_reverse()).
+	 * of list_for_each_entry_safe_reverse()). Lookups only take the
+	 * bucket lock shared and leave the objects they reference on the
+	 * list, these are removed by lu_site_purge_objects().
 	 */
 	struct list_head	lsb_lru;
 	/**
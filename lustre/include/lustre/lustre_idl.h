@@ -725,6 +725,16 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT_FLAGS2	 0x8000000000000000ULL /* second flags word */
 /* ocd_connect_flags2 flags */
 #define OBD_CONNECT2_FILE_SECCTX	0x1ULL /* set file security context at create */
+/* Flags not reserved on the other branches are taken from the top byte, so
+ * they cannot collide with the flags assigned in order from the bottom. */
+/** MDS_BATCH_GETATTR for statahead */
+#define OBD_CONNECT2_BATCH_GETATTR	0x0100000000000000ULL
+/** compressed BRW write bulk */
+#define OBD_CONNECT2_COMPRESS		0x0200000000000000ULL
+/** OST_COPY of object extents */
+#define OBD_CONNECT2_SERVER_COPY	0x0400000000000000ULL
+/** several locks per blocking AST */
+#define OBD_CONNECT2_BATCH_BL_AST	0x0800000000000000ULL
 
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
@@ -773,7 +783,9 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_SUBTREE | \
 				OBD_CONNECT_FLAGS2)
 
-#define MDT_CONNECT_SUPPORTED2 OBD_CONNECT2_FILE_SECCTX
+#define MDT_CONNECT_SUPPORTED2 (OBD_CONNECT2_FILE_SECCTX | \
+				OBD_CONNECT2_BATCH_GETATTR | \
+				OBD_CONNECT2_BATCH_BL_AST)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -791,8 +803,11 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
 				OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK | \
 				OBD_CONNECT_BULK_MBITS | \
-				OBD_CONNECT_GRANT_PARAM)
-#define OST_CONNECT_SUPPORTED2 0
+				OBD_CONNECT_GRANT_PARAM | \
+				OBD_CONNECT_LOCK_AHEAD)
+#define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_COMPRESS | \
+				OBD_CONNECT2_SERVER_COPY | \
+				OBD_CONNECT2_BATCH_BL_AST)
 
 #define ECHO_CONNECT_SUPPORTED 0
 #define ECHO_CONNECT_SUPPORTED2 0
@@ -835,7 +850,7 @@ struct obd_connect_data {
          * may result in out-of-bound memory access and kernel oops. */
 	__u16 ocd_maxmodrpcs;    /* Maximum modify RPCs in parallel */
 	__u16 padding0;          /* added 2.1.0. also fix lustre_swab_connect */
-	__u32 padding1;          /* added 2.1.0. also fix lustre_swab_connect */
+	__u32 ocd_compr_types;   /* supported compression algorithms */
 	__u64 ocd_connect_flags2;
         __u64 padding3;          /* added 2.1.0. also fix lustre_swab_connect */
         __u64 padding4;          /* added 2.1.0. also fix lustre_swab_connect */
@@ -869,8 +884,25 @@ typedef enum {
         OBD_CKSUM_CRC32 = 0x00000001,
         OBD_CKSUM_ADLER = 0x00000002,
         OBD_CKSUM_CRC32C= 0x00000004,
+	OBD_CKSUM_T10IP512  = 0x00000008, /* T10 PI IP guards, 512B sectors */
+	OBD_CKSUM_T10IP4K   = 0x00000010, /* T10 PI IP guards, 4KB sectors */
+	OBD_CKSUM_T10CRC512 = 0x00000020, /* T10 PI CRC guards, 512B sectors */
+	OBD_CKSUM_T10CRC4K  = 0x00000040, /* T10 PI CRC guards, 4KB sectors */
 } cksum_type_t;
 
+/*
+ * Bulk compression algorithms. The mask of supported algorithms is stored
+ * in obd_connect_data::ocd_compr_types as (1 << type).
+ * Please update DECLARE_COMPR_NAME in obd_compress.h when adding a new one.
+ */
+enum obd_compr_type {
+	OBD_COMPR_NONE		= 0,
+	OBD_COMPR_LZ4		= 1,
+	OBD_COMPR_LZO		= 2,
+	OBD_COMPR_DEFLATE	= 3,
+	OBD_COMPR_MAX
+};
+
 /*
  *   OST requests: OBDO & OBD request records
  */
@@ -897,6 +929,7 @@ typedef enum {
         OST_QUOTACTL   = 19,
 	OST_QUOTA_ADJUST_QUNIT = 20, /* not used since 2.4 */
 	OST_LADVISE    = 21,
+	OST_COPY       = 22,
 	OST_LAST_OPC /* must be < 33 to avoid MDS_GETATTR */
 } ost_cmd_t;
 #define OST_FIRST_OPC  OST_REPLY
@@ -916,7 +949,10 @@ enum obdo_flags {
         OBD_FL_CKSUM_CRC32  = 0x00001000, /* CRC32 checksum type */
         OBD_FL_CKSUM_ADLER  = 0x00002000, /* ADLER checksum type */
         OBD_FL_CKSUM_CRC32C = 0x00004000, /* CRC32C checksum type */
-        OBD_FL_CKSUM_RSVD2  = 0x00008000, /* for future cksum types */
+	OBD_FL_CKSUM_T10IP512  = 0x00005000, /* T10 PI IP, 512B sectors */
+	OBD_FL_CKSUM_T10IP4K   = 0x00006000, /* T10 PI IP, 4KB sectors */
+	OBD_FL_CKSUM_T10CRC512 = 0x00007000, /* T10 PI CRC, 512B sectors */
+	OBD_FL_CKSUM_T10CRC4K  = 0x00008000, /* T10 PI CRC, 4KB sectors */
         OBD_FL_CKSUM_RSVD3  = 0x00010000, /* for future cksum types */
         OBD_FL_SHRINK_GRANT = 0x00020000, /* object shrink the grant */
         OBD_FL_MMAP         = 0x00040000, /* object is mmapped on the client.
@@ -927,10 +963,9 @@ enum obdo_flags {
 	OBD_FL_FLUSH	    = 0x00200000, /* flush pages on the OST */
 	OBD_FL_SHORT_IO	    = 0x00400000, /* short io request */
 
-        /* Note that while these checksum values are currently separate bits,
-         * in 2.x we can actually allow all values from 1-31 if we wanted. */
-        OBD_FL_CKSUM_ALL    = OBD_FL_CKSUM_CRC32 | OBD_FL_CKSUM_ADLER |
-                              OBD_FL_CKSUM_CRC32C,
+	/* The first checksum types were separate bits, the T10 PI ones use
+	 * the remaining values of the 4-bit field. */
+	OBD_FL_CKSUM_ALL    = 0x0000f000,
 
         /* mask for local-only flag, which won't be sent over network */
         OBD_FL_LOCAL_MASK   = 0xF0000000,
@@ -1207,6 +1242,24 @@ struct niobuf_remote {
 	__u32	rnb_flags;
 };
 
+/** Compressed OST_WRITE bulk descriptor, sent in RMF_BRW_COMPR.
+ *
+ * The bytes described by the niobufs are cut into bch_chunk_size chunks
+ * which are compressed one by one and sent back to back in the bulk. A
+ * chunk whose bch_chunk_len[] equals its raw length is sent uncompressed. */
+struct brw_compr_hdr {
+	__u32	bch_type;	/* enum obd_compr_type */
+	__u32	bch_chunk_size;	/* uncompressed bytes per chunk */
+	__u32	bch_count;	/* number of chunks */
+	__u32	bch_padding;
+	__u32	bch_chunk_len[0]; /* bytes of each chunk in the bulk */
+};
+
+static inline size_t brw_compr_hdr_size(__u32 count)
+{
+	return offsetof(struct brw_compr_hdr, bch_chunk_len[count]);
+}
+
 /* lock value block communicated between the filter and llite */
 
 /* OST_LVB_ERR_INIT is needed because the return code in rc is
@@ -1441,6 +1494,7 @@ typedef enum {
 	MDS_HSM_CT_REGISTER	= 59,
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
+	MDS_BATCH_GETATTR	= 62,
 	MDS_LAST_OPC
 } mds_cmd_t;
 
@@ -1633,6 +1687,35 @@ struct mdt_ioepoch {
 	__u32 mio_padding;
 };
 
+/* max number of entries in one MDS_BATCH_GETATTR request */
+#define MDT_BATCH_GETATTR_MAX	64
+
+/** One entry of a MDS_BATCH_GETATTR request, the parent FID is in mdt_body.
+ * Entries are packed back to back, each padded to 8 bytes. */
+struct mdt_batch_getattr_item {
+	struct lustre_handle	mgi_lockh;	/* client lock handle */
+	struct lu_fid		mgi_fid;	/* child FID from the dirent */
+	__u16			mgi_namelen;	/* name length, without '\0' */
+	__u16			mgi_padding0;
+	__u32			mgi_padding1;
+	char			mgi_name[0];	/* '\0' terminated name */
+};
+
+static inline size_t mdt_batch_getattr_item_size(size_t namelen)
+{
+	return (sizeof(struct mdt_batch_getattr_item) + namelen + 1 + 7) & ~7;
+}
+
+/** Per-entry reply of MDS_BATCH_GETATTR, in request order. */
+struct mdt_batch_getattr_reply {
+	__s32			mgr_status;	/* 0 or negative errno */
+	__u32			mgr_padding;
+	struct lustre_handle	mgr_lockh;	/* granted lock, server handle */
+	__u64			mgr_bits;	/* granted inodebits */
+	__u64			mgr_flags;	/* LDLM_FL_* of granted lock */
+	struct mdt_body		mgr_body;	/* attributes of the entry */
+};
+
 /* permissions for md_perm.mp_perm */
 enum {
         CFS_SETUID_PERM = 0x01,
@@ -2819,6 +2902,17 @@ struct ost_body {
 	struct obdo oa;
 };
 
+/** Extent copied by OST_COPY from the source object to the destination
+ * object of ost_body, both on the same OST. */
+struct ost_copy {
+	struct ost_id	oc_src_oi;	/* source object */
+	__u64		oc_src_offset;	/* first byte to copy */
+	__u64		oc_dst_offset;	/* first byte to write */
+	__u64		oc_length;	/* bytes to copy, copied in the reply */
+	__u64		oc_flags;	/* unused */
+	__u64		oc_padding;
+};
+
 /* Key for FIEMAP to be used in get_info calls */
 struct ll_fiemap_info_key {
 	char		lfik_name[8];
@@ -1379,11 +1379,13 @@ enum lu_ladvise_type {
 	LU_LADVISE_INVALID	= 0,
 	LU_LADVISE_WILLREAD	= 1,
 	LU_LADVISE_DONTNEED	= 2,
+	LU_LADVISE_LOCKAHEAD	= 3,
 };
 
 #define LU_LADVISE_NAMES {						\
 	[LU_LADVISE_WILLREAD]	= "willread",				\
 	[LU_LADVISE_DONTNEED]	= "dontneed",				\
+	[LU_LADVISE_LOCKAHEAD]	= "lockahead",				\
 }
 
 /* This is the userspace argument for ladvise.  It is currently the same as
@@ -1399,6 +1401,27 @@ struct llapi_lu_ladvise {
 	__u32 lla_value4;
 };
 
+/* LU_LADVISE_LOCKAHEAD takes the lock mode in lla_value1 and returns the
+ * result of the request in lla_value3 */
+#define lla_lockahead_mode	lla_value1
+#define lla_lockahead_result	lla_value3
+
+enum lock_mode_user {
+	MODE_READ_USER		= 1,
+	MODE_WRITE_USER		= 2,
+	MODE_MAX_USER,
+};
+
+#define LOCK_MODE_NAMES {						\
+	[MODE_READ_USER]	= "READ",				\
+	[MODE_WRITE_USER]	= "WRITE",				\
+}
+
+enum lla_lockahead_result {
+	LLA_RESULT_SENT		= 0,	/* lock request sent to the server */
+	LLA_RESULT_SAME		= 1,	/* a lock is cached on the extent */
+};
+
 enum ladvise_flag {
 	LF_ASYNC	= 0x00000001,
 };
@@ -63,8 +63,13 @@ extern struct kset *ldlm_svc_kset;
 
 #define LDLM_DEFAULT_LRU_SIZE (100 * num_online_cpus())
 #define LDLM_DEFAULT_MAX_ALIVE (cfs_time_seconds(3900)) /* 65 min */
+/* resources of the locks last cancelled from the LRU, must be a power of 2 */
+#define LDLM_LRU_GHOSTS 1024
 #define LDLM_CTIME_AGE_LIMIT (10)
 #define LDLM_DEFAULT_PARALLEL_AST_LIMIT 1024
+/* locks per blocking AST RPC, see ldlm_server_blocking_ast() */
+#define LDLM_DEFAULT_BL_AST_BATCH 64
+#define LDLM_MAX_BL_AST_BATCH 256
 
 /**
  * LDLM non-error return states
@@ -180,7 +185,7 @@ static inline int lockmode_compat(enum ldlm_mode exist_mode,
  * lr_lock
  *
  * lr_lock
- *     waiting_locks_spinlock
+ *     ldlm_waiting_locks::wl_lock
  *
  * lr_lock
  *     led_lock
@@ -309,6 +314,20 @@ enum ldlm_appetite {
 	LDLM_NAMESPACE_MODEST = 1 << 1
 };
 
+/**
+ * Order in which the unused locks of a client namespace are cancelled.
+ */
+enum ldlm_lru_policy {
+	/** least recently used first */
+	LDLM_LRU_POLICY_LRU	= 0,
+	/**
+	 * Locks used only once first, as with the 2Q page replacement, so
+	 * that a scan over many files does not push the locks used again
+	 * and again out of the LRU.
+	 */
+	LDLM_LRU_POLICY_2Q	= 1,
+};
+
 /**
  * Default values for the "max_nolock_size", "contention_time" and
  * "contended_locks" namespace tunables.
@@ -335,6 +354,13 @@ struct ldlm_ns_bucket {
 enum {
 	/** LDLM namespace lock stats */
 	LDLM_NSS_LOCKS          = 0,
+	/** unused locks of the LRU used again */
+	LDLM_NSS_LRU_HITS,
+	/** locks put in the LRU for the first time */
+	LDLM_NSS_LRU_MISSES,
+	/** locks of a resource whose lock was cancelled from the LRU, 2q
+	 * policy only */
+	LDLM_NSS_LRU_REENQUEUES,
 	LDLM_NSS_LAST
 };
 
@@ -414,8 +440,23 @@ struct ldlm_namespace {
 	 * Locks are linked via l_lru field in \see struct ldlm_lock.
 	 */
 	struct list_head	ns_unused_list;
-	/** Number of locks in the LRU list above */
+	/** Number of locks in the LRU lists, ns_unused_list and ns_unused_hot */
 	int			ns_nr_unused;
+	/**
+	 * LDLM_LRU_POLICY_2Q only: unused locks which were used more than
+	 * once, cancelled after the locks of ns_unused_list.
+	 */
+	struct list_head	ns_unused_hot;
+	/** Number of locks in ns_unused_hot */
+	int			ns_nr_hot;
+	/** How to choose the unused locks to cancel */
+	enum ldlm_lru_policy	ns_lru_policy;
+	/**
+	 * Client only: hashes of the resources of the last locks cancelled
+	 * from the LRU, to find the locks enqueued again soon after. Only
+	 * allocated while the policy is LDLM_LRU_POLICY_2Q.
+	 */
+	__u32			*ns_lru_ghosts;
 
 	/**
 	 * Maximum number of locks permitted in the LRU. If 0, means locks
@@ -494,6 +535,12 @@ struct ldlm_namespace {
 	/** Limit of parallel AST RPC count. */
 	unsigned		ns_max_parallel_ast;
 
+	/**
+	 * Most locks of one export revoked by a single blocking AST RPC,
+	 * 0 or 1 to send one RPC per lock.
+	 */
+	unsigned		ns_max_bl_ast_batch;
+
 	/**
 	 * Callback to check if a lock is good to be canceled by ELC or
 	 * during recovery.
@@ -614,6 +661,36 @@ struct ldlm_interval_tree {
 	struct interval_node	*lit_root; /* actual ldlm_interval */
 };
 
+/**
+ * Number of lists the inodebits locks of a resource are indexed in: one for
+ * each MDS_INODELOCK_* bit and a last one for any higher bit.
+ */
+#define LDLM_IBITS_INDEX_SLOTS	(MDS_INODELOCK_MAXSHIFT + 2)
+
+/** Index node for each LDLM_IBITS lock of a server namespace. */
+struct ldlm_ibits_node {
+	/** linkage to the lists of struct ldlm_ibits_queues, one per slot */
+	struct list_head	lin_link[LDLM_IBITS_INDEX_SLOTS];
+	struct ldlm_lock	*lin_lock;
+	/** order of the lock in lr_waiting, 0 if it is not waiting */
+	__u64			lin_seq;
+};
+
+/**
+ * Granted and waiting inodebits locks of a resource, indexed by bit and by
+ * mode, so that conflicts are only looked up among the locks that share a
+ * bit with the request and have an incompatible mode. It is only built by
+ * the server for resources with many locks, see ldlm_inodebits.c.
+ * Protected by lr_lock.
+ */
+struct ldlm_ibits_queues {
+	struct list_head	liq_granted[LDLM_IBITS_INDEX_SLOTS][LCK_MODE_NUM];
+	/** each list is in lr_waiting order */
+	struct list_head	liq_waiting[LDLM_IBITS_INDEX_SLOTS][LCK_MODE_NUM];
+	/** last lin_seq given to a waiting lock */
+	__u64			liq_seq;
+};
+
 /** Whether to track references to exports by LDLM locks. */
 #define LUSTRE_TRACKS_LOCK_EXP_REFS (0)
 
@@ -702,6 +779,10 @@ struct ldlm_lock {
 	 * Protected by ns_lock in struct ldlm_namespace.
 	 */
 	struct list_head	l_lru;
+	/** The lock was in the LRU before. Protected by ns_lock. */
+	bool			l_lru_seen;
+	/** l_lru is on ns_unused_hot. Protected by ns_lock. */
+	bool			l_lru_hot;
 	/**
 	 * Linkage to resource's lock queues according to current lock state.
 	 * (could be granted, waiting or converting)
@@ -712,6 +793,10 @@ struct ldlm_lock {
 	 * Tree node for ldlm_extent.
 	 */
 	struct ldlm_interval	*l_tree_node;
+	/**
+	 * Index node for server side ldlm_inodebits.
+	 */
+	struct ldlm_ibits_node	*l_ibits_node;
 	/**
 	 * Per export hash of locks.
 	 * Protected by per-bucket exp->exp_lock_hash locks.
@@ -840,12 +925,14 @@ struct ldlm_lock {
 	/**
 	 * List item for locks waiting for cancellation from clients.
 	 * The lists this could be linked into are:
-	 * waiting_locks_list (protected by waiting_locks_spinlock),
-	 * then if the lock timed out, it is moved to
-	 * expired_lock_thread.elt_expired_locks for further processing.
-	 * Protected by elt_lock.
+	 * a slot of the waiting-lock timer wheel the lock hashes to,
+	 * then if the lock timed out, it is moved to the wl_expired list
+	 * of that wheel for further processing.
+	 * Protected by the wl_lock of the wheel.
 	 */
 	struct list_head	l_pending_chain;
+	/** l_pending_chain is on the wl_expired list of its wheel */
+	bool			l_pending_expired;
 
 	/**
 	 * Set when lock is sent a blocking AST. Time in seconds when timeout
@@ -960,6 +1047,12 @@ struct ldlm_resource {
 	 */
 	struct ldlm_interval_tree *lr_itree;
 
+	/**
+	 * Index of the granted and waiting queues (only for inodebits locks
+	 * on the server side), NULL until the resource has many locks.
+	 */
+	struct ldlm_ibits_queues *lr_ibits_queues;
+
 	union {
 		/**
 		 * When the resource was considered as contended,
@@ -1500,6 +1593,14 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 			  enum ldlm_mode mode, __u64 *flags, void *lvb,
 			  __u32 lvb_len,
 			  const struct lustre_handle *lockh, int rc);
+int ldlm_cli_lock_prep(struct obd_export *exp, struct ldlm_enqueue_info *einfo,
+		       const struct ldlm_res_id *res_id,
+		       union ldlm_policy_data const *policy,
+		       struct lustre_handle *lockh);
+int ldlm_cli_lock_fini(struct obd_export *exp, const struct lustre_handle *lockh,
+		       enum ldlm_mode mode, const struct lustre_handle *remote,
+		       union ldlm_policy_data const *policy, __u64 flags,
+		       int rc);
 int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
 			   const struct ldlm_res_id *res_id,
 			   enum ldlm_type type, union ldlm_policy_data *policy,
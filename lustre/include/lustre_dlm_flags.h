@@ -26,7 +26,7 @@
 #ifndef LDLM_ALL_FLAGS_MASK
 
 /** l_flags bits marked as "all_flags" bits */
-#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC08F932FULL
+#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC08F937FULL
 
 /** extent, mode, or resource changed */
 #define LDLM_FL_LOCK_CHANGED            0x0000000000000001ULL // bit   0
@@ -58,12 +58,27 @@
 #define ldlm_set_block_wait(_l)         LDLM_SET_FLAG((  _l), 1ULL <<  3)
 #define ldlm_clear_block_wait(_l)       LDLM_CLEAR_FLAG((_l), 1ULL <<  3)
 
+/**
+ * Lock request is speculative (lock ahead): it must not wait for, nor send
+ * blocking ASTs to, conflicting locks. The request fails with -EWOULDBLOCK
+ * instead. */
+#define LDLM_FL_SPECULATIVE		0x0000000000000010ULL /* bit   4 */
+#define ldlm_is_speculative(_l)		LDLM_TEST_FLAG((_l), 1ULL <<  4)
+#define ldlm_set_speculative(_l)	LDLM_SET_FLAG((_l), 1ULL <<  4)
+#define ldlm_clear_speculative(_l)	LDLM_CLEAR_FLAG((_l), 1ULL <<  4)
+
 /** blocking or cancel packet was queued for sending. */
 #define LDLM_FL_AST_SENT                0x0000000000000020ULL // bit   5
 #define ldlm_is_ast_sent(_l)            LDLM_TEST_FLAG(( _l), 1ULL <<  5)
 #define ldlm_set_ast_sent(_l)           LDLM_SET_FLAG((  _l), 1ULL <<  5)
 #define ldlm_clear_ast_sent(_l)         LDLM_CLEAR_FLAG((_l), 1ULL <<  5)
 
+/** Server must grant exactly the requested extent, without expanding it. */
+#define LDLM_FL_NO_EXPANSION		0x0000000000000040ULL /* bit   6 */
+#define ldlm_is_no_expansion(_l)	LDLM_TEST_FLAG((_l), 1ULL <<  6)
+#define ldlm_set_no_expansion(_l)	LDLM_SET_FLAG((_l), 1ULL <<  6)
+#define ldlm_clear_no_expansion(_l)	LDLM_CLEAR_FLAG((_l), 1ULL <<  6)
+
 /**
  * Lock is being replayed.  This could probably be implied by the fact that
  * one of BLOCK_{GRANTED,CONV,WAIT} is set, but that is pretty dangerous. */
@@ -379,9 +394,11 @@
 /* Flags inherited from wire on enqueue/reply between client/server. */
 /* NO_TIMEOUT flag to force ldlm_lock_match() to wait with no timeout. */
 /* TEST_LOCK flag to not let TEST lock to be granted. */
+/* NO_EXPANSION flag to keep the extent of a lock reprocessed later. */
 #define LDLM_FL_INHERIT_MASK            (LDLM_FL_CANCEL_ON_BLOCK	|\
 					 LDLM_FL_NO_TIMEOUT		|\
-					 LDLM_FL_TEST_LOCK)
+					 LDLM_FL_TEST_LOCK		|\
+					 LDLM_FL_NO_EXPANSION)
 
 /** flags returned in @flags parameter on ldlm_lock_enqueue,
  * to be re-constructed on re-send */
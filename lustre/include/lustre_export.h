@@ -120,6 +120,7 @@ struct filter_export_data {
 	long			fed_grant;    /* in bytes */
 	struct list_head	fed_mod_list; /* files being modified */
 	long			fed_pending;  /* bytes just being written */
+	int			fed_grant_cpt; /* CPT of the grant counters */
 	/* count of SOFT_SYNC RPCs, which will be reset after
 	 * ofd_soft_sync_limit number of RPCs, and trigger a sync. */
 	atomic_t		fed_soft_sync_count;
@@ -376,6 +377,23 @@ static inline int exp_connect_layout(struct obd_export *exp)
 	return !!(exp_connect_flags(exp) & OBD_CONNECT_LAYOUTLOCK);
 }
 
+static inline __u64 exp_connect_flags2(struct obd_export *exp)
+{
+	if (exp_connect_flags(exp) & OBD_CONNECT_FLAGS2)
+		return exp->exp_connect_data.ocd_connect_flags2;
+	return 0;
+}
+
+static inline bool exp_connect_batch_getattr(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_BATCH_GETATTR);
+}
+
+static inline bool exp_connect_batch_bl_ast(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_BATCH_BL_AST);
+}
+
 static inline bool exp_connect_lvb_type(struct obd_export *exp)
 {
 	LASSERT(exp != NULL);
@@ -1907,6 +1907,10 @@ struct ptlrpcd_ctl {
 	 * Number of the ptlrpcd's partners.
 	 */
 	int				pc_npartners;
+	/**
+	 * Number of requests taken from the partners, for statistics.
+	 */
+	unsigned long			pc_stolen;
 	/**
 	 * Record the partner index to be processed next.
 	 */
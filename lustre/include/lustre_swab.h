@@ -87,6 +87,7 @@ void lustre_swab_lfsck_request(struct lfsck_request *lr);
 void lustre_swab_lfsck_reply(struct lfsck_reply *lr);
 void lustre_swab_obdo(struct obdo *o);
 void lustre_swab_ost_body(struct ost_body *b);
+void lustre_swab_ost_copy(struct ost_copy *oc);
 void lustre_swab_ost_last_id(__u64 *id);
 void lustre_swab_fiemap(struct fiemap *fiemap);
 void lustre_swab_lov_user_md_v1(struct lov_user_md_v1 *lum);
@@ -113,6 +114,8 @@ void lustre_swab_out_update_buffer(struct out_update_buffer *oub);
 void lustre_swab_object_update_result(struct object_update_result *our);
 void lustre_swab_object_update_reply(struct object_update_reply *our);
 void lustre_swab_swap_layouts(struct mdc_swap_layouts *msl);
+void lustre_swab_mdt_batch_getattr_item(struct mdt_batch_getattr_item *mgi);
+void lustre_swab_mdt_batch_getattr_reply(struct mdt_batch_getattr_reply *mgr);
 void lustre_swab_close_data(struct close_data *data);
 void lustre_swab_lmv_user_md(struct lmv_user_md *lum);
 void lustre_swab_ladvise(struct lu_ladvise *ladvise);
@@ -157,6 +157,67 @@ enum obd_cl_sem_lock_class {
 	OBD_CLI_SEM_MDCOSC,
 };
 
+/** One CPU partition of the LRU page list of a client_obd. Pages are added to
+ * the partition of the CPU completing their transfer, so that buffered I/O
+ * running on different CPTs doesn't contend on a single LRU lock. */
+struct cl_lru_part {
+	spinlock_t		clp_lock;
+	/** LRU pages, oldest first */
+	struct list_head	clp_list;
+	/** # of pages in clp_list, protected by clp_lock */
+	long			clp_count;
+	/** # of threads shrinking this partition. Only one non-forced
+	 * shrinker is allowed per partition */
+	atomic_t		clp_shrinkers;
+	/** client_obd this partition belongs to */
+	struct client_obd	*clp_cli;
+	/** ptlrpcd work shrinking this partition, see lru_queue_work() */
+	void			*clp_work;
+	/** # of pages clp_work should drop */
+	atomic_long_t		clp_target;
+};
+
+/** Statistics of compressed BRW writes, see osc.*.compress_stats */
+struct cl_compr_stats {
+	spinlock_t		ccs_lock;
+	/** RPCs sent with a compressed bulk */
+	__u64			ccs_rpcs;
+	/** RPCs sent raw because no chunk could be compressed */
+	__u64			ccs_rpcs_raw;
+	/** chunks compressed, and sent raw because incompressible */
+	__u64			ccs_chunks;
+	__u64			ccs_chunks_raw;
+	/** bytes before and after compression */
+	__u64			ccs_bytes_in;
+	__u64			ccs_bytes_out;
+	/** time spent compressing, in microseconds */
+	__u64			ccs_usec;
+};
+
+/**
+ * State of the RPC size and depth controller, see osc.*.rpc_autotune.
+ * Protected by cl_loi_list_lock.
+ */
+struct cl_rpc_tune {
+	/** RPC size and RPCs in flight currently chosen by the controller */
+	__u32			crt_pages_per_rpc;
+	__u32			crt_rpcs_in_flight;
+	/** BRW RPCs completed, their bytes and summed latency in the current
+	 * sampling window */
+	__u32			crt_rpcs;
+	__u64			crt_bytes;
+	__u64			crt_usec;
+	ktime_t			crt_start;
+	/** throughput of the last window, in bytes per second */
+	__u64			crt_rate;
+	/** lowest latency seen, in microseconds per MB transferred */
+	__u64			crt_base_usec;
+	/** windows sampled, and the increases and decreases decided */
+	__u64			crt_windows;
+	__u64			crt_increases;
+	__u64			crt_decreases;
+};
+
 struct mdc_rpc_lock;
 struct obd_import;
 struct client_obd {
@@ -267,9 +328,6 @@ struct client_obd {
 	atomic_long_t            cl_lru_busy;
 	/** # of LRU pages in the cache for this client_obd */
 	atomic_long_t            cl_lru_in_list;
-	/** # of threads are shrinking LRU cache. To avoid contention, it's not
-	 * allowed to have multiple threads shrinking LRU cache. */
-	atomic_t                 cl_lru_shrinkers;
 	/** The time when this LRU cache was last used. */
 	time64_t		 cl_lru_last_used;
 	/** stats: how many reclaims have happened for this client_obd.
@@ -277,10 +335,8 @@ struct client_obd {
 	 * reclaim is sync, initiated by IO thread when the LRU slots are
 	 * in shortage. */
 	__u64                    cl_lru_reclaim;
-	/** List of LRU pages for this client_obd */
-	struct list_head         cl_lru_list;
-	/** Lock for LRU page list */
-	spinlock_t		 cl_lru_list_lock;
+	/** Per-CPT lists of LRU pages for this client_obd */
+	struct cl_lru_part     **cl_lru_parts;
 	/** # of unstable pages in this client_obd.
 	 * An unstable page is a page state that WRITE RPC has finished but
 	 * the transaction has NOT yet committed. */
@@ -318,6 +374,17 @@ struct client_obd {
         /* checksum algorithm to be used */
         cksum_type_t             cl_cksum_type;
 
+	/* compression of BRW write bulk, OBD_COMPR_NONE if disabled */
+	enum obd_compr_type	 cl_compr_type;
+	/* compression types supported by both ends, worked out at connect */
+	__u32			 cl_supp_compr_types;
+	struct cl_compr_stats	 cl_compr_stats;
+
+	/* adjust RPC size and depth from the observed BRW latency and
+	 * throughput, within cl_max_pages_per_rpc and cl_max_rpcs_in_flight */
+	unsigned int		 cl_rpc_autotune:1;
+	struct cl_rpc_tune	 cl_rpc_tune;
+
         /* also protected by the poorly named _loi_list_lock lock above */
         struct osc_async_rc      cl_ar;
 
@@ -429,6 +496,8 @@ struct niobuf_local {
 	int		lnb_rc;
 	struct page	*lnb_page;
 	void		*lnb_data;
+	/* the page is locked, reads can share unlocked pages */
+	__u16		lnb_locked:1;
 };
 
 struct tgt_thread_big_cache {
@@ -873,6 +942,33 @@ struct md_enqueue_info {
 	void			       *mi_cbdata;
 };
 
+/* one entry of a batched stat */
+struct md_batch_item {
+	struct lustre_handle	 mbi_lockh;	/* lock granted on success */
+	struct lu_fid		 mbi_fid;	/* child FID from the dirent */
+	const char		*mbi_name;
+	int			 mbi_namelen;
+	int			 mbi_rc;	/* per-entry result */
+	struct mdt_body		*mbi_body;	/* attributes, in the reply */
+	void			*mbi_cbdata;
+};
+
+struct md_batch_info;
+typedef int (*md_batch_cb_t)(struct ptlrpc_request *req,
+			     struct md_batch_info *binfo, int rc);
+
+/* metadata stat-ahead of several entries in one RPC */
+struct md_batch_info {
+	struct md_op_data		mb_data;	/* parent directory */
+	struct inode		       *mb_dir;
+	struct ldlm_enqueue_info	mb_einfo;
+	md_batch_cb_t			mb_cb;
+	void			       *mb_cbdata;
+	int				mb_count;
+	int				mb_max;
+	struct md_batch_item		mb_items[0];
+};
+
 struct obd_ops {
 	struct module *o_owner;
 	int (*o_iocontrol)(unsigned int cmd, struct obd_export *exp, int len,
@@ -1068,6 +1164,9 @@ struct md_ops {
 	int (*m_intent_getattr_async)(struct obd_export *,
 				      struct md_enqueue_info *);
 
+	int (*m_batch_getattr_async)(struct obd_export *,
+				     struct md_batch_info *);
+
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
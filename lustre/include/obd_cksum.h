@@ -36,6 +36,60 @@
 #include <libcfs/libcfs_crypto.h>
 #include <lustre/lustre_idl.h>
 
+#define OBD_CKSUM_T10_ALL (OBD_CKSUM_T10IP512 | OBD_CKSUM_T10IP4K | \
+			   OBD_CKSUM_T10CRC512 | OBD_CKSUM_T10CRC4K)
+
+static inline bool cksum_type_is_t10(cksum_type_t cksum_type)
+{
+	return (cksum_type & OBD_CKSUM_T10_ALL) != 0;
+}
+
+/* sector size covered by one T10 PI guard tag */
+static inline unsigned int cksum_t10_sector_size(cksum_type_t cksum_type)
+{
+	switch (cksum_type) {
+	case OBD_CKSUM_T10IP512:
+	case OBD_CKSUM_T10CRC512:
+		return 512;
+	case OBD_CKSUM_T10IP4K:
+	case OBD_CKSUM_T10CRC4K:
+		return 4096;
+	default:
+		return 0;
+	}
+}
+
+/* Number of guard tags of \a len bytes at \a offset in a page. Sectors are
+ * aligned on the file offset so that nodes with different page sizes agree,
+ * the first and last one may be partial. */
+static inline unsigned int cksum_t10_guards(cksum_type_t cksum_type,
+					    unsigned int offset,
+					    unsigned int len)
+{
+	unsigned int sector = cksum_t10_sector_size(cksum_type);
+
+	return (round_up(offset + len, sector) -
+		round_down(offset, sector)) / sector;
+}
+
+int obd_page_dif_generate(cksum_type_t cksum_type, struct page *page,
+			  unsigned int offset, unsigned int len,
+			  __be16 *guards, unsigned int nr_guards);
+int obd_page_dif_hash(struct cfs_crypto_hash_desc *hdesc,
+		      cksum_type_t cksum_type, struct page *page,
+		      unsigned int offset, unsigned int len,
+		      __be16 *guards, unsigned int nr_guards);
+
+/* get page fragment \a idx of a bulk, see obd_cksum_bulk() */
+typedef void (*obd_cksum_frag_get_t)(void *data, int idx, struct page **page,
+				     unsigned int *offset, unsigned int *len);
+
+int obd_cksum_bulk(cksum_type_t cksum_type, obd_cksum_frag_get_t get,
+		   void *data, int nr_frags, __be16 *guards,
+		   unsigned int nr_guards, __u32 *cksum);
+int obd_cksum_init(void);
+void obd_cksum_fini(void);
+
 static inline unsigned char cksum_obd2cfs(cksum_type_t cksum_type)
 {
 	switch (cksum_type) {
@@ -45,6 +99,13 @@ static inline unsigned char cksum_obd2cfs(cksum_type_t cksum_type)
 		return CFS_HASH_ALG_ADLER32;
 	case OBD_CKSUM_CRC32C:
 		return CFS_HASH_ALG_CRC32C;
+	/* T10 PI types hash the per-sector guard tags */
+	case OBD_CKSUM_T10IP512:
+	case OBD_CKSUM_T10IP4K:
+		return CFS_HASH_ALG_ADLER32;
+	case OBD_CKSUM_T10CRC512:
+	case OBD_CKSUM_T10CRC4K:
+		return CFS_HASH_ALG_CRC32;
 	default:
 		CERROR("Unknown checksum type (%x)!!!\n", cksum_type);
 		LBUG();
@@ -91,9 +152,31 @@ static inline u32 cksum_type_pack(cksum_type_t cksum_type)
 	}
 	if (unlikely(cksum_type && !(cksum_type & (OBD_CKSUM_CRC32C |
 						   OBD_CKSUM_CRC32 |
-						   OBD_CKSUM_ADLER))))
+						   OBD_CKSUM_ADLER |
+						   OBD_CKSUM_T10_ALL))))
 		CWARN("unknown cksum type %x\n", cksum_type);
 
+	/* T10 PI types are only used when asked for explicitly, a mask of
+	 * several types selects the fastest whole-RPC checksum above */
+	if (performance == 0) {
+		switch (cksum_type) {
+		case OBD_CKSUM_T10IP512:
+			flag = OBD_FL_CKSUM_T10IP512;
+			break;
+		case OBD_CKSUM_T10IP4K:
+			flag = OBD_FL_CKSUM_T10IP4K;
+			break;
+		case OBD_CKSUM_T10CRC512:
+			flag = OBD_FL_CKSUM_T10CRC512;
+			break;
+		case OBD_CKSUM_T10CRC4K:
+			flag = OBD_FL_CKSUM_T10CRC4K;
+			break;
+		default:
+			break;
+		}
+	}
+
 	return flag;
 }
 
@@ -104,6 +187,14 @@ static inline cksum_type_t cksum_type_unpack(u32 o_flags)
 		return OBD_CKSUM_CRC32C;
 	case OBD_FL_CKSUM_CRC32:
 		return OBD_CKSUM_CRC32;
+	case OBD_FL_CKSUM_T10IP512:
+		return OBD_CKSUM_T10IP512;
+	case OBD_FL_CKSUM_T10IP4K:
+		return OBD_CKSUM_T10IP4K;
+	case OBD_FL_CKSUM_T10CRC512:
+		return OBD_CKSUM_T10CRC512;
+	case OBD_FL_CKSUM_T10CRC4K:
+		return OBD_CKSUM_T10CRC4K;
 	default:
 		break;
 	}
@@ -128,6 +219,8 @@ static inline cksum_type_t cksum_types_supported_client(void)
 		ret |= OBD_CKSUM_CRC32C;
 	if (cfs_crypto_hash_speed(cksum_obd2cfs(OBD_CKSUM_CRC32)) > 0)
 		ret |= OBD_CKSUM_CRC32;
+	/* guard tags are computed without the crypto API */
+	ret |= OBD_CKSUM_T10_ALL;
 
 	return ret;
 }
@@ -151,6 +244,7 @@ static inline cksum_type_t cksum_types_supported_server(void)
 	if (cfs_crypto_hash_speed(cksum_obd2cfs(OBD_CKSUM_CRC32)) >=
 	    base_speed)
 		ret |= OBD_CKSUM_CRC32;
+	ret |= OBD_CKSUM_T10_ALL;
 
 	return ret;
 }
@@ -170,6 +264,8 @@ static inline cksum_type_t cksum_type_select(cksum_type_t cksum_types)
 
 /* Checksum algorithm names. Must be defined in the same order as the
  * OBD_CKSUM_* flags. */
-#define DECLARE_CKSUM_NAME char *cksum_name[] = {"crc32", "adler", "crc32c"}
+#define DECLARE_CKSUM_NAME char *cksum_name[] = {"crc32", "adler", "crc32c", \
+						 "t10ip512", "t10ip4K", \
+						 "t10crc512", "t10crc4K"}
 
 #endif /* __OBD_H */
@@ -0,0 +1,64 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Compression of BRW bulk data, see ptlrpc/compress.c.
+ */
+
+#ifndef __OBD_COMPRESS_H
+#define __OBD_COMPRESS_H
+
+#include <libcfs/libcfs.h>
+#include <lustre/lustre_idl.h>
+
+#define DECLARE_COMPR_NAME char *compr_name[] = {"none", "lz4", "lzo", \
+						 "deflate"}
+
+/* uncompressed bytes per chunk of a compressed BRW */
+#define OBD_COMPR_CHUNK_SIZE	(64 * 1024)
+/* largest chunk accepted by the server */
+#define OBD_COMPR_CHUNK_MAX	(1024 * 1024)
+
+/* Worst case size of @len bytes after compression, for all algorithms. The
+ * lz4 and lzo compressors of older kernels do not check the output length,
+ * so the destination buffer must always be that large. */
+#define OBD_COMPR_BOUND(len)	((len) + (len) / 16 + 128)
+
+static inline __u32 obd_compr_type2mask(enum obd_compr_type type)
+{
+	return type == OBD_COMPR_NONE ? 0 : 1U << type;
+}
+
+struct ptlrpc_compr_ctx;
+
+__u32 ptlrpc_compr_types_supported(void);
+int ptlrpc_compr_pool_setup(__u32 types);
+struct ptlrpc_compr_ctx *ptlrpc_compr_get(enum obd_compr_type type,
+					  bool alloc);
+void ptlrpc_compr_put(struct ptlrpc_compr_ctx *ctx);
+int ptlrpc_compress(struct ptlrpc_compr_ctx *ctx, const void *src,
+		    unsigned int slen, void *dst, unsigned int *dlen);
+int ptlrpc_decompress(struct ptlrpc_compr_ctx *ctx, const void *src,
+		      unsigned int slen, void *dst, unsigned int *dlen);
+
+#endif /* __OBD_COMPRESS_H */
@@ -69,6 +69,8 @@ extern unsigned int at_history;
 extern int at_early_margin;
 extern int at_extra;
 extern unsigned long obd_max_dirty_pages;
+extern unsigned int obd_cksum_parallel_min_kb;
+extern unsigned int cl_page_arena_batch;
 extern atomic_long_t obd_dirty_pages;
 extern atomic_long_t obd_dirty_transit_pages;
 extern char obd_jobid_var[];
@@ -327,6 +329,7 @@ extern char obd_jobid_var[];
 #define OBD_FAIL_OST_PAUSE_PUNCH         0x236
 #define OBD_FAIL_OST_LADVISE_PAUSE	 0x237
 #define OBD_FAIL_OST_FAKE_WRITE          0x238
+#define OBD_FAIL_OST_COPY_NET		 0x239
 
 #define OBD_FAIL_LDLM                    0x300
 #define OBD_FAIL_LDLM_NAMESPACE_NEW      0x301
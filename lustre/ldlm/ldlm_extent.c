@@ -281,6 +281,11 @@ static void ldlm_extent_policy(struct ldlm_resource *res,
                  */
                 return;
 
+	/* lock ahead asks for exactly the extent it is going to write, so
+	 * that several clients can each own their part of a shared file */
+	if (ldlm_is_no_expansion(lock))
+		return;
+
         if (lock->l_policy_data.l_extent.start == 0 &&
             lock->l_policy_data.l_extent.end == OBD_OBJECT_EOF)
                 /* fast-path whole file locks */
@@ -421,7 +426,8 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                         }
 
                         if (tree->lit_mode == LCK_GROUP) {
-                                if (*flags & LDLM_FL_BLOCK_NOWAIT) {
+				if (*flags & (LDLM_FL_BLOCK_NOWAIT |
+					      LDLM_FL_SPECULATIVE)) {
                                         compat = -EWOULDBLOCK;
                                         goto destroylock;
                                 }
@@ -438,6 +444,17 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                                 continue;
                         }
 
+			/* a speculative lock never revokes the locks of
+			 * other users */
+			if (*flags & LDLM_FL_SPECULATIVE) {
+				if (interval_is_overlapped(tree->lit_root,
+							   &ex)) {
+					compat = -EWOULDBLOCK;
+					goto destroylock;
+				}
+				continue;
+			}
+
                         if (!work_list) {
                                 rc = interval_is_overlapped(tree->lit_root,&ex);
                                 if (rc)
@@ -583,7 +600,8 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                                 /* If compared lock is GROUP, then requested is PR/PW/
                                  * so this is not compatible; extent range does not
                                  * matter */
-                                if (*flags & LDLM_FL_BLOCK_NOWAIT) {
+				if (*flags & (LDLM_FL_BLOCK_NOWAIT |
+					      LDLM_FL_SPECULATIVE)) {
                                         compat = -EWOULDBLOCK;
                                         goto destroylock;
                                 } else {
@@ -599,6 +617,11 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                                 check_contention = 0;
                         }
 
+			if (*flags & LDLM_FL_SPECULATIVE) {
+				compat = -EWOULDBLOCK;
+				goto destroylock;
+			}
+
                         if (!work_list)
                                 RETURN(0);
 
@@ -1060,18 +1083,6 @@ struct ldlm_interval *ldlm_interval_detach(struct ldlm_lock *l)
 	return list_empty(&n->li_group) ? n : NULL;
 }
 
-static inline int ldlm_mode_to_index(enum ldlm_mode mode)
-{
-	int index;
-
-	LASSERT(mode != 0);
-	LASSERT(is_power_of_2(mode));
-	for (index = -1; mode != 0; index++, mode >>= 1)
-		/* do nothing */;
-	LASSERT(index < LCK_MODE_NUM);
-	return index;
-}
-
 /** Add newly granted lock into interval tree for the resource. */
 void ldlm_extent_add_lock(struct ldlm_resource *res,
                           struct ldlm_lock *lock)
@@ -56,12 +56,281 @@
 
 #include "ldlm_internal.h"
 
+/*
+ * Once a resource has many locks, the server indexes its granted and
+ * waiting inodebits locks in struct ldlm_ibits_queues: every lock is linked,
+ * for each bit it holds, in the list of that bit and of its mode. A conflict
+ * check then only walks the lists of the bits of the request and of the
+ * modes incompatible with it, instead of the whole lr_granted and lr_waiting
+ * queues. Walking the whole lr_waiting queue for each waiting lock made the
+ * reprocessing of a busy resource quadratic in the number of its locks.
+ *
+ * Every inodebits lock of a server namespace gets a struct ldlm_ibits_node
+ * when it is created, so the index can be built at any time under the
+ * resource lock. The index is an optimization only: the resource is checked
+ * through its queues as before until the index is built, or if it can not
+ * be allocated.
+ */
+
+/* locks walked in one conflict check before the resource is indexed */
+#define LDLM_IBITS_INDEX_MIN	64
+
+struct kmem_cache *ldlm_ibits_node_slab;
+struct kmem_cache *ldlm_ibits_queues_slab;
+
+/** Bits of an inodebits lock that are indexed in slot \a slot. */
+static inline __u64 ldlm_ibits_slot_bits(int slot)
+{
+	if (slot == LDLM_IBITS_INDEX_SLOTS - 1)
+		return ~0ULL << slot;
+	return 1ULL << slot;
+}
+
+int ldlm_ibits_node_alloc(struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node;
+	int i;
+
+	LASSERT(lock->l_ibits_node == NULL);
+
+	OBD_SLAB_ALLOC_PTR_GFP(node, ldlm_ibits_node_slab, GFP_NOFS);
+	if (node == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++)
+		INIT_LIST_HEAD(&node->lin_link[i]);
+	node->lin_lock = lock;
+	lock->l_ibits_node = node;
+
+	return 0;
+}
+
+void ldlm_ibits_node_free(struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+	int i;
+
+	if (node == NULL)
+		return;
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++)
+		LASSERT(list_empty(&node->lin_link[i]));
+	lock->l_ibits_node = NULL;
+	OBD_SLAB_FREE_PTR(node, ldlm_ibits_node_slab);
+}
+
+/** Drop the index of \a res, its queues are walked until it is rebuilt. */
+static void ldlm_inodebits_unindex(struct ldlm_resource *res)
+{
+	struct ldlm_ibits_queues *queues = res->lr_ibits_queues;
+	int i;
+	int j;
+
+	check_res_locked(res);
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++) {
+		for (j = 0; j < LCK_MODE_NUM; j++) {
+			while (!list_empty(&queues->liq_granted[i][j]))
+				list_del_init(queues->liq_granted[i][j].next);
+			while (!list_empty(&queues->liq_waiting[i][j]))
+				list_del_init(queues->liq_waiting[i][j].next);
+		}
+	}
+	res->lr_ibits_queues = NULL;
+	OBD_SLAB_FREE_PTR(queues, ldlm_ibits_queues_slab);
+}
+
+/**
+ * Index \a lock that was just added to the queue \a head of \a res.
+ *
+ * Locks added to the waiting queue get the next waiting sequence number,
+ * so that the locks enqueued after a waiting request can be told apart.
+ */
+void ldlm_inodebits_add_lock(struct ldlm_resource *res, struct list_head *head,
+			     struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_queues *queues = res->lr_ibits_queues;
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+	__u64 bits = lock->l_policy_data.l_inodebits.bits;
+	struct list_head (*lists)[LCK_MODE_NUM];
+	int idx;
+	int i;
+
+	check_res_locked(res);
+
+	if (queues == NULL)
+		return;
+
+	if (head != &res->lr_granted && head != &res->lr_waiting)
+		return;
+
+	if (unlikely(node == NULL)) {
+		/* not created by this server, it can't be indexed */
+		LDLM_ERROR(lock, "inodebits lock without index node");
+		ldlm_inodebits_unindex(res);
+		return;
+	}
+
+	if (head == &res->lr_granted) {
+		lists = queues->liq_granted;
+		node->lin_seq = 0;
+	} else {
+		lists = queues->liq_waiting;
+		node->lin_seq = ++queues->liq_seq;
+	}
+
+	idx = ldlm_mode_to_index(lock->l_req_mode);
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++)
+		if (bits & ldlm_ibits_slot_bits(i))
+			list_add_tail(&node->lin_link[i], &lists[i][idx]);
+}
+
+/** Remove \a lock from the index of its resource, if any. */
+void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+	int i;
+
+	if (node == NULL)
+		return;
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++)
+		list_del_init(&node->lin_link[i]);
+	node->lin_seq = 0;
+}
+
 #ifdef HAVE_SERVER_SUPPORT
+/**
+ * Build the index of \a res from its granted and waiting queues.
+ *
+ * This is called under the resource lock when a conflict check walked many
+ * locks. Failing to allocate the index is not an error, it is tried again
+ * by the next conflict check.
+ */
+static void ldlm_inodebits_index(struct ldlm_resource *res)
+{
+	struct ldlm_ibits_queues *queues;
+	struct ldlm_lock *lock;
+	int i;
+	int j;
+
+	check_res_locked(res);
+	LASSERT(res->lr_ibits_queues == NULL);
+
+	OBD_SLAB_ALLOC_PTR_GFP(queues, ldlm_ibits_queues_slab, GFP_ATOMIC);
+	if (queues == NULL)
+		return;
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++) {
+		for (j = 0; j < LCK_MODE_NUM; j++) {
+			INIT_LIST_HEAD(&queues->liq_granted[i][j]);
+			INIT_LIST_HEAD(&queues->liq_waiting[i][j]);
+		}
+	}
+	queues->liq_seq = 0;
+	res->lr_ibits_queues = queues;
+
+	list_for_each_entry(lock, &res->lr_granted, l_res_link) {
+		ldlm_inodebits_add_lock(res, &res->lr_granted, lock);
+		if (res->lr_ibits_queues == NULL)
+			return;
+	}
+	list_for_each_entry(lock, &res->lr_waiting, l_res_link) {
+		ldlm_inodebits_add_lock(res, &res->lr_waiting, lock);
+		if (res->lr_ibits_queues == NULL)
+			return;
+	}
+	CDEBUG(D_DLMTRACE, "indexed inodebits locks of resource "DLDLMRES"\n",
+	       PLDLMRES(res));
+}
+
+/**
+ * Determine if the lock is compatible with all locks of the granted or the
+ * waiting index \a lists of its resource.
+ *
+ * Only the lists of the bits of \a req and of the modes incompatible with
+ * it are walked. The lists of the waiting index are in lr_waiting order,
+ * the walk stops at the first lock enqueued after \a req if it is waiting.
+ *
+ * \see ldlm_inodebits_compat_list() for the arguments and return values.
+ */
+static int
+ldlm_inodebits_compat_index(struct list_head (*lists)[LCK_MODE_NUM],
+			    struct ldlm_lock *req, struct list_head *work_list)
+{
+	__u64 req_bits = req->l_policy_data.l_inodebits.bits;
+	__u64 req_seq = 0;
+	int compat = 1;
+	int i;
+	int j;
+
+	if (lists == req->l_resource->lr_ibits_queues->liq_waiting &&
+	    req->l_ibits_node != NULL)
+		req_seq = req->l_ibits_node->lin_seq;
+
+	for (i = 0; i < LDLM_IBITS_INDEX_SLOTS; i++) {
+		if (!(req_bits & ldlm_ibits_slot_bits(i)))
+			continue;
+
+		for (j = 0; j < LCK_MODE_NUM; j++) {
+			enum ldlm_mode mode = 1 << j;
+			struct ldlm_ibits_node *node;
+
+			if (list_empty(&lists[i][j]))
+				continue;
+
+			/* see ldlm_inodebits_compat_list() about COS */
+			if (mode == LCK_COS && !ldlm_is_cos_incompat(req) &&
+			    !ldlm_is_cos_enabled(req))
+				continue;
+
+			if (lockmode_compat(mode, req->l_req_mode))
+				continue;
+
+			list_for_each_entry(node, &lists[i][j], lin_link[i]) {
+				struct ldlm_lock *lock = node->lin_lock;
+
+				/* Don't take locks enqueued after us into
+				 * account, or we'd wait forever. */
+				if (lock == req ||
+				    (req_seq != 0 && node->lin_seq >= req_seq))
+					break;
+
+				/* the higher bits share a single slot */
+				if (!(lock->l_policy_data.l_inodebits.bits &
+				      req_bits))
+					continue;
+
+				if (mode == LCK_COS &&
+				    !ldlm_is_cos_incompat(req) &&
+				    ldlm_is_cos_enabled(req) &&
+				    lock->l_client_cookie ==
+				    req->l_client_cookie)
+					continue;
+
+				if (work_list == NULL)
+					return 0;
+
+				compat = 0;
+				/* a lock with several bits of the request is
+				 * found in several lists, but is added to
+				 * @work_list only once */
+				if (lock->l_blocking_ast)
+					ldlm_add_ast_work_item(lock, req,
+							       work_list);
+			}
+		}
+	}
+
+	return compat;
+}
+
 /**
  * Determine if the lock is compatible with all locks on the queue.
  *
  * If \a work_list is provided, conflicting locks are linked there.
  * If \a work_list is not provided, we exit this function on first conflict.
+ * The number of locks walked is added to \a walked.
  *
  * \retval 0 if there are conflicting locks in the \a queue
  * \retval 1 if the lock is compatible to all locks in \a queue
@@ -73,8 +342,8 @@
  * locks if first lock of the bunch is not conflicting with us.
  */
 static int
-ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
-			    struct list_head *work_list)
+ldlm_inodebits_compat_list(struct list_head *queue, struct ldlm_lock *req,
+			   struct list_head *work_list, int *walked)
 {
 	struct list_head *tmp;
 	struct ldlm_lock *lock;
@@ -82,14 +351,11 @@ ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 	int compat = 1;
 	ENTRY;
 
-	/* There is no sense in lock with no bits set, I think.
-	 * Also, such a lock would be compatible with any other bit lock */
-	LASSERT(req_bits != 0);
-
 	list_for_each(tmp, queue) {
 		struct list_head *mode_tail;
 
 		lock = list_entry(tmp, struct ldlm_lock, l_res_link);
+		(*walked)++;
 
 		/* We stop walking the queue if we hit ourselves so we don't
 		 * take conflicting locks enqueued after us into account,
@@ -162,12 +428,46 @@ ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                         tmp = tmp->next;
 			lock = list_entry(tmp, struct ldlm_lock,
                                               l_res_link);
+			(*walked)++;
 		} /* Loop over policy groups within one mode group. */
 	} /* Loop over mode groups within @queue. */
 
 	RETURN(compat);
 }
 
+/**
+ * Determine if the lock is compatible with all locks on the granted or
+ * waiting \a queue of its resource, through the index of the resource if
+ * it has one. A resource whose queue is long to walk gets indexed.
+ *
+ * \see ldlm_inodebits_compat_list()
+ */
+static int
+ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
+			    struct list_head *work_list)
+{
+	struct ldlm_resource *res = req->l_resource;
+	struct ldlm_ibits_queues *queues = res->lr_ibits_queues;
+	int walked = 0;
+	int rc;
+
+	/* There is no sense in lock with no bits set, I think.
+	 * Also, such a lock would be compatible with any other bit lock */
+	LASSERT(req->l_policy_data.l_inodebits.bits != 0);
+
+	if (queues != NULL)
+		return ldlm_inodebits_compat_index(queue == &res->lr_granted ?
+						   queues->liq_granted :
+						   queues->liq_waiting,
+						   req, work_list);
+
+	rc = ldlm_inodebits_compat_list(queue, req, work_list, &walked);
+	if (walked >= LDLM_IBITS_INDEX_MIN && ns_is_server(ldlm_res_to_ns(res)))
+		ldlm_inodebits_index(res);
+
+	return rc;
+}
+
 /**
  * Process a granting attempt for IBITS lock.
  * Must be called with ns lock held
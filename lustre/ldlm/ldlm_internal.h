@@ -106,6 +106,7 @@ enum ldlm_lru_flags {
 	LDLM_LRU_FLAG_LRUR_NO_WAIT = 0x20, /* LRUR + NO_WAIT */
 };
 
+int ldlm_request_bufsize(int count, int type);
 int ldlm_cancel_lru(struct ldlm_namespace *ns, int nr,
 		    enum ldlm_cancel_flags cancel_flags,
 		    enum ldlm_lru_flags lru_flags);
@@ -130,6 +131,9 @@ struct ldlm_cb_set_arg {
 	atomic_t			 restart;
 	struct list_head			*list;
 	union ldlm_gl_desc		*gl_desc; /* glimpse AST descriptor */
+	/* most locks per blocking AST RPC, 0 to send one RPC per lock */
+	unsigned int			 bl_batch_max;
+	struct ldlm_bl_batch		*bl_batch; /* blocking AST being filled */
 };
 
 typedef enum {
@@ -169,6 +173,10 @@ int ldlm_lock_remove_from_lru_nolock(struct ldlm_lock *lock);
 void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock);
 void ldlm_lock_add_to_lru(struct ldlm_lock *lock);
 void ldlm_lock_touch_in_lru(struct ldlm_lock *lock);
+void ldlm_lru_ghost_add(struct ldlm_namespace *ns,
+			const struct ldlm_res_id *name);
+int ldlm_lru_set_policy(struct ldlm_namespace *ns,
+			enum ldlm_lru_policy policy);
 void ldlm_lock_destroy_nolock(struct ldlm_lock *lock);
 
 int ldlm_export_cancel_blocked_locks(struct obd_export *exp);
@@ -185,6 +193,10 @@ int ldlm_bl_thread_wakeup(void);
 
 void ldlm_handle_bl_callback(struct ldlm_namespace *ns,
                              struct ldlm_lock_desc *ld, struct ldlm_lock *lock);
+#ifdef HAVE_SERVER_SUPPORT
+void ldlm_bl_batch_flush(struct ldlm_cb_set_arg *arg);
+int ldlm_waiting_locks_seq_show(struct seq_file *m, void *v);
+#endif
 
 #ifdef HAVE_SERVER_SUPPORT
 /* ldlm_plain.c */
@@ -197,6 +209,13 @@ int ldlm_process_inodebits_lock(struct ldlm_lock *lock, __u64 *flags,
 				int first_enq, enum ldlm_error *err,
 				struct list_head *work_list);
 #endif
+extern struct kmem_cache *ldlm_ibits_node_slab;
+extern struct kmem_cache *ldlm_ibits_queues_slab;
+int ldlm_ibits_node_alloc(struct ldlm_lock *lock);
+void ldlm_ibits_node_free(struct ldlm_lock *lock);
+void ldlm_inodebits_add_lock(struct ldlm_resource *res, struct list_head *head,
+			     struct ldlm_lock *lock);
+void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock);
 
 /* ldlm_extent.c */
 #ifdef HAVE_SERVER_SUPPORT
@@ -246,6 +265,18 @@ ldlm_interval_extent(struct ldlm_interval *node)
         return &lock->l_policy_data.l_extent;
 }
 
+static inline int ldlm_mode_to_index(enum ldlm_mode mode)
+{
+	int index;
+
+	LASSERT(mode != 0);
+	LASSERT(is_power_of_2(mode));
+	for (index = -1; mode != 0; index++, mode >>= 1)
+		/* do nothing */;
+	LASSERT(index < LCK_MODE_NUM);
+	return index;
+}
+
 int ldlm_init(void);
 void ldlm_exit(void);
 
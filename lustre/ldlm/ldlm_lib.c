@@ -381,11 +381,9 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 
 	/* lru for osc. */
 	INIT_LIST_HEAD(&cli->cl_lru_osc);
-	atomic_set(&cli->cl_lru_shrinkers, 0);
 	atomic_long_set(&cli->cl_lru_busy, 0);
 	atomic_long_set(&cli->cl_lru_in_list, 0);
-	INIT_LIST_HEAD(&cli->cl_lru_list);
-	spin_lock_init(&cli->cl_lru_list_lock);
+	cli->cl_lru_parts = NULL;
 	atomic_long_set(&cli->cl_unstable_count, 0);
 	INIT_LIST_HEAD(&cli->cl_shrink_list);
 
@@ -401,6 +399,9 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	 */
 	cli->cl_cksum_type = cli->cl_supp_cksum_types = OBD_CKSUM_CRC32;
 #endif
+	cli->cl_compr_type = OBD_COMPR_NONE;
+	cli->cl_supp_compr_types = 0;
+	spin_lock_init(&cli->cl_compr_stats.ccs_lock);
 	atomic_set(&cli->cl_resends, OSC_DEFAULT_RESENDS);
 
 	/* Set it to possible maximum size. It may be reduced by ocd_brw_size
@@ -215,6 +215,7 @@ void ldlm_lock_put(struct ldlm_lock *lock)
                         OBD_FREE_LARGE(lock->l_lvb_data, lock->l_lvb_len);
 
                 ldlm_interval_free(ldlm_interval_detach(lock));
+		ldlm_ibits_node_free(lock);
                 lu_ref_fini(&lock->l_reference);
 		OBD_FREE_RCU(lock, sizeof(*lock), &lock->l_handle);
         }
@@ -223,6 +224,54 @@ void ldlm_lock_put(struct ldlm_lock *lock)
 }
 EXPORT_SYMBOL(ldlm_lock_put);
 
+/*
+ * The ghosts of the LRU remember the resources of the locks cancelled from
+ * it, in a table indexed by the hash of the resource name. A newer ghost
+ * replaces an older one with the same index, so the table keeps about the
+ * last LDLM_LRU_GHOSTS resources.
+ */
+static inline __u32 ldlm_lru_ghost_hash(const struct ldlm_res_id *name)
+{
+	/* never 0, which is an empty slot */
+	return cfs_hash_djb2_hash(name->name, sizeof(name->name), ~0U) | 1;
+}
+
+static inline __u32 *ldlm_lru_ghost_slot(struct ldlm_namespace *ns, __u32 hash)
+{
+	return &ns->ns_lru_ghosts[(hash >> 1) & (LDLM_LRU_GHOSTS - 1)];
+}
+
+/**
+ * Remember that a lock of resource \a name was cancelled from the LRU of
+ * \a ns. Assumes LRU is already locked.
+ */
+void ldlm_lru_ghost_add(struct ldlm_namespace *ns,
+			const struct ldlm_res_id *name)
+{
+	__u32 hash = ldlm_lru_ghost_hash(name);
+
+	if (ns->ns_lru_ghosts != NULL)
+		*ldlm_lru_ghost_slot(ns, hash) = hash;
+}
+
+/* Whether a lock of \a name was cancelled from the LRU lately, forgetting it */
+static bool ldlm_lru_ghost_del(struct ldlm_namespace *ns,
+			       const struct ldlm_res_id *name)
+{
+	__u32 hash = ldlm_lru_ghost_hash(name);
+	__u32 *slot;
+
+	if (ns->ns_lru_ghosts == NULL)
+		return false;
+
+	slot = ldlm_lru_ghost_slot(ns, hash);
+	if (*slot != hash)
+		return false;
+
+	*slot = 0;
+	return true;
+}
+
 /**
  * Removes LDLM lock \a lock from LRU. Assumes LRU is already locked.
  */
@@ -236,6 +285,11 @@ int ldlm_lock_remove_from_lru_nolock(struct ldlm_lock *lock)
 		list_del_init(&lock->l_lru);
 		LASSERT(ns->ns_nr_unused > 0);
 		ns->ns_nr_unused--;
+		if (lock->l_lru_hot) {
+			lock->l_lru_hot = false;
+			LASSERT(ns->ns_nr_hot > 0);
+			ns->ns_nr_hot--;
+		}
 		rc = 1;
 	}
 	return rc;
@@ -273,15 +327,35 @@ int ldlm_lock_remove_from_lru_check(struct ldlm_lock *lock, cfs_time_t last_use)
 
 /**
  * Adds LDLM lock \a lock to namespace LRU. Assumes LRU is already locked.
+ *
+ * With LDLM_LRU_POLICY_2Q, a lock used again, or enqueued again soon after
+ * a lock of its resource was cancelled from the LRU, goes to ns_unused_hot.
  */
 void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock)
 {
 	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	bool hot = lock->l_lru_seen;
 
 	lock->l_last_used = cfs_time_current();
 	LASSERT(list_empty(&lock->l_lru));
 	LASSERT(lock->l_resource->lr_type != LDLM_FLOCK);
-	list_add_tail(&lock->l_lru, &ns->ns_unused_list);
+	if (!lock->l_lru_seen) {
+		lock->l_lru_seen = true;
+		lprocfs_counter_incr(ns->ns_stats, LDLM_NSS_LRU_MISSES);
+		if (ldlm_lru_ghost_del(ns, &lock->l_resource->lr_name)) {
+			lprocfs_counter_incr(ns->ns_stats,
+					     LDLM_NSS_LRU_REENQUEUES);
+			hot = true;
+		}
+	}
+
+	if (hot && ns->ns_lru_policy == LDLM_LRU_POLICY_2Q) {
+		list_add_tail(&lock->l_lru, &ns->ns_unused_hot);
+		lock->l_lru_hot = true;
+		ns->ns_nr_hot++;
+	} else {
+		list_add_tail(&lock->l_lru, &ns->ns_unused_list);
+	}
 	ldlm_clear_skipped(lock);
 	LASSERT(ns->ns_nr_unused >= 0);
 	ns->ns_nr_unused++;
@@ -321,11 +395,58 @@ void ldlm_lock_touch_in_lru(struct ldlm_lock *lock)
 	if (!list_empty(&lock->l_lru)) {
 		ldlm_lock_remove_from_lru_nolock(lock);
 		ldlm_lock_add_to_lru_nolock(lock);
+		lprocfs_counter_incr(ns->ns_stats, LDLM_NSS_LRU_HITS);
 	}
 	spin_unlock(&ns->ns_lock);
 	EXIT;
 }
 
+/**
+ * Change the LRU policy of \a ns. The locks used again are put back with
+ * the others when leaving LDLM_LRU_POLICY_2Q.
+ *
+ * The ghosts of a client namespace are only needed by LDLM_LRU_POLICY_2Q,
+ * so the table is allocated when switching to it and freed when leaving it.
+ */
+int ldlm_lru_set_policy(struct ldlm_namespace *ns,
+			enum ldlm_lru_policy policy)
+{
+	struct ldlm_lock *lock;
+	__u32 *ghosts = NULL;
+
+	if (policy == LDLM_LRU_POLICY_2Q && ns_is_client(ns) &&
+	    ns->ns_lru_ghosts == NULL) {
+		OBD_ALLOC_LARGE(ghosts, LDLM_LRU_GHOSTS * sizeof(*ghosts));
+		if (ghosts == NULL)
+			return -ENOMEM;
+	}
+
+	spin_lock(&ns->ns_lock);
+	ns->ns_lru_policy = policy;
+	if (policy == LDLM_LRU_POLICY_2Q) {
+		/* keep the table of a concurrent switch */
+		if (ns->ns_lru_ghosts == NULL) {
+			ns->ns_lru_ghosts = ghosts;
+			ghosts = NULL;
+		}
+	} else {
+		list_for_each_entry(lock, &ns->ns_unused_hot, l_lru)
+			lock->l_lru_hot = false;
+		list_splice_init(&ns->ns_unused_hot, &ns->ns_unused_list);
+		ns->ns_nr_hot = 0;
+		ghosts = ns->ns_lru_ghosts;
+		ns->ns_lru_ghosts = NULL;
+	}
+	spin_unlock(&ns->ns_lock);
+
+	if (ghosts != NULL)
+		OBD_FREE_LARGE(ghosts, LDLM_LRU_GHOSTS * sizeof(*ghosts));
+
+	return 0;
+}
+	spin_unlock(&ns->ns_lock);
+}
+
 /**
  * Helper to destroy a locked lock.
  *
@@ -728,7 +849,9 @@ EXPORT_SYMBOL(ldlm_lock_addref);
 void ldlm_lock_addref_internal_nolock(struct ldlm_lock *lock,
 				      enum ldlm_mode mode)
 {
-        ldlm_lock_remove_from_lru(lock);
+	if (ldlm_lock_remove_from_lru(lock))
+		lprocfs_counter_incr(ldlm_lock_to_ns(lock)->ns_stats,
+				     LDLM_NSS_LRU_HITS);
         if (mode & (LCK_NL | LCK_CR | LCK_PR)) {
                 lock->l_readers++;
                 lu_ref_add_atomic(&lock->l_reference, "reader", lock);
@@ -1060,6 +1183,8 @@ static void ldlm_granted_list_add_lock(struct ldlm_lock *lock,
 		list_add(&lock->l_sl_mode, prev->mode_link);
 	if (&lock->l_sl_policy != prev->policy_link)
 		list_add(&lock->l_sl_policy, prev->policy_link);
+	if (res->lr_type == LDLM_IBITS)
+		ldlm_inodebits_add_lock(res, &res->lr_granted, lock);
 
         EXIT;
 }
@@ -1671,6 +1796,10 @@ struct ldlm_lock *ldlm_lock_create(struct ldlm_namespace *ns,
 	if (type == LDLM_EXTENT)
 		if (ldlm_interval_alloc(lock) == NULL)
 			GOTO(out, rc = -ENOMEM);
+	/* the server indexes the inodebits locks of busy resources */
+	if (type == LDLM_IBITS && ns_is_server(ns))
+		if (ldlm_ibits_node_alloc(lock) != 0)
+			GOTO(out, rc = -ENOMEM);
 
 	if (lvb_len) {
 		lock->l_lvb_len = lvb_len;
@@ -1903,8 +2032,16 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	struct ldlm_lock       *lock;
 	ENTRY;
 
-	if (list_empty(arg->list))
+	if (list_empty(arg->list)) {
+#ifdef HAVE_SERVER_SUPPORT
+		/* send the blocking AST of the last locks */
+		if (arg->bl_batch != NULL) {
+			ldlm_bl_batch_flush(arg);
+			RETURN(0);
+		}
+#endif
 		RETURN(-ENOENT);
+	}
 
 	lock = list_entry(arg->list->next, struct ldlm_lock, l_bl_ast);
 
@@ -2063,6 +2200,9 @@ int ldlm_run_ast_work(struct ldlm_namespace *ns, struct list_head *rpc_list,
 	switch (ast_type) {
 		case LDLM_WORK_BL_AST:
 			arg->type = LDLM_BL_CALLBACK;
+			arg->bl_batch_max = min_t(unsigned int,
+						  ns->ns_max_bl_ast_batch,
+						  LDLM_MAX_BL_AST_BATCH);
 			work_ast_lock = ldlm_work_bl_ast_lock;
 			break;
 		case LDLM_WORK_CP_AST:
@@ -2092,6 +2232,7 @@ int ldlm_run_ast_work(struct ldlm_namespace *ns, struct list_head *rpc_list,
 
 	ptlrpc_set_wait(arg->set);
 	ptlrpc_set_destroy(arg->set);
+	LASSERT(arg->bl_batch == NULL);
 
 	rc = atomic_read(&arg->restart) ? -ERESTART : 0;
 	GOTO(out, rc);
@@ -63,17 +63,30 @@ struct kset *ldlm_svc_kset;
 struct ldlm_cb_async_args {
         struct ldlm_cb_set_arg *ca_set_arg;
         struct ldlm_lock       *ca_lock;
+	struct ldlm_bl_batch   *ca_batch;
+};
+
+/**
+ * Locks of one export revoked by the same blocking AST RPC, see
+ * ldlm_server_blocking_ast().
+ */
+struct ldlm_bl_batch {
+	struct ptlrpc_request	*bb_req;
+	struct obd_export	*bb_exp;
+	/* lock the locks are blocking, described by bb_desc */
+	struct ldlm_lock	*bb_blocking;
+	struct ldlm_lock_desc	 bb_desc;
+	/* LDLM_FL_AST_MASK flags of the locks */
+	__u64			 bb_flags;
+	int			 bb_max;
+	int			 bb_count;
+	struct ldlm_lock	*bb_locks[0];
 };
 
 /* LDLM state */
 
 static struct ldlm_state *ldlm_state;
 
-static inline cfs_time_t round_timeout(cfs_time_t timeout)
-{
-        return cfs_time_seconds((int)cfs_duration_sec(cfs_time_sub(timeout, 0)) + 1);
-}
-
 /* timeout for initial callback (AST) reply (bz10399) */
 static inline unsigned int ldlm_get_rq_timeout(void)
 {
@@ -125,40 +138,163 @@ struct ldlm_bl_work_item {
 
 #ifdef HAVE_SERVER_SUPPORT
 
-/**
- * Protects both waiting_locks_list and expired_lock_thread.
- */
-static spinlock_t waiting_locks_spinlock;   /* BH lock (timer) */
-
-/**
- * List for contended locks.
+/*
+ * Contended locks.
+ *
+ * As soon as a lock is contended, it gets added to a timer wheel and the
+ * expected time to get a response is filled in the lock. When it is not
+ * released in time, the lock is moved to the expired list of the wheel and a
+ * special thread schedules the eviction of its client.
  *
- * As soon as a lock is contended, it gets placed on this list and
- * expected time to get a response is filled in the lock. A special
- * thread walks the list looking for locks that should be released and
- * schedules client evictions for those that have not been released in
- * time.
+ * There is one wheel per CPT and a lock always uses the wheel its address
+ * hashes to, so adding, prolonging and removing a lock only take the lock of
+ * one wheel, and take constant time. A wheel has LDLM_WHEEL_SIZE slots of one
+ * second for the locks expiring in the current period of LDLM_WHEEL_SIZE
+ * seconds, and LDLM_WHEEL_SIZE slots of one period for the later locks, which
+ * are spread over the seconds at the start of their period. Locks beyond the
+ * last period are kept in it and spread again when it starts.
  *
- * All access to it should be under waiting_locks_spinlock.
+ * Each wheel has its own timer, armed for the next second with locks to
+ * expire or the start of the next period, so that the expiry of locks is
+ * spread over the CPTs as well.
  */
-static struct list_head waiting_locks_list;
-static struct timer_list waiting_locks_timer;
+#define LDLM_WHEEL_BITS		6
+#define LDLM_WHEEL_SIZE		(1 << LDLM_WHEEL_BITS)
+#define LDLM_WHEEL_MASK		(LDLM_WHEEL_SIZE - 1)
+
+struct ldlm_waiting_locks {
+	spinlock_t		wl_lock;	/* BH lock (timer) */
+	struct timer_list	wl_timer;
+	/* next second to be expired */
+	unsigned long		wl_clock;
+	/* second the timer is armed for */
+	unsigned long		wl_next;
+	/* locks in the wheel */
+	unsigned int		wl_count;
+	/* locks whose callback timer expired */
+	__u64			wl_timeouts;
+	/* timed out locks, for expired_lock_main() */
+	struct list_head	wl_expired;
+	/* locks expiring in each second of the current period */
+	struct list_head	wl_sec[LDLM_WHEEL_SIZE];
+	/* locks expiring in each of the next periods */
+	struct list_head	wl_period[LDLM_WHEEL_SIZE];
+};
+
+static struct ldlm_waiting_locks **ldlm_waiting_locks;
 
 static struct expired_lock_thread {
 	wait_queue_head_t	elt_waitq;
 	int			elt_state;
 	int			elt_dump;
-	struct list_head		elt_expired_locks;
 } expired_lock_thread;
 
+static inline struct ldlm_waiting_locks *ldlm_lock_to_wl(struct ldlm_lock *lock)
+{
+	return ldlm_waiting_locks[hash_long((unsigned long)lock, 32) %
+				  cfs_percpt_number(ldlm_waiting_locks)];
+}
+
+/* second at the start of which a lock timing out at \a timeout expires */
+static inline unsigned long ldlm_wheel_sec(cfs_time_t timeout)
+{
+	return cfs_duration_sec(timeout) + 1;
+}
+
+static inline unsigned long ldlm_wheel_period(unsigned long sec)
+{
+	return sec >> LDLM_WHEEL_BITS;
+}
+
+/**
+ * Link \a lock into the slot of \a wl for its l_callback_timeout.
+ *
+ * \retval the second at which the timer of \a wl has to fire for \a lock
+ */
+static unsigned long ldlm_wheel_link(struct ldlm_waiting_locks *wl,
+				     struct ldlm_lock *lock)
+{
+	unsigned long sec = ldlm_wheel_sec(lock->l_callback_timeout);
+	unsigned long period = ldlm_wheel_period(wl->wl_clock);
+
+	if (sec < wl->wl_clock)
+		sec = wl->wl_clock;
+
+	if (ldlm_wheel_period(sec) == period) {
+		list_add_tail(&lock->l_pending_chain,
+			      &wl->wl_sec[sec & LDLM_WHEEL_MASK]);
+		return sec;
+	}
+
+	period = min(ldlm_wheel_period(sec), period + LDLM_WHEEL_MASK);
+	list_add_tail(&lock->l_pending_chain,
+		      &wl->wl_period[period & LDLM_WHEEL_MASK]);
+
+	return (ldlm_wheel_period(wl->wl_clock) + 1) << LDLM_WHEEL_BITS;
+}
+
+/**
+ * Add \a lock to \a wl, to expire in \a seconds unless it was already due
+ * later.
+ *
+ * \retval the second at which the timer of \a wl has to fire for \a lock
+ */
+static unsigned long ldlm_wheel_add(struct ldlm_waiting_locks *wl,
+				    struct ldlm_lock *lock, int seconds)
+{
+	cfs_time_t timeout = cfs_time_shift(seconds);
+
+	if (likely(cfs_time_after(timeout, lock->l_callback_timeout)))
+		lock->l_callback_timeout = timeout;
+
+	/* all the slots are empty, catch the clock up */
+	if (wl->wl_count++ == 0)
+		wl->wl_clock = cfs_duration_sec(cfs_time_current());
+
+	return ldlm_wheel_link(wl, lock);
+}
+
+/* Make the timer of \a wl fire at \a sec at the latest */
+static void ldlm_wheel_arm(struct ldlm_waiting_locks *wl, unsigned long sec)
+{
+	if (!timer_pending(&wl->wl_timer) || sec < wl->wl_next) {
+		wl->wl_next = sec;
+		mod_timer(&wl->wl_timer, cfs_time_seconds(sec));
+	}
+}
+
+/* The next second with locks to expire, or the start of the next period */
+static unsigned long ldlm_wheel_next(struct ldlm_waiting_locks *wl)
+{
+	unsigned long sec = wl->wl_clock;
+
+	if (!(sec & LDLM_WHEEL_MASK) &&
+	    !list_empty(&wl->wl_period[ldlm_wheel_period(sec) &
+				       LDLM_WHEEL_MASK]))
+		return sec;
+
+	do {
+		if (!list_empty(&wl->wl_sec[sec & LDLM_WHEEL_MASK]))
+			break;
+	} while (++sec & LDLM_WHEEL_MASK);
+
+	return sec;
+}
+
 static inline int have_expired_locks(void)
 {
-	int need_to_run;
+	struct ldlm_waiting_locks *wl;
+	int need_to_run = 0;
+	int i;
 
 	ENTRY;
-	spin_lock_bh(&waiting_locks_spinlock);
-	need_to_run = !list_empty(&expired_lock_thread.elt_expired_locks);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	cfs_percpt_for_each(wl, i, ldlm_waiting_locks) {
+		spin_lock_bh(&wl->wl_lock);
+		need_to_run = !list_empty(&wl->wl_expired);
+		spin_unlock_bh(&wl->wl_lock);
+		if (need_to_run)
+			break;
+	}
 
 	RETURN(need_to_run);
 }
@@ -168,9 +304,10 @@ static inline int have_expired_locks(void)
  */
 static int expired_lock_main(void *arg)
 {
-	struct list_head *expired = &expired_lock_thread.elt_expired_locks;
+	struct ldlm_waiting_locks *wl;
 	struct l_wait_info lwi = { 0 };
 	int do_dump;
+	int i;
 
 	ENTRY;
 
@@ -183,70 +320,75 @@ static int expired_lock_main(void *arg)
 			     expired_lock_thread.elt_state == ELT_TERMINATE,
 			     &lwi);
 
-		spin_lock_bh(&waiting_locks_spinlock);
 		if (expired_lock_thread.elt_dump) {
-			spin_unlock_bh(&waiting_locks_spinlock);
-
 			/* from waiting_locks_callback, but not in timer */
 			libcfs_debug_dumplog();
-
-			spin_lock_bh(&waiting_locks_spinlock);
 			expired_lock_thread.elt_dump = 0;
 		}
 
 		do_dump = 0;
 
-		while (!list_empty(expired)) {
-			struct obd_export *export;
-			struct ldlm_lock *lock;
-
-			lock = list_entry(expired->next, struct ldlm_lock,
-					  l_pending_chain);
-			if ((void *)lock < LP_POISON + PAGE_SIZE &&
-			    (void *)lock >= LP_POISON) {
-				spin_unlock_bh(&waiting_locks_spinlock);
-				CERROR("free lock on elt list %p\n", lock);
-				LBUG();
-			}
-			list_del_init(&lock->l_pending_chain);
-			if ((void *)lock->l_export <
-			     LP_POISON + PAGE_SIZE &&
-			    (void *)lock->l_export >= LP_POISON) {
-				CERROR("lock with free export on elt list %p\n",
-				       lock->l_export);
-				lock->l_export = NULL;
-				LDLM_ERROR(lock, "free export");
-				/* release extra ref grabbed by
-				 * ldlm_add_waiting_lock() or
-				 * ldlm_failed_ast() */
-				LDLM_LOCK_RELEASE(lock);
-				continue;
-			}
+		cfs_percpt_for_each(wl, i, ldlm_waiting_locks) {
+			struct list_head *expired = &wl->wl_expired;
+
+			spin_lock_bh(&wl->wl_lock);
+			while (!list_empty(expired)) {
+				struct obd_export *export;
+				struct ldlm_lock *lock;
+
+				lock = list_entry(expired->next,
+						  struct ldlm_lock,
+						  l_pending_chain);
+				if ((void *)lock < LP_POISON + PAGE_SIZE &&
+				    (void *)lock >= LP_POISON) {
+					spin_unlock_bh(&wl->wl_lock);
+					CERROR("free lock on elt list %p\n",
+					       lock);
+					LBUG();
+				}
+				list_del_init(&lock->l_pending_chain);
+				lock->l_pending_expired = false;
+				if ((void *)lock->l_export <
+				     LP_POISON + PAGE_SIZE &&
+				    (void *)lock->l_export >= LP_POISON) {
+					CERROR("lock with free export on elt "
+					       "list %p\n", lock->l_export);
+					lock->l_export = NULL;
+					LDLM_ERROR(lock, "free export");
+					/* release extra ref grabbed by
+					 * ldlm_add_waiting_lock() or
+					 * ldlm_failed_ast() */
+					LDLM_LOCK_RELEASE(lock);
+					continue;
+				}
 
-			if (ldlm_is_destroyed(lock)) {
-				/* release the lock refcount where
-				 * waiting_locks_callback() founds */
-				LDLM_LOCK_RELEASE(lock);
-				continue;
-			}
-			export = class_export_lock_get(lock->l_export, lock);
-			spin_unlock_bh(&waiting_locks_spinlock);
+				if (ldlm_is_destroyed(lock)) {
+					/* release the lock refcount where
+					 * waiting_locks_callback() founds */
+					LDLM_LOCK_RELEASE(lock);
+					continue;
+				}
+				export = class_export_lock_get(lock->l_export,
+							       lock);
+				spin_unlock_bh(&wl->wl_lock);
 
-			spin_lock_bh(&export->exp_bl_list_lock);
-			list_del_init(&lock->l_exp_list);
-			spin_unlock_bh(&export->exp_bl_list_lock);
+				spin_lock_bh(&export->exp_bl_list_lock);
+				list_del_init(&lock->l_exp_list);
+				spin_unlock_bh(&export->exp_bl_list_lock);
 
-			do_dump++;
-			class_fail_export(export);
-			class_export_lock_put(export, lock);
+				do_dump++;
+				class_fail_export(export);
+				class_export_lock_put(export, lock);
 
-			/* release extra ref grabbed by ldlm_add_waiting_lock()
-			 * or ldlm_failed_ast() */
-			LDLM_LOCK_RELEASE(lock);
+				/* release extra ref grabbed by
+				 * ldlm_add_waiting_lock() or ldlm_failed_ast()
+				 */
+				LDLM_LOCK_RELEASE(lock);
 
-			spin_lock_bh(&waiting_locks_spinlock);
+				spin_lock_bh(&wl->wl_lock);
+			}
+			spin_unlock_bh(&wl->wl_lock);
 		}
-		spin_unlock_bh(&waiting_locks_spinlock);
 
 		if (do_dump && obd_dump_on_eviction) {
 			CERROR("dump the log upon eviction\n");
@@ -292,120 +434,115 @@ static int ldlm_lock_busy(struct ldlm_lock *lock)
 }
 
 /* This is called from within a timer interrupt and cannot schedule */
-static void waiting_locks_callback(unsigned long unused)
-{
-	struct ldlm_lock	*lock;
-	int			need_dump = 0;
-
-	spin_lock_bh(&waiting_locks_spinlock);
-	while (!list_empty(&waiting_locks_list)) {
-		lock = list_entry(waiting_locks_list.next, struct ldlm_lock,
-                                      l_pending_chain);
-                if (cfs_time_after(lock->l_callback_timeout,
-                                   cfs_time_current()) ||
-                    (lock->l_req_mode == LCK_GROUP))
-                        break;
-
-                /* Check if we need to prolong timeout */
-                if (!OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT) &&
-                    ldlm_lock_busy(lock)) {
-                        int cont = 1;
-
-                        if (lock->l_pending_chain.next == &waiting_locks_list)
-                                cont = 0;
+static void waiting_locks_callback(unsigned long data)
+{
+	struct ldlm_waiting_locks *wl = (struct ldlm_waiting_locks *)data;
+	unsigned long now = cfs_duration_sec(cfs_time_current());
+	struct ldlm_lock *lock;
+	struct list_head list;
+	int need_dump = 0;
+
+	INIT_LIST_HEAD(&list);
+
+	spin_lock_bh(&wl->wl_lock);
+	if (wl->wl_count == 0)
+		wl->wl_clock = now + 1;
+
+	while (wl->wl_clock <= now) {
+		unsigned long sec = wl->wl_clock;
+
+		/* spread the locks of the period starting over its seconds */
+		if (!(sec & LDLM_WHEEL_MASK)) {
+			list_splice_init(&wl->wl_period[ldlm_wheel_period(sec) &
+							LDLM_WHEEL_MASK],
+					 &list);
+			while (!list_empty(&list)) {
+				lock = list_entry(list.next, struct ldlm_lock,
+						  l_pending_chain);
+				list_del(&lock->l_pending_chain);
+				ldlm_wheel_link(wl, lock);
+			}
+		}
 
-                        LDLM_LOCK_GET(lock);
+		list_splice_init(&wl->wl_sec[sec & LDLM_WHEEL_MASK], &list);
+		wl->wl_clock++;
 
-			spin_unlock_bh(&waiting_locks_spinlock);
-			LDLM_DEBUG(lock, "prolong the busy lock");
-			ldlm_refresh_waiting_lock(lock,
-						  ldlm_bl_timeout(lock) >> 1);
-			spin_lock_bh(&waiting_locks_spinlock);
+		while (!list_empty(&list)) {
+			lock = list_entry(list.next, struct ldlm_lock,
+					  l_pending_chain);
+			list_del_init(&lock->l_pending_chain);
+			wl->wl_count--;
+
+			/* group locks are never evicted, check them again
+			 * later as busy locks */
+			if (lock->l_req_mode == LCK_GROUP ||
+			    (!OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT) &&
+			     ldlm_lock_busy(lock))) {
+				LDLM_DEBUG(lock, "prolong the busy lock");
+				ldlm_wheel_add(wl, lock,
+					       ldlm_bl_timeout(lock) >> 1);
+				continue;
+			}
 
-                        if (!cont) {
-                                LDLM_LOCK_RELEASE(lock);
-                                break;
-                        }
+			ldlm_lock_to_ns(lock)->ns_timeouts++;
+			wl->wl_timeouts++;
+			LDLM_ERROR(lock, "lock callback timer expired after "
+				   "%llds: evicting client at %s ",
+				   ktime_get_real_seconds() -
+				   lock->l_last_activity,
+				   libcfs_nid2str(
+				   lock->l_export->exp_connection->c_peer.nid));
+
+			/* no needs to take an extra ref on the lock since it
+			 * was in the wheel and ldlm_add_waiting_lock()
+			 * already grabbed a ref */
+			lock->l_pending_expired = true;
+			list_add(&lock->l_pending_chain, &wl->wl_expired);
+			need_dump = 1;
+		}
+	}
 
-                        LDLM_LOCK_RELEASE(lock);
-                        continue;
-                }
-                ldlm_lock_to_ns(lock)->ns_timeouts++;
-		LDLM_ERROR(lock, "lock callback timer expired after %llds: "
-                           "evicting client at %s ",
-			   ktime_get_real_seconds() - lock->l_last_activity,
-                           libcfs_nid2str(
-                                   lock->l_export->exp_connection->c_peer.nid));
-
-                /* no needs to take an extra ref on the lock since it was in
-                 * the waiting_locks_list and ldlm_add_waiting_lock()
-                 * already grabbed a ref */
-		list_del(&lock->l_pending_chain);
-		list_add(&lock->l_pending_chain,
-                             &expired_lock_thread.elt_expired_locks);
-		need_dump = 1;
-	}
-
-	if (!list_empty(&expired_lock_thread.elt_expired_locks)) {
+	if (!list_empty(&wl->wl_expired)) {
 		if (obd_dump_on_timeout && need_dump)
 			expired_lock_thread.elt_dump = __LINE__;
 
 		wake_up(&expired_lock_thread.elt_waitq);
 	}
 
-        /*
-         * Make sure the timer will fire again if we have any locks
-         * left.
-         */
-	if (!list_empty(&waiting_locks_list)) {
-                cfs_time_t timeout_rounded;
-		lock = list_entry(waiting_locks_list.next, struct ldlm_lock,
-                                      l_pending_chain);
-                timeout_rounded = (cfs_time_t)round_timeout(lock->l_callback_timeout);
-		mod_timer(&waiting_locks_timer, timeout_rounded);
-        }
-	spin_unlock_bh(&waiting_locks_spinlock);
+	/*
+	 * Make sure the timer will fire again if we have any locks
+	 * left.
+	 */
+	if (wl->wl_count != 0)
+		ldlm_wheel_arm(wl, ldlm_wheel_next(wl));
+	spin_unlock_bh(&wl->wl_lock);
 }
 
 /**
  * Add lock to the list of contended locks.
  *
  * Indicate that we're waiting for a client to call us back cancelling a given
- * lock.  We add it to the pending-callback chain, and schedule the lock-timeout
- * timer to fire appropriately.  (We round up to the next second, to avoid
- * floods of timer firings during periods of high lock contention and traffic).
- * As done by ldlm_add_waiting_lock(), the caller must grab a lock reference
- * if it has been added to the waiting list (1 is returned).
+ * lock.  We add it to the timer wheel of the lock, and schedule the
+ * lock-timeout timer to fire appropriately.  (We round up to the next second,
+ * to avoid floods of timer firings during periods of high lock contention and
+ * traffic). As done by ldlm_add_waiting_lock(), the caller must grab a lock
+ * reference if it has been added to the waiting list (1 is returned).
  *
- * Called with the namespace lock held.
+ * Called with the wl_lock of the wheel held.
  */
 static int __ldlm_add_waiting_lock(struct ldlm_lock *lock, int seconds)
 {
-        cfs_time_t timeout;
-        cfs_time_t timeout_rounded;
+	struct ldlm_waiting_locks *wl = ldlm_lock_to_wl(lock);
 
 	if (!list_empty(&lock->l_pending_chain))
-                return 0;
-
-        if (OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT) ||
-            OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT))
-                seconds = 1;
-
-        timeout = cfs_time_shift(seconds);
-        if (likely(cfs_time_after(timeout, lock->l_callback_timeout)))
-                lock->l_callback_timeout = timeout;
+		return 0;
 
-        timeout_rounded = round_timeout(lock->l_callback_timeout);
+	if (OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT) ||
+	    OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT))
+		seconds = 1;
 
-	if (cfs_time_before(timeout_rounded, waiting_locks_timer.expires) ||
-	    !timer_pending(&waiting_locks_timer)) {
-		mod_timer(&waiting_locks_timer, timeout_rounded);
-        }
-        /* if the new lock has a shorter timeout than something earlier on
-           the list, we'll wait the longer amount of time; no big deal. */
-        /* FIFO */
-	list_add_tail(&lock->l_pending_chain, &waiting_locks_list);
-        return 1;
+	ldlm_wheel_arm(wl, ldlm_wheel_add(wl, lock, seconds));
+	return 1;
 }
 
 static void ldlm_add_blocked_lock(struct ldlm_lock *lock)
@@ -432,6 +569,7 @@ static void ldlm_add_blocked_lock(struct ldlm_lock *lock)
 
 static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 {
+	struct ldlm_waiting_locks *wl = ldlm_lock_to_wl(lock);
 	int ret;
 	int timeout = ldlm_bl_timeout(lock);
 
@@ -445,16 +583,16 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 	    (exp_connect_flags(lock->l_export) & OBD_CONNECT_MDS_MDS))
 		return 0;
 
-	spin_lock_bh(&waiting_locks_spinlock);
+	spin_lock_bh(&wl->wl_lock);
 	if (ldlm_is_cancel(lock)) {
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
 		return 0;
 	}
 
 	if (ldlm_is_destroyed(lock)) {
 		static cfs_time_t next;
 
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
 		LDLM_ERROR(lock, "not waiting on destroyed lock (bug 5653)");
 		if (cfs_time_after(cfs_time_current(), next)) {
 			next = cfs_time_shift(14400);
@@ -471,7 +609,7 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 		 * waiting list */
 		LDLM_LOCK_GET(lock);
 	}
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_unlock_bh(&wl->wl_lock);
 
 	if (ret)
 		ldlm_add_blocked_lock(lock);
@@ -484,41 +622,31 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 
 /**
  * Remove a lock from the pending list, likely because it had its cancellation
- * callback arrive without incident.  This adjusts the lock-timeout timer if
- * needed.  Returns 0 if the lock wasn't pending after all, 1 if it was.
+ * callback arrive without incident.  The timer of the wheel is left as is, at
+ * worst it fires with nothing to expire.  Returns 0 if the lock wasn't pending
+ * after all, 1 if it was.
  * As done by ldlm_del_waiting_lock(), the caller must release the lock
  * reference when the lock is removed from any list (1 is returned).
  *
- * Called with namespace lock held.
+ * Called with the wl_lock of the wheel held.
  */
 static int __ldlm_del_waiting_lock(struct ldlm_lock *lock)
 {
-	struct list_head *list_next;
-
 	if (list_empty(&lock->l_pending_chain))
-                return 0;
+		return 0;
 
-        list_next = lock->l_pending_chain.next;
-        if (lock->l_pending_chain.prev == &waiting_locks_list) {
-                /* Removing the head of the list, adjust timer. */
-                if (list_next == &waiting_locks_list) {
-                        /* No more, just cancel. */
-			del_timer(&waiting_locks_timer);
-                } else {
-                        struct ldlm_lock *next;
-			next = list_entry(list_next, struct ldlm_lock,
-                                              l_pending_chain);
-			mod_timer(&waiting_locks_timer,
-				  round_timeout(next->l_callback_timeout));
-                }
-        }
 	list_del_init(&lock->l_pending_chain);
+	if (lock->l_pending_expired)
+		lock->l_pending_expired = false;
+	else
+		ldlm_lock_to_wl(lock)->wl_count--;
 
-        return 1;
+	return 1;
 }
 
 int ldlm_del_waiting_lock(struct ldlm_lock *lock)
 {
+	struct ldlm_waiting_locks *wl;
         int ret;
 
         if (lock->l_export == NULL) {
@@ -527,10 +655,11 @@ int ldlm_del_waiting_lock(struct ldlm_lock *lock)
                 return 0;
         }
 
-	spin_lock_bh(&waiting_locks_spinlock);
+	wl = ldlm_lock_to_wl(lock);
+	spin_lock_bh(&wl->wl_lock);
 	ret = __ldlm_del_waiting_lock(lock);
 	ldlm_clear_waited(lock);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_unlock_bh(&wl->wl_lock);
 
 	/* remove the lock out of export blocking list */
 	spin_lock_bh(&lock->l_export->exp_bl_list_lock);
@@ -554,6 +683,8 @@ int ldlm_del_waiting_lock(struct ldlm_lock *lock)
  */
 int ldlm_refresh_waiting_lock(struct ldlm_lock *lock, int timeout)
 {
+	struct ldlm_waiting_locks *wl;
+
 	if (lock->l_export == NULL) {
 		/* We don't have a "waiting locks list" on clients. */
 		LDLM_DEBUG(lock, "client lock: no-op");
@@ -566,10 +697,11 @@ int ldlm_refresh_waiting_lock(struct ldlm_lock *lock, int timeout)
 		return 0;
 	}
 
-	spin_lock_bh(&waiting_locks_spinlock);
+	wl = ldlm_lock_to_wl(lock);
+	spin_lock_bh(&wl->wl_lock);
 
 	if (list_empty(&lock->l_pending_chain)) {
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
 		LDLM_DEBUG(lock, "wasn't waiting");
 		return 0;
 	}
@@ -578,13 +710,41 @@ int ldlm_refresh_waiting_lock(struct ldlm_lock *lock, int timeout)
 	 * release/take a lock reference */
 	__ldlm_del_waiting_lock(lock);
 	__ldlm_add_waiting_lock(lock, timeout);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_unlock_bh(&wl->wl_lock);
 
 	LDLM_DEBUG(lock, "refreshed");
 	return 1;
 }
 EXPORT_SYMBOL(ldlm_refresh_waiting_lock);
 
+/**
+ * Show the number of locks waiting in the wheel of each CPT, and how many
+ * locks of it timed out.
+ */
+int ldlm_waiting_locks_seq_show(struct seq_file *m, void *v)
+{
+	struct ldlm_waiting_locks *wl;
+	int i;
+
+	if (ldlm_waiting_locks == NULL)
+		return 0;
+
+	cfs_percpt_for_each(wl, i, ldlm_waiting_locks) {
+		unsigned int count;
+		__u64 timeouts;
+
+		spin_lock_bh(&wl->wl_lock);
+		count = wl->wl_count;
+		timeouts = wl->wl_timeouts;
+		spin_unlock_bh(&wl->wl_lock);
+
+		seq_printf(m, "cpt%d: { waiting: %u, timeouts: %llu }\n",
+			   i, count, timeouts);
+	}
+
+	return 0;
+}
+
 #else /* HAVE_SERVER_SUPPORT */
 
 int ldlm_del_waiting_lock(struct ldlm_lock *lock)
@@ -632,6 +792,8 @@ EXPORT_SYMBOL(ldlm_bl_timeout);
 static void ldlm_failed_ast(struct ldlm_lock *lock, int rc,
                             const char *ast_type)
 {
+	struct ldlm_waiting_locks *wl = ldlm_lock_to_wl(lock);
+
         LCONSOLE_ERROR_MSG(0x138, "%s: A client on nid %s was evicted due "
                            "to a lock %s callback time out: rc %d\n",
                            lock->l_export->exp_obd->obd_name,
@@ -639,15 +801,15 @@ static void ldlm_failed_ast(struct ldlm_lock *lock, int rc,
 
         if (obd_dump_on_timeout)
                 libcfs_debug_dumplog();
-	spin_lock_bh(&waiting_locks_spinlock);
+	spin_lock_bh(&wl->wl_lock);
 	if (__ldlm_del_waiting_lock(lock) == 0)
 		/* the lock was not in any list, grab an extra ref before adding
 		 * the lock to the expired list */
 		LDLM_LOCK_GET(lock);
-	list_add(&lock->l_pending_chain,
-		     &expired_lock_thread.elt_expired_locks);
+	lock->l_pending_expired = true;
+	list_add(&lock->l_pending_chain, &wl->wl_expired);
 	wake_up(&expired_lock_thread.elt_waitq);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_unlock_bh(&wl->wl_lock);
 }
 
 /**
@@ -712,6 +874,48 @@ static int ldlm_handle_ast_error(struct ldlm_lock *lock,
 	return rc;
 }
 
+static void ldlm_bl_batch_free(struct ldlm_bl_batch *batch)
+{
+	if (batch->bb_blocking != NULL)
+		LDLM_LOCK_RELEASE(batch->bb_blocking);
+	OBD_FREE(batch, offsetof(struct ldlm_bl_batch, bb_locks[batch->bb_max]));
+}
+
+/**
+ * Handle the reply to a batched blocking AST, which has a status for each of
+ * its locks. An error of the whole RPC applies to all the locks.
+ */
+static void ldlm_bl_batch_interpret(struct ptlrpc_request *req,
+				    struct ldlm_bl_batch *batch,
+				    struct ldlm_cb_set_arg *arg, int rc)
+{
+	__u32 *rcs = NULL;
+	int i;
+
+	if (rc == 0) {
+		rcs = req_capsule_server_sized_get(&req->rq_pill,
+						   &RMF_DLM_BL_RC,
+						   batch->bb_count *
+						   sizeof(*rcs));
+		if (rcs == NULL)
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < batch->bb_count; i++) {
+		struct ldlm_lock *lock = batch->bb_locks[i];
+		int lock_rc = rcs != NULL ? (int)rcs[i] : rc;
+
+		if (lock_rc != 0)
+			lock_rc = ldlm_handle_ast_error(lock, req, lock_rc,
+							"blocking");
+		if (lock_rc == -ERESTART)
+			atomic_inc(&arg->restart);
+		/* release the reference taken in ldlm_bl_batch_add() */
+		LDLM_LOCK_RELEASE(lock);
+	}
+	ldlm_bl_batch_free(batch);
+}
+
 static int ldlm_cb_interpret(const struct lu_env *env,
                              struct ptlrpc_request *req, void *data, int rc)
 {
@@ -743,6 +947,10 @@ static int ldlm_cb_interpret(const struct lu_env *env,
 		}
 		break;
 	case LDLM_BL_CALLBACK:
+		if (ca->ca_batch != NULL) {
+			ldlm_bl_batch_interpret(req, ca->ca_batch, arg, rc);
+			RETURN(0);
+		}
 		if (rc != 0)
 			rc = ldlm_handle_ast_error(lock, req, rc, "blocking");
 		break;
@@ -769,8 +977,17 @@ static void ldlm_update_resend(struct ptlrpc_request *req, void *data)
 {
 	struct ldlm_cb_async_args *ca   = data;
 	struct ldlm_lock          *lock = ca->ca_lock;
+	int			   i;
+
+	if (ca->ca_batch == NULL) {
+		ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+		return;
+	}
 
-	ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+	for (i = 0; i < ca->ca_batch->bb_count; i++) {
+		lock = ca->ca_batch->bb_locks[i];
+		ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+	}
 }
 
 static inline int ldlm_ast_fini(struct ptlrpc_request *req,
@@ -826,12 +1043,185 @@ static void ldlm_lock_reorder_req(struct ldlm_lock *lock)
 	EXIT;
 }
 
+/**
+ * Start a blocking AST that will revoke the locks of the export of \a lock
+ * that are blocking the same lock.
+ *
+ * The request is allocated for the largest batch, so that adding locks to it
+ * and sending it can not fail.
+ */
+static struct ldlm_bl_batch *ldlm_bl_batch_new(struct ldlm_lock *lock,
+					       struct ldlm_lock_desc *desc,
+					       struct ldlm_cb_set_arg *arg)
+{
+	struct ldlm_bl_batch *batch;
+	struct ptlrpc_request *req;
+	int max = arg->bl_batch_max;
+	int rc;
+
+	OBD_ALLOC(batch, offsetof(struct ldlm_bl_batch, bb_locks[max]));
+	if (batch == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	req = ptlrpc_request_alloc(lock->l_export->exp_imp_reverse,
+				   &RQF_LDLM_BL_CALLBACK_BATCH);
+	if (req == NULL) {
+		OBD_FREE(batch, offsetof(struct ldlm_bl_batch, bb_locks[max]));
+		return ERR_PTR(-ENOMEM);
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT,
+			     ldlm_request_bufsize(max, LDLM_BL_CALLBACK));
+	rc = ptlrpc_request_pack(req, LUSTRE_DLM_VERSION, LDLM_BL_CALLBACK);
+	if (rc != 0) {
+		ptlrpc_request_free(req);
+		OBD_FREE(batch, offsetof(struct ldlm_bl_batch, bb_locks[max]));
+		return ERR_PTR(rc);
+	}
+
+	batch->bb_req = req;
+	batch->bb_exp = lock->l_export;
+	batch->bb_blocking = LDLM_LOCK_GET(lock->l_blocking_lock);
+	batch->bb_desc = *desc;
+	batch->bb_flags = lock->l_flags & LDLM_FL_AST_MASK;
+	batch->bb_max = max;
+
+	return batch;
+}
+
+/**
+ * Send the blocking AST of the locks added to the batch of \a arg.
+ */
+void ldlm_bl_batch_flush(struct ldlm_cb_set_arg *arg)
+{
+	struct ldlm_bl_batch *batch = arg->bl_batch;
+	struct ptlrpc_request *req = batch->bb_req;
+	struct ldlm_cb_async_args *ca;
+	struct ldlm_request *body;
+	int i;
+
+	arg->bl_batch = NULL;
+	if (batch->bb_count == 0) {
+		/* none of the locks needed a blocking AST after all */
+		ptlrpc_req_finished(req);
+		ldlm_bl_batch_free(batch);
+		return;
+	}
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
+	for (i = 0; i < batch->bb_count; i++)
+		body->lock_handle[i] = batch->bb_locks[i]->l_remote_handle;
+	/* a non-zero lock_count tells the client to reply with a status for
+	 * each lock */
+	body->lock_count = batch->bb_count;
+	body->lock_desc = batch->bb_desc;
+	body->lock_flags |= ldlm_flags_to_wire(batch->bb_flags);
+	req_capsule_shrink(&req->rq_pill, &RMF_DLM_REQ,
+			   ldlm_request_bufsize(batch->bb_count,
+						LDLM_BL_CALLBACK),
+			   RCL_CLIENT);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_BL_RC, RCL_SERVER,
+			     batch->bb_count * sizeof(__u32));
+	ptlrpc_request_set_replen(req);
+
+	CLASSERT(sizeof(*ca) <= sizeof(req->rq_async_args));
+	ca = ptlrpc_req_async_args(req);
+	ca->ca_set_arg = arg;
+	ca->ca_lock = batch->bb_locks[0];
+	ca->ca_batch = batch;
+	req->rq_interpret_reply = ldlm_cb_interpret;
+
+	/* Do not resend after lock callback timeout */
+	req->rq_delay_limit = ldlm_bl_timeout(batch->bb_locks[0]);
+	req->rq_resend_cb = ldlm_update_resend;
+	req->rq_send_state = LUSTRE_IMP_FULL;
+	/* ptlrpc_request_pack already set timeout */
+	if (AT_OFF)
+		req->rq_timeout = ldlm_get_rq_timeout();
+
+	DEBUG_REQ(D_DLMTRACE, req, "blocking AST for %d locks",
+		  batch->bb_count);
+	ptlrpc_set_add_req(arg->set, req);
+}
+
+/**
+ * Add \a lock to the blocking AST being filled for its export, starting a
+ * new one if the lock can not join it.
+ *
+ * The locks of a batch belong to the same export, are blocking the same lock
+ * and have the same AST flags. The batch is sent once it is full, when a lock
+ * that can not join it comes, or at the end of the AST work list.
+ */
+static int ldlm_bl_batch_add(struct ldlm_lock *lock,
+			     struct ldlm_lock_desc *desc,
+			     struct ldlm_cb_set_arg *arg)
+{
+	struct ldlm_bl_batch *batch = arg->bl_batch;
+	ENTRY;
+
+	if (batch != NULL &&
+	    (batch->bb_exp != lock->l_export ||
+	     batch->bb_blocking != lock->l_blocking_lock ||
+	     batch->bb_flags != (lock->l_flags & LDLM_FL_AST_MASK) ||
+	     batch->bb_count == batch->bb_max)) {
+		ldlm_bl_batch_flush(arg);
+		batch = NULL;
+	}
+
+	if (batch == NULL) {
+		batch = ldlm_bl_batch_new(lock, desc, arg);
+		if (IS_ERR(batch))
+			RETURN(PTR_ERR(batch));
+		arg->bl_batch = batch;
+	}
+
+	lock_res_and_lock(lock);
+	if (ldlm_is_destroyed(lock)) {
+		unlock_res_and_lock(lock);
+		RETURN(0);
+	}
+
+	if (lock->l_granted_mode != lock->l_req_mode) {
+		/* this blocking AST will be communicated as part of the
+		 * completion AST instead */
+		ldlm_add_blocked_lock(lock);
+		ldlm_set_waited(lock);
+		unlock_res_and_lock(lock);
+
+		LDLM_DEBUG(lock, "lock not granted, not sending blocking AST");
+		RETURN(0);
+	}
+
+	LDLM_DEBUG(lock, "server preparing batched blocking AST");
+
+	ldlm_set_cbpending(lock);
+	ldlm_add_waiting_lock(lock);
+	unlock_res_and_lock(lock);
+
+	lock->l_last_activity = ktime_get_real_seconds();
+
+	if (lock->l_export->exp_nid_stats &&
+	    lock->l_export->exp_nid_stats->nid_ldlm_stats)
+		lprocfs_counter_incr(lock->l_export->exp_nid_stats->nid_ldlm_stats,
+				     LDLM_BL_CALLBACK - LDLM_FIRST_OPC);
+
+	/* released in ldlm_bl_batch_interpret() */
+	batch->bb_locks[batch->bb_count++] = LDLM_LOCK_GET(lock);
+
+	RETURN(0);
+}
+
 /**
  * ->l_blocking_ast() method for server-side locks. This is invoked when newly
  * enqueued server lock conflicts with given one.
  *
  * Sends blocking AST RPC to the client owning that lock; arms timeout timer
  * to wait for client response.
+ *
+ * When the client supports it, the blocking ASTs for the locks of an export
+ * that block the same lock are gathered into a single RPC carrying all their
+ * handles, see ldlm_bl_batch_add().
  */
 int ldlm_server_blocking_ast(struct ldlm_lock *lock,
                              struct ldlm_lock_desc *desc,
@@ -861,6 +1251,11 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
 
         ldlm_lock_reorder_req(lock);
 
+	if (arg->bl_batch_max > 1 && lock->l_blocking_lock != NULL &&
+	    exp_connect_batch_bl_ast(lock->l_export) &&
+	    !ldlm_is_cancel_on_block(lock))
+		RETURN(ldlm_bl_batch_add(lock, desc, arg));
+
         req = ptlrpc_request_alloc_pack(lock->l_export->exp_imp_reverse,
                                         &RQF_LDLM_BL_CALLBACK,
                                         LUSTRE_DLM_VERSION, LDLM_BL_CALLBACK);
@@ -871,6 +1266,7 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
         ca = ptlrpc_req_async_args(req);
         ca->ca_set_arg = arg;
         ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
         req->rq_interpret_reply = ldlm_cb_interpret;
 
@@ -989,6 +1385,7 @@ int ldlm_server_completion_ast(struct ldlm_lock *lock, __u64 flags, void *data)
         ca = ptlrpc_req_async_args(req);
         ca->ca_set_arg = arg;
         ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
         req->rq_interpret_reply = ldlm_cb_interpret;
         body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
@@ -1115,6 +1512,7 @@ int ldlm_server_glimpse_ast(struct ldlm_lock *lock, void *data)
 	ca = ptlrpc_req_async_args(req);
 	ca->ca_set_arg = arg;
 	ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
         /* server namespace, doesn't need lock */
         req_capsule_set_size(&req->rq_pill, &RMF_DLM_LVB, RCL_SERVER,
@@ -2134,6 +2532,94 @@ static inline void ldlm_callback_errmsg(struct ptlrpc_request *req,
                 CWARN("Send reply failed, maybe cause bug 21636.\n");
 }
 
+/**
+ * Handle a blocking AST revoking several locks at once.
+ *
+ * The reply has a status for each lock, -EINVAL telling the server that the
+ * lock is already gone as for a single lock. As for a single lock, the reply
+ * is sent before the locks are handed to the blocking threads.
+ */
+static void ldlm_handle_bl_callback_batch(struct ptlrpc_request *req,
+					  struct ldlm_namespace *ns,
+					  struct ldlm_request *dlm_req)
+{
+	DECLARE_BITMAP(valid, LDLM_MAX_BL_AST_BATCH);
+	struct ldlm_lock *lock;
+	__u32 count = dlm_req->lock_count;
+	__u32 *rcs;
+	int rc;
+	int i;
+	ENTRY;
+
+	if (count > LDLM_MAX_BL_AST_BATCH ||
+	    req_capsule_get_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT) <
+	    ldlm_request_bufsize(count, LDLM_BL_CALLBACK)) {
+		rc = ldlm_callback_reply(req, -EPROTO);
+		ldlm_callback_errmsg(req, "Operate with invalid lock count",
+				     rc, NULL);
+		RETURN_EXIT;
+	}
+
+	req_capsule_extend(&req->rq_pill, &RQF_LDLM_BL_CALLBACK_BATCH);
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_BL_RC, RCL_SERVER,
+			     count * sizeof(*rcs));
+	rc = req_capsule_server_pack(&req->rq_pill);
+	if (rc != 0) {
+		rc = ldlm_callback_reply(req, rc);
+		ldlm_callback_errmsg(req, "Pack batched reply", rc, NULL);
+		RETURN_EXIT;
+	}
+	rcs = req_capsule_server_get(&req->rq_pill, &RMF_DLM_BL_RC);
+
+	bitmap_zero(valid, LDLM_MAX_BL_AST_BATCH);
+	for (i = 0; i < count; i++) {
+		struct lustre_handle *lockh = &dlm_req->lock_handle[i];
+
+		rcs[i] = -EINVAL;
+		lock = ldlm_handle2lock_long(lockh, 0);
+		if (lock == NULL) {
+			CDEBUG(D_DLMTRACE, "callback on lock %#llx - lock "
+			       "disappeared\n", lockh->cookie);
+			continue;
+		}
+
+		/* see ldlm_callback_handler() for a single lock */
+		lock_res_and_lock(lock);
+		lock->l_flags |= ldlm_flags_from_wire(dlm_req->lock_flags &
+						      LDLM_FL_AST_MASK);
+		if ((ldlm_is_canceling(lock) && ldlm_is_bl_done(lock)) ||
+		    ldlm_is_failed(lock)) {
+			LDLM_DEBUG(lock, "callback on lock %llx - lock "
+				   "disappeared", lockh->cookie);
+		} else {
+			ldlm_lock_remove_from_lru(lock);
+			ldlm_set_bl_ast(lock);
+			rcs[i] = 0;
+			set_bit(i, valid);
+		}
+		unlock_res_and_lock(lock);
+		LDLM_LOCK_RELEASE(lock);
+	}
+
+	/* the reply buffer may be freed once sent, so the valid locks are
+	 * remembered in @valid */
+	rc = ldlm_callback_reply(req, 0);
+	if (req->rq_no_reply || rc)
+		ldlm_callback_errmsg(req, "Normal process", rc, NULL);
+
+	for_each_set_bit(i, valid, count) {
+		/* a lock cancelled meanwhile needs nothing more */
+		lock = ldlm_handle2lock_long(&dlm_req->lock_handle[i], 0);
+		if (lock == NULL)
+			continue;
+
+		if (ldlm_bl_to_thread_lock(ns, &dlm_req->lock_desc, lock))
+			ldlm_handle_bl_callback(ns, &dlm_req->lock_desc, lock);
+	}
+
+	EXIT;
+}
+
 /* TODO: handle requests in a similar way as MDT: see mdt_handle_common() */
 static int ldlm_callback_handler(struct ptlrpc_request *req)
 {
@@ -2233,6 +2719,13 @@ static int ldlm_callback_handler(struct ptlrpc_request *req)
                 RETURN(0);
         }
 
+	/* only batched blocking ASTs have a lock count */
+	if (lustre_msg_get_opc(req->rq_reqmsg) == LDLM_BL_CALLBACK &&
+	    dlm_req->lock_count > 0) {
+		ldlm_handle_bl_callback_batch(req, ns, dlm_req);
+		RETURN(0);
+	}
+
         /* Force a known safe race, send a cancel to the server for a lock
          * which the server has already started a blocking callback on. */
         if (OBD_FAIL_CHECK(OBD_FAIL_LDLM_CANCEL_BL_CB_RACE) &&
@@ -2944,7 +3437,9 @@ static int ldlm_setup(void)
 	static struct ptlrpc_service_conf	conf;
 	struct ldlm_bl_pool		       *blp = NULL;
 #ifdef HAVE_SERVER_SUPPORT
+	struct ldlm_waiting_locks *wl;
 	struct task_struct *task;
+	int j;
 #endif /* HAVE_SERVER_SUPPORT */
 	int i;
 	int rc = 0;
@@ -3090,13 +3585,24 @@ static int ldlm_setup(void)
 	}
 
 #ifdef HAVE_SERVER_SUPPORT
-	INIT_LIST_HEAD(&expired_lock_thread.elt_expired_locks);
 	expired_lock_thread.elt_state = ELT_STOPPED;
 	init_waitqueue_head(&expired_lock_thread.elt_waitq);
 
-	INIT_LIST_HEAD(&waiting_locks_list);
-	spin_lock_init(&waiting_locks_spinlock);
-	setup_timer(&waiting_locks_timer, waiting_locks_callback, 0);
+	ldlm_waiting_locks = cfs_percpt_alloc(cfs_cpt_table,
+					      sizeof(struct ldlm_waiting_locks));
+	if (ldlm_waiting_locks == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	cfs_percpt_for_each(wl, i, ldlm_waiting_locks) {
+		spin_lock_init(&wl->wl_lock);
+		setup_timer(&wl->wl_timer, waiting_locks_callback,
+			    (unsigned long)wl);
+		INIT_LIST_HEAD(&wl->wl_expired);
+		for (j = 0; j < LDLM_WHEEL_SIZE; j++) {
+			INIT_LIST_HEAD(&wl->wl_sec[j]);
+			INIT_LIST_HEAD(&wl->wl_period[j]);
+		}
+	}
 
 	task = kthread_run(expired_lock_main, NULL, "ldlm_elt");
 	if (IS_ERR(task)) {
@@ -3184,6 +3690,18 @@ static int ldlm_cleanup(void)
 		wait_event(expired_lock_thread.elt_waitq,
 			       expired_lock_thread.elt_state == ELT_STOPPED);
 	}
+
+	if (ldlm_waiting_locks != NULL) {
+		struct ldlm_waiting_locks *wl;
+		int i;
+
+		cfs_percpt_for_each(wl, i, ldlm_waiting_locks) {
+			del_timer_sync(&wl->wl_timer);
+			LASSERT(wl->wl_count == 0);
+		}
+		cfs_percpt_free(ldlm_waiting_locks);
+		ldlm_waiting_locks = NULL;
+	}
 #endif
 
         OBD_FREE(ldlm_state, sizeof(*ldlm_state));
@@ -3226,11 +3744,27 @@ int ldlm_init(void)
 	if (ldlm_interval_tree_slab == NULL)
 		goto out_interval;
 
+	ldlm_ibits_node_slab = kmem_cache_create("ibits_node",
+			sizeof(struct ldlm_ibits_node),
+			0, SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_ibits_node_slab == NULL)
+		goto out_interval_tree;
+
+	ldlm_ibits_queues_slab = kmem_cache_create("ibits_queues",
+			sizeof(struct ldlm_ibits_queues),
+			0, SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_ibits_queues_slab == NULL)
+		goto out_ibits_node;
+
 #if LUSTRE_TRACKS_LOCK_EXP_REFS
 	class_export_dump_hook = ldlm_dump_export_locks;
 #endif
 	return 0;
 
+out_ibits_node:
+	kmem_cache_destroy(ldlm_ibits_node_slab);
+out_interval_tree:
+	kmem_cache_destroy(ldlm_interval_tree_slab);
 out_interval:
 	kmem_cache_destroy(ldlm_interval_slab);
 out_lock:
@@ -3253,4 +3787,6 @@ void ldlm_exit(void)
 	kmem_cache_destroy(ldlm_lock_slab);
 	kmem_cache_destroy(ldlm_interval_slab);
 	kmem_cache_destroy(ldlm_interval_tree_slab);
+	kmem_cache_destroy(ldlm_ibits_node_slab);
+	kmem_cache_destroy(ldlm_ibits_queues_slab);
 }
@@ -737,6 +737,109 @@ cleanup:
 }
 EXPORT_SYMBOL(ldlm_cli_enqueue_fini);
 
+/**
+ * Create a client lock for a request which is not an LDLM enqueue but has
+ * the server grant locks on its behalf, e.g. MDS_BATCH_GETATTR.
+ *
+ * The handle returned in \a lockh is sent to the server, which uses it as
+ * the remote handle of the lock it grants.  The lock must be finished with
+ * ldlm_cli_lock_fini() whatever the outcome of the request.
+ */
+int ldlm_cli_lock_prep(struct obd_export *exp, struct ldlm_enqueue_info *einfo,
+		       const struct ldlm_res_id *res_id,
+		       union ldlm_policy_data const *policy,
+		       struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion	= einfo->ei_cb_cp,
+		.lcs_blocking	= einfo->ei_cb_bl,
+		.lcs_glimpse	= einfo->ei_cb_gl
+	};
+	struct ldlm_lock *lock;
+	ENTRY;
+
+	lock = ldlm_lock_create(exp->exp_obd->obd_namespace, res_id,
+				einfo->ei_type, einfo->ei_mode, &cbs,
+				einfo->ei_cbdata, 0, LVB_T_NONE);
+	if (IS_ERR(lock))
+		RETURN(PTR_ERR(lock));
+
+	/* for the local lock, add the reference */
+	ldlm_lock_addref_internal(lock, einfo->ei_mode);
+	ldlm_lock2handle(lock, lockh);
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+
+	lock->l_conn_export = exp;
+	lock->l_export = NULL;
+	lock->l_blocking_ast = einfo->ei_cb_bl;
+	lock->l_last_activity = cfs_time_current_sec();
+
+	LDLM_DEBUG(lock, "client-side prepared lock");
+	RETURN(0);
+}
+EXPORT_SYMBOL(ldlm_cli_lock_prep);
+
+/**
+ * Finish a lock created by ldlm_cli_lock_prep().
+ *
+ * If \a rc is 0 the server granted the lock with handle \a remote, policy
+ * \a policy and wire flags \a flags, so grant it locally as well; the
+ * reference taken in ldlm_cli_lock_prep() is then left to the caller.
+ * Otherwise the lock is destroyed.
+ */
+int ldlm_cli_lock_fini(struct obd_export *exp, const struct lustre_handle *lockh,
+		       enum ldlm_mode mode, const struct lustre_handle *remote,
+		       union ldlm_policy_data const *policy, __u64 flags,
+		       int rc)
+{
+	struct ldlm_namespace *ns = exp->exp_obd->obd_namespace;
+	struct ldlm_lock *lock;
+	ENTRY;
+
+	lock = ldlm_handle2lock(lockh);
+	if (lock == NULL)
+		RETURN(-ENOLCK);
+
+	if (rc != 0)
+		GOTO(cleanup, rc);
+
+	lock_res_and_lock(lock);
+	if (exp->exp_lock_hash) {
+		/* In the function below, .hs_keycmp resolves to
+		 * ldlm_export_lock_keycmp() */
+		/* coverity[overrun-buffer-val] */
+		cfs_hash_rehash_key(exp->exp_lock_hash,
+				    &lock->l_remote_handle, (void *)remote,
+				    &lock->l_exp_hash);
+	} else {
+		lock->l_remote_handle = *remote;
+	}
+	flags = ldlm_flags_from_wire(flags);
+	lock->l_flags |= flags & LDLM_FL_INHERIT_MASK;
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+	if (flags & LDLM_FL_AST_SENT)
+		lock->l_flags |= LDLM_FL_CBPENDING | LDLM_FL_BL_AST;
+	unlock_res_and_lock(lock);
+
+	rc = ldlm_lock_enqueue(ns, &lock, NULL, &flags);
+	if (rc == ELDLM_OK && lock->l_completion_ast != NULL)
+		rc = lock->l_completion_ast(lock, flags, NULL);
+
+	LDLM_DEBUG(lock, "client-side prepared lock granted, rc = %d", rc);
+	EXIT;
+cleanup:
+	if (rc != 0)
+		failed_lock_cleanup(ns, lock, mode);
+	/* put the reference from ldlm_handle2lock() and the one held since
+	 * ldlm_lock_create() */
+	LDLM_LOCK_PUT(lock);
+	LDLM_LOCK_RELEASE(lock);
+	return rc;
+}
+EXPORT_SYMBOL(ldlm_cli_lock_fini);
+
 /**
  * Estimate number of lock handles that would fit into request of given
  * size.  PAGE_SIZE-512 is to allow TCP/IP and LNET headers to fit into
@@ -1642,6 +1745,63 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, enum ldlm_lru_flags lru_flags)
 	return ldlm_cancel_default_policy;
 }
 
+/**
+ * The LRU list to take the next lock to cancel from.
+ *
+ * With LDLM_LRU_POLICY_2Q, the locks used only once are cancelled first, but
+ * as for the A1 queue of 2Q, a quarter of the LRU is kept for them so that
+ * they have a chance to be used again. The locks used again are cancelled
+ * first as well once they are unused for ns_max_age.
+ */
+static struct list_head *ldlm_lru_list(struct ldlm_namespace *ns)
+{
+	struct ldlm_lock *lock;
+
+	if (list_empty(&ns->ns_unused_hot))
+		return &ns->ns_unused_list;
+
+	if (list_empty(&ns->ns_unused_list) ||
+	    ns->ns_nr_unused - ns->ns_nr_hot <= ns->ns_nr_unused / 4)
+		return &ns->ns_unused_hot;
+
+	lock = list_entry(ns->ns_unused_hot.next, struct ldlm_lock, l_lru);
+	if (cfs_time_after(cfs_time_current(),
+			   cfs_time_add(lock->l_last_used, ns->ns_max_age)))
+		return &ns->ns_unused_hot;
+
+	return &ns->ns_unused_list;
+}
+
+/**
+ * The first lock of the LRU list \a list which may be cancelled, or NULL.
+ * The locks being cancelled already are removed from the list on the way.
+ */
+static struct ldlm_lock *ldlm_lru_first(struct list_head *list, int no_wait)
+{
+	struct ldlm_lock *lock, *next;
+
+	list_for_each_entry_safe(lock, next, list, l_lru) {
+		/* No locks which got blocking requests. */
+		LASSERT(!ldlm_is_bl_ast(lock));
+
+		if (no_wait && ldlm_is_skipped(lock))
+			/* already processed */
+			continue;
+
+		if (lock->l_last_used == cfs_time_current())
+			continue;
+
+		/* Somebody is already doing CANCEL. No need for this
+		 * lock in LRU, do not traverse it again. */
+		if (!ldlm_is_canceling(lock))
+			return lock;
+
+		ldlm_lock_remove_from_lru_nolock(lock);
+	}
+
+	return NULL;
+}
+
 /**
  * - Free space in LRU for \a count new locks,
  *   redundant unused locks are canceled locally;
@@ -1674,13 +1834,16 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, enum ldlm_lru_flags lru_flags)
  *				(typically before replaying locks) w/o
  *				sending any RPCs or waiting for any
  *				outstanding RPC to complete.
+ *
+ * The order in which the locks are passed to the policies depends on the
+ * LRU policy of the namespace, see ldlm_lru_list().
  */
 static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 				 struct list_head *cancels, int count, int max,
 				 enum ldlm_lru_flags lru_flags)
 {
 	ldlm_cancel_lru_policy_t pf;
-	struct ldlm_lock *lock, *next;
+	struct ldlm_lock *lock;
 	int added = 0, unused, remained;
 	int no_wait = lru_flags & (LDLM_LRU_FLAG_NO_WAIT |
 				   LDLM_LRU_FLAG_LRUR_NO_WAIT);
@@ -1696,7 +1859,8 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 	pf = ldlm_cancel_lru_policy(ns, lru_flags);
 	LASSERT(pf != NULL);
 
-	while (!list_empty(&ns->ns_unused_list)) {
+	while (ns->ns_nr_unused > 0) {
+		struct list_head *list = ldlm_lru_list(ns);
 		enum ldlm_policy_res result;
 		cfs_time_t last_use = 0;
 
@@ -1708,28 +1872,14 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 		if (max && added >= max)
 			break;
 
-		list_for_each_entry_safe(lock, next, &ns->ns_unused_list,
-					 l_lru) {
-			/* No locks which got blocking requests. */
-			LASSERT(!ldlm_is_bl_ast(lock));
-
-			if (no_wait && ldlm_is_skipped(lock))
-				/* already processed */
-				continue;
-
-			last_use = lock->l_last_used;
-			if (last_use == cfs_time_current())
-				continue;
-
-			/* Somebody is already doing CANCEL. No need for this
-			 * lock in LRU, do not traverse it again. */
-			if (!ldlm_is_canceling(lock))
-                                break;
-
-			ldlm_lock_remove_from_lru_nolock(lock);
-		}
-		if (&lock->l_lru == &ns->ns_unused_list)
+		lock = ldlm_lru_first(list, no_wait);
+		if (lock == NULL)
+			lock = ldlm_lru_first(list == &ns->ns_unused_list ?
+					      &ns->ns_unused_hot :
+					      &ns->ns_unused_list, no_wait);
+		if (lock == NULL)
 			break;
+		last_use = lock->l_last_used;
 
 		LDLM_LOCK_GET(lock);
 		spin_unlock(&ns->ns_lock);
@@ -1808,6 +1958,7 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 		unlock_res_and_lock(lock);
 		lu_ref_del(&lock->l_reference, __FUNCTION__, current);
 		spin_lock(&ns->ns_lock);
+		ldlm_lru_ghost_add(ns, &lock->l_resource->lr_name);
 		added++;
 		unused--;
 	}
@@ -177,6 +177,8 @@ static const struct file_operations ldlm_granted_fops = {
 	.release = seq_release,
 };
 
+LPROC_SEQ_FOPS_RO(ldlm_waiting_locks);
+
 #endif /* HAVE_SERVER_SUPPORT */
 
 int ldlm_proc_setup(void)
@@ -199,6 +201,8 @@ int ldlm_proc_setup(void)
 		{ .name =	"lock_granted_count",
 		  .fops =	&ldlm_granted_fops,
 		  .data =	&ldlm_granted_total },
+		{ .name =	"waiting_locks",
+		  .fops =	&ldlm_waiting_locks_fops },
 #endif
 		{ NULL }};
 	ENTRY;
@@ -427,6 +431,39 @@ static ssize_t lru_max_age_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(lru_max_age);
 
+static const char *ldlm_lru_policy_names[] = {
+	[LDLM_LRU_POLICY_LRU]	= "lru",
+	[LDLM_LRU_POLICY_2Q]	= "2q",
+};
+
+static ssize_t lru_policy_show(struct kobject *kobj, struct attribute *attr,
+			       char *buf)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+
+	return sprintf(buf, "%s\n", ldlm_lru_policy_names[ns->ns_lru_policy]);
+}
+
+static ssize_t lru_policy_store(struct kobject *kobj, struct attribute *attr,
+				const char *buffer, size_t count)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+	int rc;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ldlm_lru_policy_names); i++) {
+		if (sysfs_streq(buffer, ldlm_lru_policy_names[i])) {
+			rc = ldlm_lru_set_policy(ns, i);
+			return rc ? rc : count;
+		}
+	}
+
+	return -EINVAL;
+}
+LUSTRE_RW_ATTR(lru_policy);
+
 static ssize_t early_lock_cancel_show(struct kobject *kobj,
 				      struct attribute *attr,
 				      char *buf)
@@ -466,6 +503,7 @@ static struct attribute *ldlm_ns_attrs[] = {
 	&lustre_attr_lock_unused_count.attr,
 	&lustre_attr_lru_size.attr,
 	&lustre_attr_lru_max_age.attr,
+	&lustre_attr_lru_policy.attr,
 	&lustre_attr_early_lock_cancel.attr,
 	NULL,
 };
@@ -518,6 +556,12 @@ int ldlm_namespace_sysfs_register(struct ldlm_namespace *ns)
 
 	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LOCKS,
 			     LPROCFS_CNTR_AVGMINMAX, "locks", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_HITS, 0,
+			     "lru_hits", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_MISSES, 0,
+			     "lru_misses", "locks");
+	lprocfs_counter_init(ns->ns_stats, LDLM_NSS_LRU_REENQUEUES, 0,
+			     "lru_reenqueues", "locks");
 
 	return err;
 }
@@ -558,6 +602,14 @@ static int ldlm_namespace_proc_register(struct ldlm_namespace *ns)
 			     &ns->ns_contended_locks, &ldlm_rw_uint_fops);
 		ldlm_add_var(&lock_vars[0], ns_pde, "max_parallel_ast",
 			     &ns->ns_max_parallel_ast, &ldlm_rw_uint_fops);
+		ldlm_add_var(&lock_vars[0], ns_pde, "max_bl_ast_batch",
+			     &ns->ns_max_bl_ast_batch, &ldlm_rw_uint_fops);
+	} else {
+		int rc;
+
+		rc = lprocfs_register_stats(ns_pde, "stats", ns->ns_stats);
+		if (rc != 0)
+			return rc;
 	}
 	return 0;
 }
@@ -788,6 +840,7 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 
 	INIT_LIST_HEAD(&ns->ns_list_chain);
 	INIT_LIST_HEAD(&ns->ns_unused_list);
+	INIT_LIST_HEAD(&ns->ns_unused_hot);
 	spin_lock_init(&ns->ns_lock);
 	atomic_set(&ns->ns_bref, 0);
 	init_waitqueue_head(&ns->ns_waitq);
@@ -797,7 +850,10 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	ns->ns_contended_locks    = NS_DEFAULT_CONTENDED_LOCKS;
 
         ns->ns_max_parallel_ast   = LDLM_DEFAULT_PARALLEL_AST_LIMIT;
+	ns->ns_max_bl_ast_batch   = LDLM_DEFAULT_BL_AST_BATCH;
         ns->ns_nr_unused          = 0;
+	ns->ns_nr_hot		  = 0;
+	ns->ns_lru_policy	  = LDLM_LRU_POLICY_LRU;
         ns->ns_max_unused         = LDLM_DEFAULT_LRU_SIZE;
         ns->ns_max_age            = LDLM_DEFAULT_MAX_ALIVE;
         ns->ns_ctime_age_limit    = LDLM_CTIME_AGE_LIMIT;
@@ -1099,6 +1155,9 @@ void ldlm_namespace_free_post(struct ldlm_namespace *ns)
 	ldlm_namespace_proc_unregister(ns);
 	ldlm_namespace_sysfs_unregister(ns);
 	cfs_hash_putref(ns->ns_rs_hash);
+	if (ns->ns_lru_ghosts != NULL)
+		OBD_FREE_LARGE(ns->ns_lru_ghosts,
+			       LDLM_LRU_GHOSTS * sizeof(*ns->ns_lru_ghosts));
 	/* Namespace \a ns should be not on list at this time, otherwise
 	 * this will cause issues related to using freed \a ns in poold
 	 * thread. */
@@ -1388,6 +1447,9 @@ int ldlm_resource_putref(struct ldlm_resource *res)
 		if (res->lr_itree != NULL)
 			OBD_SLAB_FREE(res->lr_itree, ldlm_interval_tree_slab,
 				      sizeof(*res->lr_itree) * LCK_MODE_NUM);
+		if (res->lr_ibits_queues != NULL)
+			OBD_SLAB_FREE_PTR(res->lr_ibits_queues,
+					  ldlm_ibits_queues_slab);
 		OBD_SLAB_FREE(res, ldlm_resource_slab, sizeof *res);
 		return 1;
 	}
@@ -1413,6 +1475,8 @@ void ldlm_resource_add_lock(struct ldlm_resource *res, struct list_head *head,
 	LASSERT(list_empty(&lock->l_res_link));
 
 	list_add_tail(&lock->l_res_link, head);
+	if (res->lr_type == LDLM_IBITS)
+		ldlm_inodebits_add_lock(res, head, lock);
 }
 
 /**
@@ -1448,6 +1512,8 @@ void ldlm_resource_unlink_lock(struct ldlm_lock *lock)
         check_res_locked(lock->l_resource);
         if (type == LDLM_IBITS || type == LDLM_PLAIN)
                 ldlm_unlink_lock_skiplist(lock);
+	if (type == LDLM_IBITS)
+		ldlm_inodebits_unlink_lock(lock);
         else if (type == LDLM_EXTENT)
                 ldlm_extent_unlink_lock(lock);
 	list_del_init(&lock->l_res_link);
@@ -79,8 +79,10 @@ static struct ll_file_data *ll_file_data_get(void)
 
 static void ll_file_data_put(struct ll_file_data *fd)
 {
-        if (fd != NULL)
-                OBD_SLAB_FREE_PTR(fd, ll_file_data_slab);
+	if (fd != NULL) {
+		ll_readahead_fini(&fd->fd_ra_streams);
+		OBD_SLAB_FREE_PTR(fd, ll_file_data_slab);
+	}
 }
 
 /**
@@ -457,7 +459,7 @@ static int ll_local_open(struct file *file, struct lookup_intent *it,
 	}
 
 	LUSTRE_FPRIVATE(file) = fd;
-	ll_readahead_init(inode, &fd->fd_ras);
+	ll_readahead_init(inode, &fd->fd_ra_streams);
 	fd->fd_omode = it->it_flags & (FMODE_READ | FMODE_WRITE | FMODE_EXEC);
 
 	/* ll_cl_context initialize */
@@ -1890,6 +1892,51 @@ out:
 	RETURN(rc);
 }
 
+#ifdef HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+/**
+ * Copy a range of \a file_in into \a file_out on the OST, without moving
+ * the data through this client.
+ *
+ * This is only possible when both files have a single stripe on the same
+ * OST and the offsets are page aligned. -EOPNOTSUPP in any other case makes
+ * the VFS fall back to a copy through the page cache.
+ */
+static ssize_t ll_copy_file_range(struct file *file_in, loff_t pos_in,
+				  struct file *file_out, loff_t pos_out,
+				  size_t len, unsigned int flags)
+{
+	struct inode	*src = file_inode(file_in);
+	struct inode	*dst = file_inode(file_out);
+	struct lu_env	*env;
+	__u16		 refcheck;
+	size_t		 copied = len;
+	int		 rc;
+	ENTRY;
+
+	CDEBUG(D_VFSTRACE, "VFS Op:src="DFID" [%lld, +%zu) dst="DFID" %lld\n",
+	       PFID(ll_inode2fid(src)), pos_in, len, PFID(ll_inode2fid(dst)),
+	       pos_out);
+
+	if (src->i_sb != dst->i_sb)
+		RETURN(-EXDEV);
+
+	if (src == dst || ((pos_in | pos_out) & ~PAGE_MASK) != 0 ||
+	    ll_i2info(src)->lli_clob == NULL ||
+	    ll_i2info(dst)->lli_clob == NULL)
+		RETURN(-EOPNOTSUPP);
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		RETURN(PTR_ERR(env));
+
+	rc = cl_object_copy(env, ll_i2info(dst)->lli_clob,
+			    ll_i2info(src)->lli_clob, pos_in, pos_out, &copied);
+	cl_env_put(env, &refcheck);
+
+	RETURN(rc < 0 ? rc : copied);
+}
+#endif /* HAVE_FILE_OPERATIONS_COPY_FILE_RANGE */
+
 int ll_fid2path(struct inode *inode, void __user *arg)
 {
 	struct obd_export	*exp = ll_i2mdexp(inode);
@@ -2289,6 +2336,86 @@ static int ll_file_futimes_3(struct file *file, const struct ll_futimes_3 *lfu)
 	RETURN(rc);
 }
 
+/**
+ * Request the DLM locks of an extent ahead of the I/O (lock ahead).
+ *
+ * The locks are enqueued asynchronously. The server grants exactly the
+ * requested extent, and fails the request instead of calling back the
+ * conflicting locks of other clients, so that every writer of a shared file
+ * can own the locks of just its own extents.
+ *
+ * \retval 0 if the lock requests are sent, or if a lock is cached already
+ *	     on the extent, in which case lla_lockahead_result is
+ *	     LLA_RESULT_SAME
+ * \retval negative errno on error
+ */
+static int ll_file_lock_ahead(struct inode *inode,
+			      struct llapi_lu_ladvise *ladvise)
+{
+	struct cl_object *clob = ll_i2info(inode)->lli_clob;
+	struct lu_env *env;
+	struct cl_io *io;
+	struct cl_lock *lock;
+	struct cl_lock_descr *descr;
+	enum cl_lock_mode mode;
+	__u16 refcheck;
+	int rc;
+	ENTRY;
+
+	switch (ladvise->lla_lockahead_mode) {
+	case MODE_READ_USER:
+		mode = CLM_READ;
+		break;
+	case MODE_WRITE_USER:
+		mode = CLM_WRITE;
+		break;
+	default:
+		RETURN(-EINVAL);
+	}
+
+	if (ladvise->lla_end <= ladvise->lla_start)
+		RETURN(-EINVAL);
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		RETURN(PTR_ERR(env));
+
+	io = vvp_env_thread_io(env);
+	io->ci_obj = clob;
+
+	rc = cl_io_init(env, io, CIT_MISC, clob);
+	if (rc == 0) {
+		lock = vvp_env_lock(env);
+		descr = &lock->cll_descr;
+		descr->cld_obj = clob;
+		descr->cld_start = cl_index(clob, ladvise->lla_start);
+		descr->cld_end = cl_index(clob, ladvise->lla_end - 1);
+		descr->cld_mode = mode;
+		descr->cld_enq_flags = CEF_MUST | CEF_SPECULATIVE |
+				       CEF_LOCK_NO_EXPAND;
+
+		rc = cl_lock_request(env, io, lock);
+		/* nothing to keep, the DLM locks are cached once granted */
+		if (rc == 0)
+			cl_lock_release(env, lock);
+	} else if (rc > 0) {
+		/* no layout */
+		rc = -ENODATA;
+	}
+
+	cl_io_fini(env, io);
+	cl_env_put(env, &refcheck);
+
+	if (rc == -ECANCELED) {
+		ladvise->lla_lockahead_result = LLA_RESULT_SAME;
+		rc = 0;
+	} else if (rc == 0) {
+		ladvise->lla_lockahead_result = LLA_RESULT_SENT;
+	}
+
+	RETURN(rc);
+}
+
 /*
  * Give file access advices
  *
@@ -2685,6 +2812,7 @@ out:
 	}
 	case LL_IOC_LADVISE: {
 		struct llapi_ladvise_hdr *ladvise_hdr;
+		bool lockahead = false;
 		int i;
 		int num_advise;
 		int alloc_size = sizeof(*ladvise_hdr);
@@ -2723,12 +2851,28 @@ out:
 			GOTO(out_ladvise, rc = -EFAULT);
 
 		for (i = 0; i < num_advise; i++) {
-			rc = ll_ladvise(inode, file, ladvise_hdr->lah_flags,
-					&ladvise_hdr->lah_advise[i]);
+			struct llapi_lu_ladvise *ladvise;
+
+			ladvise = &ladvise_hdr->lah_advise[i];
+			if (ladvise->lla_advice == LU_LADVISE_LOCKAHEAD) {
+				/* handled by the client, no RPC to servers */
+				rc = ll_file_lock_ahead(inode, ladvise);
+				lockahead = true;
+			} else {
+				rc = ll_ladvise(inode, file,
+						ladvise_hdr->lah_flags,
+						ladvise);
+			}
 			if (rc)
 				break;
 		}
 
+		/* return the lock ahead results to the application */
+		if (rc == 0 && lockahead &&
+		    copy_to_user((struct llapi_ladvise_hdr __user *)arg,
+				 ladvise_hdr, alloc_size))
+			rc = -EFAULT;
+
 out_ladvise:
 		OBD_FREE(ladvise_hdr, alloc_size);
 		RETURN(rc);
@@ -3796,6 +3940,9 @@ struct file_operations ll_file_operations = {
 	.mmap		= ll_file_mmap,
 	.llseek		= ll_file_seek,
 	.splice_read	= ll_file_splice_read,
+#ifdef HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+	.copy_file_range = ll_copy_file_range,
+#endif
 	.fsync		= ll_fsync,
 	.flush		= ll_flush
 };
@@ -3820,6 +3967,9 @@ struct file_operations ll_file_operations_flock = {
 	.mmap		= ll_file_mmap,
 	.llseek		= ll_file_seek,
 	.splice_read	= ll_file_splice_read,
+#ifdef HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+	.copy_file_range = ll_copy_file_range,
+#endif
 	.fsync		= ll_fsync,
 	.flush		= ll_flush,
 	.flock		= ll_file_flock,
@@ -3847,6 +3997,9 @@ struct file_operations ll_file_operations_noflock = {
 	.mmap		= ll_file_mmap,
 	.llseek		= ll_file_seek,
 	.splice_read	= ll_file_splice_read,
+#ifdef HAVE_FILE_OPERATIONS_COPY_FILE_RANGE
+	.copy_file_range = ll_copy_file_range,
+#endif
 	.fsync		= ll_fsync,
 	.flush		= ll_flush,
 	.flock		= ll_file_noflock,
@@ -197,6 +197,9 @@ struct ll_inode_info {
 			/* for writepage() only to communicate to fsync */
 			int				lli_async_rc;
 
+			/* pages of asynchronous read-ahead queued */
+			atomic_long_t			lli_ra_async_pages;
+
 			/*
 			 * whenever a process try to read/write the file, the
 			 * jobid of the process will be saved here, and it'll
@@ -334,14 +337,47 @@ enum ra_stat {
         RA_STAT_MAX_IN_FLIGHT,
         RA_STAT_WRONG_GRAB_PAGE,
 	RA_STAT_FAILED_REACH_END,
+	RA_STAT_STREAM_NEW,
+	RA_STAT_STREAM_RECYCLED,
+	RA_STAT_ASYNC,
+	RA_STAT_ASYNC_THROTTLED,
 	_NR_RA_STAT,
 };
 
+/* maximum number of concurrent read-ahead streams tracked per open file */
+#define LL_RA_STREAMS_MAX	8
+/* default number of read-ahead streams, 1 means single-stream behaviour */
+#define LL_RA_STREAMS_DEF	4
+
+/* maximum number of asynchronous read-ahead threads per mount */
+#define LL_RA_ASYNC_THREADS_MAX	32
+/* default number of asynchronous read-ahead threads, 0 disables it */
+#define LL_RA_ASYNC_THREADS_DEF	0
+
+/* per-stream counters in read_ahead_stream_stats, two for each stream slot */
+enum ra_stream_stat {
+	RA_STREAM_STAT_HIT = 0,
+	RA_STREAM_STAT_MISS,
+	_NR_RA_STREAM_STAT,
+};
+
 struct ll_ra_info {
 	atomic_t	ra_cur_pages;
 	unsigned long	ra_max_pages;
 	unsigned long	ra_max_pages_per_file;
 	unsigned long	ra_max_read_ahead_whole_pages;
+	unsigned int	ra_max_streams;
+	/* number of asynchronous read-ahead threads, 0 means disabled */
+	unsigned int	ra_async_threads;
+	/* maximum pages of asynchronous read-ahead queued per file */
+	unsigned long	ra_async_pages_per_file;
+	/* scheduler running asynchronous read-ahead work items */
+	struct cfs_wi_sched *ra_async_sched;
+	/* serializes replacement of ra_async_sched against new work items */
+	struct rw_semaphore ra_async_sem;
+	/* number of queued or running asynchronous read-ahead work items */
+	atomic_t	ra_async_inflight;
+	wait_queue_head_t ra_async_waitq;
 };
 
 /* ra_io_arg will be filled in the beginning of ll_readahead with
@@ -427,6 +463,7 @@ enum stats_track_type {
 				       * suppress_pings */
 #define LL_SBI_FAST_READ     0x400000 /* fast read support */
 #define LL_SBI_FILE_SECCTX   0x800000 /* set file security context at create */
+#define LL_SBI_BATCH_GETATTR 0x1000000 /* batched getattr for statahead */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -453,6 +490,7 @@ enum stats_track_type {
 	"always_ping",	\
 	"fast_read",	\
 	"file_secctx",	\
+	"batch_getattr",\
 }
 
 /* This is embedded into llite super-blocks to keep track of connect
@@ -496,6 +534,8 @@ struct ll_sb_info {
 	struct cl_client_cache	 *ll_cache;
 
         struct lprocfs_stats     *ll_ra_stats;
+	/* hit/miss counters of each read-ahead stream slot */
+	struct lprocfs_stats	 *ll_ra_stream_stats;
 
         struct ll_ra_info         ll_ra_info;
         unsigned int              ll_namelen;
@@ -518,6 +558,8 @@ struct ll_sb_info {
 
 	/* metadata stat-ahead */
 	unsigned int		  ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max; /* max entries per batched
+						    * statahead RPC */
 	atomic_t		  ll_sa_total;   /* statahead thread started
 						  * count */
 	atomic_t		  ll_sa_wrong;   /* statahead thread stopped for
@@ -525,6 +567,8 @@ struct ll_sb_info {
 	atomic_t		  ll_sa_running; /* running statahead thread
 						  * count */
 	atomic_t		  ll_agl_total;  /* AGL thread started count */
+	atomic_t		  ll_sa_batch_total; /* batched statahead RPCs
+						      * sent */
 
 	dev_t			  ll_sdev_orig; /* save s_dev before assign for
 						 * clustred nfs */
@@ -616,12 +660,49 @@ struct ll_readahead_state {
          * stride read-ahead will be enable
          */
         unsigned long   ras_consecutive_stride_requests;
+	/*
+	 * Value of ll_ra_streams::lrs_requests when this stream was last
+	 * accessed, used to account read requests to the stream they hit.
+	 */
+	unsigned long	ras_request_seq;
+	/* ll_ra_streams::lrs_clock at last access, for stream recycling */
+	unsigned long	ras_last_access;
+	/* slot of this stream in ll_ra_streams::lrs_ras[] */
+	unsigned int	ras_stream_id;
+};
+
+/*
+ * Per file-descriptor table of read-ahead streams.
+ *
+ * Applications reading several regions of one file through the same file
+ * descriptor (e.g. interleaved sequential or strided scans) would keep
+ * resetting a single read-ahead window. Each stream has its own window and
+ * stride detector, and a page access is routed to the stream it continues.
+ * If no stream matches, an unused slot is taken or the least recently used
+ * stream is recycled.
+ */
+struct ll_ra_streams {
+	/* protects stream selection and recycling */
+	spinlock_t			lrs_lock;
+	/* number of streams in use, lrs_ras and lrs_more[] */
+	unsigned int			lrs_count;
+	/* number of read requests issued on this file descriptor */
+	unsigned long			lrs_requests;
+	/* logical clock, advanced on every stream lookup */
+	unsigned long			lrs_clock;
+	/* the first stream, the only one of most file descriptors */
+	struct ll_readahead_state	lrs_ras;
+	/*
+	 * The other LL_RA_STREAMS_MAX - 1 streams, allocated once a second
+	 * stream is detected.
+	 */
+	struct ll_readahead_state	*lrs_more;
 };
 
 extern struct kmem_cache *ll_file_data_slab;
 struct lustre_handle;
 struct ll_file_data {
-	struct ll_readahead_state fd_ras;
+	struct ll_ra_streams fd_ra_streams;
 	struct ll_grouplock fd_grouplock;
 	__u64 lfd_pos;
 	__u32 fd_flags;
@@ -770,7 +851,8 @@ void ll_update_times(struct ptlrpc_request *request, struct inode *inode);
 int ll_writepage(struct page *page, struct writeback_control *wbc);
 int ll_writepages(struct address_space *, struct writeback_control *wbc);
 int ll_readpage(struct file *file, struct page *page);
-void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras);
+void ll_readahead_init(struct inode *inode, struct ll_ra_streams *lrs);
+void ll_readahead_fini(struct ll_ra_streams *lrs);
 int vvp_io_write_commit(const struct lu_env *env, struct cl_io *io);
 
 enum lcc_type;
@@ -881,6 +963,8 @@ int ll_show_options(struct seq_file *seq, struct vfsmount *vfs);
 void ll_dirty_page_discard_warn(struct page *page, int ioret);
 int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 		  struct super_block *, struct lookup_intent *);
+int ll_prep_inode_body(struct inode **inode, struct mdt_body *body,
+		       struct super_block *, struct lookup_intent *);
 void lustre_dump_dentry(struct dentry *, int recur);
 int ll_obd_statfs(struct inode *inode, void __user *arg);
 int ll_get_max_mdsize(struct ll_sb_info *sbi, int *max_mdsize);
@@ -1104,6 +1188,7 @@ enum ras_update_flags {
 };
 void ll_ra_count_put(struct ll_sb_info *sbi, unsigned long len);
 void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
+int ll_ra_async_set_threads(struct ll_sb_info *sbi, unsigned int nthreads);
 
 /* statahead.c */
 
@@ -1111,6 +1196,9 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 #define LL_SA_RPC_DEF           32
 #define LL_SA_RPC_MAX           8192
 
+#define LL_SA_BATCH_DEF         32
+#define LL_SA_BATCH_MAX         MDT_BATCH_GETATTR_MAX
+
 #define LL_SA_CACHE_BIT         5
 #define LL_SA_CACHE_SIZE        (1 << LL_SA_CACHE_BIT)
 #define LL_SA_CACHE_MASK        (LL_SA_CACHE_SIZE - 1)
@@ -1156,6 +1244,9 @@ struct ll_statahead_info {
 	struct list_head	sai_cache[LL_SA_CACHE_SIZE];
 	spinlock_t		sai_cache_lock[LL_SA_CACHE_SIZE];
 	atomic_t		sai_cache_count; /* entry count in cache */
+	struct md_batch_info   *sai_batch;	/* entries not sent yet */
+	unsigned int		sai_batch_max;	/* max entries per batch,
+						 * 0 if batching is off */
 };
 
 int ll_statahead(struct inode *dir, struct dentry **dentry, bool unplug);
@@ -57,6 +57,7 @@
 #include <lustre_log.h>
 #include <cl_object.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include "llite_internal.h"
 
 struct kmem_cache *ll_file_data_slab;
@@ -101,6 +102,14 @@ static struct ll_sb_info *ll_init_sbi(void)
 	sbi->ll_ra_info.ra_max_pages = sbi->ll_ra_info.ra_max_pages_per_file;
 	sbi->ll_ra_info.ra_max_read_ahead_whole_pages =
 					   SBI_DEFAULT_READAHEAD_WHOLE_MAX;
+	sbi->ll_ra_info.ra_max_streams = LL_RA_STREAMS_DEF;
+	sbi->ll_ra_info.ra_async_pages_per_file =
+				sbi->ll_ra_info.ra_max_pages_per_file / 2;
+	init_rwsem(&sbi->ll_ra_info.ra_async_sem);
+	atomic_set(&sbi->ll_ra_info.ra_async_inflight, 0);
+	init_waitqueue_head(&sbi->ll_ra_info.ra_async_waitq);
+	/* async read-ahead is an optimization, mount without it on failure */
+	ll_ra_async_set_threads(sbi, LL_RA_ASYNC_THREADS_DEF);
 
         ll_generate_random_uuid(uuid);
         class_uuid_unparse(uuid, &sbi->ll_sb_uuid);
@@ -125,10 +134,12 @@ static struct ll_sb_info *ll_init_sbi(void)
 
 	/* metadata statahead is enabled by default */
 	sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
 	atomic_set(&sbi->ll_agl_total, 0);
+	atomic_set(&sbi->ll_sa_batch_total, 0);
 	sbi->ll_flags |= LL_SBI_AGL_ENABLED;
 	sbi->ll_flags |= LL_SBI_FAST_READ;
 
@@ -147,6 +158,7 @@ static void ll_free_sbi(struct super_block *sb)
 	ENTRY;
 
 	if (sbi != NULL) {
+		ll_ra_async_set_threads(sbi, 0);
 		if (!list_empty(&sbi->ll_squash.rsi_nosquash_nids))
 			cfs_free_nidlist(&sbi->ll_squash.rsi_nosquash_nids);
 		if (sbi->ll_cache != NULL) {
@@ -164,6 +176,12 @@ static inline int obd_connect_has_secctx(struct obd_connect_data *data)
 	       data->ocd_connect_flags2 & OBD_CONNECT2_FILE_SECCTX;
 }
 
+static inline int obd_connect_has_batch_getattr(struct obd_connect_data *data)
+{
+	return data->ocd_connect_flags & OBD_CONNECT_FLAGS2 &&
+	       data->ocd_connect_flags2 & OBD_CONNECT2_BATCH_GETATTR;
+}
+
 static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                     struct vfsmount *mnt)
 {
@@ -254,6 +272,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 #ifdef HAVE_SECURITY_DENTRY_INIT_SECURITY
 	data->ocd_connect_flags2 |= OBD_CONNECT2_FILE_SECCTX;
 #endif /* HAVE_SECURITY_DENTRY_INIT_SECURITY */
+	data->ocd_connect_flags2 |= OBD_CONNECT2_BATCH_GETATTR |
+				    OBD_CONNECT2_BATCH_BL_AST;
 
 	data->ocd_brw_size = MD_MAX_BRW_SIZE;
 
@@ -363,6 +383,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 	if (obd_connect_has_secctx(data))
 		sbi->ll_flags |= LL_SBI_FILE_SECCTX;
 
+	if (obd_connect_has_batch_getattr(data))
+		sbi->ll_flags |= LL_SBI_BATCH_GETATTR;
+
 	if (data->ocd_ibits_known & MDS_INODELOCK_XATTR) {
 		if (!(data->ocd_connect_flags & OBD_CONNECT_MAX_EASIZE)) {
 			LCONSOLE_INFO("%s: disabling xattr cache due to "
@@ -394,9 +417,17 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
 				  OBD_CONNECT_LAYOUTLOCK |
 				  OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK |
-				  OBD_CONNECT_BULK_MBITS;
+				  OBD_CONNECT_BULK_MBITS | OBD_CONNECT_FLAGS2 |
+				  OBD_CONNECT_LOCK_AHEAD;
 
-	data->ocd_connect_flags2 = 0;
+	data->ocd_connect_flags2 = OBD_CONNECT2_SERVER_COPY |
+				   OBD_CONNECT2_BATCH_BL_AST;
+
+	/* offer the compression algorithms this node supports, the OSC
+	 * decides per RPC whether to use one of them */
+	data->ocd_compr_types = ptlrpc_compr_types_supported();
+	if (data->ocd_compr_types != 0)
+		data->ocd_connect_flags2 |= OBD_CONNECT2_COMPRESS;
 
 	if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_GRANT_PARAM))
 		data->ocd_connect_flags |= OBD_CONNECT_GRANT_PARAM;
@@ -767,6 +798,9 @@ void ll_kill_super(struct super_block *sb)
 			set_current_state(TASK_UNINTERRUPTIBLE);
 			schedule_timeout(msecs_to_jiffies(MSEC_PER_SEC >> 3));
 		}
+
+		/* background read-ahead holds inode references */
+		ll_ra_async_set_threads(sbi, 0);
 	}
 
 	EXIT;
@@ -953,6 +987,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 		INIT_LIST_HEAD(&lli->lli_agl_list);
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
+		atomic_long_set(&lli->lli_ra_async_pages, 0);
 	}
 	mutex_init(&lli->lli_layout_mutex);
 	memset(lli->lli_jobid, 0, LUSTRE_JOBID_SIZE);
@@ -2253,25 +2288,17 @@ void ll_open_cleanup(struct super_block *sb, struct ptlrpc_request *open_req)
 	EXIT;
 }
 
-int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
-		  struct super_block *sb, struct lookup_intent *it)
+/* update or instantiate \a inode from the reply metadata \a md */
+static int ll_prep_inode_md(struct inode **inode, struct lustre_md *md,
+			    struct super_block *sb, struct lookup_intent *it)
 {
-	struct ll_sb_info *sbi = NULL;
-	struct lustre_md md = { NULL };
+	struct ll_sb_info *sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
 	int rc;
-	ENTRY;
-
-	LASSERT(*inode || sb);
-	sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
-	rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
-			      sbi->ll_md_exp, &md);
-	if (rc != 0)
-		GOTO(cleanup, rc);
 
 	if (*inode) {
-		rc = ll_update_inode(*inode, &md);
+		rc = ll_update_inode(*inode, md);
 		if (rc != 0)
-			GOTO(out, rc);
+			return rc;
 	} else {
 		LASSERT(sb != NULL);
 
@@ -2279,29 +2306,29 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 		 * At this point server returns to client's same fid as client
 		 * generated for creating. So using ->fid1 is okay here.
 		 */
-		if (!fid_is_sane(&md.body->mbo_fid1)) {
+		if (!fid_is_sane(&md->body->mbo_fid1)) {
 			CERROR("%s: Fid is insane "DFID"\n",
 				ll_get_fsname(sb, NULL, 0),
-				PFID(&md.body->mbo_fid1));
-			GOTO(out, rc = -EINVAL);
+				PFID(&md->body->mbo_fid1));
+			return -EINVAL;
 		}
 
-		*inode = ll_iget(sb, cl_fid_build_ino(&md.body->mbo_fid1,
+		*inode = ll_iget(sb, cl_fid_build_ino(&md->body->mbo_fid1,
 					     sbi->ll_flags & LL_SBI_32BIT_API),
-				 &md);
+				 md);
 		if (IS_ERR(*inode)) {
 #ifdef CONFIG_FS_POSIX_ACL
-                        if (md.posix_acl) {
-                                posix_acl_release(md.posix_acl);
-                                md.posix_acl = NULL;
-                        }
+			if (md->posix_acl) {
+				posix_acl_release(md->posix_acl);
+				md->posix_acl = NULL;
+			}
 #endif
-                        rc = IS_ERR(*inode) ? PTR_ERR(*inode) : -ENOMEM;
-                        *inode = NULL;
-                        CERROR("new_inode -fatal: rc %d\n", rc);
-                        GOTO(out, rc);
-                }
-        }
+			rc = IS_ERR(*inode) ? PTR_ERR(*inode) : -ENOMEM;
+			*inode = NULL;
+			CERROR("new_inode -fatal: rc %d\n", rc);
+			return rc;
+		}
+	}
 
 	/* Handling piggyback layout lock.
 	 * Layout lock can be piggybacked by getattr and open request.
@@ -2325,15 +2352,32 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 			conf.coc_opc = OBJECT_CONF_SET;
 			conf.coc_inode = *inode;
 			conf.coc_lock = lock;
-			conf.u.coc_layout = md.layout;
+			conf.u.coc_layout = md->layout;
 			(void)ll_layout_conf(*inode, &conf);
 		}
 		LDLM_LOCK_PUT(lock);
 	}
 
-	GOTO(out, rc = 0);
+	return 0;
+}
+
+int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
+		  struct super_block *sb, struct lookup_intent *it)
+{
+	struct ll_sb_info *sbi = NULL;
+	struct lustre_md md = { NULL };
+	int rc;
+	ENTRY;
+
+	LASSERT(*inode || sb);
+	sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
+	rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
+			      sbi->ll_md_exp, &md);
+	if (rc != 0)
+		GOTO(cleanup, rc);
+
+	rc = ll_prep_inode_md(inode, &md, sb, it);
 
-out:
 	md_free_lustre_md(sbi->ll_md_exp, &md);
 
 cleanup:
@@ -2343,6 +2387,23 @@ cleanup:
 	return rc;
 }
 
+/*
+ * Same as ll_prep_inode() for attributes which come as a bare mdt_body,
+ * i.e. without layout, LMV or ACL, as returned by batched getattr.
+ */
+int ll_prep_inode_body(struct inode **inode, struct mdt_body *body,
+		       struct super_block *sb, struct lookup_intent *it)
+{
+	struct lustre_md md = { .body = body };
+	int rc;
+	ENTRY;
+
+	LASSERT(*inode || sb);
+	rc = ll_prep_inode_md(inode, &md, sb, it);
+
+	RETURN(rc);
+}
+
 int ll_obd_statfs(struct inode *inode, void __user *arg)
 {
         struct ll_sb_info *sbi = NULL;
@@ -390,6 +390,135 @@ ll_max_read_ahead_whole_mb_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_max_read_ahead_whole_mb);
 
+static int ll_max_read_ahead_streams_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_ra_info.ra_max_streams);
+	return 0;
+}
+
+static ssize_t
+ll_max_read_ahead_streams_seq_write(struct file *file,
+				    const char __user *buffer,
+				    size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > LL_RA_STREAMS_MAX) {
+		CERROR("%s: can't set max_read_ahead_streams=%lld, valid "
+		       "values are in the range [1, %d]\n",
+		       ll_get_fsname(sb, NULL, 0), val, LL_RA_STREAMS_MAX);
+		return -ERANGE;
+	}
+
+	spin_lock(&sbi->ll_lock);
+	sbi->ll_ra_info.ra_max_streams = val;
+	spin_unlock(&sbi->ll_lock);
+	return count;
+}
+LPROC_SEQ_FOPS(ll_max_read_ahead_streams);
+
+static int ll_read_ahead_async_threads_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_ra_info.ra_async_threads);
+	return 0;
+}
+
+static ssize_t
+ll_read_ahead_async_threads_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_RA_ASYNC_THREADS_MAX) {
+		CERROR("%s: can't set read_ahead_async_threads=%lld, valid "
+		       "values are in the range [0, %d]\n",
+		       ll_get_fsname(sb, NULL, 0), val,
+		       LL_RA_ASYNC_THREADS_MAX);
+		return -ERANGE;
+	}
+
+	rc = ll_ra_async_set_threads(sbi, val);
+	if (rc)
+		return rc;
+
+	return count;
+}
+LPROC_SEQ_FOPS(ll_read_ahead_async_threads);
+
+static int ll_read_ahead_async_file_max_mb_seq_show(struct seq_file *m,
+						    void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	long pages_number;
+	int mult;
+
+	spin_lock(&sbi->ll_lock);
+	pages_number = sbi->ll_ra_info.ra_async_pages_per_file;
+	spin_unlock(&sbi->ll_lock);
+
+	mult = 1 << (20 - PAGE_SHIFT);
+	return lprocfs_seq_read_frac_helper(m, pages_number, mult);
+}
+
+static ssize_t
+ll_read_ahead_async_file_max_mb_seq_write(struct file *file,
+					  const char __user *buffer,
+					  size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int rc;
+	__s64 pages_number;
+
+	rc = lprocfs_str_with_units_to_s64(buffer, count, &pages_number, 'M');
+	if (rc)
+		return rc;
+
+	pages_number >>= PAGE_SHIFT;
+
+	if (pages_number < 0 ||
+	    pages_number > sbi->ll_ra_info.ra_max_pages_per_file) {
+		CERROR("%s: can't set read_ahead_async_file_max_mb=%lu > "
+		       "max_read_ahead_per_file_mb=%lu\n",
+		       ll_get_fsname(sb, NULL, 0),
+		       (unsigned long)pages_number >> (20 - PAGE_SHIFT),
+		       sbi->ll_ra_info.ra_max_pages_per_file >>
+		       (20 - PAGE_SHIFT));
+		return -ERANGE;
+	}
+
+	spin_lock(&sbi->ll_lock);
+	sbi->ll_ra_info.ra_async_pages_per_file = pages_number;
+	spin_unlock(&sbi->ll_lock);
+	return count;
+}
+LPROC_SEQ_FOPS(ll_read_ahead_async_file_max_mb);
+
 static int ll_max_cached_mb_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block     *sb    = m->private;
@@ -672,6 +801,38 @@ static ssize_t ll_statahead_max_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_statahead_max);
 
+static int ll_statahead_batch_max_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "%u\n", sbi->ll_sa_batch_max);
+	return 0;
+}
+
+static ssize_t ll_statahead_batch_max_seq_write(struct file *file,
+						const char __user *buffer,
+						size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ll_sb_info *sbi = ll_s2sbi((struct super_block *)m->private);
+	int rc;
+	__s64 val;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val >= 0 && val <= LL_SA_BATCH_MAX)
+		sbi->ll_sa_batch_max = val;
+	else
+		CERROR("Bad statahead_batch_max value %lld. Valid values are "
+		       "in the range [0, %d]\n", val, LL_SA_BATCH_MAX);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ll_statahead_batch_max);
+
 static int ll_statahead_agl_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
@@ -711,10 +872,12 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 
 	seq_printf(m, "statahead total: %u\n"
 		    "statahead wrong: %u\n"
-		    "agl total: %u\n",
+		    "agl total: %u\n"
+		    "statahead batch: %u\n",
 		    atomic_read(&sbi->ll_sa_total),
 		    atomic_read(&sbi->ll_sa_wrong),
-		    atomic_read(&sbi->ll_agl_total));
+		    atomic_read(&sbi->ll_agl_total),
+		    atomic_read(&sbi->ll_sa_batch_total));
 	return 0;
 }
 LPROC_SEQ_FOPS_RO(ll_statahead_stats);
@@ -1039,6 +1202,12 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_max_readahead_per_file_mb_fops	},
 	{ .name	=	"max_read_ahead_whole_mb",
 	  .fops	=	&ll_max_read_ahead_whole_mb_fops	},
+	{ .name	=	"max_read_ahead_streams",
+	  .fops	=	&ll_max_read_ahead_streams_fops		},
+	{ .name	=	"read_ahead_async_threads",
+	  .fops	=	&ll_read_ahead_async_threads_fops	},
+	{ .name	=	"read_ahead_async_file_max_mb",
+	  .fops	=	&ll_read_ahead_async_file_max_mb_fops	},
 	{ .name	=	"max_cached_mb",
 	  .fops	=	&ll_max_cached_mb_fops			},
 	{ .name	=	"checksum_pages",
@@ -1051,6 +1220,8 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_track_gid_fops			},
 	{ .name	=	"statahead_max",
 	  .fops	=	&ll_statahead_max_fops			},
+	{ .name	=	"statahead_batch_max",
+	  .fops	=	&ll_statahead_batch_max_fops		},
 	{ .name	=	"statahead_agl",
 	  .fops	=	&ll_statahead_agl_fops			},
 	{ .name	=	"statahead_stats",
@@ -1160,7 +1331,23 @@ static const char *ra_stat_string[] = {
 	[RA_STAT_EOF] = "read-ahead to EOF",
 	[RA_STAT_MAX_IN_FLIGHT] = "hit max r-a issue",
 	[RA_STAT_WRONG_GRAB_PAGE] = "wrong page from grab_cache_page",
-	[RA_STAT_FAILED_REACH_END] = "failed to reach end"
+	[RA_STAT_FAILED_REACH_END] = "failed to reach end",
+	[RA_STAT_STREAM_NEW] = "stream started",
+	[RA_STAT_STREAM_RECYCLED] = "stream recycled",
+	[RA_STAT_ASYNC] = "async readahead",
+	[RA_STAT_ASYNC_THROTTLED] = "async r-a throttled",
+};
+
+/* indexed by stream slot * _NR_RA_STREAM_STAT + enum ra_stream_stat */
+static const char *ra_stream_stat_string[] = {
+	"stream0 hits", "stream0 misses",
+	"stream1 hits", "stream1 misses",
+	"stream2 hits", "stream2 misses",
+	"stream3 hits", "stream3 misses",
+	"stream4 hits", "stream4 misses",
+	"stream5 hits", "stream5 misses",
+	"stream6 hits", "stream6 misses",
+	"stream7 hits", "stream7 misses",
 };
 
 LPROC_SEQ_FOPS_RO_TYPE(llite, name);
@@ -1261,6 +1448,22 @@ int lprocfs_register_mountpoint(struct proc_dir_entry *parent,
         if (err)
                 GOTO(out, err);
 
+	CLASSERT(ARRAY_SIZE(ra_stream_stat_string) ==
+		 LL_RA_STREAMS_MAX * _NR_RA_STREAM_STAT);
+	sbi->ll_ra_stream_stats =
+		lprocfs_alloc_stats(ARRAY_SIZE(ra_stream_stat_string),
+				    LPROCFS_STATS_FLAG_NONE);
+	if (sbi->ll_ra_stream_stats == NULL)
+		GOTO(out, err = -ENOMEM);
+
+	for (id = 0; id < ARRAY_SIZE(ra_stream_stat_string); id++)
+		lprocfs_counter_init(sbi->ll_ra_stream_stats, id, 0,
+				     ra_stream_stat_string[id], "pages");
+	err = lprocfs_register_stats(sbi->ll_proc_root,
+				     "read_ahead_stream_stats",
+				     sbi->ll_ra_stream_stats);
+	if (err)
+		GOTO(out, err);
 
 	err = lprocfs_add_vars(sbi->ll_proc_root, lprocfs_llite_obd_vars, sb);
 	if (err)
@@ -1312,6 +1515,7 @@ int lprocfs_register_mountpoint(struct proc_dir_entry *parent,
 out:
 	if (err) {
 		lprocfs_remove(&sbi->ll_proc_root);
+		lprocfs_free_stats(&sbi->ll_ra_stream_stats);
 		lprocfs_free_stats(&sbi->ll_ra_stats);
 		lprocfs_free_stats(&sbi->ll_stats);
 	}
@@ -1322,6 +1526,7 @@ void lprocfs_unregister_mountpoint(struct ll_sb_info *sbi)
 {
         if (sbi->ll_proc_root) {
                 lprocfs_remove(&sbi->ll_proc_root);
+		lprocfs_free_stats(&sbi->ll_ra_stream_stats);
                 lprocfs_free_stats(&sbi->ll_ra_stats);
                 lprocfs_free_stats(&sbi->ll_stats);
         }
@@ -34,6 +34,7 @@
  * Author: Bobi Jam <bobijam.xu@intel.com>
  */
 #include "range_lock.h"
+#include <obd_support.h>
 #include <lustre/lustre_user.h>
 
 /**
@@ -46,9 +47,13 @@
  */
 void range_lock_tree_init(struct range_lock_tree *tree)
 {
-	tree->rlt_root = NULL;
-	tree->rlt_sequence = 0;
-	spin_lock_init(&tree->rlt_lock);
+	int i;
+
+	for (i = 0; i < RANGE_LOCK_SHARDS; i++) {
+		tree->rlt_shards[i].rls_root = NULL;
+		tree->rlt_shards[i].rls_sequence = 0;
+		spin_lock_init(&tree->rlt_shards[i].rls_lock);
+	}
 }
 
 /**
@@ -63,26 +68,83 @@ void range_lock_tree_init(struct range_lock_tree *tree)
  */
 int range_lock_init(struct range_lock *lock, __u64 start, __u64 end)
 {
-	int rc;
-
-	interval_init(&lock->rl_node);
+	start >>= PAGE_SHIFT;
 	if (end != LUSTRE_EOF)
 		end >>= PAGE_SHIFT;
-	rc = interval_set(&lock->rl_node, start >> PAGE_SHIFT, end);
-	if (rc)
-		return rc;
+	if (start > end)
+		return -ERANGE;
 
-	INIT_LIST_HEAD(&lock->rl_next_lock);
+	lock->rl_start = start;
+	lock->rl_end = end;
 	lock->rl_task = NULL;
-	lock->rl_lock_count = 0;
-	lock->rl_blocking_ranges = 0;
-	lock->rl_sequence = 0;
-	return rc;
+	lock->rl_nodes = NULL;
+	lock->rl_nr_nodes = 0;
+	return 0;
+}
+
+static void range_lock_node_init(struct range_lock *lock,
+				 struct range_lock_node *node,
+				 unsigned int shard)
+{
+	interval_init(&node->rln_node);
+	interval_set(&node->rln_node, lock->rl_start, lock->rl_end);
+	node->rln_lock = lock;
+	INIT_LIST_HEAD(&node->rln_next_lock);
+	node->rln_lock_count = 0;
+	node->rln_blocking_ranges = 0;
+	node->rln_shard = shard;
+	node->rln_sequence = 0;
+}
+
+/**
+ * Set up the nodes of \a lock, one per shard covered by its range.
+ */
+static int range_lock_nodes_init(struct range_lock *lock)
+{
+	unsigned long shards = 0;
+	__u64 first = lock->rl_start / RANGE_LOCK_SHARD_SIZE;
+	__u64 last = lock->rl_end / RANGE_LOCK_SHARD_SIZE;
+	unsigned int i;
+	unsigned int n = 0;
+
+	if (last - first >= RANGE_LOCK_SHARDS - 1) {
+		shards = (1UL << RANGE_LOCK_SHARDS) - 1;
+	} else {
+		for (; first <= last; first++)
+			shards |= 1UL << (first % RANGE_LOCK_SHARDS);
+	}
+
+	lock->rl_nr_nodes = hweight_long(shards);
+	if (lock->rl_nr_nodes == 1) {
+		lock->rl_nodes = &lock->rl_node0;
+	} else {
+		OBD_ALLOC(lock->rl_nodes,
+			  lock->rl_nr_nodes * sizeof(*lock->rl_nodes));
+		if (lock->rl_nodes == NULL)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < RANGE_LOCK_SHARDS; i++) {
+		if (shards & (1UL << i))
+			range_lock_node_init(lock, &lock->rl_nodes[n++], i);
+	}
+	return 0;
+}
+
+static void range_lock_nodes_fini(struct range_lock *lock)
+{
+	if (lock->rl_nodes != &lock->rl_node0)
+		OBD_FREE(lock->rl_nodes,
+			 lock->rl_nr_nodes * sizeof(*lock->rl_nodes));
+	lock->rl_nodes = NULL;
+	lock->rl_nr_nodes = 0;
 }
 
-static inline struct range_lock *next_lock(struct range_lock *lock)
+static inline struct range_lock_node *
+next_lock(struct range_lock_node *node)
 {
-	return list_entry(lock->rl_next_lock.next, typeof(*lock), rl_next_lock);
+	return list_entry(node->rln_next_lock.next, typeof(*node),
+			  rln_next_lock);
 }
 
 /**
@@ -90,7 +152,7 @@ static inline struct range_lock *next_lock(struct range_lock *lock)
  *
  * \param node [in]	a range lock found overlapped during interval node
  *			search
- * \param arg [in]	the range lock to be tested
+ * \param arg [in]	the range lock node to be tested
  *
  * \retval INTERVAL_ITER_CONT	indicate to continue the search for next
  *				overlapping range node
@@ -98,71 +160,89 @@ static inline struct range_lock *next_lock(struct range_lock *lock)
  */
 static enum interval_iter range_unlock_cb(struct interval_node *node, void *arg)
 {
-	struct range_lock *lock = arg;
-	struct range_lock *overlap = node2rangelock(node);
-	struct range_lock *iter;
+	struct range_lock_node *lock = arg;
+	struct range_lock_node *overlap = node2rangelock(node);
+	struct range_lock_node *iter;
 	ENTRY;
 
-	list_for_each_entry(iter, &overlap->rl_next_lock, rl_next_lock) {
-		if (iter->rl_sequence > lock->rl_sequence) {
-			--iter->rl_blocking_ranges;
-			LASSERT(iter->rl_blocking_ranges > 0);
+	list_for_each_entry(iter, &overlap->rln_next_lock, rln_next_lock) {
+		if (iter->rln_sequence > lock->rln_sequence) {
+			--iter->rln_blocking_ranges;
+			LASSERT(iter->rln_blocking_ranges > 0);
 		}
 	}
-	if (overlap->rl_sequence > lock->rl_sequence) {
-		--overlap->rl_blocking_ranges;
-		if (overlap->rl_blocking_ranges == 0)
-			wake_up_process(overlap->rl_task);
+	if (overlap->rln_sequence > lock->rln_sequence) {
+		--overlap->rln_blocking_ranges;
+		if (overlap->rln_blocking_ranges == 0)
+			wake_up_process(overlap->rln_lock->rl_task);
 	}
 	RETURN(INTERVAL_ITER_CONT);
 }
 
 /**
- * Unlock a range lock, wake up locks blocked by this lock.
- *
- * \param tree [in]	range lock tree
- * \param lock [in]	range lock to be deleted
- *
- * If this lock has been granted, relase it; if not, just delete it from
- * the tree or the same region lock list. Wake up those locks only blocked
- * by this lock through range_unlock_cb().
+ * Remove \a lock from \a shard, wake up locks blocked by this lock only.
  */
-void range_unlock(struct range_lock_tree *tree, struct range_lock *lock)
+static void range_unlock_shard(struct range_lock_shard *shard,
+			       struct range_lock_node *lock)
 {
-	ENTRY;
-
-	spin_lock(&tree->rlt_lock);
-	if (!list_empty(&lock->rl_next_lock)) {
-		struct range_lock *next;
+	spin_lock(&shard->rls_lock);
+	if (!list_empty(&lock->rln_next_lock)) {
+		struct range_lock_node *next;
 
-		if (interval_is_intree(&lock->rl_node)) { /* first lock */
+		if (interval_is_intree(&lock->rln_node)) { /* first lock */
 			/* Insert the next same range lock into the tree */
 			next = next_lock(lock);
-			next->rl_lock_count = lock->rl_lock_count - 1;
-			interval_erase(&lock->rl_node, &tree->rlt_root);
-			interval_insert(&next->rl_node, &tree->rlt_root);
+			next->rln_lock_count = lock->rln_lock_count - 1;
+			interval_erase(&lock->rln_node, &shard->rls_root);
+			interval_insert(&next->rln_node, &shard->rls_root);
 		} else {
 			/* find the first lock in tree */
-			list_for_each_entry(next, &lock->rl_next_lock,
-					    rl_next_lock) {
-				if (!interval_is_intree(&next->rl_node))
+			list_for_each_entry(next, &lock->rln_next_lock,
+					    rln_next_lock) {
+				if (!interval_is_intree(&next->rln_node))
 					continue;
 
-				LASSERT(next->rl_lock_count > 0);
-				next->rl_lock_count--;
+				LASSERT(next->rln_lock_count > 0);
+				next->rln_lock_count--;
 				break;
 			}
 		}
-		list_del_init(&lock->rl_next_lock);
+		list_del_init(&lock->rln_next_lock);
 	} else {
-		LASSERT(interval_is_intree(&lock->rl_node));
-		interval_erase(&lock->rl_node, &tree->rlt_root);
+		LASSERT(interval_is_intree(&lock->rln_node));
+		interval_erase(&lock->rln_node, &shard->rls_root);
 	}
 
-	interval_search(tree->rlt_root, &lock->rl_node.in_extent,
+	interval_search(shard->rls_root, &lock->rln_node.in_extent,
 			range_unlock_cb, lock);
-	spin_unlock(&tree->rlt_lock);
+	spin_unlock(&shard->rls_lock);
+}
 
+/**
+ * Unlock a range lock, wake up locks blocked by this lock.
+ *
+ * \param tree [in]	range lock tree
+ * \param lock [in]	range lock to be deleted
+ *
+ * If this lock has been granted, relase it; if not, just delete it from
+ * the tree or the same region lock list. Wake up those locks only blocked
+ * by this lock through range_unlock_cb().
+ */
+static void range_unlock_nodes(struct range_lock_tree *tree,
+			       struct range_lock *lock, int nr)
+{
+	while (--nr >= 0) {
+		struct range_lock_node *node = &lock->rl_nodes[nr];
+
+		range_unlock_shard(&tree->rlt_shards[node->rln_shard], node);
+	}
+	range_lock_nodes_fini(lock);
+}
+
+void range_unlock(struct range_lock_tree *tree, struct range_lock *lock)
+{
+	ENTRY;
+	range_unlock_nodes(tree, lock, lock->rl_nr_nodes);
 	EXIT;
 }
 
@@ -171,7 +251,7 @@ void range_unlock(struct range_lock_tree *tree, struct range_lock *lock)
  *
  * \param node [in]	a range lock found overlapped during interval node
  *			search
- * \param arg [in]	the range lock to be tested
+ * \param arg [in]	the range lock node to be tested
  *
  * \retval INTERVAL_ITER_CONT	indicate to continue the search for next
  *				overlapping range node
@@ -179,66 +259,97 @@ void range_unlock(struct range_lock_tree *tree, struct range_lock *lock)
  */
 static enum interval_iter range_lock_cb(struct interval_node *node, void *arg)
 {
-	struct range_lock *lock = (struct range_lock *)arg;
-	struct range_lock *overlap = node2rangelock(node);
+	struct range_lock_node *lock = arg;
+	struct range_lock_node *overlap = node2rangelock(node);
 
-	lock->rl_blocking_ranges += overlap->rl_lock_count + 1;
+	lock->rln_blocking_ranges += overlap->rln_lock_count + 1;
 	RETURN(INTERVAL_ITER_CONT);
 }
 
 /**
- * Lock a region
- *
- * \param tree [in]	range lock tree
- * \param lock [in]	range lock node containing the region span
+ * Queue \a lock in \a shard and wait until it is granted there.
  *
- * \retval 0	get the range lock
- * \retval <0	error code while not getting the range lock
- *
- * If there exists overlapping range lock, the new lock will wait and
- * retry, if later it find that it is not the chosen one to wake up,
- * it wait again.
+ * \retval 0		the node is granted
+ * \retval -EINTR	interrupted, the node is left queued
  */
-int range_lock(struct range_lock_tree *tree, struct range_lock *lock)
+static int range_lock_shard(struct range_lock_shard *shard,
+			    struct range_lock_node *lock)
 {
 	struct interval_node *node;
-	int rc = 0;
-	ENTRY;
 
-	spin_lock(&tree->rlt_lock);
+	spin_lock(&shard->rls_lock);
 	/*
 	 * We need to check for all conflicting intervals
 	 * already in the tree.
 	 */
-	interval_search(tree->rlt_root, &lock->rl_node.in_extent,
+	interval_search(shard->rls_root, &lock->rln_node.in_extent,
 			range_lock_cb, lock);
 	/*
 	 * Insert to the tree if I am unique, otherwise I've been linked to
-	 * the rl_next_lock of another lock which has the same range as mine
+	 * the rln_next_lock of another lock which has the same range as mine
 	 * in range_lock_cb().
 	 */
-	node = interval_insert(&lock->rl_node, &tree->rlt_root);
+	node = interval_insert(&lock->rln_node, &shard->rls_root);
 	if (node != NULL) {
-		struct range_lock *tmp = node2rangelock(node);
+		struct range_lock_node *tmp = node2rangelock(node);
 
-		list_add_tail(&lock->rl_next_lock, &tmp->rl_next_lock);
-		tmp->rl_lock_count++;
+		list_add_tail(&lock->rln_next_lock, &tmp->rln_next_lock);
+		tmp->rln_lock_count++;
 	}
-	lock->rl_sequence = ++tree->rlt_sequence;
+	lock->rln_sequence = ++shard->rls_sequence;
 
-	while (lock->rl_blocking_ranges > 0) {
-		lock->rl_task = current;
+	while (lock->rln_blocking_ranges > 0) {
 		__set_current_state(TASK_INTERRUPTIBLE);
-		spin_unlock(&tree->rlt_lock);
+		spin_unlock(&shard->rls_lock);
 		schedule();
 
-		if (signal_pending(current)) {
-			range_unlock(tree, lock);
-			GOTO(out, rc = -EINTR);
+		if (signal_pending(current))
+			return -EINTR;
+		spin_lock(&shard->rls_lock);
+	}
+	spin_unlock(&shard->rls_lock);
+
+	return 0;
+}
+
+/**
+ * Lock a region
+ *
+ * \param tree [in]	range lock tree
+ * \param lock [in]	range lock node containing the region span
+ *
+ * \retval 0	get the range lock
+ * \retval <0	error code while not getting the range lock
+ *
+ * If there exists overlapping range lock, the new lock will wait and
+ * retry, if later it find that it is not the chosen one to wake up,
+ * it wait again.
+ *
+ * The lock is acquired in each of the shards it covers in increasing shard
+ * order, waiting to be granted in one shard before being queued in the next,
+ * so that two locks covering the same shards can not deadlock.
+ */
+int range_lock(struct range_lock_tree *tree, struct range_lock *lock)
+{
+	unsigned int i;
+	int rc;
+	ENTRY;
+
+	rc = range_lock_nodes_init(lock);
+	if (rc != 0)
+		RETURN(rc);
+
+	lock->rl_task = current;
+	for (i = 0; i < lock->rl_nr_nodes; i++) {
+		struct range_lock_node *node = &lock->rl_nodes[i];
+
+		rc = range_lock_shard(&tree->rlt_shards[node->rln_shard], node);
+		if (rc != 0) {
+			/* drop the nodes queued so far, this one included */
+			range_unlock_nodes(tree, lock, i + 1);
+			break;
 		}
-		spin_lock(&tree->rlt_lock);
 	}
-	spin_unlock(&tree->rlt_lock);
-out:
+
 	RETURN(rc);
 }
@@ -41,43 +41,86 @@
 
 #define RL_FMT "[%llu, %llu]"
 #define RL_PARA(range)				\
-	(range)->rl_node.in_extent.start,	\
-	(range)->rl_node.in_extent.end
+	(range)->rl_start,			\
+	(range)->rl_end
 
-struct range_lock {
-	struct interval_node	rl_node;
+/*
+ * The lock tree is split into RANGE_LOCK_SHARDS independent interval trees,
+ * each with its own spinlock. File regions of RANGE_LOCK_SHARD_SIZE pages
+ * are mapped round-robin onto the shards, and a range lock is queued on the
+ * shard of every region it covers, so writers of disjoint regions do not
+ * share a spinlock. Two overlapping ranges always have a shard in common,
+ * in which their conflict is resolved as with a single tree.
+ */
+#define RANGE_LOCK_SHARDS	8
+#define RANGE_LOCK_SHARD_SIZE	(1UL << (20 - PAGE_SHIFT))
+
+/**
+ * Part of a range lock queued in one shard of the tree.
+ */
+struct range_lock_node {
+	struct interval_node	rln_node;
 	/**
-	 * Process to enqueue this lock.
+	 * Range lock this node belongs to.
 	 */
-	struct task_struct	*rl_task;
+	struct range_lock	*rln_lock;
+	/**
+	 * List of nodes with the same range in this shard.
+	 */
+	struct list_head	rln_next_lock;
 	/**
-	 * List of locks with the same range.
+	 * Number of nodes in the list rln_next_lock
 	 */
-	struct list_head	rl_next_lock;
+	unsigned int		rln_lock_count;
 	/**
-	 * Number of locks in the list rl_next_lock
+	 * Number of ranges which are blocking acquisition of the node
 	 */
-	unsigned int		rl_lock_count;
+	unsigned int		rln_blocking_ranges;
 	/**
-	 * Number of ranges which are blocking acquisition of the lock
+	 * Index of the shard this node is queued in.
 	 */
-	unsigned int		rl_blocking_ranges;
+	unsigned int		rln_shard;
 	/**
-	 * Sequence number of range lock. This number is used to get to know
-	 * the order the locks are queued; this is required for range_cancel().
+	 * Sequence number of the node in its shard. This number is used to
+	 * get to know the order the locks are queued; this is required for
+	 * range_unlock().
 	 */
-	__u64			rl_sequence;
+	__u64			rln_sequence;
 };
 
-static inline struct range_lock *node2rangelock(const struct interval_node *n)
+static inline struct range_lock_node *
+node2rangelock(const struct interval_node *n)
 {
-	return container_of(n, struct range_lock, rl_node);
+	return container_of(n, struct range_lock_node, rln_node);
 }
 
+struct range_lock {
+	/**
+	 * Locked region in pages, inclusive.
+	 */
+	__u64			rl_start;
+	__u64			rl_end;
+	/**
+	 * Process to enqueue this lock.
+	 */
+	struct task_struct	*rl_task;
+	/**
+	 * Nodes queued in the shards, in increasing shard order. This points
+	 * to rl_node0 unless the lock covers several shards.
+	 */
+	struct range_lock_node	*rl_nodes;
+	unsigned int		 rl_nr_nodes;
+	struct range_lock_node	 rl_node0;
+};
+
+struct range_lock_shard {
+	struct interval_node	*rls_root;
+	spinlock_t		 rls_lock;
+	__u64			 rls_sequence;
+};
+
 struct range_lock_tree {
-	struct interval_node	*rlt_root;
-	spinlock_t		 rlt_lock;
-	__u64			 rlt_sequence;
+	struct range_lock_shard	rlt_shards[RANGE_LOCK_SHARDS];
 };
 
 void range_lock_tree_init(struct range_lock_tree *tree);
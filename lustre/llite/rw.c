@@ -154,13 +154,13 @@ static int index_in_window(unsigned long index, unsigned long point,
 void ll_ras_enter(struct file *f)
 {
 	struct ll_file_data *fd = LUSTRE_FPRIVATE(f);
-	struct ll_readahead_state *ras = &fd->fd_ras;
+	struct ll_ra_streams *lrs = &fd->fd_ra_streams;
 
-	spin_lock(&ras->ras_lock);
-	ras->ras_requests++;
-	ras->ras_request_index = 0;
-	ras->ras_consecutive_requests++;
-	spin_unlock(&ras->ras_lock);
+	/* the request is accounted to a stream once the stream is hit,
+	 * see ras_stream_find() */
+	spin_lock(&lrs->lrs_lock);
+	lrs->lrs_requests++;
+	spin_unlock(&lrs->lrs_lock);
 }
 
 /**
@@ -598,12 +598,71 @@ static void ras_stride_reset(struct ll_readahead_state *ras)
         RAS_CDEBUG(ras);
 }
 
-void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras)
+static void ras_stream_init(struct inode *inode,
+			    struct ll_readahead_state *ras,
+			    unsigned long rpc_size, unsigned long index,
+			    unsigned long seq)
 {
-	spin_lock_init(&ras->ras_lock);
-	ras->ras_rpc_size = PTLRPC_MAX_BRW_PAGES;
-	ras_reset(inode, ras, 0);
+	ras->ras_rpc_size = rpc_size;
+	ras_reset(inode, ras, index);
+	ras_stride_reset(ras);
 	ras->ras_requests = 0;
+	ras->ras_request_index = 0;
+	ras->ras_request_seq = seq;
+}
+
+static void ras_stream_setup(struct inode *inode,
+			     struct ll_readahead_state *ras, unsigned int id)
+{
+	spin_lock_init(&ras->ras_lock);
+	ras->ras_stream_id = id;
+	ras->ras_last_access = 0;
+	ras_stream_init(inode, ras, PTLRPC_MAX_BRW_PAGES, 0, 0);
+}
+
+void ll_readahead_init(struct inode *inode, struct ll_ra_streams *lrs)
+{
+	spin_lock_init(&lrs->lrs_lock);
+	lrs->lrs_requests = 0;
+	lrs->lrs_clock = 0;
+	ras_stream_setup(inode, &lrs->lrs_ras, 0);
+	lrs->lrs_more = NULL;
+	/* the first stream is always in use */
+	lrs->lrs_count = 1;
+}
+
+void ll_readahead_fini(struct ll_ra_streams *lrs)
+{
+	if (lrs->lrs_more != NULL)
+		OBD_FREE(lrs->lrs_more, (LL_RA_STREAMS_MAX - 1) *
+			 sizeof(*lrs->lrs_more));
+	lrs->lrs_more = NULL;
+}
+
+static inline struct ll_readahead_state *
+ras_stream(struct ll_ra_streams *lrs, unsigned int i)
+{
+	return i == 0 ? &lrs->lrs_ras : &lrs->lrs_more[i - 1];
+}
+
+/*
+ * Allocate the streams other than the first one, once a second stream is
+ * detected. Called under lrs_lock, on failure the stream least recently
+ * used is recycled instead.
+ */
+static int ras_streams_alloc(struct inode *inode, struct ll_ra_streams *lrs)
+{
+	unsigned int i;
+
+	OBD_ALLOC_GFP(lrs->lrs_more, (LL_RA_STREAMS_MAX - 1) *
+		      sizeof(*lrs->lrs_more), GFP_ATOMIC);
+	if (lrs->lrs_more == NULL)
+		return -ENOMEM;
+
+	for (i = 1; i < LL_RA_STREAMS_MAX; i++)
+		ras_stream_setup(inode, ras_stream(lrs, i), i);
+
+	return 0;
 }
 
 /*
@@ -722,6 +781,190 @@ static void ras_increase_window(struct inode *inode,
 	}
 }
 
+/*
+ * Check whether page \a index continues the sequential access of stream
+ * \a ras, i.e. it is close to the last page read or inside the current
+ * read-ahead window.
+ *
+ * Called with the ras_lock of \a ras held, as ras_update() moves the window
+ * under it.
+ */
+static bool ras_stream_match(struct ll_readahead_state *ras,
+			     unsigned long index)
+{
+	if (index_in_window(index, ras->ras_last_readpage, 8, 8))
+		return true;
+
+	return ras->ras_window_len > 0 &&
+	       index_in_window(index, ras->ras_window_start, 0,
+			       ras->ras_window_len);
+}
+
+/*
+ * Start stream \a ras at page \a index. A jump forward from the most recently
+ * used stream \a prev may be the first step of a stride pattern, so arm the
+ * stride detector of the new stream the same way ras_update() does it for a
+ * single stream, otherwise strided reads would never be detected because
+ * every stride step would start yet another stream.
+ *
+ * Called without any ras_lock held: the state of \a prev is read under its
+ * own lock first, so that two stream locks are never nested.
+ */
+static void ras_stream_start(struct inode *inode,
+			     struct ll_readahead_state *ras,
+			     struct ll_readahead_state *prev,
+			     unsigned long index, unsigned long seq)
+{
+	unsigned long rpc_size = PTLRPC_MAX_BRW_PAGES;
+	unsigned long stride_pages = 0;
+	unsigned long stride_length = 0;
+
+	if (prev != NULL && prev != ras) {
+		spin_lock(&prev->ras_lock);
+		rpc_size = prev->ras_rpc_size;
+		if (!stride_io_mode(prev) && prev->ras_consecutive_pages > 0 &&
+		    index > prev->ras_last_readpage) {
+			stride_pages = prev->ras_consecutive_pages;
+			stride_length = index - prev->ras_last_readpage - 1 +
+					prev->ras_consecutive_pages;
+		}
+		spin_unlock(&prev->ras_lock);
+	}
+
+	spin_lock(&ras->ras_lock);
+	ras_stream_init(inode, ras, rpc_size, index, seq);
+	if (stride_pages > 0) {
+		ras->ras_stride_pages = stride_pages;
+		ras->ras_stride_length = stride_length;
+		ras->ras_consecutive_stride_requests = 1;
+		RAS_CDEBUG(ras);
+	}
+	spin_unlock(&ras->ras_lock);
+}
+
+/**
+ * Find the read-ahead stream that page \a index belongs to.
+ *
+ * A stream matches if \a index continues its sequential access or is the
+ * next step of its stride pattern. If no stream matches, an unused stream
+ * slot is started at \a index, or the least recently used stream is recycled
+ * once ll_ra_info::ra_max_streams streams are in use.
+ *
+ * This also accounts the current read request to the returned stream, which
+ * is what ll_ras_enter() does for a single stream.
+ */
+static struct ll_readahead_state *
+ras_stream_find(struct ll_sb_info *sbi, struct inode *inode,
+		struct ll_ra_streams *lrs, unsigned long index)
+{
+	struct ll_readahead_state *ras = NULL;
+	struct ll_readahead_state *mru = NULL;
+	struct ll_readahead_state *lru = NULL;
+	unsigned int max_streams = sbi->ll_ra_info.ra_max_streams;
+	unsigned int count;
+	unsigned int i;
+
+	spin_lock(&lrs->lrs_lock);
+	lrs->lrs_clock++;
+
+	/* single stream, ras_update() resets the window on a seek */
+	if (max_streams <= 1) {
+		ras = &lrs->lrs_ras;
+		goto out_enter;
+	}
+
+	/* the windows are updated by ras_update() under the ras_lock of
+	 * each stream, not under lrs_lock */
+	count = min(lrs->lrs_count, max_streams);
+	for (i = 0; i < count; i++) {
+		struct ll_readahead_state *tmp = ras_stream(lrs, i);
+
+		spin_lock(&tmp->ras_lock);
+		if (ras_stream_match(tmp, index))
+			ras = tmp;
+		spin_unlock(&tmp->ras_lock);
+		if (ras != NULL)
+			goto out_enter;
+		if (mru == NULL || tmp->ras_last_access > mru->ras_last_access)
+			mru = tmp;
+		if (lru == NULL || tmp->ras_last_access < lru->ras_last_access)
+			lru = tmp;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct ll_readahead_state *tmp = ras_stream(lrs, i);
+
+		spin_lock(&tmp->ras_lock);
+		if (index_in_stride_window(tmp, index))
+			ras = tmp;
+		spin_unlock(&tmp->ras_lock);
+		if (ras != NULL)
+			goto out_enter;
+	}
+
+	if (count < max_streams &&
+	    (lrs->lrs_more != NULL || ras_streams_alloc(inode, lrs) == 0)) {
+		ras = ras_stream(lrs, count);
+		lrs->lrs_count = count + 1;
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_STREAM_NEW);
+	} else {
+		ras = lru;
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_STREAM_RECYCLED);
+	}
+	CDEBUG(D_READA, DFID " start ra stream %u at %lu\n",
+	       PFID(ll_inode2fid(inode)), ras->ras_stream_id, index);
+
+	/* the current request has been entered already */
+	ras_stream_start(inode, ras, mru, index, lrs->lrs_requests - 1);
+
+out_enter:
+	ras->ras_last_access = lrs->lrs_clock;
+	spin_lock(&ras->ras_lock);
+	if (ras->ras_request_seq != lrs->lrs_requests) {
+		ras->ras_request_seq = lrs->lrs_requests;
+		ras->ras_requests++;
+		ras->ras_request_index = 0;
+		ras->ras_consecutive_requests++;
+	}
+	spin_unlock(&ras->ras_lock);
+	spin_unlock(&lrs->lrs_lock);
+
+	return ras;
+}
+
+/**
+ * The stream returned by the last ras_stream_find() of \a lrs, without
+ * accounting another access to it. This is for a page whose read-ahead
+ * state was updated already by the fast read path, see vpg_ra_updated.
+ */
+static struct ll_readahead_state *ras_stream_last(struct ll_ra_streams *lrs)
+{
+	struct ll_readahead_state *ras = &lrs->lrs_ras;
+	unsigned int i;
+
+	spin_lock(&lrs->lrs_lock);
+	for (i = 1; i < lrs->lrs_count; i++) {
+		if (ras_stream(lrs, i)->ras_last_access == lrs->lrs_clock) {
+			ras = ras_stream(lrs, i);
+			break;
+		}
+	}
+	spin_unlock(&lrs->lrs_lock);
+
+	return ras;
+}
+
+static void ll_ra_stream_stats_inc(struct ll_sb_info *sbi,
+				   struct ll_readahead_state *ras,
+				   enum ra_stream_stat which)
+{
+	if (sbi->ll_ra_stream_stats == NULL)
+		return;
+
+	lprocfs_counter_incr(sbi->ll_ra_stream_stats,
+			     ras->ras_stream_id * _NR_RA_STREAM_STAT + which);
+}
+
 static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 		       struct ll_readahead_state *ras, unsigned long index,
 		       enum ras_update_flags flags)
@@ -737,6 +980,8 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 		CDEBUG(D_READA, DFID " pages at %lu miss.\n",
 		       PFID(ll_inode2fid(inode)), index);
         ll_ra_stats_inc_sbi(sbi, hit ? RA_STAT_HIT : RA_STAT_MISS);
+	ll_ra_stream_stats_inc(sbi, ras,
+			       hit ? RA_STREAM_STAT_HIT : RA_STREAM_STAT_MISS);
 
         /* reset the read-ahead window in two cases.  First when the app seeks
          * or reads to some other part of the file.  Secondly if we get a
@@ -890,6 +1135,235 @@ out_unlock:
 	return;
 }
 
+struct ll_readahead_work {
+	struct cfs_workitem		 lrw_wi;
+	struct cfs_wi_sched		*lrw_sched;
+	/* inode reference held until the work item is done */
+	struct inode			*lrw_inode;
+	/* copy of the stream when the work item was queued */
+	struct ll_readahead_state	 lrw_ras;
+	/* pages accounted in ll_inode_info::lli_ra_async_pages */
+	unsigned long			 lrw_pages;
+};
+
+/**
+ * Issue read-ahead of a stream from an asynchronous read-ahead thread.
+ *
+ * The work item reads the window of its own copy of the stream, so the
+ * stream of the file descriptor can be recycled or freed meanwhile. The
+ * read lock of the window is taken as for a read(2), but without waiting
+ * for a conflicting lock.
+ */
+static int ll_readahead_work_handler(struct cfs_workitem *wi)
+{
+	struct ll_readahead_work *work = wi->wi_data;
+	struct inode *inode = work->lrw_inode;
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_readahead_state *ras = &work->lrw_ras;
+	struct cl_object *clob = ll_i2info(inode)->lli_clob;
+	struct lu_env *env;
+	struct vvp_io *vio;
+	struct cl_io *io;
+	struct cl_2queue *queue;
+	__u16 refcheck;
+	int rc;
+	ENTRY;
+
+	cfs_wi_exit(work->lrw_sched, wi);
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		GOTO(out, rc = PTR_ERR(env));
+
+	/* the io has no file, vvp_io_one_lock() and vvp_io_read_ahead()
+	 * check vui_fd for NULL, see ll_readahead_async() for group locks */
+	vio = vvp_env_io(env);
+	vio->vui_fd = NULL;
+	vio->vui_iter = NULL;
+	vio->vui_io_subtype = IO_NORMAL;
+
+	io = vvp_env_thread_io(env);
+	io->ci_obj = clob;
+	rc = cl_io_rw_init(env, io, CIT_READ,
+			   cl_offset(clob, ras->ras_next_readahead),
+			   work->lrw_pages << PAGE_SHIFT);
+	if (rc == 0) {
+		io->u.ci_rd.rd.crw_nonblock = 1;
+		rc = cl_io_iter_init(env, io);
+		if (rc == 0) {
+			rc = cl_io_lock(env, io);
+			if (rc == 0) {
+				queue = &io->ci_queue;
+				cl_2queue_init(queue);
+				rc = ll_readahead(env, io, &queue->c2_qin, ras,
+						  true);
+				if (queue->c2_qin.pl_nr > 0)
+					rc = cl_io_submit_rw(env, io, CRT_READ,
+							     queue);
+
+				/* Unlock unsent pages in case of error. */
+				cl_page_list_disown(env, io, &queue->c2_qin);
+				cl_2queue_fini(env, queue);
+				cl_io_unlock(env, io);
+			}
+		}
+		cl_io_iter_fini(env, io);
+	}
+	cl_io_fini(env, io);
+	cl_env_put(env, &refcheck);
+out:
+	if (rc < 0)
+		CDEBUG(D_READA, DFID " async read-ahead failed: rc = %d\n",
+		       PFID(ll_inode2fid(inode)), rc);
+
+	atomic_long_sub(work->lrw_pages, &ll_i2info(inode)->lli_ra_async_pages);
+	iput(inode);
+	OBD_FREE_PTR(work);
+
+	if (atomic_dec_and_test(&sbi->ll_ra_info.ra_async_inflight))
+		wake_up_all(&sbi->ll_ra_info.ra_async_waitq);
+
+	/* the work item is freed */
+	RETURN(1);
+}
+
+/**
+ * Hand read-ahead of stream \a ras over to an asynchronous read-ahead thread.
+ *
+ * This is done once the read-ahead window is at least one RPC ahead of what
+ * has been issued already, so the reader does not have to build and queue the
+ * next window before its own page is returned. The window is handed over as
+ * a whole, the stream goes on after it.
+ *
+ * \retval true	read-ahead of the window is queued, the caller must not
+ *			issue read-ahead itself
+ * \retval false	the caller should fall back to synchronous read-ahead
+ */
+static bool ll_readahead_async(struct ll_sb_info *sbi, struct file *file,
+			       struct ll_readahead_state *ras)
+{
+	struct ll_ra_info *ra = &sbi->ll_ra_info;
+	struct inode *inode = file_inode(file);
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct ll_readahead_work *work;
+	unsigned long window_end;
+	unsigned long pages;
+	bool queued = false;
+
+	if (ra->ra_async_threads == 0)
+		return false;
+
+	/* the read lock of the work item would conflict with the group lock */
+	if (LUSTRE_FPRIVATE(file)->fd_flags & LL_FILE_GROUP_LOCKED)
+		return false;
+
+	/* not worth the allocation, checked again under ras_lock */
+	if (ras->ras_window_len == 0 ||
+	    ras->ras_window_start + ras->ras_window_len <
+	    ras->ras_next_readahead + ras->ras_rpc_size)
+		return false;
+
+	/* the scheduler is being replaced, see ll_ra_async_set_threads() */
+	if (!down_read_trylock(&ra->ra_async_sem))
+		return false;
+
+	if (ra->ra_async_sched == NULL)
+		GOTO(out_unlock, queued = false);
+
+	OBD_ALLOC_PTR(work);
+	if (work == NULL)
+		GOTO(out_unlock, queued = false);
+
+	spin_lock(&ras->ras_lock);
+	window_end = ras->ras_window_start + ras->ras_window_len;
+	if (ras->ras_window_len == 0 ||
+	    window_end < ras->ras_next_readahead + ras->ras_rpc_size) {
+		spin_unlock(&ras->ras_lock);
+		OBD_FREE_PTR(work);
+		GOTO(out_unlock, queued = false);
+	}
+
+	pages = window_end - ras->ras_next_readahead;
+	if (atomic_long_add_return(pages, &lli->lli_ra_async_pages) >
+	    ra->ra_async_pages_per_file) {
+		atomic_long_sub(pages, &lli->lli_ra_async_pages);
+		spin_unlock(&ras->ras_lock);
+		OBD_FREE_PTR(work);
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_ASYNC_THROTTLED);
+		GOTO(out_unlock, queued = false);
+	}
+	work->lrw_ras = *ras;
+	ras->ras_next_readahead = window_end;
+	spin_unlock(&ras->ras_lock);
+	spin_lock_init(&work->lrw_ras.ras_lock);
+
+	work->lrw_inode = igrab(inode);
+	if (work->lrw_inode == NULL) {
+		atomic_long_sub(pages, &lli->lli_ra_async_pages);
+		OBD_FREE_PTR(work);
+		GOTO(out_unlock, queued = false);
+	}
+	work->lrw_pages = pages;
+	work->lrw_sched = ra->ra_async_sched;
+	cfs_wi_init(&work->lrw_wi, work, ll_readahead_work_handler);
+
+	atomic_inc(&ra->ra_async_inflight);
+	cfs_wi_schedule(ra->ra_async_sched, &work->lrw_wi);
+	ll_ra_stats_inc_sbi(sbi, RA_STAT_ASYNC);
+	queued = true;
+	CDEBUG(D_READA, DFID " queued async read-ahead of %lu pages at %lu\n",
+	       PFID(ll_inode2fid(inode)), pages,
+	       work->lrw_ras.ras_next_readahead);
+
+out_unlock:
+	up_read(&ra->ra_async_sem);
+	return queued;
+}
+
+/**
+ * Set the number of asynchronous read-ahead threads of a mount, 0 disables
+ * asynchronous read-ahead.
+ *
+ * Queued work items keep running on the old scheduler, so wait for them to
+ * finish before it is replaced. New work items are not queued meanwhile and
+ * readers fall back to synchronous read-ahead.
+ */
+int ll_ra_async_set_threads(struct ll_sb_info *sbi, unsigned int nthreads)
+{
+	struct ll_ra_info *ra = &sbi->ll_ra_info;
+	struct cfs_wi_sched *sched = NULL;
+	int rc = 0;
+	ENTRY;
+
+	if (nthreads > LL_RA_ASYNC_THREADS_MAX)
+		RETURN(-ERANGE);
+
+	down_write(&ra->ra_async_sem);
+	wait_event(ra->ra_async_waitq,
+		   atomic_read(&ra->ra_async_inflight) == 0);
+
+	if (ra->ra_async_sched != NULL) {
+		cfs_wi_sched_destroy(ra->ra_async_sched);
+		ra->ra_async_sched = NULL;
+	}
+	ra->ra_async_threads = 0;
+
+	if (nthreads > 0) {
+		rc = cfs_wi_sched_create("ll_ra", NULL, CFS_CPT_ANY, nthreads,
+					 &sched);
+		if (rc == 0) {
+			ra->ra_async_sched = sched;
+			ra->ra_async_threads = nthreads;
+		} else {
+			CERROR("cannot start %u async read-ahead threads: "
+			       "rc = %d\n", nthreads, rc);
+		}
+	}
+	up_write(&ra->ra_async_sem);
+
+	RETURN(rc);
+}
+
 int ll_writepage(struct page *vmpage, struct writeback_control *wbc)
 {
 	struct inode	       *inode = vmpage->mapping->host;
@@ -1088,7 +1562,7 @@ static int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 	struct inode              *inode  = vvp_object_inode(page->cp_obj);
 	struct ll_sb_info         *sbi    = ll_i2sbi(inode);
 	struct ll_file_data       *fd     = LUSTRE_FPRIVATE(file);
-	struct ll_readahead_state *ras    = &fd->fd_ras;
+	struct ll_readahead_state *ras    = NULL;
 	struct cl_2queue          *queue  = &io->ci_queue;
 	struct vvp_page           *vpg;
 	int			   rc = 0;
@@ -1098,9 +1572,15 @@ static int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 	vpg = cl2vvp_page(cl_object_page_slice(page->cp_obj, page));
 	uptodate = vpg->vpg_defer_uptodate;
 
+	/* the fast read path accounted the page to its stream already */
 	if (sbi->ll_ra_info.ra_max_pages_per_file > 0 &&
-	    sbi->ll_ra_info.ra_max_pages > 0 &&
-	    !vpg->vpg_ra_updated) {
+	    sbi->ll_ra_info.ra_max_pages > 0)
+		ras = vpg->vpg_ra_updated ?
+		      ras_stream_last(&fd->fd_ra_streams) :
+		      ras_stream_find(sbi, inode, &fd->fd_ra_streams,
+				      vvp_index(vpg));
+
+	if (ras != NULL && !vpg->vpg_ra_updated) {
 		struct vvp_io *vio = vvp_env_io(env);
 		enum ras_update_flags flags = 0;
 
@@ -1120,8 +1600,9 @@ static int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 		cl_2queue_add(queue, page);
 	}
 
-	if (sbi->ll_ra_info.ra_max_pages_per_file > 0 &&
-	    sbi->ll_ra_info.ra_max_pages > 0) {
+	/* if the page is a read-ahead hit, the rest of the window can be
+	 * read ahead without making this reader wait for it */
+	if (ras != NULL && !(uptodate && ll_readahead_async(sbi, file, ras))) {
 		int rc2;
 
 		rc2 = ll_readahead(env, io, &queue->c2_qin, ras,
@@ -1164,7 +1645,7 @@ int ll_readpage(struct file *file, struct page *vmpage)
 	if (io == NULL) { /* fast read */
 		struct inode *inode = file_inode(file);
 		struct ll_file_data *fd = LUSTRE_FPRIVATE(file);
-		struct ll_readahead_state *ras = &fd->fd_ras;
+		struct ll_readahead_state *ras;
 		struct vvp_page *vpg;
 
 		result = -ENODATA;
@@ -1184,6 +1665,9 @@ int ll_readpage(struct file *file, struct page *vmpage)
 			if (lcc->lcc_type == LCC_MMAP)
 				flags |= LL_RAS_MMAP;
 
+			ras = ras_stream_find(ll_i2sbi(inode), inode,
+					      &fd->fd_ra_streams,
+					      vvp_index(vpg));
 			/* For fast read, it updates read ahead state only
 			 * if the page is hit in cache because non cache page
 			 * case will be handled by slow read later. */
@@ -1194,9 +1678,11 @@ int ll_readpage(struct file *file, struct page *vmpage)
 
 			/* Check if we can issue a readahead RPC, if that is
 			 * the case, we can't do fast IO because we will need
-			 * a cl_io to issue the RPC. */
+			 * a cl_io to issue the RPC, unless the read-ahead is
+			 * handed over to an async read-ahead thread. */
 			if (ras->ras_window_start + ras->ras_window_len <
-			    ras->ras_next_readahead + PTLRPC_MAX_BRW_PAGES) {
+			    ras->ras_next_readahead + PTLRPC_MAX_BRW_PAGES ||
+			    ll_readahead_async(ll_i2sbi(inode), file, ras)) {
 				/* export the page and skip io stack */
 				vpg->vpg_ra_used = 1;
 				cl_page_export(env, page, 1);
@@ -74,6 +74,10 @@ struct sa_entry {
 	struct md_enqueue_info *se_minfo;
 	/* pointer to the async getattr request */
 	struct ptlrpc_request  *se_req;
+	/* attributes in se_req reply, for batched getattr */
+	struct mdt_body	       *se_body;
+	/* batched getattr refused the entry, stat it on its own */
+	unsigned int		se_resend:1;
 	/* pointer to the target inode */
 	struct inode	       *se_inode;
 	/* entry name */
@@ -352,6 +356,7 @@ sa_make_ready(struct ll_statahead_info *sai, struct sa_entry *entry, int ret)
 
 	if (req) {
 		entry->se_req = NULL;
+		entry->se_body = NULL;
 		ptlrpc_req_finished(req);
 	}
 
@@ -422,6 +427,12 @@ static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry)
 	}
 	atomic_set(&sai->sai_cache_count, 0);
 
+	/* entries of a striped directory live on several MDTs, and batched
+	 * getattr replies carry no LMV, so stat them one by one */
+	if (ll_i2sbi(dentry->d_inode)->ll_flags & LL_SBI_BATCH_GETATTR &&
+	    lli->lli_lsm_md == NULL)
+		sai->sai_batch_max = ll_i2sbi(dentry->d_inode)->ll_sa_batch_max;
+
 	spin_lock(&sai_generation_lock);
 	lli->lli_sa_generation = ++sai_generation;
 	if (unlikely(sai_generation == 0))
@@ -476,6 +487,7 @@ static void ll_sai_put(struct ll_statahead_info *sai)
 		LASSERT(thread_is_stopped(&sai->sai_agl_thread));
 		LASSERT(sai->sai_sent == sai->sai_replied);
 		LASSERT(!sa_has_callback(sai));
+		LASSERT(sai->sai_batch == NULL);
 
 		list_for_each_entry_safe(entry, next, &sai->sai_entries,
 					 se_list)
@@ -562,6 +574,7 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 	struct inode *dir = sai->sai_dentry->d_inode;
 	struct inode *child;
 	struct md_enqueue_info *minfo;
+	struct lookup_intent batch_it = { .it_op = IT_GETATTR };
 	struct lookup_intent *it;
 	struct ptlrpc_request *req;
 	struct mdt_body *body;
@@ -570,12 +583,19 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 
         LASSERT(entry->se_handle != 0);
 
-        minfo = entry->se_minfo;
-        it = &minfo->mi_it;
-        req = entry->se_req;
-        body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
-        if (body == NULL)
-                GOTO(out, rc = -EFAULT);
+	minfo = entry->se_minfo;
+	req = entry->se_req;
+	if (minfo != NULL) {
+		it = &minfo->mi_it;
+		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	} else {
+		/* batched getattr, only lookups of uncached names */
+		LASSERT(entry->se_inode == NULL);
+		it = &batch_it;
+		body = entry->se_body;
+	}
+	if (body == NULL)
+		GOTO(out, rc = -EFAULT);
 
 	child = entry->se_inode;
 	if (child != NULL) {
@@ -593,9 +613,12 @@ static void sa_instantiate(struct ll_statahead_info *sai,
         if (rc != 1)
                 GOTO(out, rc = -EAGAIN);
 
-        rc = ll_prep_inode(&child, req, dir->i_sb, it);
-        if (rc)
-                GOTO(out, rc);
+	if (minfo != NULL)
+		rc = ll_prep_inode(&child, req, dir->i_sb, it);
+	else
+		rc = ll_prep_inode_body(&child, body, dir->i_sb, it);
+	if (rc)
+		GOTO(out, rc);
 
 	CDEBUG(D_READA, "%s: setting %.*s"DFID" l_data to inode %p\n",
 	       ll_get_fsname(child->i_sb, NULL, 0),
@@ -614,9 +637,32 @@ out:
 	/* sa_make_ready() will drop ldlm ibits lock refcount by calling
 	 * ll_intent_drop_lock() in spite of failures. Do not worry about
 	 * calling ll_intent_drop_lock() more than once. */
+	if (minfo == NULL)
+		ll_intent_release(it);
 	sa_make_ready(sai, entry, rc);
 }
 
+static int sa_lookup(struct inode *dir, struct sa_entry *entry);
+
+/* stat an entry refused by batched getattr with an intent getattr RPC */
+static void sa_resend(struct ll_statahead_info *sai, struct sa_entry *entry)
+{
+	int rc = -EINTR;
+
+	entry->se_resend = 0;
+	/* only statahead thread sends RPCs and counts them in sai_sent, and
+	 * once it stops it only waits for inflight ones; the scanner helping
+	 * in sa_handle_callback() will do a regular lookup instead */
+	if (thread_is_running(&sai->sai_thread) &&
+	    sai->sai_thread.t_pid == current_pid())
+		rc = sa_lookup(sai->sai_dentry->d_inode, entry);
+
+	if (rc != 0)
+		sa_make_ready(sai, entry, rc);
+	else
+		sai->sai_sent++;
+}
+
 /* once there are async stat replies, instantiate sa_entry from replies */
 static void sa_handle_callback(struct ll_statahead_info *sai)
 {
@@ -637,7 +683,10 @@ static void sa_handle_callback(struct ll_statahead_info *sai)
 		list_del_init(&entry->se_list);
 		spin_unlock(&lli->lli_sa_lock);
 
-		sa_instantiate(sai, entry);
+		if (unlikely(entry->se_resend))
+			sa_resend(sai, entry);
+		else
+			sa_instantiate(sai, entry);
 	}
 }
 
@@ -708,6 +757,167 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	RETURN(rc);
 }
 
+/*
+ * callback for batched stat RPC, in ptlrpcd context like
+ * ll_statahead_interpret(). Entries the MDT refused for reasons other than
+ * not existing are queued with se_resend set, and the statahead thread will
+ * stat them one by one.
+ */
+static int ll_statahead_batch_interpret(struct ptlrpc_request *req,
+					struct md_batch_info *binfo, int rc)
+{
+	struct inode *dir = binfo->mb_dir;
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ll_statahead_info *sai = lli->lli_sai;
+	bool wakeup_scanner = false;
+	bool wakeup_thread = false;
+	int i;
+	ENTRY;
+
+	LASSERT(sai != NULL);
+	LASSERT(!thread_is_stopped(&sai->sai_thread));
+
+	CDEBUG(D_READA, "batch of %d entries rc %d\n", binfo->mb_count, rc);
+
+	for (i = 0; i < binfo->mb_count; i++) {
+		struct md_batch_item *mbi = &binfo->mb_items[i];
+		struct sa_entry *entry = mbi->mbi_cbdata;
+
+		if (mbi->mbi_rc != 0)
+			continue;
+
+		/* release ibits lock ASAP, see ll_statahead_interpret() */
+		entry->se_handle = mbi->mbi_lockh.cookie;
+		entry->se_req = ptlrpc_request_addref(req);
+		entry->se_body = mbi->mbi_body;
+		ldlm_lock_decref(&mbi->mbi_lockh, binfo->mb_einfo.ei_mode);
+	}
+
+	spin_lock(&lli->lli_sa_lock);
+	for (i = 0; i < binfo->mb_count; i++) {
+		struct md_batch_item *mbi = &binfo->mb_items[i];
+		struct sa_entry *entry = mbi->mbi_cbdata;
+
+		if (mbi->mbi_rc == -ENOENT) {
+			if (__sa_make_ready(sai, entry, mbi->mbi_rc))
+				wakeup_scanner = true;
+		} else {
+			entry->se_resend = mbi->mbi_rc != 0;
+			if (!sa_has_callback(sai))
+				wakeup_thread = true;
+			list_add_tail(&entry->se_list,
+				      &sai->sai_interim_entries);
+		}
+		sai->sai_replied++;
+	}
+	if (wakeup_scanner)
+		wake_up(&sai->sai_waitq);
+	if (wakeup_thread)
+		wake_up(&sai->sai_thread.t_ctl_waitq);
+	spin_unlock(&lli->lli_sa_lock);
+
+	iput(dir);
+	OBD_FREE(binfo, offsetof(struct md_batch_info, mb_items[binfo->mb_max]));
+
+	RETURN(rc);
+}
+
+/* send the pending batch, stat its entries one by one if that fails */
+static void sa_batch_flush(struct ll_statahead_info *sai)
+{
+	struct md_batch_info *binfo = sai->sai_batch;
+	struct inode *dir = sai->sai_dentry->d_inode;
+	int count;
+	int rc;
+	int i;
+	ENTRY;
+
+	if (binfo == NULL)
+		RETURN_EXIT;
+
+	sai->sai_batch = NULL;
+	count = binfo->mb_count;
+	/* replies may come before md_batch_getattr_async() returns */
+	sai->sai_sent += count;
+	rc = md_batch_getattr_async(ll_i2mdexp(dir), binfo);
+	if (rc == 0) {
+		atomic_inc(&ll_i2sbi(dir)->ll_sa_batch_total);
+		RETURN_EXIT;
+	}
+
+	sai->sai_sent -= count;
+	CDEBUG(D_READA, "batch of %d entries failed: rc = %d\n", count, rc);
+	if (rc == -ENOTSUPP)
+		sai->sai_batch_max = 0;
+
+	for (i = 0; i < count; i++) {
+		struct sa_entry *entry = binfo->mb_items[i].mbi_cbdata;
+
+		rc = sa_lookup(dir, entry);
+		if (rc != 0)
+			sa_make_ready(sai, entry, rc);
+		else
+			sai->sai_sent++;
+	}
+
+	iput(binfo->mb_dir);
+	OBD_FREE(binfo, offsetof(struct md_batch_info, mb_items[binfo->mb_max]));
+	EXIT;
+}
+
+/* add entry to the pending batch, send it once full */
+static int sa_batch_add(struct ll_statahead_info *sai, struct sa_entry *entry)
+{
+	struct md_batch_info *binfo = sai->sai_batch;
+	struct inode *dir = sai->sai_dentry->d_inode;
+	struct md_batch_item *mbi;
+	ENTRY;
+
+	if (binfo == NULL) {
+		struct ldlm_enqueue_info *einfo;
+		struct md_op_data *op_data;
+
+		OBD_ALLOC(binfo, offsetof(struct md_batch_info,
+					  mb_items[sai->sai_batch_max]));
+		if (binfo == NULL)
+			RETURN(-ENOMEM);
+
+		op_data = ll_prep_md_op_data(&binfo->mb_data, dir, NULL, NULL,
+					     0, 0, LUSTRE_OPC_ANY, NULL);
+		if (IS_ERR(op_data)) {
+			OBD_FREE(binfo, offsetof(struct md_batch_info,
+					mb_items[sai->sai_batch_max]));
+			RETURN(PTR_ERR(op_data));
+		}
+
+		binfo->mb_dir = igrab(dir);
+		binfo->mb_cb = ll_statahead_batch_interpret;
+		binfo->mb_cbdata = sai;
+		binfo->mb_max = sai->sai_batch_max;
+
+		einfo = &binfo->mb_einfo;
+		einfo->ei_type   = LDLM_IBITS;
+		einfo->ei_mode   = LCK_PR;
+		einfo->ei_cb_bl  = ll_md_blocking_ast;
+		einfo->ei_cb_cp  = ldlm_completion_ast;
+		einfo->ei_cb_gl  = NULL;
+		einfo->ei_cbdata = NULL;
+
+		sai->sai_batch = binfo;
+	}
+
+	mbi = &binfo->mb_items[binfo->mb_count++];
+	mbi->mbi_fid = entry->se_fid;
+	mbi->mbi_name = entry->se_qstr.name;
+	mbi->mbi_namelen = entry->se_qstr.len;
+	mbi->mbi_cbdata = entry;
+
+	if (binfo->mb_count == binfo->mb_max)
+		sa_batch_flush(sai);
+
+	RETURN(0);
+}
+
 /* finish async stat RPC arguments */
 static void sa_fini_data(struct md_enqueue_info *minfo)
 {
@@ -840,6 +1050,12 @@ static void sa_statahead(struct dentry *parent, const char *name, int len,
 
 	dentry = d_lookup(parent, &entry->se_qstr);
 	if (!dentry) {
+		/* accounted in sai_sent once the batch is sent */
+		if (sai->sai_batch_max > 0 && fid_is_sane(fid) &&
+		    sa_batch_add(sai, entry) == 0) {
+			sai->sai_index++;
+			RETURN_EXIT;
+		}
 		rc = sa_lookup(dir, entry);
 	} else {
 		rc = sa_revalidate(dir, entry, dentry);
@@ -1077,6 +1293,9 @@ static int ll_statahead_thread(void *arg)
 
 			/* wait for spare statahead window */
 			do {
+				if (sa_sent_full(sai))
+					sa_batch_flush(sai);
+
 				l_wait_event(sa_thread->t_ctl_waitq,
 					     !sa_sent_full(sai) ||
 					     sa_has_callback(sai) ||
@@ -1106,6 +1325,8 @@ static int ll_statahead_thread(void *arg)
 
 			sa_statahead(parent, name, namelen, &fid);
 		}
+		/* don't keep entries pending while reading next page */
+		sa_batch_flush(sai);
 
 		pos = le64_to_cpu(dp->ldp_hash_end);
 		ll_release_page(dir, page,
@@ -1309,7 +1309,10 @@ static int vvp_io_read_ahead(const struct lu_env *env,
 	    ios->cis_io->ci_type == CIT_FAULT) {
 		struct vvp_io *vio = cl2vvp_io(env, ios);
 
-		if (unlikely(vio->vui_fd->fd_flags & LL_FILE_GROUP_LOCKED)) {
+		/* no file for the asynchronous read-ahead threads, which
+		 * are never used under a group lock */
+		if (unlikely(vio->vui_fd != NULL &&
+			     vio->vui_fd->fd_flags & LL_FILE_GROUP_LOCKED)) {
 			ra->cra_end = CL_PAGE_EOF;
 			result = +1; /* no need to call down */
 		}
@@ -3002,6 +3002,32 @@ int lmv_intent_getattr_async(struct obd_export *exp,
 	RETURN(rc);
 }
 
+int lmv_batch_getattr_async(struct obd_export *exp,
+			    struct md_batch_info *binfo)
+{
+	struct md_op_data	*op_data = &binfo->mb_data;
+	struct obd_device	*obd = exp->exp_obd;
+	struct lmv_obd		*lmv = &obd->u.lmv;
+	struct lmv_tgt_desc	*tgt;
+	int			 rc;
+	ENTRY;
+
+	/*
+	 * names of a striped directory hash to different stripes, leave those
+	 * to per-entry statahead. Entries living on another MDT than their
+	 * parent are refused by the MDT one by one.
+	 */
+	if (op_data->op_mea1 != NULL)
+		RETURN(-ENOTSUPP);
+
+	tgt = lmv_find_target(lmv, &op_data->op_fid1);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_batch_getattr_async(tgt->ltd_exp, binfo);
+	RETURN(rc);
+}
+
 int lmv_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
                         struct lu_fid *fid, __u64 *bits)
 {
@@ -3175,6 +3201,7 @@ struct md_ops lmv_md_ops = {
         .m_set_open_replay_data = lmv_set_open_replay_data,
         .m_clear_open_replay_data = lmv_clear_open_replay_data,
         .m_intent_getattr_async = lmv_intent_getattr_async,
+	.m_batch_getattr_async	= lmv_batch_getattr_async,
 	.m_revalidate_lock      = lmv_revalidate_lock,
 	.m_get_fid_from_lsm	= lmv_get_fid_from_lsm,
 	.m_unpackmd		= lmv_unpackmd,
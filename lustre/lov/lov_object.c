@@ -1497,6 +1497,69 @@ static loff_t lov_object_maxbytes(struct cl_object *obj)
 	return maxbytes;
 }
 
+/**
+ * Copy an extent of \a src into \a obj on the OST.
+ *
+ * Only files with a single stripe, both on the same OST, can be copied
+ * there since an extent of a striped file is spread over several objects.
+ * Other layouts return -EOPNOTSUPP so that the caller copies through the
+ * client instead.
+ */
+static int lov_object_copy(const struct lu_env *env, struct cl_object *obj,
+			   struct cl_object *src, loff_t src_off,
+			   loff_t dst_off, size_t *len)
+{
+	struct lov_object	*dst_lov = cl2lov(obj);
+	struct lov_object	*src_lov;
+	struct lov_stripe_md	*dst_lsm;
+	struct lov_stripe_md	*src_lsm = NULL;
+	struct cl_object	*dst_sub = NULL;
+	struct cl_object	*src_sub = NULL;
+	struct lu_object	*lo;
+	int			 rc;
+	ENTRY;
+
+	lo = lu_object_locate(src->co_lu.lo_header, obj->co_lu.lo_dev->ld_type);
+	if (lo == NULL)
+		RETURN(-EOPNOTSUPP);
+	src_lov = lu2lov(lo);
+
+	dst_lsm = lov_lsm_addref(dst_lov);
+	if (dst_lsm == NULL)
+		RETURN(-EOPNOTSUPP);
+
+	src_lsm = lov_lsm_addref(src_lov);
+	if (src_lsm == NULL)
+		GOTO(out_lsm, rc = -EOPNOTSUPP);
+
+	if (dst_lov->lo_type != LLT_RAID0 || src_lov->lo_type != LLT_RAID0 ||
+	    dst_lsm->lsm_stripe_count != 1 || src_lsm->lsm_stripe_count != 1 ||
+	    lov_oinfo_is_dummy(dst_lsm->lsm_oinfo[0]) ||
+	    lov_oinfo_is_dummy(src_lsm->lsm_oinfo[0]) ||
+	    dst_lsm->lsm_oinfo[0]->loi_ost_idx !=
+	    src_lsm->lsm_oinfo[0]->loi_ost_idx)
+		GOTO(out_lsm, rc = -EOPNOTSUPP);
+
+	dst_sub = lov_find_subobj(env, dst_lov, dst_lsm, 0);
+	if (IS_ERR(dst_sub))
+		GOTO(out_lsm, rc = PTR_ERR(dst_sub));
+
+	src_sub = lov_find_subobj(env, src_lov, src_lsm, 0);
+	if (IS_ERR(src_sub))
+		GOTO(out_sub, rc = PTR_ERR(src_sub));
+
+	rc = cl_object_copy(env, dst_sub, src_sub, src_off, dst_off, len);
+	cl_object_put(env, src_sub);
+	EXIT;
+out_sub:
+	cl_object_put(env, dst_sub);
+out_lsm:
+	lov_lsm_put(src_lsm);
+	lov_lsm_put(dst_lsm);
+
+	return rc;
+}
+
 static const struct cl_object_operations lov_ops = {
 	.coo_page_init    = lov_page_init,
 	.coo_lock_init    = lov_lock_init,
@@ -1508,6 +1571,7 @@ static const struct cl_object_operations lov_ops = {
 	.coo_layout_get   = lov_object_layout_get,
 	.coo_maxbytes     = lov_object_maxbytes,
 	.coo_fiemap       = lov_object_fiemap,
+	.coo_copy         = lov_object_copy,
 };
 
 static const struct lu_object_operations lov_lu_obj_ops = {
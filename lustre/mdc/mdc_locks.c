@@ -51,6 +51,11 @@ struct mdc_getattr_args {
 	struct md_enqueue_info		*ga_minfo;
 };
 
+struct mdc_batch_getattr_args {
+	struct obd_export		*ba_exp;
+	struct md_batch_info		*ba_binfo;
+};
+
 int it_open_error(int phase, struct lookup_intent *it)
 {
 	if (it_disposition(it, DISP_OPEN_LEASE)) {
@@ -1240,3 +1245,155 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 
 	RETURN(0);
 }
+
+static int mdc_batch_getattr_interpret(const struct lu_env *env,
+				       struct ptlrpc_request *req,
+				       void *args, int rc)
+{
+	struct mdc_batch_getattr_args	*ba = args;
+	struct obd_export		*exp = ba->ba_exp;
+	struct md_batch_info		*binfo = ba->ba_binfo;
+	struct mdt_batch_getattr_reply	*rep = NULL;
+	int				 i;
+	ENTRY;
+
+	obd_put_request_slot(&class_exp2obd(exp)->u.cli);
+	if (OBD_FAIL_CHECK(OBD_FAIL_MDC_GETATTR_ENQUEUE))
+		rc = -ETIMEDOUT;
+
+	if (rc == 0) {
+		rep = req_capsule_server_sized_get(&req->rq_pill,
+					&RMF_BATCH_GETATTR_REPLY,
+					binfo->mb_count * sizeof(*rep));
+		if (rep == NULL)
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < binfo->mb_count; i++) {
+		struct md_batch_item *mbi = &binfo->mb_items[i];
+		union ldlm_policy_data policy = { { 0 } };
+		int rc2 = rc;
+
+		if (rc2 == 0)
+			rc2 = ptlrpc_status_ntoh(rep[i].mgr_status);
+		if (rc2 == 0)
+			policy.l_inodebits.bits = rep[i].mgr_bits;
+
+		rc2 = ldlm_cli_lock_fini(exp, &mbi->mbi_lockh,
+					 binfo->mb_einfo.ei_mode,
+					 rc2 == 0 ? &rep[i].mgr_lockh : NULL,
+					 &policy, rc2 == 0 ? rep[i].mgr_flags : 0,
+					 rc2);
+		if (rc2 == 0)
+			mbi->mbi_body = &rep[i].mgr_body;
+		else
+			mbi->mbi_lockh.cookie = 0;
+		mbi->mbi_rc = rc2;
+	}
+
+	binfo->mb_cb(req, binfo, rc);
+	RETURN(0);
+}
+
+/**
+ * Stat several entries of one directory in a single MDS_BATCH_GETATTR RPC.
+ *
+ * A PR LOOKUP|UPDATE|PERM lock is prepared for each entry; the MDT grants it
+ * along with the entry attributes, or returns a per-entry error which is
+ * passed in md_batch_item::mbi_rc to \a binfo->mb_cb, called from ptlrpcd
+ * context once the reply arrives.
+ */
+int mdc_batch_getattr_async(struct obd_export *exp,
+			    struct md_batch_info *binfo)
+{
+	struct md_op_data		*op_data = &binfo->mb_data;
+	struct obd_device		*obddev = class_exp2obd(exp);
+	struct mdc_batch_getattr_args	*ba;
+	struct ptlrpc_request		*req;
+	struct mdt_batch_getattr_item	*item;
+	union ldlm_policy_data policy = {
+				.l_inodebits = { MDS_INODELOCK_LOOKUP |
+						 MDS_INODELOCK_UPDATE |
+						 MDS_INODELOCK_PERM } };
+	int				 size = 0;
+	int				 i;
+	int				 rc;
+	ENTRY;
+
+	if (!exp_connect_batch_getattr(exp))
+		RETURN(-ENOTSUPP);
+
+	LASSERT(binfo->mb_count > 0 &&
+		binfo->mb_count <= MDT_BATCH_GETATTR_MAX);
+
+	CDEBUG(D_DLMTRACE, "%d entries in inode "DFID"\n",
+	       binfo->mb_count, PFID(&op_data->op_fid1));
+
+	for (i = 0; i < binfo->mb_count; i++)
+		size += mdt_batch_getattr_item_size(
+					binfo->mb_items[i].mbi_namelen);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_MDS_BATCH_GETATTR);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_GETATTR, RCL_CLIENT,
+			     size);
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_BATCH_GETATTR);
+	if (rc != 0) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	mdc_pack_body(req, &op_data->op_fid1, 0, 0, op_data->op_suppgids[0],
+		      0);
+
+	item = req_capsule_client_get(&req->rq_pill, &RMF_BATCH_GETATTR);
+	for (i = 0; i < binfo->mb_count; i++) {
+		struct md_batch_item *mbi = &binfo->mb_items[i];
+		struct ldlm_res_id res_id;
+
+		fid_build_reg_res_name(&mbi->mbi_fid, &res_id);
+		rc = ldlm_cli_lock_prep(exp, &binfo->mb_einfo, &res_id,
+					&policy, &mbi->mbi_lockh);
+		if (rc != 0)
+			GOTO(out_locks, rc);
+
+		item->mgi_lockh = mbi->mbi_lockh;
+		item->mgi_fid = mbi->mbi_fid;
+		item->mgi_namelen = mbi->mbi_namelen;
+		memcpy(item->mgi_name, mbi->mbi_name, mbi->mbi_namelen);
+		item->mgi_name[mbi->mbi_namelen] = '\0';
+		item = (void *)item +
+		       mdt_batch_getattr_item_size(mbi->mbi_namelen);
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_GETATTR_REPLY,
+			     RCL_SERVER, binfo->mb_count *
+				sizeof(struct mdt_batch_getattr_reply));
+	ptlrpc_request_set_replen(req);
+
+	rc = obd_get_request_slot(&obddev->u.cli);
+	if (rc != 0)
+		GOTO(out_locks, rc);
+
+	CLASSERT(sizeof(*ba) <= sizeof(req->rq_async_args));
+	ba = ptlrpc_req_async_args(req);
+	ba->ba_exp = exp;
+	ba->ba_binfo = binfo;
+
+	req->rq_interpret_reply = mdc_batch_getattr_interpret;
+	ptlrpcd_add_req(req);
+
+	RETURN(0);
+
+out_locks:
+	while (--i >= 0) {
+		ldlm_cli_lock_fini(exp, &binfo->mb_items[i].mbi_lockh,
+				   binfo->mb_einfo.ei_mode, NULL, NULL, 0, rc);
+		binfo->mb_items[i].mbi_lockh.cookie = 0;
+	}
+	ptlrpc_req_finished(req);
+	return rc;
+}
@@ -2768,6 +2768,7 @@ static struct md_ops mdc_md_ops = {
         .m_set_open_replay_data = mdc_set_open_replay_data,
         .m_clear_open_replay_data = mdc_clear_open_replay_data,
         .m_intent_getattr_async = mdc_intent_getattr_async,
+	.m_batch_getattr_async	= mdc_batch_getattr_async,
         .m_revalidate_lock      = mdc_revalidate_lock
 };
 
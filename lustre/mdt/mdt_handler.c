@@ -1682,6 +1682,262 @@ out_shrink:
 	return rc;
 }
 
+/*
+ * Hand a local lock taken by mdt_object_lock() over to the client, which
+ * knows it by \a remote, see also mdt_intent_lock_replace(). A lock which
+ * got a blocking AST while it was held is not handed over, -EAGAIN is
+ * returned and the caller cancels it with mdt_object_unlock().
+ */
+static int mdt_batch_lock_export(struct mdt_thread_info *info,
+				 struct mdt_lock_handle *lh,
+				 const struct lustre_handle *remote,
+				 struct mdt_batch_getattr_reply *rep)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct ldlm_lock	*lock;
+
+	lock = ldlm_handle2lock(&lh->mlh_reg_lh);
+	LASSERT(lock != NULL);
+
+	lock_res_and_lock(lock);
+	LASSERT(lock->l_export == NULL);
+	if (ldlm_is_cbpending(lock) || ldlm_is_ast_sent(lock)) {
+		unlock_res_and_lock(lock);
+		LDLM_LOCK_PUT(lock);
+		return -EAGAIN;
+	}
+
+	/* from now on a conflicting lock sends the blocking AST to the
+	 * client, the reader reference is dropped below */
+	lock->l_export = class_export_lock_get(req->rq_export, lock);
+	lock->l_blocking_ast = ldlm_server_blocking_ast;
+	lock->l_completion_ast = ldlm_server_completion_ast;
+	lock->l_remote_handle = *remote;
+	lock->l_flags &= ~LDLM_FL_LOCAL;
+	rep->mgr_bits = lock->l_policy_data.l_inodebits.bits;
+	rep->mgr_flags = 0;
+	unlock_res_and_lock(lock);
+
+	cfs_hash_add(lock->l_export->exp_lock_hash, &lock->l_remote_handle,
+		     &lock->l_exp_hash);
+	ldlm_lock2handle(lock, &rep->mgr_lockh);
+
+	LDLM_DEBUG(lock, "Returning batched lock to client");
+	LDLM_LOCK_PUT(lock);
+	ldlm_lock_decref(&lh->mlh_reg_lh, lh->mlh_reg_mode);
+	lh->mlh_reg_lh.cookie = 0;
+
+	return 0;
+}
+
+/* 1 if \a o has xattr \a name, 0 if not, negative errno on failure */
+static int mdt_batch_xattr_exists(struct mdt_thread_info *info,
+				  struct mdt_object *o, const char *name)
+{
+	int rc;
+
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), &LU_BUF_NULL,
+			  name);
+	if (rc == -ENODATA || rc == -EOPNOTSUPP)
+		return 0;
+
+	return rc < 0 ? rc : !!rc;
+}
+
+/*
+ * Stat one entry of a MDS_BATCH_GETATTR request. Anything that does not fit
+ * in a bare mdt_body (striped directories, ACLs, remote objects) or cannot
+ * be locked at once is refused with -EAGAIN and the client falls back to a
+ * regular intent getattr for it.
+ */
+static int mdt_batch_getattr_one(struct mdt_thread_info *info,
+				 struct mdt_batch_getattr_item *item,
+				 struct mdt_batch_getattr_reply *rep)
+{
+	struct ptlrpc_request	*req = mdt_info_req(info);
+	struct mdt_object	*parent = info->mti_object;
+	struct mdt_lock_handle	*lhp = &info->mti_lh[MDT_LH_PARENT];
+	struct mdt_lock_handle	*lhc = &info->mti_lh[MDT_LH_CHILD];
+	struct lu_fid		*child_fid = &info->mti_tmp_fid1;
+	struct lu_name		*lname = &info->mti_name;
+	struct md_attr		*ma = &info->mti_attr;
+	struct ldlm_lock	*lock = NULL;
+	struct mdt_object	*child;
+	int			 rc;
+	ENTRY;
+
+	lname->ln_name = item->mgi_name;
+	lname->ln_namelen = item->mgi_namelen;
+	if (!lu_name_is_valid(lname) || !fid_is_sane(&item->mgi_fid))
+		RETURN(-EPROTO);
+
+	mdt_lock_pdo_init(lhp, LCK_PR, lname);
+	rc = mdt_object_lock(info, parent, lhp, MDS_INODELOCK_UPDATE);
+	if (rc != 0)
+		RETURN(rc);
+
+	fid_zero(child_fid);
+	rc = mdo_lookup(info->mti_env, mdt_object_child(parent), lname,
+			child_fid, &info->mti_spec);
+	if (rc != 0)
+		GOTO(out_parent, rc);
+
+	/* renamed over since the client read the dirent */
+	if (!lu_fid_eq(child_fid, &item->mgi_fid))
+		GOTO(out_parent, rc = -EAGAIN);
+
+	child = mdt_object_find(info->mti_env, info->mti_mdt, child_fid);
+	if (IS_ERR(child))
+		GOTO(out_parent, rc = PTR_ERR(child));
+
+	if (!mdt_object_exists(child))
+		GOTO(out_child, rc = -ENOENT);
+
+	if (mdt_object_remote(child))
+		GOTO(out_child, rc = -EAGAIN);
+
+	if (S_ISDIR(lu_object_attr(&child->mot_obj))) {
+		rc = mdt_batch_xattr_exists(info, child, XATTR_NAME_LMV);
+		if (rc != 0)
+			GOTO(out_child, rc = rc < 0 ? rc : -EAGAIN);
+	}
+
+	/* a lock granted to the original request, reply with it again */
+	if (lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT)
+		lock = cfs_hash_lookup(req->rq_export->exp_lock_hash,
+				       &item->mgi_lockh);
+
+	if (lock == NULL) {
+		mdt_lock_handle_init(lhc);
+		mdt_lock_reg_init(lhc, LCK_PR);
+		if (!mdt_object_lock_try(info, child, lhc,
+					 MDS_INODELOCK_LOOKUP |
+					 MDS_INODELOCK_UPDATE |
+					 MDS_INODELOCK_PERM))
+			GOTO(out_child, rc = -EAGAIN);
+	}
+
+	ma->ma_valid = 0;
+	ma->ma_need = MA_INODE;
+	rc = mdt_attr_get_complex(info, child, ma);
+	if (rc != 0)
+		GOTO(out_unlock, rc);
+
+	memset(&rep->mgr_body, 0, sizeof(rep->mgr_body));
+	mdt_pack_attr2body(info, &rep->mgr_body, &ma->ma_attr,
+			   mdt_object_fid(child));
+
+#ifdef CONFIG_FS_POSIX_ACL
+	if (exp_connect_flags(info->mti_exp) & OBD_CONNECT_ACL) {
+		rc = mdt_batch_xattr_exists(info, child,
+					    XATTR_NAME_ACL_ACCESS);
+		if (rc != 0)
+			GOTO(out_unlock, rc = rc < 0 ? rc : -EAGAIN);
+
+		rep->mgr_body.mbo_aclsize = 0;
+		rep->mgr_body.mbo_valid |= OBD_MD_FLACL;
+	}
+#endif
+
+	if (lock != NULL) {
+		ldlm_lock2handle(lock, &rep->mgr_lockh);
+		rep->mgr_bits = lock->l_policy_data.l_inodebits.bits;
+		rep->mgr_flags = 0;
+	} else {
+		rc = mdt_batch_lock_export(info, lhc, &item->mgi_lockh, rep);
+		if (rc != 0)
+			GOTO(out_unlock, rc);
+	}
+	mdt_counter_incr(req, LPROC_MDT_GETATTR);
+	EXIT;
+out_unlock:
+	if (lock != NULL)
+		LDLM_LOCK_PUT(lock);
+	else if (rc != 0)
+		mdt_object_unlock(info, child, lhc, 1);
+out_child:
+	mdt_object_put(info->mti_env, child);
+out_parent:
+	mdt_object_unlock(info, parent, lhp, 1);
+	return rc;
+}
+
+/**
+ * MDS_BATCH_GETATTR handler, used by client statahead: look up each name
+ * of the request under the parent directory, grant the client the PR
+ * LOOKUP|UPDATE|PERM lock it prepared for the entry and return the entry
+ * attributes, saving one intent getattr RPC per entry.
+ */
+static int mdt_batch_getattr(struct tgt_session_info *tsi)
+{
+	struct mdt_thread_info		*info = tsi2mdt_info(tsi);
+	struct req_capsule		*pill = info->mti_pill;
+	struct mdt_object		*parent = info->mti_object;
+	struct mdt_batch_getattr_item	*item;
+	struct mdt_batch_getattr_reply	*rep;
+	struct mdt_body			*reqbody;
+	void				*buf;
+	int				 len;
+	int				 count = 0;
+	int				 i;
+	int				 rc;
+	ENTRY;
+
+	reqbody = req_capsule_client_get(pill, &RMF_MDT_BODY);
+	LASSERT(reqbody != NULL);
+	LASSERT(parent != NULL);
+
+	buf = req_capsule_client_get(pill, &RMF_BATCH_GETATTR);
+	len = req_capsule_get_size(pill, &RMF_BATCH_GETATTR, RCL_CLIENT);
+	if (buf == NULL)
+		GOTO(out, rc = err_serious(-EPROTO));
+
+	/* count and swab entries, making sure they fill the buffer exactly */
+	for (item = buf; (void *)item + sizeof(*item) <= buf + len;
+	     item = (void *)item +
+		    mdt_batch_getattr_item_size(item->mgi_namelen)) {
+		if (ptlrpc_req_need_swab(mdt_info_req(info)))
+			lustre_swab_mdt_batch_getattr_item(item);
+		if ((void *)item + mdt_batch_getattr_item_size(
+				item->mgi_namelen) > buf + len ||
+		    ++count > MDT_BATCH_GETATTR_MAX)
+			GOTO(out, rc = err_serious(-EPROTO));
+	}
+	if (count == 0 || (void *)item != buf + len)
+		GOTO(out, rc = err_serious(-EPROTO));
+
+	req_capsule_set_size(pill, &RMF_BATCH_GETATTR_REPLY, RCL_SERVER,
+			     count * sizeof(*rep));
+	rc = req_capsule_server_pack(pill);
+	if (unlikely(rc != 0))
+		GOTO(out, rc = err_serious(rc));
+
+	rep = req_capsule_server_get(pill, &RMF_BATCH_GETATTR_REPLY);
+	LASSERT(rep != NULL);
+
+	rc = mdt_init_ucred_intent_getattr(info, reqbody);
+	if (unlikely(rc != 0))
+		GOTO(out, rc);
+
+	if (!mdt_object_exists(parent) || mdt_object_remote(parent) ||
+	    !S_ISDIR(lu_object_attr(&parent->mot_obj)))
+		GOTO(out_ucred, rc = -ENOTDIR);
+
+	for (i = 0, item = buf; i < count; i++,
+	     item = (void *)item +
+		    mdt_batch_getattr_item_size(item->mgi_namelen)) {
+		rc = mdt_batch_getattr_one(info, item, &rep[i]);
+		rep[i].mgr_status = ptlrpc_status_hton(rc);
+	}
+	rc = 0;
+	EXIT;
+out_ucred:
+	mdt_exit_ucred(info);
+out:
+	mdt_thread_info_fini(info);
+	return rc;
+}
+
 static int mdt_iocontrol(unsigned int cmd, struct obd_export *exp, int len,
 			 void *karg, void __user *uarg);
 
@@ -4435,6 +4691,8 @@ TGT_MDT_HDL(HABEO_CORPUS| HABEO_REFERO, MDS_HSM_REQUEST,
 TGT_MDT_HDL(HABEO_CLAVIS | HABEO_CORPUS | HABEO_REFERO | MUTABOR,
 	    MDS_SWAP_LAYOUTS,
 	    mdt_swap_layouts),
+TGT_MDT_HDL(HABEO_CORPUS,		MDS_BATCH_GETATTR,
+							mdt_batch_getattr),
 };
 
 static struct tgt_handler mdt_sec_ctx_ops[] = {
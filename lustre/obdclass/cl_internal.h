@@ -37,6 +37,7 @@
 #define _CL_INTERNAL_H
 
 #define CLT_PVEC_SIZE (14)
+#define CL_PAGE_ARENA_MAX (16)
 
 /**
  * Possible levels of the nesting. Currently this is 2: there are "top"
@@ -49,6 +50,19 @@ enum clt_nesting_level {
         CNL_NR
 };
 
+/**
+ * Page descriptors allocated in a batch for the ongoing IO of a thread and
+ * not handed out yet, see cl_page_alloc(). All of them are zeroed buffers of
+ * cpa_bufsize bytes from cpa_kmem. Whatever is left is returned to the slab
+ * when the top IO finishes.
+ */
+struct cl_page_arena {
+	struct kmem_cache	*cpa_kmem;
+	unsigned short		 cpa_bufsize;
+	unsigned short		 cpa_nr;
+	void			*cpa_pages[CL_PAGE_ARENA_MAX];
+};
+
 /**
  * Thread local state internal for generic cl-code.
  */
@@ -70,6 +84,7 @@ struct cl_thread_info {
          * Fields used by cl_page.c
          */
         struct cl_page      *clt_pvec[CLT_PVEC_SIZE];
+	struct cl_page_arena clt_arena;
 
         /*
          * Fields used by cl_io.c
@@ -92,6 +107,9 @@ struct cl_thread_info {
 struct cl_thread_info *cl_env_info(const struct lu_env *env);
 void cl_page_disown0(const struct lu_env *env,
 		     struct cl_io *io, struct cl_page *pg);
+void cl_page_arena_drain(struct cl_page_arena *arena);
+void cl_page_arena_stats_print(struct seq_file *m);
+void cl_page_kmem_fini(void);
 
 
 #endif /* _CL_INTERNAL_H */
@@ -120,8 +120,10 @@ void cl_io_fini(const struct lu_env *env, struct cl_io *io)
         }
         io->ci_state = CIS_FINI;
         info = cl_env_info(env);
-        if (info->clt_current_io == io)
-                info->clt_current_io = NULL;
+	if (info->clt_current_io == io) {
+		info->clt_current_io = NULL;
+		cl_page_arena_drain(&info->clt_arena);
+	}
 
 	/* sanity check for layout change */
 	switch(io->ci_type) {
@@ -390,6 +390,37 @@ int cl_object_fiemap(const struct lu_env *env, struct cl_object *obj,
 }
 EXPORT_SYMBOL(cl_object_fiemap);
 
+/**
+ * Copy an extent of a file object into another one on the servers.
+ *
+ * \param env [in]	lustre environment
+ * \param obj [in]	destination file object
+ * \param src [in]	source file object
+ * \param src_off [in]	offset of the extent in \a src
+ * \param dst_off [in]	offset of the copy in \a obj
+ * \param len [in,out]	bytes to copy, set to the bytes copied
+ *
+ * \retval 0		success, less than \a len is copied at the end of \a src
+ * \retval -EOPNOTSUPP	the layouts do not allow a copy on the servers
+ * \retval < 0		other error
+ */
+int cl_object_copy(const struct lu_env *env, struct cl_object *obj,
+		   struct cl_object *src, loff_t src_off, loff_t dst_off,
+		   size_t *len)
+{
+	struct lu_object_header	*top = obj->co_lu.lo_header;
+	ENTRY;
+
+	list_for_each_entry(obj, &top->loh_layers, co_lu.lo_linkage) {
+		if (obj->co_ops->coo_copy != NULL)
+			RETURN(obj->co_ops->coo_copy(env, obj, src, src_off,
+						     dst_off, len));
+	}
+
+	RETURN(-EOPNOTSUPP);
+}
+EXPORT_SYMBOL(cl_object_copy);
+
 int cl_object_layout_get(const struct lu_env *env, struct cl_object *obj,
 			 struct cl_layout *cl)
 {
@@ -537,6 +568,7 @@ locks: ...... ...... ...... ...... ...... [...... ...... ...... ...... ......]
 	seq_printf(m, "]\n");
 	cache_stats_print(&cl_env_stats, m, 0);
 	seq_printf(m, "\n");
+	cl_page_arena_stats_print(m);
 	return 0;
 }
 EXPORT_SYMBOL(cl_site_stats_print);
@@ -1034,6 +1066,9 @@ static void *cl_key_init(const struct lu_context *ctx,
 static void cl_key_fini(const struct lu_context *ctx,
                         struct lu_context_key *key, void *data)
 {
+	struct cl_thread_info *info = data;
+
+	cl_page_arena_drain(&info->clt_arena);
 	cl0_key_fini(ctx, key, data);
 }
 
@@ -1100,6 +1135,7 @@ void cl_global_fini(void)
 {
 	cl_env_percpu_fini();
 	lu_context_key_degister(&cl_key);
+	cl_page_kmem_fini();
 	lu_kmem_fini(cl_object_caches);
 	OBD_FREE(cl_envs, sizeof(*cl_envs) * num_possible_cpus());
 }
@@ -126,10 +126,241 @@ cl_page_at_trusted(const struct cl_page *page,
 	RETURN(NULL);
 }
 
+/*
+ * Page descriptors (cl_page with the slices of all layers) come from a kmem
+ * cache per distinct coh_page_bufsize. There are only a few of them, one per
+ * layout type of the top object.
+ */
+#define CL_PAGE_KMEM_MAX	16
+
+static struct kmem_cache *cl_page_kmem_array[CL_PAGE_KMEM_MAX];
+static unsigned short cl_page_kmem_size_array[CL_PAGE_KMEM_MAX];
+static char cl_page_kmem_name[CL_PAGE_KMEM_MAX][24];
+static DEFINE_MUTEX(cl_page_kmem_mutex);
+
+enum cl_page_arena_stat {
+	CPA_SLAB,	/* descriptors allocated one by one */
+	CPA_BATCH,	/* arena refills */
+	CPA_BATCHED,	/* descriptors allocated by the refills */
+	CPA_HIT,	/* descriptors taken from the arena */
+	CPA_RECYCLE,	/* freed descriptors put back into the arena */
+	CPA_DRAIN,	/* unused descriptors freed at IO end */
+	CPA_NR
+};
+
+static atomic_long_t cl_page_arena_stats[CPA_NR];
+
+#define CPA_INC(item, n) atomic_long_add((n), &cl_page_arena_stats[CPA_##item])
+
+static struct kmem_cache *cl_page_kmem_get(unsigned short bufsize)
+{
+	struct kmem_cache *kmem = NULL;
+	int i;
+
+	for (i = 0; i < CL_PAGE_KMEM_MAX; i++) {
+		unsigned short size = ACCESS_ONCE(cl_page_kmem_size_array[i]);
+
+		if (size == bufsize) {
+			smp_rmb();
+			return cl_page_kmem_array[i];
+		}
+		if (size == 0)
+			break;
+	}
+	if (i == CL_PAGE_KMEM_MAX)
+		return NULL;
+
+	mutex_lock(&cl_page_kmem_mutex);
+	for (; i < CL_PAGE_KMEM_MAX; i++) {
+		if (cl_page_kmem_size_array[i] == bufsize) {
+			kmem = cl_page_kmem_array[i];
+			break;
+		}
+		if (cl_page_kmem_size_array[i] != 0)
+			continue;
+
+		snprintf(cl_page_kmem_name[i], sizeof(cl_page_kmem_name[i]),
+			 "cl_page_kmem-%u", bufsize);
+		kmem = kmem_cache_create(cl_page_kmem_name[i], bufsize, 0, 0,
+					 NULL);
+		if (kmem != NULL) {
+			cl_page_kmem_array[i] = kmem;
+			smp_wmb();
+			cl_page_kmem_size_array[i] = bufsize;
+		}
+		break;
+	}
+	mutex_unlock(&cl_page_kmem_mutex);
+
+	return kmem;
+}
+
+void cl_page_kmem_fini(void)
+{
+	int i;
+
+	for (i = 0; i < CL_PAGE_KMEM_MAX; i++) {
+		if (cl_page_kmem_array[i] == NULL)
+			break;
+		kmem_cache_destroy(cl_page_kmem_array[i]);
+		cl_page_kmem_array[i] = NULL;
+		cl_page_kmem_size_array[i] = 0;
+	}
+}
+
+static int cl_page_arena_refill(struct cl_page_arena *arena,
+				struct kmem_cache *kmem,
+				unsigned short bufsize, unsigned int batch)
+{
+	int i;
+
+	LASSERT(arena->cpa_nr == 0);
+	arena->cpa_kmem = kmem;
+	arena->cpa_bufsize = bufsize;
+#ifdef HAVE_KMEM_CACHE_ALLOC_BULK
+	if (kmem_cache_alloc_bulk(kmem, GFP_NOFS | __GFP_ZERO, batch,
+				  arena->cpa_pages) != 0) {
+		for (i = 0; i < batch; i++) {
+			OBD_ALLOC_POST(arena->cpa_pages[i], bufsize,
+				       "slab-alloced");
+		}
+		arena->cpa_nr = batch;
+	}
+#else
+	for (i = 0; i < batch; i++) {
+		OBD_SLAB_ALLOC_GFP(arena->cpa_pages[i], kmem, bufsize,
+				   GFP_NOFS);
+		if (arena->cpa_pages[i] == NULL)
+			break;
+		arena->cpa_nr++;
+	}
+#endif
+	CPA_INC(BATCH, 1);
+	CPA_INC(BATCHED, arena->cpa_nr);
+
+	return arena->cpa_nr;
+}
+
+/**
+ * Return the descriptors left in \a arena to the slab. Called when the top
+ * IO of the thread is finished, or when it needs descriptors of another size.
+ */
+void cl_page_arena_drain(struct cl_page_arena *arena)
+{
+	if (arena->cpa_nr == 0)
+		return;
+
+	CPA_INC(DRAIN, arena->cpa_nr);
+	while (arena->cpa_nr > 0) {
+		void *buf = arena->cpa_pages[--arena->cpa_nr];
+
+		OBD_SLAB_FREE(buf, arena->cpa_kmem, arena->cpa_bufsize);
+	}
+}
+
+/**
+ * Returns the arena of the IO \a env is running, if descriptors should be
+ * batched at all.
+ */
+static struct cl_page_arena *cl_page_arena_get(const struct lu_env *env)
+{
+	struct cl_thread_info *info;
+
+	if (cl_page_arena_batch <= 1)
+		return NULL;
+
+	info = cl_env_info(env);
+	if (info == NULL || info->clt_current_io == NULL)
+		return NULL;
+
+	return &info->clt_arena;
+}
+
+/**
+ * Allocates a zeroed page descriptor of \a bufsize bytes.
+ *
+ * Within an IO, descriptors are allocated from the slab in batches of
+ * cl_page_arena_batch into the per-thread arena, so that a large read or
+ * write pays the slab cost once per batch rather than once per page.
+ */
+static struct cl_page *cl_page_buf_alloc(const struct lu_env *env,
+					 unsigned short bufsize)
+{
+	struct cl_page_arena *arena;
+	struct kmem_cache *kmem;
+	struct cl_page *page = NULL;
+	unsigned int batch;
+
+	kmem = cl_page_kmem_get(bufsize);
+	if (unlikely(kmem == NULL)) {
+		OBD_ALLOC_GFP(page, bufsize, GFP_NOFS);
+		return page;
+	}
+
+	arena = cl_page_arena_get(env);
+	if (arena == NULL) {
+		CPA_INC(SLAB, 1);
+		OBD_SLAB_ALLOC_GFP(page, kmem, bufsize, GFP_NOFS);
+		return page;
+	}
+
+	if (arena->cpa_nr > 0 && arena->cpa_bufsize != bufsize)
+		cl_page_arena_drain(arena);
+
+	batch = min_t(unsigned int, cl_page_arena_batch, CL_PAGE_ARENA_MAX);
+	if (arena->cpa_nr == 0 &&
+	    cl_page_arena_refill(arena, kmem, bufsize, batch) == 0)
+		return NULL;
+
+	CPA_INC(HIT, 1);
+	return arena->cpa_pages[--arena->cpa_nr];
+}
+
+static void cl_page_buf_free(const struct lu_env *env, struct cl_page *page,
+			     unsigned short bufsize)
+{
+	struct cl_page_arena *arena;
+	struct kmem_cache *kmem;
+
+	kmem = cl_page_kmem_get(bufsize);
+	if (unlikely(kmem == NULL)) {
+		OBD_FREE(page, bufsize);
+		return;
+	}
+
+	/* keep the descriptor for the next page of the same IO */
+	arena = cl_page_arena_get(env);
+	if (arena != NULL &&
+	    arena->cpa_nr < min_t(unsigned int, cl_page_arena_batch,
+				  CL_PAGE_ARENA_MAX) &&
+	    (arena->cpa_nr == 0 || arena->cpa_bufsize == bufsize)) {
+		memset(page, 0, bufsize);
+		arena->cpa_kmem = kmem;
+		arena->cpa_bufsize = bufsize;
+		arena->cpa_pages[arena->cpa_nr++] = page;
+		CPA_INC(RECYCLE, 1);
+		return;
+	}
+
+	OBD_SLAB_FREE(page, kmem, bufsize);
+}
+
+void cl_page_arena_stats_print(struct seq_file *m)
+{
+	seq_printf(m, "arena: slab %ld batch %ld batched %ld hit %ld "
+		   "recycle %ld drain %ld\n",
+		   atomic_long_read(&cl_page_arena_stats[CPA_SLAB]),
+		   atomic_long_read(&cl_page_arena_stats[CPA_BATCH]),
+		   atomic_long_read(&cl_page_arena_stats[CPA_BATCHED]),
+		   atomic_long_read(&cl_page_arena_stats[CPA_HIT]),
+		   atomic_long_read(&cl_page_arena_stats[CPA_RECYCLE]),
+		   atomic_long_read(&cl_page_arena_stats[CPA_DRAIN]));
+}
+
 static void cl_page_free(const struct lu_env *env, struct cl_page *page)
 {
 	struct cl_object *obj  = page->cp_obj;
-	int pagesize = cl_object_header(obj)->coh_page_bufsize;
+	unsigned short bufsize = cl_object_header(obj)->coh_page_bufsize;
 
 	PASSERT(env, page, list_empty(&page->cp_batch));
 	PASSERT(env, page, page->cp_owner == NULL);
@@ -150,7 +381,7 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *page)
 	lu_object_ref_del_at(&obj->co_lu, &page->cp_obj_ref, "cl_page", page);
 	cl_object_put(env, obj);
 	lu_ref_fini(&page->cp_reference);
-	OBD_FREE(page, pagesize);
+	cl_page_buf_free(env, page, bufsize);
 	EXIT;
 }
 
@@ -173,8 +404,7 @@ struct cl_page *cl_page_alloc(const struct lu_env *env,
 	struct lu_object_header *head;
 
 	ENTRY;
-	OBD_ALLOC_GFP(page, cl_object_header(o)->coh_page_bufsize,
-			GFP_NOFS);
+	page = cl_page_buf_alloc(env, cl_object_header(o)->coh_page_bufsize);
 	if (page != NULL) {
 		int result = 0;
 		atomic_set(&page->cp_ref, 1);
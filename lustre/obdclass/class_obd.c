@@ -46,6 +46,7 @@
 #include <lprocfs_status.h>
 #include <lustre_ver.h>
 #include <cl_object.h>
+#include <obd_cksum.h>
 #ifdef HAVE_SERVER_SUPPORT
 # include <dt_object.h>
 # include <md_object.h>
@@ -98,6 +99,12 @@ int at_early_margin = 5;
 EXPORT_SYMBOL(at_early_margin);
 int at_extra = 30;
 EXPORT_SYMBOL(at_extra);
+/* bulks of at least this size are checksummed by several threads, 0 = off */
+unsigned int obd_cksum_parallel_min_kb = 4096;
+EXPORT_SYMBOL(obd_cksum_parallel_min_kb);
+/* cl_page descriptors allocated at once by an IO, 0 or 1 = one by one */
+unsigned int cl_page_arena_batch = 16;
+EXPORT_SYMBOL(cl_page_arena_batch);
 
 atomic_long_t obd_dirty_transit_pages;
 EXPORT_SYMBOL(obd_dirty_transit_pages);
@@ -578,6 +585,10 @@ static int __init obdclass_init(void)
 	if (err)
 		return err;
 
+	err = obd_cksum_init();
+	if (err)
+		return err;
+
 	err = lustre_register_fs();
 
 	return err;
@@ -619,6 +630,7 @@ static void __exit obdclass_exit(void)
 	lustre_unregister_fs();
 
 	misc_deregister(&obd_psdev);
+	obd_cksum_fini();
 	llog_info_fini();
 #ifdef HAVE_SERVER_SUPPORT
 	lu_ucred_global_fini();
@@ -135,6 +135,8 @@ LUSTRE_STATIC_UINT_ATTR(at_max, &at_max);
 LUSTRE_STATIC_UINT_ATTR(at_extra, &at_extra);
 LUSTRE_STATIC_UINT_ATTR(at_early_margin, &at_early_margin);
 LUSTRE_STATIC_UINT_ATTR(at_history, &at_history);
+LUSTRE_STATIC_UINT_ATTR(checksum_parallel_min_kb, &obd_cksum_parallel_min_kb);
+LUSTRE_STATIC_UINT_ATTR(page_arena_batch, &cl_page_arena_batch);
 
 #ifdef HAVE_SERVER_SUPPORT
 LUSTRE_STATIC_UINT_ATTR(ldlm_timeout, &ldlm_timeout);
@@ -166,6 +168,8 @@ static struct attribute *lustre_attrs[] = {
 	&lustre_sattr_at_extra.u.attr,
 	&lustre_sattr_at_early_margin.u.attr,
 	&lustre_sattr_at_history.u.attr,
+	&lustre_sattr_checksum_parallel_min_kb.u.attr,
+	&lustre_sattr_page_arena_batch.u.attr,
 	&lustre_attr_memused_max.attr,
 	&lustre_attr_memused.attr,
 #ifdef HAVE_SERVER_SUPPORT
@@ -823,6 +823,18 @@ static const char *obd_connect_names[] = {
 	NULL
 };
 
+/* names of the ocd_connect_flags2 flags of the top byte */
+static const struct {
+	__u64		 ocl_flag;
+	const char	*ocl_name;
+} obd_connect_names2_top[] = {
+	{ OBD_CONNECT2_BATCH_GETATTR,	"batch_getattr" },
+	{ OBD_CONNECT2_COMPRESS,	"compress" },
+	{ OBD_CONNECT2_SERVER_COPY,	"server_copy" },
+	{ OBD_CONNECT2_BATCH_BL_AST,	"batch_bl_ast" },
+	{ 0,				NULL }
+};
+
 static void obd_connect_seq_flags2str(struct seq_file *m, __u64 flags,
 				      __u64 flags2, const char *sep)
 {
@@ -854,10 +866,20 @@ static void obd_connect_seq_flags2str(struct seq_file *m, __u64 flags,
 			first = false;
 		}
 	}
+	flags2 &= ~(mask - 1);
 
-	if (flags2 & ~(mask - 1)) {
+	for (i = 0; obd_connect_names2_top[i].ocl_name != NULL; i++) {
+		if (flags2 & obd_connect_names2_top[i].ocl_flag) {
+			seq_printf(m, "%s%s", first ? "" : sep,
+				   obd_connect_names2_top[i].ocl_name);
+			first = false;
+		}
+		flags2 &= ~obd_connect_names2_top[i].ocl_flag;
+	}
+
+	if (flags2) {
 		seq_printf(m, "%sunknown2_%#llx",
-			   first ? "" : sep, flags2 & ~(mask - 1));
+			   first ? "" : sep, flags2);
 		first = false;
 	}
 }
@@ -887,11 +909,20 @@ int obd_connect_flags2str(char *page, int count, __u64 flags, __u64 flags2,
 			ret += snprintf(page + ret, count - ret, "%s%s",
 					ret ? sep : "", obd_connect_names[i]);
 	}
+	flags2 &= ~(mask - 1);
+
+	for (i = 0; obd_connect_names2_top[i].ocl_name != NULL; i++) {
+		if (flags2 & obd_connect_names2_top[i].ocl_flag)
+			ret += snprintf(page + ret, count - ret, "%s%s",
+					ret ? sep : "",
+					obd_connect_names2_top[i].ocl_name);
+		flags2 &= ~obd_connect_names2_top[i].ocl_flag;
+	}
 
-	if (flags2 & ~(mask - 1))
+	if (flags2)
 		ret += snprintf(page + ret, count - ret,
 				"%sunknown2_%#llx",
-				ret ? sep : "", flags2 & ~(mask - 1));
+				ret ? sep : "", flags2);
 
 	return ret;
 }
@@ -1617,6 +1648,7 @@ void lprocfs_init_mps_stats(int num_private_stats, struct lprocfs_stats *stats)
         LPROCFS_MD_OP_INIT(num_private_stats, stats, lock_match);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, cancel_unused);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, intent_getattr_async);
+	LPROCFS_MD_OP_INIT(num_private_stats, stats, batch_getattr_async);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, revalidate_lock);
 }
 
@@ -149,13 +149,18 @@ void lu_object_put(const struct lu_env *env, struct lu_object *o)
 
 	if (!lu_object_is_dying(top) &&
 	    (lu_object_exists(orig) || lu_object_is_cl(orig))) {
-		LASSERT(list_empty(&top->loh_lru));
-		list_add_tail(&top->loh_lru, &bkt->lsb_lru);
-		bkt->lsb_lru_len++;
+		/* a lookup leaves the object on the LRU, see htable_lookup(),
+		 * so just move it to the hot end in that case */
+		if (list_empty(&top->loh_lru))
+			list_add_tail(&top->loh_lru, &bkt->lsb_lru);
+		else
+			list_move_tail(&top->loh_lru, &bkt->lsb_lru);
+		atomic_long_inc(&bkt->lsb_lru_len);
 		percpu_counter_inc(&site->ls_lru_len_counter);
 		CDEBUG(D_INODE, "Add %p to site lru. hash: %p, bkt: %p, "
 		       "lru_len: %ld\n",
-		       o, site->ls_obj_hash, bkt, bkt->lsb_lru_len);
+		       o, site->ls_obj_hash, bkt,
+		       atomic_long_read(&bkt->lsb_lru_len));
                 cfs_hash_bd_unlock(site->ls_obj_hash, &bd, 1);
                 return;
         }
@@ -171,6 +176,9 @@ void lu_object_put(const struct lu_env *env, struct lu_object *o)
          * and LRU lock, no race with concurrent object lookup is possible
          * and we can safely destroy object below.
          */
+	/* not counted in lsb_lru_len since it was found, see htable_lookup() */
+	if (!list_empty(&top->loh_lru))
+		list_del_init(&top->loh_lru);
 	if (!test_and_set_bit(LU_OBJECT_UNHASHED, &top->loh_flags))
 		cfs_hash_bd_del_locked(site->ls_obj_hash, &bd, &top->loh_hash);
         cfs_hash_bd_unlock(site->ls_obj_hash, &bd, 1);
@@ -209,14 +217,10 @@ void lu_object_unhash(const struct lu_env *env, struct lu_object *o)
 		struct cfs_hash_bd bd;
 
 		cfs_hash_bd_get_and_lock(obj_hash, &top->loh_fid, &bd, 1);
-		if (!list_empty(&top->loh_lru)) {
-			struct lu_site_bkt_data *bkt;
-
+		/* the caller holds a reference, so the object is not counted
+		 * in lsb_lru_len even if it is still on the LRU */
+		if (!list_empty(&top->loh_lru))
 			list_del_init(&top->loh_lru);
-			bkt = cfs_hash_bd_extra_get(obj_hash, &bd);
-			bkt->lsb_lru_len--;
-			percpu_counter_dec(&site->ls_lru_len_counter);
-		}
 		cfs_hash_bd_del_locked(obj_hash, &bd, &top->loh_hash);
 		cfs_hash_bd_unlock(obj_hash, &bd, 1);
 	}
@@ -392,7 +396,13 @@ int lu_site_purge_objects(const struct lu_env *env, struct lu_site *s,
                 bkt = cfs_hash_bd_extra_get(s->ls_obj_hash, &bd);
 
 		list_for_each_entry_safe(h, temp, &bkt->lsb_lru, loh_lru) {
-			LASSERT(atomic_read(&h->loh_ref) == 0);
+			/* referenced again since it was put, only remove it
+			 * from the LRU, it is no longer counted in
+			 * lsb_lru_len, see htable_lookup() */
+			if (atomic_read(&h->loh_ref) > 0) {
+				list_del_init(&h->loh_lru);
+				continue;
+			}
 
                         cfs_hash_bd_get(s->ls_obj_hash, &h->loh_fid, &bd2);
                         LASSERT(bd.bd_bucket == bd2.bd_bucket);
@@ -400,7 +410,7 @@ int lu_site_purge_objects(const struct lu_env *env, struct lu_site *s,
                         cfs_hash_bd_del_locked(s->ls_obj_hash,
                                                &bd2, &h->loh_hash);
 			list_move(&h->loh_lru, &dispose);
-			bkt->lsb_lru_len--;
+			atomic_long_dec(&bkt->lsb_lru_len);
 			percpu_counter_dec(&s->ls_lru_len_counter);
                         if (did_sth == 0)
                                 did_sth = 1;
@@ -613,13 +623,24 @@ static struct lu_object *htable_lookup(struct lu_site *s,
 
         h = container_of0(hnode, struct lu_object_header, loh_hash);
         if (likely(!lu_object_is_dying(h))) {
-		cfs_hash_get(s->ls_obj_hash, hnode);
-                lprocfs_counter_incr(s->ls_stats, LU_SS_CACHE_HIT);
-		if (!list_empty(&h->loh_lru)) {
-			list_del_init(&h->loh_lru);
-			bkt->lsb_lru_len--;
+		/*
+		 * Only the reference is taken here, the object is left on the
+		 * LRU. This allows cache hits to run under the shared bucket
+		 * lock: referenced objects are taken off the LRU lazily by
+		 * lu_site_purge_objects(), and lu_object_put() moves the
+		 * object to the hot end of the LRU when it is released.
+		 *
+		 * The LRU length only counts idle objects, so the first
+		 * reference uncounts it. The last reference is only dropped
+		 * under the exclusive bucket lock, so this cannot race with
+		 * lu_object_put() counting it again.
+		 */
+		if (atomic_inc_return(&h->loh_ref) == 1 &&
+		    !list_empty(&h->loh_lru)) {
+			atomic_long_dec(&bkt->lsb_lru_len);
 			percpu_counter_dec(&s->ls_lru_len_counter);
 		}
+                lprocfs_counter_incr(s->ls_stats, LU_SS_CACHE_HIT);
                 return lu_object_top(h);
         }
 
@@ -740,9 +761,10 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
 
         s  = dev->ld_site;
         hs = s->ls_obj_hash;
-        cfs_hash_bd_get_and_lock(hs, (void *)f, &bd, 1);
-        o = htable_lookup(s, &bd, f, waiter, &version);
-        cfs_hash_bd_unlock(hs, &bd, 1);
+	/* cache hits do not modify the bucket, so a shared lock is enough */
+	cfs_hash_bd_get_and_lock(hs, (void *)f, &bd, 0);
+	o = htable_lookup(s, &bd, f, waiter, &version);
+	cfs_hash_bd_unlock(hs, &bd, 0);
 	if (!IS_ERR(o) || PTR_ERR(o) != -ENOENT)
                 return o;
 
@@ -1087,7 +1109,7 @@ int lu_site_init(struct lu_site *s, struct lu_device *top)
 						 bits - LU_SITE_BKT_BITS,
 						 sizeof(*bkt), 0, 0,
 						 &lu_site_hash_ops,
-						 CFS_HASH_SPIN_BKTLOCK |
+						 CFS_HASH_RW_BKTLOCK |
 						 CFS_HASH_NO_ITEMREF |
 						 CFS_HASH_DEPTH |
 						 CFS_HASH_ASSERT_EMPTY |
@@ -1104,6 +1126,7 @@ int lu_site_init(struct lu_site *s, struct lu_device *top)
 	cfs_hash_for_each_bucket(s->ls_obj_hash, &bd, i) {
 		bkt = cfs_hash_bd_extra_get(s->ls_obj_hash, &bd);
 		INIT_LIST_HEAD(&bkt->lsb_lru);
+		atomic_long_set(&bkt->lsb_lru_len, 0);
 		init_waitqueue_head(&bkt->lsb_marche_funebre);
 	}
 
@@ -1950,8 +1973,8 @@ static void lu_site_stats_get(struct cfs_hash *hs,
 		struct hlist_head	*hhead;
 
                 cfs_hash_bd_lock(hs, &bd, 1);
-		stats->lss_busy  +=
-			cfs_hash_bd_count_get(&bd) - bkt->lsb_lru_len;
+		stats->lss_busy  += cfs_hash_bd_count_get(&bd) -
+				    atomic_long_read(&bkt->lsb_lru_len);
                 stats->lss_total += cfs_hash_bd_count_get(&bd);
                 stats->lss_max_search = max((int)stats->lss_max_search,
                                             cfs_hash_bd_depmax_get(&bd));
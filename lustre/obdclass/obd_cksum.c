@@ -0,0 +1,412 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/obdclass/obd_cksum.c
+ *
+ * Checksums of bulk pages.
+ *
+ * The OBD_CKSUM_T10* checksum types compute one 16-bit guard tag per sector,
+ * as a DIF-capable device would, and the RPC checksum is the hash of all the
+ * guard tags. Guards are stored big-endian as in the T10 PI tuple, so arrays
+ * of them can be compared and hashed on nodes of any endianness.
+ *
+ * A large bulk is split into pieces which are hashed by the threads of the
+ * local CPU partition, and the digests of the pieces are then combined into
+ * the one the serial computation would give, so that peers don't need to
+ * know about it.
+ */
+
+#define DEBUG_SUBSYSTEM S_CLASS
+
+#include <linux/crc-t10dif.h>
+#include <net/checksum.h>
+#include <obd_cksum.h>
+#include <obd_support.h>
+
+static __be16 obd_dif_crc_fn(void *data, unsigned int len)
+{
+	return cpu_to_be16(crc_t10dif(data, len));
+}
+
+static __be16 obd_dif_ip_fn(void *data, unsigned int len)
+{
+	/* the IP checksum is already in network byte order */
+	return (__force __be16)ip_compute_csum(data, len);
+}
+
+/**
+ * Compute the guard tags of \a len bytes at \a offset of \a page, one per
+ * sector of \a cksum_type. See cksum_t10_guards() for the sector layout.
+ *
+ * \retval number of guards stored in \a guards
+ * \retval -E2BIG if \a nr_guards is too small
+ */
+int obd_page_dif_generate(cksum_type_t cksum_type, struct page *page,
+			  unsigned int offset, unsigned int len,
+			  __be16 *guards, unsigned int nr_guards)
+{
+	__be16 (*fn)(void *, unsigned int);
+	unsigned int sector = cksum_t10_sector_size(cksum_type);
+	unsigned int i;
+	char *addr;
+
+	LASSERT(sector != 0);
+	LASSERT(offset + len <= PAGE_SIZE);
+	if (cksum_t10_guards(cksum_type, offset, len) > nr_guards)
+		return -E2BIG;
+
+	if (cksum_type == OBD_CKSUM_T10CRC512 ||
+	    cksum_type == OBD_CKSUM_T10CRC4K)
+		fn = obd_dif_crc_fn;
+	else
+		fn = obd_dif_ip_fn;
+
+	addr = kmap(page);
+	for (i = 0; len > 0; i++) {
+		unsigned int count = min(len, sector - (offset & (sector - 1)));
+
+		guards[i] = fn(addr + offset, count);
+		offset += count;
+		len -= count;
+	}
+	kunmap(page);
+
+	return i;
+}
+EXPORT_SYMBOL(obd_page_dif_generate);
+
+/**
+ * Add the guard tags of a page fragment to the RPC checksum \a hdesc, and
+ * save them in \a guards if it is not NULL.
+ *
+ * \retval number of guards of the fragment, they are not saved if
+ *	   \a nr_guards is too small
+ */
+int obd_page_dif_hash(struct cfs_crypto_hash_desc *hdesc,
+		      cksum_type_t cksum_type, struct page *page,
+		      unsigned int offset, unsigned int len,
+		      __be16 *guards, unsigned int nr_guards)
+{
+	/* sectors are aligned in the page, this is enough for any fragment */
+	__be16 buf[PAGE_SIZE / 512];
+	int n;
+
+	n = obd_page_dif_generate(cksum_type, page, offset, len, buf,
+				  ARRAY_SIZE(buf));
+	LASSERT(n > 0);
+
+	cfs_crypto_hash_update(hdesc, buf, n * sizeof(buf[0]));
+	if (guards != NULL && n <= nr_guards)
+		memcpy(guards, buf, n * sizeof(buf[0]));
+
+	return n;
+}
+EXPORT_SYMBOL(obd_page_dif_hash);
+
+/* smallest piece of a bulk hashed by one thread */
+#define OBD_CKSUM_CHUNK_MIN	(1 << 20)
+/* most pieces a bulk is split into */
+#define OBD_CKSUM_JOBS_MAX	16
+
+struct obd_cksum_req {
+	cksum_type_t		 ocr_type;
+	obd_cksum_frag_get_t	 ocr_get;
+	void			*ocr_data;
+	/* jobs not completed by the scheduler threads */
+	atomic_t		 ocr_pending;
+	struct completion	 ocr_done;
+};
+
+struct obd_cksum_job {
+	struct cfs_workitem	 ocj_wi;
+	struct cfs_wi_sched	*ocj_sched;
+	struct obd_cksum_req	*ocj_req;
+	/* fragments [ocj_first, ocj_last) of the bulk */
+	int			 ocj_first;
+	int			 ocj_last;
+	__be16			*ocj_guards;
+	unsigned int		 ocj_nr_guards;
+	/* bytes hashed, to combine the digests */
+	unsigned int		 ocj_nob;
+	__u32			 ocj_cksum;
+	int			 ocj_rc;
+};
+
+/* per-CPT schedulers of the checksum threads */
+static struct cfs_wi_sched **obd_cksum_scheds;
+
+static void obd_cksum_job_run(struct obd_cksum_job *job)
+{
+	struct obd_cksum_req *req = job->ocj_req;
+	unsigned char cfs_alg = cksum_obd2cfs(req->ocr_type);
+	struct cfs_crypto_hash_desc *hdesc;
+	__be16 *guards = job->ocj_guards;
+	unsigned int nr_guards = job->ocj_nr_guards;
+	unsigned int bufsize = sizeof(job->ocj_cksum);
+	int i;
+
+	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
+	if (IS_ERR(hdesc)) {
+		CERROR("unable to initialize checksum hash %s\n",
+		       cfs_crypto_hash_name(cfs_alg));
+		job->ocj_rc = PTR_ERR(hdesc);
+		return;
+	}
+
+	for (i = job->ocj_first; i < job->ocj_last; i++) {
+		struct page *page;
+		unsigned int offset;
+		unsigned int len;
+
+		req->ocr_get(req->ocr_data, i, &page, &offset, &len);
+		if (cksum_type_is_t10(req->ocr_type)) {
+			int n;
+
+			n = obd_page_dif_hash(hdesc, req->ocr_type, page,
+					      offset, len, guards, nr_guards);
+			if (guards != NULL && n <= nr_guards) {
+				guards += n;
+				nr_guards -= n;
+			} else {
+				guards = NULL;
+			}
+			job->ocj_nob += n * sizeof(__be16);
+		} else {
+			cfs_crypto_hash_update_page(hdesc, page, offset, len);
+			job->ocj_nob += len;
+		}
+	}
+
+	job->ocj_rc = cfs_crypto_hash_final(hdesc,
+					    (unsigned char *)&job->ocj_cksum,
+					    &bufsize);
+}
+
+static int obd_cksum_job_action(struct cfs_workitem *wi)
+{
+	struct obd_cksum_job *job = container_of(wi, struct obd_cksum_job,
+						 ocj_wi);
+	struct obd_cksum_req *req = job->ocj_req;
+
+	obd_cksum_job_run(job);
+	cfs_wi_exit(job->ocj_sched, wi);
+	/* the job and the request may be freed once the last one is done */
+	if (atomic_dec_and_test(&req->ocr_pending))
+		complete(&req->ocr_done);
+
+	return 1;
+}
+
+/**
+ * Split the fragments of a bulk into at most \a nr_jobs pieces of about the
+ * same size, and assign each piece its slice of \a guards.
+ *
+ * \retval number of pieces
+ */
+static int obd_cksum_split(struct obd_cksum_req *req,
+			   struct obd_cksum_job *jobs, int nr_jobs,
+			   int nr_frags, unsigned long nob, __be16 *guards,
+			   unsigned int nr_guards)
+{
+	unsigned int used = 0;
+	unsigned long done = 0;
+	int i, j = 0;
+
+	jobs[0].ocj_first = 0;
+	for (i = 0; i < nr_frags; i++) {
+		struct page *page;
+		unsigned int offset;
+		unsigned int len;
+
+		/* start the next piece when this one has its share */
+		if (j < nr_jobs - 1 && done >= nob * (j + 1) / nr_jobs) {
+			jobs[j].ocj_last = i;
+			jobs[++j].ocj_first = i;
+			if (guards != NULL && used <= nr_guards) {
+				jobs[j].ocj_guards = guards + used;
+				jobs[j].ocj_nr_guards = nr_guards - used;
+			}
+		}
+
+		req->ocr_get(req->ocr_data, i, &page, &offset, &len);
+		done += len;
+		if (cksum_type_is_t10(req->ocr_type))
+			used += cksum_t10_guards(req->ocr_type, offset, len);
+	}
+	jobs[j].ocj_last = nr_frags;
+
+	return j + 1;
+}
+
+/**
+ * Compute the checksum of the \a nr_frags page fragments of a bulk, given
+ * one at a time by \a get. For T10 PI types the guard tags are saved in
+ * \a guards if it is not NULL.
+ *
+ * A bulk of at least obd_cksum_parallel_min_kb is hashed in parallel, with
+ * the same result.
+ */
+int obd_cksum_bulk(cksum_type_t cksum_type, obd_cksum_frag_get_t get,
+		   void *data, int nr_frags, __be16 *guards,
+		   unsigned int nr_guards, __u32 *cksum)
+{
+	struct obd_cksum_req req = {
+		.ocr_type	= cksum_type,
+		.ocr_get	= get,
+		.ocr_data	= data,
+	};
+	unsigned char cfs_alg = cksum_obd2cfs(cksum_type);
+	struct cfs_wi_sched *sched = NULL;
+	struct obd_cksum_job *jobs;
+	struct obd_cksum_job job0 = {
+		.ocj_req	= &req,
+		.ocj_first	= 0,
+		.ocj_last	= nr_frags,
+		.ocj_guards	= guards,
+		.ocj_nr_guards	= nr_guards,
+	};
+	unsigned int min_kb = obd_cksum_parallel_min_kb;
+	int nr_jobs = 1;
+	unsigned long nob = 0;
+	int size;
+	int rc = 0;
+	int i;
+
+	if (min_kb > 0 && obd_cksum_scheds != NULL) {
+		struct page *page;
+		unsigned int offset;
+		unsigned int len;
+		int cpt;
+
+		for (i = 0; i < nr_frags; i++) {
+			get(data, i, &page, &offset, &len);
+			nob += len;
+		}
+
+		if (nob >= (unsigned long)min_kb << 10) {
+			cpt = cfs_cpt_current(cfs_cpt_table, 1);
+			sched = obd_cksum_scheds[cpt];
+			nr_jobs = min_t(unsigned long, OBD_CKSUM_JOBS_MAX,
+					nob / OBD_CKSUM_CHUNK_MIN);
+			nr_jobs = min3(nr_jobs, nr_frags,
+				       cfs_cpt_weight(cfs_cpt_table, cpt));
+		}
+	}
+
+	if (nr_jobs <= 1 || sched == NULL) {
+		obd_cksum_job_run(&job0);
+		*cksum = job0.ocj_cksum;
+		return job0.ocj_rc;
+	}
+
+	size = nr_jobs * sizeof(*jobs);
+	OBD_ALLOC(jobs, size);
+	if (jobs == NULL) {
+		obd_cksum_job_run(&job0);
+		*cksum = job0.ocj_cksum;
+		return job0.ocj_rc;
+	}
+
+	jobs[0] = job0;
+	for (i = 1; i < nr_jobs; i++)
+		jobs[i].ocj_req = &req;
+	nr_jobs = obd_cksum_split(&req, jobs, nr_jobs, nr_frags, nob, guards,
+				  nr_guards);
+
+	atomic_set(&req.ocr_pending, nr_jobs - 1);
+	init_completion(&req.ocr_done);
+	for (i = 1; i < nr_jobs; i++) {
+		jobs[i].ocj_sched = sched;
+		cfs_wi_init(&jobs[i].ocj_wi, &jobs[i], obd_cksum_job_action);
+		cfs_wi_schedule(sched, &jobs[i].ocj_wi);
+	}
+	/* hash the first piece here while the threads do the others */
+	obd_cksum_job_run(&jobs[0]);
+	wait_for_completion(&req.ocr_done);
+
+	*cksum = jobs[0].ocj_cksum;
+	for (i = 0; i < nr_jobs && rc == 0; i++)
+		rc = jobs[i].ocj_rc;
+	for (i = 1; i < nr_jobs && rc == 0; i++)
+		rc = cfs_crypto_hash_combine(cfs_alg, (unsigned char *)cksum,
+					     (unsigned char *)&jobs[i].ocj_cksum,
+					     jobs[i].ocj_nob);
+	CDEBUG(D_INFO, "checksum of %lu bytes in %d pieces: %x rc = %d\n",
+	       nob, nr_jobs, *cksum, rc);
+
+	OBD_FREE(jobs, size);
+
+	return rc;
+}
+EXPORT_SYMBOL(obd_cksum_bulk);
+
+int obd_cksum_init(void)
+{
+	int nr_cpts = cfs_cpt_number(cfs_cpt_table);
+	int rc;
+	int i;
+
+	/* nothing to share the work with */
+	if (num_possible_cpus() == 1)
+		return 0;
+
+	OBD_ALLOC(obd_cksum_scheds, nr_cpts * sizeof(*obd_cksum_scheds));
+	if (obd_cksum_scheds == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < nr_cpts; i++) {
+		/* the calling thread hashes one piece itself */
+		int nthrs = min(cfs_cpt_weight(cfs_cpt_table, i),
+				OBD_CKSUM_JOBS_MAX) - 1;
+
+		if (nthrs <= 0)
+			continue;
+
+		rc = cfs_wi_sched_create("obd_ck", cfs_cpt_table, i, nthrs,
+					 &obd_cksum_scheds[i]);
+		if (rc != 0) {
+			CERROR("cannot start checksum threads: rc = %d\n", rc);
+			obd_cksum_fini();
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+void obd_cksum_fini(void)
+{
+	int nr_cpts = cfs_cpt_number(cfs_cpt_table);
+	int i;
+
+	if (obd_cksum_scheds == NULL)
+		return;
+
+	for (i = 0; i < nr_cpts; i++)
+		if (obd_cksum_scheds[i] != NULL)
+			cfs_wi_sched_destroy(obd_cksum_scheds[i]);
+
+	OBD_FREE(obd_cksum_scheds, nr_cpts * sizeof(*obd_cksum_scheds));
+	obd_cksum_scheds = NULL;
+}
@@ -82,10 +82,14 @@ static int ofd_tot_dirty_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
 	struct ofd_device *ofd;
+	u64 tot_dirty;
+	u64 tot_granted;
+	u64 tot_pending;
 
 	LASSERT(obd != NULL);
 	ofd = ofd_dev(obd->obd_lu_dev);
-	seq_printf(m, "%llu\n", ofd->ofd_tot_dirty);
+	ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
+	seq_printf(m, "%llu\n", tot_dirty);
 	return 0;
 }
 LPROC_SEQ_FOPS_RO(ofd_tot_dirty);
@@ -103,10 +107,14 @@ static int ofd_tot_granted_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
 	struct ofd_device *ofd;
+	u64 tot_dirty;
+	u64 tot_granted;
+	u64 tot_pending;
 
 	LASSERT(obd != NULL);
 	ofd = ofd_dev(obd->obd_lu_dev);
-	seq_printf(m, "%llu\n", ofd->ofd_tot_granted);
+	ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
+	seq_printf(m, "%llu\n", tot_granted);
 	return 0;
 }
 LPROC_SEQ_FOPS_RO(ofd_tot_granted);
@@ -124,10 +132,14 @@ static int ofd_tot_pending_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
 	struct ofd_device *ofd;
+	u64 tot_dirty;
+	u64 tot_granted;
+	u64 tot_pending;
 
 	LASSERT(obd != NULL);
 	ofd = ofd_dev(obd->obd_lu_dev);
-	seq_printf(m, "%llu\n", ofd->ofd_tot_pending);
+	ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
+	seq_printf(m, "%llu\n", tot_pending);
 	return 0;
 }
 LPROC_SEQ_FOPS_RO(ofd_tot_pending);
@@ -269,6 +269,9 @@ static struct cfg_interop_param ofd_interop_param[] = {
  * -writehthrough_cache_enable
  * -readcache_max_filesize
  * -read_cache_enable
+ * -readcache_small_filesize
+ * -cache_policy
+ * -prealloc_size
  * -brw_stats
  *
  * Since they are not included by the static lprocfs var list, a pre-check
@@ -295,6 +298,10 @@ static bool match_symlink_param(char *param)
 				    paramlen) == 0 ||
 			    strncmp(param, "read_cache_enable",
 				    paramlen) == 0 ||
+			    strncmp(param, "readcache_small_filesize",
+				    paramlen) == 0 ||
+			    strncmp(param, "cache_policy", paramlen) == 0 ||
+			    strncmp(param, "prealloc_size", paramlen) == 0 ||
 			    strncmp(param, "brw_stats", paramlen) == 0)
 				return true;
 		}
@@ -773,6 +780,19 @@ static void ofd_procfs_add_brw_stats_symlink(struct ofd_device *ofd)
 			    obd->obd_proc_entry,
 			    "../../%s/%s/writethrough_cache_enable",
 			    osd_obd->obd_type->typ_name, obd->obd_name);
+
+	lprocfs_add_symlink("readcache_small_filesize",
+			    obd->obd_proc_entry,
+			    "../../%s/%s/readcache_small_filesize",
+			    osd_obd->obd_type->typ_name, obd->obd_name);
+
+	lprocfs_add_symlink("cache_policy", obd->obd_proc_entry,
+			    "../../%s/%s/cache_policy",
+			    osd_obd->obd_type->typ_name, obd->obd_name);
+
+	lprocfs_add_symlink("prealloc_size", obd->obd_proc_entry,
+			    "../../%s/%s/prealloc_size",
+			    osd_obd->obd_type->typ_name, obd->obd_name);
 }
 
 /**
@@ -2264,9 +2284,16 @@ static int ofd_ladvise_hdl(struct tgt_session_info *tsi)
 			if (rc != 0)
 				break;
 
-			req->rq_status = ofd_ladvise_prefetch(env, fo,
-							      tbc->local,
-							      start, end);
+			/* the OSD merges the read ahead advised by all the
+			 * clients, read the pages here if it can not */
+			rc = dt_ladvise(env, dob, start, end,
+					LU_LADVISE_WILLREAD);
+			if (rc == -ENOTSUPP) {
+				rc = 0;
+				req->rq_status = ofd_ladvise_prefetch(env, fo,
+								tbc->local,
+								start, end);
+			}
 			tgt_extent_unlock(&lockh, LCK_PR);
 			break;
 		case LU_LADVISE_DONTNEED:
@@ -2283,6 +2310,235 @@ static int ofd_ladvise_hdl(struct tgt_session_info *tsi)
 	RETURN(rc);
 }
 
+/**
+ * Copy one chunk of an OST_COPY request.
+ *
+ * The source pages are read with obd_preprw() and copied into the pages
+ * prepared for the write of the destination object, so the data never
+ * leaves the OSS. Both offsets are page aligned.
+ *
+ * \param[in] env	execution environment
+ * \param[in] exp	OBD export of the client
+ * \param[in] src_oa	source object
+ * \param[in] dst_oa	destination object
+ * \param[in] src_off	source offset
+ * \param[in] dst_off	destination offset
+ * \param[in] len	bytes to copy, at most OFD_COPY_CHUNK
+ * \param[in] lnb	2 * (OFD_COPY_CHUNK >> PAGE_SHIFT) local buffers
+ *
+ * \retval		bytes copied, less than \a len at the source EOF
+ * \retval		negative value on error
+ */
+static ssize_t ofd_copy_chunk(const struct lu_env *env, struct obd_export *exp,
+			      struct obdo *src_oa, struct obdo *dst_oa,
+			      __u64 src_off, __u64 dst_off, __u64 len,
+			      struct niobuf_local *lnb)
+{
+	struct niobuf_local	*src_lnb = lnb;
+	struct niobuf_local	*dst_lnb = lnb + (OFD_COPY_CHUNK >> PAGE_SHIFT);
+	struct niobuf_remote	 src_rnb = { .rnb_offset = src_off,
+					     .rnb_len = len };
+	struct niobuf_remote	 dst_rnb = { .rnb_offset = dst_off };
+	struct obd_ioobj	 src_ioo;
+	struct obd_ioobj	 dst_ioo;
+	int			 src_pages = OFD_COPY_CHUNK >> PAGE_SHIFT;
+	int			 dst_pages = OFD_COPY_CHUNK >> PAGE_SHIFT;
+	__u64			 nob = 0;
+	int			 rc;
+	int			 i;
+
+	obdo_to_ioobj(src_oa, &src_ioo);
+	src_ioo.ioo_bufcnt = 1;
+	rc = obd_preprw(env, OBD_BRW_READ, exp, src_oa, 1, &src_ioo, &src_rnb,
+			&src_pages, src_lnb);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < src_pages; i++) {
+		if (src_lnb[i].lnb_rc < 0)
+			GOTO(out_read, rc = src_lnb[i].lnb_rc);
+		nob += src_lnb[i].lnb_rc;
+		if (src_lnb[i].lnb_rc < src_lnb[i].lnb_len)
+			break;
+	}
+	if (nob == 0)
+		GOTO(out_read, rc = 0);
+
+	dst_rnb.rnb_len = nob;
+	obdo_to_ioobj(dst_oa, &dst_ioo);
+	dst_ioo.ioo_bufcnt = 1;
+	rc = obd_preprw(env, OBD_BRW_WRITE, exp, dst_oa, 1, &dst_ioo, &dst_rnb,
+			&dst_pages, dst_lnb);
+	if (rc != 0)
+		GOTO(out_read, rc);
+
+	for (i = 0; i < dst_pages; i++) {
+		void *src = kmap(src_lnb[i].lnb_page);
+		void *dst = kmap(dst_lnb[i].lnb_page);
+
+		memcpy(dst + dst_lnb[i].lnb_page_offset,
+		       src + src_lnb[i].lnb_page_offset, dst_lnb[i].lnb_len);
+		kunmap(dst_lnb[i].lnb_page);
+		kunmap(src_lnb[i].lnb_page);
+		dst_lnb[i].lnb_rc = dst_lnb[i].lnb_len;
+	}
+
+	rc = obd_commitrw(env, OBD_BRW_WRITE, exp, dst_oa, 1, &dst_ioo,
+			  &dst_rnb, dst_pages, dst_lnb, 0);
+out_read:
+	rc = obd_commitrw(env, OBD_BRW_READ, exp, src_oa, 1, &src_ioo,
+			  &src_rnb, src_pages, src_lnb, rc);
+
+	return rc != 0 ? rc : nob;
+}
+
+/**
+ * OFD request handler for OST_COPY RPC.
+ *
+ * Copy an extent of the source object given in ost_copy into the object of
+ * ost_body, both on this OST, so that a client can duplicate file data
+ * without moving it over the network. The copy is done under server-side
+ * extent locks on both objects, taken in FID order, and stops at the end of
+ * the source object. Holes of the source are written as zeroes.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful, the bytes copied are in oc_length
+ * \retval		negative value on error
+ */
+static int ofd_copy_hdl(struct tgt_session_info *tsi)
+{
+	const struct lu_env	*env = tsi->tsi_env;
+	struct obd_export	*exp = tsi->tsi_exp;
+	struct ldlm_namespace	*ns = tsi->tsi_tgt->lut_obd->obd_namespace;
+	struct ost_body		*repbody;
+	struct ost_copy		*oc;
+	struct ost_copy		*repoc;
+	struct obdo		*src_oa;
+	struct niobuf_local	*lnb;
+	struct ldlm_res_id	 src_resid;
+	struct ldlm_resource	*res;
+	struct lustre_handle	 src_lh = { 0 };
+	struct lustre_handle	 dst_lh = { 0 };
+	__u64			 flags = 0;
+	__u64			 length;
+	__u64			 done = 0;
+	ssize_t			 nob;
+	int			 rc;
+
+	ENTRY;
+
+	oc = req_capsule_client_get(tsi->tsi_pill, &RMF_OST_COPY);
+	if (oc == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+	repoc = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_COPY);
+	if (repbody == NULL || repoc == NULL)
+		RETURN(err_serious(-ENOMEM));
+
+	repbody->oa = tsi->tsi_ost_body->oa;
+	*repoc = *oc;
+	repoc->oc_length = 0;
+
+	if (oc->oc_length == 0)
+		RETURN(0);
+
+	if ((oc->oc_src_offset & ~PAGE_MASK) != 0 ||
+	    (oc->oc_dst_offset & ~PAGE_MASK) != 0 ||
+	    oc->oc_src_offset + oc->oc_length < oc->oc_src_offset ||
+	    oc->oc_dst_offset + oc->oc_length < oc->oc_dst_offset)
+		RETURN(-EINVAL);
+	length = oc->oc_length;
+
+	OBD_ALLOC_PTR(src_oa);
+	if (src_oa == NULL)
+		RETURN(-ENOMEM);
+
+	src_oa->o_oi = oc->oc_src_oi;
+	src_oa->o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+	rc = tgt_validate_obdo(tsi, src_oa);
+	if (rc != 0)
+		GOTO(out_free, rc);
+
+	/* the copy of an object onto itself could deadlock on the pages */
+	if (lu_fid_eq(&src_oa->o_oi.oi_fid, &tsi->tsi_fid))
+		GOTO(out_free, rc = -EINVAL);
+
+	ost_fid_build_resid(&src_oa->o_oi.oi_fid, &src_resid);
+
+	OBD_ALLOC_LARGE(lnb, 2 * (OFD_COPY_CHUNK >> PAGE_SHIFT) *
+			     sizeof(*lnb));
+	if (lnb == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+
+	/* take both locks in FID order, so that two copies in opposite
+	 * directions between the same objects can not deadlock */
+	if (lu_fid_cmp(&src_oa->o_oi.oi_fid, &tsi->tsi_fid) < 0) {
+		rc = tgt_extent_lock(ns, &src_resid, oc->oc_src_offset,
+				     oc->oc_src_offset + length - 1, &src_lh,
+				     LCK_PR, &flags);
+		if (rc == 0)
+			rc = tgt_extent_lock(ns, &tsi->tsi_resid,
+					     oc->oc_dst_offset,
+					     oc->oc_dst_offset + length - 1,
+					     &dst_lh, LCK_PW, &flags);
+	} else {
+		rc = tgt_extent_lock(ns, &tsi->tsi_resid, oc->oc_dst_offset,
+				     oc->oc_dst_offset + length - 1, &dst_lh,
+				     LCK_PW, &flags);
+		if (rc == 0)
+			rc = tgt_extent_lock(ns, &src_resid, oc->oc_src_offset,
+					     oc->oc_src_offset + length - 1,
+					     &src_lh, LCK_PR, &flags);
+	}
+	if (rc != 0)
+		GOTO(out_unlock, rc);
+
+	CDEBUG(D_INODE, "%s: copy "DFID" [%llu, +%llu) to "DFID" at %llu\n",
+	       ofd_name(ofd_exp(exp)), PFID(&src_oa->o_oi.oi_fid),
+	       oc->oc_src_offset, length, PFID(&tsi->tsi_fid),
+	       oc->oc_dst_offset);
+
+	while (done < length) {
+		__u64 len = min_t(__u64, length - done, OFD_COPY_CHUNK);
+
+		nob = ofd_copy_chunk(env, exp, src_oa, &repbody->oa,
+				     oc->oc_src_offset + done,
+				     oc->oc_dst_offset + done, len, lnb);
+		if (nob < 0)
+			GOTO(out_unlock, rc = nob);
+
+		done += nob;
+		if (nob < len)
+			break;
+
+		/* Reuse env context. */
+		lu_context_exit((struct lu_context *)&env->le_ctx);
+		lu_context_enter((struct lu_context *)&env->le_ctx);
+	}
+	repoc->oc_length = done;
+	EXIT;
+out_unlock:
+	if (lustre_handle_is_used(&dst_lh))
+		tgt_extent_unlock(&dst_lh, LCK_PW);
+	if (lustre_handle_is_used(&src_lh))
+		tgt_extent_unlock(&src_lh, LCK_PR);
+	OBD_FREE_LARGE(lnb, 2 * (OFD_COPY_CHUNK >> PAGE_SHIFT) * sizeof(*lnb));
+	if (done > 0) {
+		/* let the clients see the new size of the destination */
+		res = ldlm_resource_get(ns, NULL, &tsi->tsi_resid,
+					LDLM_EXTENT, 0);
+		if (!IS_ERR(res)) {
+			ldlm_res_lvbo_update(res, NULL, 0);
+			ldlm_resource_putref(res);
+		}
+	}
+out_free:
+	OBD_FREE_PTR(src_oa);
+	return rc;
+}
+
 /**
  * OFD request handler for OST_QUOTACTL RPC.
  *
@@ -2790,6 +3046,8 @@ TGT_OST_HDL_HP(HABEO_CORPUS| HABEO_REFERO | MUTABOR,
 TGT_OST_HDL(HABEO_CORPUS| HABEO_REFERO,	OST_SYNC,	ofd_sync_hdl),
 TGT_OST_HDL(0		| HABEO_REFERO,	OST_QUOTACTL,	ofd_quotactl),
 TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO, OST_LADVISE,	ofd_ladvise_hdl),
+TGT_OST_HDL(HABEO_CORPUS | HABEO_REFERO | MUTABOR,
+					OST_COPY,	ofd_copy_hdl),
 };
 
 static struct tgt_opc_slice ofd_common_slice[] = {
@@ -2928,10 +3186,9 @@ static int ofd_init0(const struct lu_env *env, struct ofd_device *m,
 	m->ofd_osfs_inflight = 0;
 
 	/* grant data */
-	spin_lock_init(&m->ofd_grant_lock);
-	m->ofd_tot_dirty = 0;
-	m->ofd_tot_granted = 0;
-	m->ofd_tot_pending = 0;
+	rc = ofd_grant_init(m);
+	if (rc)
+		RETURN(rc);
 	m->ofd_seq_count = 0;
 	init_waitqueue_head(&m->ofd_inconsistency_thread.t_ctl_waitq);
 	INIT_LIST_HEAD(&m->ofd_inconsistency_list);
@@ -2948,7 +3205,7 @@ static int ofd_init0(const struct lu_env *env, struct ofd_device *m,
 	rc = ofd_procfs_init(m);
 	if (rc) {
 		CERROR("Can't init ofd lprocfs, rc %d\n", rc);
-		RETURN(rc);
+		GOTO(err_fini_grant, rc);
 	}
 
 	/* No connection accepted until configurations will finish */
@@ -3069,6 +3326,8 @@ err_fini_stack:
 	ofd_stack_fini(env, m, &m->ofd_osd->dd_lu_dev);
 err_fini_proc:
 	ofd_procfs_fini(m);
+err_fini_grant:
+	ofd_grant_fini(m);
 	return rc;
 }
 
@@ -3117,6 +3376,7 @@ static void ofd_fini(const struct lu_env *env, struct ofd_device *m)
 
 	ofd_stack_fini(env, m, &m->ofd_dt_dev.dd_lu_dev);
 	ofd_procfs_fini(m);
+	ofd_grant_fini(m);
 	LASSERT(atomic_read(&d->ld_ref) == 0);
 	server_put_mount(obd->obd_name, true);
 	EXIT;
@@ -77,6 +77,109 @@
 /* Clients typically hold 2x their max_rpcs_in_flight of grant space */
 #define OFD_GRANT_SHRINK_LIMIT(exp)	(2ULL * 8 * exp_max_brw_size(exp))
 
+/*
+ * Grant counters are split per CPT. Every export is accounted in the shard of
+ * the CPT it was created on (fed_grant_cpt), under the private lock of that CPT
+ * in ofd_grant_lock, so BRWs of clients hashed to different CPTs do not
+ * serialize. Each shard holds the sum of the counters of its exports.
+ *
+ * The global totals are the sum of all shards. A BRW computes the space left
+ * from a lockless sum, which may be off by what the other shards are doing at
+ * the same time. This is bounded by a few RPCs per CPT, so when the space
+ * left is below OFD_GRANT_EXACT_MARGIN(), or for rare operations which
+ * grant large amounts of space (connect, shrink, precreate), all the shards
+ * are locked and the totals are exact.
+ */
+#define OFD_GRANT_EXACT_MARGIN(ofd)				\
+	((u64)cfs_cpt_number(cfs_cpt_table) * 4 *		\
+	 ofd_grant_inflate(ofd, PTLRPC_MAX_BRW_SIZE))
+
+static inline int ofd_grant_cpt(struct obd_export *exp)
+{
+	return exp->exp_filter_data.fed_grant_cpt;
+}
+
+static inline struct ofd_grant_shard *ofd_grant_shard(struct obd_export *exp)
+{
+	return ofd_exp(exp)->ofd_grant_shards[ofd_grant_cpt(exp)];
+}
+
+/* Lock the grant counters of \a exp, or all of them if \a exact is set */
+static inline void ofd_grant_lock(struct obd_export *exp, bool exact)
+{
+	cfs_percpt_lock(ofd_exp(exp)->ofd_grant_lock,
+			exact ? CFS_PERCPT_LOCK_EX : ofd_grant_cpt(exp));
+}
+
+static inline void ofd_grant_unlock(struct obd_export *exp, bool exact)
+{
+	cfs_percpt_unlock(ofd_exp(exp)->ofd_grant_lock,
+			  exact ? CFS_PERCPT_LOCK_EX : ofd_grant_cpt(exp));
+}
+
+#define ofd_grant_assert_locked(exp)					\
+	assert_spin_locked(						\
+		ofd_exp(exp)->ofd_grant_lock->pcl_locks[ofd_grant_cpt(exp)])
+
+/**
+ * Sum the grant counters of all CPTs.
+ *
+ * The result is exact only if all shards are locked by the caller.
+ *
+ * \param[in] ofd	OFD device
+ * \param[out] dirty	total dirty data reported by clients
+ * \param[out] granted	total space granted to clients
+ * \param[out] pending	total space used by I/Os in progress
+ */
+void ofd_grant_totals(struct ofd_device *ofd, u64 *dirty, u64 *granted,
+		      u64 *pending)
+{
+	struct ofd_grant_shard	*ogs;
+	int			 i;
+
+	*dirty = *granted = *pending = 0;
+	cfs_percpt_for_each(ogs, i, ofd->ofd_grant_shards) {
+		*dirty += ACCESS_ONCE(ogs->ogs_tot_dirty);
+		*granted += ACCESS_ONCE(ogs->ogs_tot_granted);
+		*pending += ACCESS_ONCE(ogs->ogs_tot_pending);
+	}
+}
+
+/**
+ * Allocate the per-CPT grant counters of \a ofd.
+ *
+ * \retval 0		on success
+ * \retval -ENOMEM	on allocation failure
+ */
+int ofd_grant_init(struct ofd_device *ofd)
+{
+	ofd->ofd_grant_lock = cfs_percpt_lock_alloc(cfs_cpt_table);
+	if (ofd->ofd_grant_lock == NULL)
+		return -ENOMEM;
+
+	ofd->ofd_grant_shards = cfs_percpt_alloc(cfs_cpt_table,
+					sizeof(struct ofd_grant_shard));
+	if (ofd->ofd_grant_shards == NULL) {
+		cfs_percpt_lock_free(ofd->ofd_grant_lock);
+		ofd->ofd_grant_lock = NULL;
+		return -ENOMEM;
+	}
+	atomic_set(&ofd->ofd_tot_granted_clients, 0);
+	return 0;
+}
+
+void ofd_grant_fini(struct ofd_device *ofd)
+{
+	if (ofd->ofd_grant_shards != NULL) {
+		cfs_percpt_free(ofd->ofd_grant_shards);
+		ofd->ofd_grant_shards = NULL;
+	}
+	if (ofd->ofd_grant_lock != NULL) {
+		cfs_percpt_lock_free(ofd->ofd_grant_lock);
+		ofd->ofd_grant_lock = NULL;
+	}
+}
+
 /* Helpers to inflate/deflate grants for clients that do not support the grant
  * parameters */
 static inline u64 ofd_grant_inflate(struct ofd_device *ofd, u64 val)
@@ -167,7 +270,7 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 	maxsize = ofd->ofd_osfs.os_blocks << ofd->ofd_blockbits;
 
 	spin_lock(&obd->obd_dev_lock);
-	spin_lock(&ofd->ofd_grant_lock);
+	cfs_percpt_lock(ofd->ofd_grant_lock, CFS_PERCPT_LOCK_EX);
 	list_for_each_entry(exp, &obd->obd_exports, exp_obd_chain) {
 		struct filter_export_data	*fed;
 		int				 error = 0;
@@ -188,7 +291,8 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 			       exp->exp_client_uuid.uuid, exp, fed->fed_grant,
 			       fed->fed_pending, maxsize);
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&ofd->ofd_grant_lock);
+			cfs_percpt_unlock(ofd->ofd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 		if (fed->fed_dirty > maxsize) {
@@ -196,7 +300,8 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 			       ")\n", obd->obd_name, exp->exp_client_uuid.uuid,
 			       exp, fed->fed_dirty, maxsize);
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&ofd->ofd_grant_lock);
+			cfs_percpt_unlock(ofd->ofd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 		CDEBUG_LIMIT(error ? D_ERROR : D_CACHE, "%s: cli %s/%p dirty "
@@ -226,7 +331,8 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 			       exp->exp_client_uuid.uuid, exp, fed->fed_grant,
 			       fed->fed_pending, maxsize);
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&ofd->ofd_grant_lock);
+			cfs_percpt_unlock(ofd->ofd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 		if (fed->fed_dirty > maxsize) {
@@ -234,7 +340,8 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 			       ")\n", obd->obd_name, exp->exp_client_uuid.uuid,
 			       exp, fed->fed_dirty, maxsize);
 			spin_unlock(&obd->obd_dev_lock);
-			spin_unlock(&ofd->ofd_grant_lock);
+			cfs_percpt_unlock(ofd->ofd_grant_lock,
+					  CFS_PERCPT_LOCK_EX);
 			LBUG();
 		}
 		CDEBUG_LIMIT(error ? D_ERROR : D_CACHE, "%s: cli %s/%p dirty "
@@ -246,11 +353,10 @@ void ofd_grant_sanity_check(struct obd_device *obd, const char *func)
 		tot_dirty += fed->fed_dirty;
 	}
 
-	fo_tot_granted = ofd->ofd_tot_granted;
-	fo_tot_pending = ofd->ofd_tot_pending;
-	fo_tot_dirty = ofd->ofd_tot_dirty;
+	/* all shards are locked, so the sum is exact */
+	ofd_grant_totals(ofd, &fo_tot_dirty, &fo_tot_granted, &fo_tot_pending);
+	cfs_percpt_unlock(ofd->ofd_grant_lock, CFS_PERCPT_LOCK_EX);
 	spin_unlock(&obd->obd_dev_lock);
-	spin_unlock(&ofd->ofd_grant_lock);
 
 	if (tot_granted != fo_tot_granted)
 		CERROR("%s: tot_granted %llu != fo_tot_granted %llu\n",
@@ -321,7 +427,8 @@ static void ofd_grant_statfs(const struct lu_env *env, struct obd_export *exp,
  * This is done by accessing cached statfs data previously populated by
  * ofd_grant_statfs(), from which we withdraw the space already granted to
  * clients and the reserved space.
- * Caller must hold ofd_grant_lock spinlock.
+ * Caller must hold the grant lock of \a exp. The result is only exact if
+ * the caller holds the grant locks of all CPTs.
  *
  * \param[in] exp	export associated with the device for which the amount
  *			of available space is requested
@@ -332,12 +439,14 @@ static u64 ofd_grant_space_left(struct obd_export *exp)
 	struct obd_device *obd = exp->exp_obd;
 	struct ofd_device *ofd = ofd_exp(exp);
 	u64		   tot_granted;
+	u64		   tot_pending;
+	u64		   tot_dirty;
 	u64		   left;
 	u64		   avail;
 	u64		   unstable;
 
 	ENTRY;
-	assert_spin_locked(&ofd->ofd_grant_lock);
+	ofd_grant_assert_locked(exp);
 
 	spin_lock(&ofd->ofd_osfs_lock);
 	/* get available space from cached statfs data */
@@ -345,11 +454,11 @@ static u64 ofd_grant_space_left(struct obd_export *exp)
 	unstable = ofd->ofd_osfs_unstable; /* those might be accounted twice */
 	spin_unlock(&ofd->ofd_osfs_lock);
 
-	tot_granted = ofd->ofd_tot_granted;
+	ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
 
 	if (left < tot_granted) {
 		int mask = (left + unstable <
-			    tot_granted - ofd->ofd_tot_pending) ?
+			    tot_granted - tot_pending) ?
 			    D_ERROR : D_CACHE;
 
 		CDEBUG_LIMIT(mask, "%s: cli %s/%p left %llu < tot_grant "
@@ -357,7 +466,7 @@ static u64 ofd_grant_space_left(struct obd_export *exp)
 			     "dirty %llu\n",
 			     obd->obd_name, exp->exp_client_uuid.uuid, exp,
 			     left, tot_granted, unstable,
-			     ofd->ofd_tot_pending, ofd->ofd_tot_dirty);
+			     tot_pending, tot_dirty);
 		RETURN(0);
 	}
 
@@ -371,7 +480,7 @@ static u64 ofd_grant_space_left(struct obd_export *exp)
 	CDEBUG(D_CACHE, "%s: cli %s/%p avail %llu left %llu unstable "
 	       "%llu tot_grant %llu pending %llu\n", obd->obd_name,
 	       exp->exp_client_uuid.uuid, exp, avail, left, unstable,
-	       tot_granted, ofd->ofd_tot_pending);
+	       tot_granted, tot_pending);
 
 	RETURN(left);
 }
@@ -384,7 +493,7 @@ static u64 ofd_grant_space_left(struct obd_export *exp)
  * inflate all grant counters passed in the request if the client does not
  * support the grant parameters.
  * We will later calculate the client's new grant and return it.
- * Caller must hold ofd_grant_lock spinlock.
+ * Caller must hold the grant lock of \a exp.
  *
  * \param[in] env	LU environment supplying osfs storage
  * \param[in] exp	export for which we received the request
@@ -395,12 +504,13 @@ static void ofd_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 {
 	struct filter_export_data	*fed;
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct obd_device		*obd = exp->exp_obd;
 	long				 dirty;
 	long				 dropped;
 	ENTRY;
 
-	assert_spin_locked(&ofd->ofd_grant_lock);
+	ofd_grant_assert_locked(exp);
 
 	if ((oa->o_valid & (OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) !=
 					(OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) {
@@ -438,7 +548,7 @@ static void ofd_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 	 * on fed_dirty however, but we must check sanity to not assert. */
 	if (dirty > fed->fed_grant + 4 * chunk)
 		dirty = fed->fed_grant + 4 * chunk;
-	ofd->ofd_tot_dirty += dirty - fed->fed_dirty;
+	ogs->ogs_tot_dirty += dirty - fed->fed_dirty;
 	if (fed->fed_grant < dropped) {
 		CDEBUG(D_CACHE,
 		       "%s: cli %s/%p reports %lu dropped > grant %lu\n",
@@ -446,13 +556,13 @@ static void ofd_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		       fed->fed_grant);
 		dropped = 0;
 	}
-	if (ofd->ofd_tot_granted < dropped) {
+	if (ogs->ogs_tot_granted < dropped) {
 		CERROR("%s: cli %s/%p reports %lu dropped > tot_grant %llu\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       dropped, ofd->ofd_tot_granted);
+		       dropped, ogs->ogs_tot_granted);
 		dropped = 0;
 	}
-	ofd->ofd_tot_granted -= dropped;
+	ogs->ogs_tot_granted -= dropped;
 	fed->fed_grant -= dropped;
 	fed->fed_dirty = dirty;
 
@@ -460,7 +570,7 @@ static void ofd_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       fed->fed_dirty, fed->fed_pending, fed->fed_grant);
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
 	EXIT;
@@ -473,7 +583,7 @@ static void ofd_grant_incoming(const struct lu_env *env, struct obd_export *exp,
  * shrinking). This function proceeds with the shrink request when there is
  * less ungranted space remaining than the amount all of the connected clients
  * would consume if they used their full grant.
- * Caller must hold ofd_grant_lock spinlock.
+ * Caller must hold the grant lock of \a exp.
  *
  * \param[in] exp		export releasing grant space
  * \param[in,out] oa		incoming obdo sent by the client
@@ -485,12 +595,13 @@ static void ofd_grant_shrink(struct obd_export *exp, struct obdo *oa,
 {
 	struct filter_export_data	*fed;
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct obd_device		*obd = exp->exp_obd;
 	long				 grant_shrink;
 
-	assert_spin_locked(&ofd->ofd_grant_lock);
+	ofd_grant_assert_locked(exp);
 	LASSERT(exp);
-	if (left_space >= ofd->ofd_tot_granted_clients *
+	if (left_space >= atomic_read(&ofd->ofd_tot_granted_clients) *
 			  OFD_GRANT_SHRINK_LIMIT(exp))
 		return;
 
@@ -498,11 +609,11 @@ static void ofd_grant_shrink(struct obd_export *exp, struct obdo *oa,
 
 	fed = &exp->exp_filter_data;
 	fed->fed_grant       -= grant_shrink;
-	ofd->ofd_tot_granted -= grant_shrink;
+	ogs->ogs_tot_granted -= grant_shrink;
 
-	CDEBUG(D_CACHE, "%s: cli %s/%p shrink %ld fed_grant %ld total %llu\n",
-	       obd->obd_name, exp->exp_client_uuid.uuid, exp, grant_shrink,
-	       fed->fed_grant, ofd->ofd_tot_granted);
+	CDEBUG(D_CACHE, "%s: cli %s/%p shrink %ld fed_grant %ld cpt total "
+	       "%llu\n", obd->obd_name, exp->exp_client_uuid.uuid, exp,
+	       grant_shrink, fed->fed_grant, ogs->ogs_tot_granted);
 
 	/* client has just released some grant, don't grant any space back */
 	oa->o_grant = 0;
@@ -577,7 +688,7 @@ static inline u64 ofd_grant_rnb_size(struct obd_export *exp,
  * The OBD_BRW_GRANTED flag will be set in the rnb_flags of each network
  * buffer which has been granted enough space to proceed. Buffers without
  * this flag will fail to be written with -ENOSPC (see ofd_preprw_write().
- * Caller must hold ofd_grant_lock spinlock.
+ * Caller must hold the grant lock of \a exp.
  *
  * \param[in] env	LU environment passed by the caller
  * \param[in] exp	export identifying the client which sent the RPC
@@ -595,6 +706,7 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
 	struct filter_export_data	*fed = &exp->exp_filter_data;
 	struct obd_device		*obd = exp->exp_obd;
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	unsigned long			 ungranted = 0;
 	unsigned long			 granted = 0;
 	int				 i;
@@ -603,7 +715,7 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
 
 	ENTRY;
 
-	assert_spin_locked(&ofd->ofd_grant_lock);
+	ofd_grant_assert_locked(exp);
 
 	if (obd->obd_recovering) {
 		/* Replaying write. Grant info have been processed already so no
@@ -723,8 +835,8 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
 	 * happens in ofd_grant_commit() after the writes are done. */
 	fed->fed_grant -= granted;
 	fed->fed_pending += oa->o_grant_used;
-	ofd->ofd_tot_granted += ungranted;
-	ofd->ofd_tot_pending += oa->o_grant_used;
+	ogs->ogs_tot_granted += ungranted;
+	ogs->ogs_tot_pending += oa->o_grant_used;
 
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p granted: %lu ungranted: %lu grant: %lu dirty: %lu"
@@ -742,14 +854,14 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
 		       granted, fed->fed_dirty);
 		granted = fed->fed_dirty;
 	}
-	ofd->ofd_tot_dirty -= granted;
+	ogs->ogs_tot_dirty -= granted;
 	fed->fed_dirty -= granted;
 
 	if (fed->fed_dirty < 0 || fed->fed_grant < 0 || fed->fed_pending < 0) {
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       fed->fed_dirty, fed->fed_pending, fed->fed_grant);
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
 	EXIT;
@@ -760,7 +872,7 @@ static void ofd_grant_check(const struct lu_env *env, struct obd_export *exp,
  *
  * Calculate how much grant space to return to client, based on how much space
  * is currently free and how much of that is already granted.
- * Caller must hold ofd_grant_lock spinlock.
+ * Caller must hold the grant lock of \a exp.
  *
  * \param[in] exp		export of the client which sent the request
  * \param[in] curgrant		current grant claimed by the client
@@ -781,6 +893,7 @@ static long ofd_grant_alloc(struct obd_export *exp, u64 curgrant,
 {
 	struct obd_device		*obd = exp->exp_obd;
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct filter_export_data	*fed = &exp->exp_filter_data;
 	u64				 grant;
 
@@ -826,14 +939,14 @@ static long ofd_grant_alloc(struct obd_export *exp, u64 curgrant,
 	if ((grant > chunk) && conservative)
 		grant = chunk;
 
-	ofd->ofd_tot_granted += grant;
+	ogs->ogs_tot_granted += grant;
 	fed->fed_grant += grant;
 
 	if (fed->fed_grant < 0) {
 		CERROR("%s: cli %s/%p grant %ld want %llu current %llu\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       fed->fed_grant, want, curgrant);
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
 
@@ -842,10 +955,10 @@ static long ofd_grant_alloc(struct obd_export *exp, u64 curgrant,
 	       " granting: %llu\n", obd->obd_name, exp->exp_client_uuid.uuid,
 	       exp, want, curgrant, grant);
 	CDEBUG(D_CACHE,
-	       "%s: cli %s/%p tot cached:%llu granted:%llu"
+	       "%s: cli %s/%p cpt %d tot cached:%llu granted:%llu"
 	       " num_exports: %d\n", obd->obd_name, exp->exp_client_uuid.uuid,
-	       exp, ofd->ofd_tot_dirty, ofd->ofd_tot_granted,
-	       obd->obd_num_exports);
+	       exp, ofd_grant_cpt(exp), ogs->ogs_tot_dirty,
+	       ogs->ogs_tot_granted, obd->obd_num_exports);
 
 	RETURN(grant);
 }
@@ -869,6 +982,7 @@ void ofd_grant_connect(const struct lu_env *env, struct obd_export *exp,
 		       struct obd_connect_data *data, bool new_conn)
 {
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct filter_export_data	*fed = &exp->exp_filter_data;
 	u64				 left = 0;
 	u64				 want;
@@ -894,7 +1008,8 @@ void ofd_grant_connect(const struct lu_env *env, struct obd_export *exp,
 refresh:
 	ofd_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&ofd->ofd_grant_lock);
+	/* a (re)connection may be granted a lot of space at once */
+	ofd_grant_lock(exp, true);
 
 	/* Grab free space from cached info and take out space already granted
 	 * to clients as well as reserved space */
@@ -902,7 +1017,7 @@ refresh:
 
 	/* get fresh statfs data if we are short in ungranted space */
 	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, true);
 		CDEBUG(D_CACHE, "fs has no space left and statfs too old\n");
 		force = 1;
 		goto refresh;
@@ -919,13 +1034,13 @@ refresh:
 						    (u64)fed->fed_grant);
 
 	/* reset dirty accounting */
-	ofd->ofd_tot_dirty -= fed->fed_dirty;
+	ogs->ogs_tot_dirty -= fed->fed_dirty;
 	fed->fed_dirty = 0;
 
 	if (new_conn && OCD_HAS_FLAG(data, GRANT))
-		ofd->ofd_tot_granted_clients++;
+		atomic_inc(&ofd->ofd_tot_granted_clients);
 
-	spin_unlock(&ofd->ofd_grant_lock);
+	ofd_grant_unlock(exp, true);
 
 	CDEBUG(D_CACHE, "%s: cli %s/%p ocd_grant: %d want: %llu left: %llu\n",
 	       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid,
@@ -947,29 +1062,29 @@ refresh:
 void ofd_grant_discard(struct obd_export *exp)
 {
 	struct obd_device		*obd = exp->exp_obd;
-	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct filter_export_data	*fed = &exp->exp_filter_data;
 
-	spin_lock(&ofd->ofd_grant_lock);
-	LASSERTF(ofd->ofd_tot_granted >= fed->fed_grant,
+	ofd_grant_lock(exp, false);
+	LASSERTF(ogs->ogs_tot_granted >= fed->fed_grant,
 		 "%s: tot_granted %llu cli %s/%p fed_grant %ld\n",
-		 obd->obd_name, ofd->ofd_tot_granted,
+		 obd->obd_name, ogs->ogs_tot_granted,
 		 exp->exp_client_uuid.uuid, exp, fed->fed_grant);
-	ofd->ofd_tot_granted -= fed->fed_grant;
+	ogs->ogs_tot_granted -= fed->fed_grant;
 	fed->fed_grant = 0;
-	LASSERTF(ofd->ofd_tot_pending >= fed->fed_pending,
+	LASSERTF(ogs->ogs_tot_pending >= fed->fed_pending,
 		 "%s: tot_pending %llu cli %s/%p fed_pending %ld\n",
-		 obd->obd_name, ofd->ofd_tot_pending,
+		 obd->obd_name, ogs->ogs_tot_pending,
 		 exp->exp_client_uuid.uuid, exp, fed->fed_pending);
-	/* ofd_tot_pending is handled in ofd_grant_commit as bulk
+	/* ogs_tot_pending is handled in ofd_grant_commit as bulk
 	 * commmits */
-	LASSERTF(ofd->ofd_tot_dirty >= fed->fed_dirty,
+	LASSERTF(ogs->ogs_tot_dirty >= fed->fed_dirty,
 		 "%s: tot_dirty %llu cli %s/%p fed_dirty %ld\n",
-		 obd->obd_name, ofd->ofd_tot_dirty,
+		 obd->obd_name, ogs->ogs_tot_dirty,
 		 exp->exp_client_uuid.uuid, exp, fed->fed_dirty);
-	ofd->ofd_tot_dirty -= fed->fed_dirty;
+	ogs->ogs_tot_dirty -= fed->fed_dirty;
 	fed->fed_dirty = 0;
-	spin_unlock(&ofd->ofd_grant_lock);
+	ofd_grant_unlock(exp, false);
 }
 
 /**
@@ -1009,8 +1124,8 @@ void ofd_grant_prepare_read(const struct lu_env *env,
 		 * statfs information. */
 		ofd_grant_statfs(env, exp, 1, NULL);
 
-		/* protect all grant counters */
-		spin_lock(&ofd->ofd_grant_lock);
+		/* shrinking depends on the exact amount of space left */
+		ofd_grant_lock(exp, true);
 
 		/* Grab free space from cached statfs data and take out space
 		 * already granted to clients as well as reserved space */
@@ -1023,7 +1138,7 @@ void ofd_grant_prepare_read(const struct lu_env *env,
 		 * since we don't grant space back on reads, no point
 		 * in running statfs, so just skip it and process
 		 * incoming grant data directly. */
-		spin_lock(&ofd->ofd_grant_lock);
+		ofd_grant_lock(exp, false);
 		do_shrink = 0;
 	}
 
@@ -1040,7 +1155,7 @@ void ofd_grant_prepare_read(const struct lu_env *env,
 
 	if (!ofd_grant_param_supp(exp))
 		oa->o_grant = ofd_grant_deflate(ofd, oa->o_grant);
-	spin_unlock(&ofd->ofd_grant_lock);
+	ofd_grant_unlock(exp, do_shrink);
 	EXIT;
 }
 
@@ -1075,6 +1190,7 @@ void ofd_grant_prepare_write(const struct lu_env *env,
 	int			 from_cache;
 	int			 force = 0; /* can use cached data intially */
 	long			 chunk = ofd_grant_chunk(exp, ofd, NULL);
+	bool			 exact = false;
 
 	ENTRY;
 
@@ -1082,15 +1198,24 @@ refresh:
 	/* get statfs information from OSD layer */
 	ofd_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&ofd->ofd_grant_lock); /* protect all grant counters */
+relock:
+	ofd_grant_lock(exp, exact);
 
 	/* Grab free space from cached statfs data and take out space already
 	 * granted to clients as well as reserved space */
 	left = ofd_grant_space_left(exp);
 
+	/* The space left is only approximate with the counters of this CPT
+	 * locked, get the exact value if we are getting short */
+	if (!exact && left < OFD_GRANT_EXACT_MARGIN(ofd)) {
+		ofd_grant_unlock(exp, exact);
+		exact = true;
+		goto relock;
+	}
+
 	/* Get fresh statfs data if we are short in ungranted space */
 	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, exact);
 		CDEBUG(D_CACHE, "%s: fs has no space left and statfs too old\n",
 		       obd->obd_name);
 		force = 1;
@@ -1114,7 +1239,7 @@ refresh:
 		if (!from_grant) {
 			/* at least one network buffer requires acquiring grant
 			 * space on the server */
-			spin_unlock(&ofd->ofd_grant_lock);
+			ofd_grant_unlock(exp, exact);
 			/* discard errors, at least we tried ... */
 			dt_sync(env, ofd->ofd_osd);
 			force = 2;
@@ -1130,7 +1255,7 @@ refresh:
 	ofd_grant_check(env, exp, oa, rnb, niocount, &left);
 
 	if (!(oa->o_valid & OBD_MD_FLGRANT)) {
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, exact);
 		RETURN_EXIT;
 	}
 
@@ -1146,7 +1271,7 @@ refresh:
 
 	if (!ofd_grant_param_supp(exp))
 		oa->o_grant = ofd_grant_deflate(ofd, oa->o_grant);
-	spin_unlock(&ofd->ofd_grant_lock);
+	ofd_grant_unlock(exp, exact);
 	EXIT;
 }
 
@@ -1171,6 +1296,7 @@ refresh:
 long ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 {
 	struct ofd_device		*ofd = ofd_exp(exp);
+	struct ofd_grant_shard		*ogs = ofd_grant_shard(exp);
 	struct filter_export_data	*fed = &exp->exp_filter_data;
 	u64				 left = 0;
 	unsigned long			 wanted;
@@ -1185,14 +1311,14 @@ long ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 	/* Update statfs data if required */
 	ofd_grant_statfs(env, exp, 1, NULL);
 
-	/* protect all grant counters */
-	spin_lock(&ofd->ofd_grant_lock);
+	/* precreation may book a lot of space, lock all grant counters */
+	ofd_grant_lock(exp, true);
 
 	/* fail precreate request if there is not enough blocks available for
 	 * writing */
 	if (ofd->ofd_osfs.os_bavail - (fed->fed_grant >> ofd->ofd_blockbits) <
 	    (ofd->ofd_osfs.os_blocks >> 10)) {
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, true);
 		CDEBUG(D_RPCTRACE, "%s: not enough space for create %llu\n",
 		       ofd_name(ofd),
 		       ofd->ofd_osfs.os_bavail * ofd->ofd_osfs.os_blocks);
@@ -1214,7 +1340,7 @@ long ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 		if (*nr == 0) {
 			/* we really have no space any more for precreation,
 			 * fail the precreate request with ENOSPC */
-			spin_unlock(&ofd->ofd_grant_lock);
+			ofd_grant_unlock(exp, true);
 			RETURN(-ENOSPC);
 		}
 		/* compute space needed for the new number of creations */
@@ -1227,13 +1353,13 @@ long ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 		fed->fed_grant -= wanted;
 	} else {
 		/* we need to take some space from the ungranted pool */
-		ofd->ofd_tot_granted += wanted - fed->fed_grant;
+		ogs->ogs_tot_granted += wanted - fed->fed_grant;
 		left -= wanted - fed->fed_grant;
 		fed->fed_grant = 0;
 	}
 	granted = wanted;
 	fed->fed_pending += granted;
-	ofd->ofd_tot_pending += granted;
+	ogs->ogs_tot_pending += granted;
 
 	/* grant more space for precreate purpose if possible. */
 	wanted = OST_MAX_PRECREATE * ofd->ofd_dt_conf.ddp_inodespace / 2;
@@ -1247,7 +1373,7 @@ long ofd_grant_create(const struct lu_env *env, struct obd_export *exp, int *nr)
 		ofd_grant_alloc(exp, fed->fed_grant, wanted, left, chunk,
 				false);
 	}
-	spin_unlock(&ofd->ofd_grant_lock);
+	ofd_grant_unlock(exp, true);
 	RETURN(granted);
 }
 
@@ -1264,6 +1390,7 @@ void ofd_grant_commit(struct obd_export *exp, unsigned long pending,
 		      int rc)
 {
 	struct ofd_device	*ofd  = ofd_exp(exp);
+	struct ofd_grant_shard	*ogs = ofd_grant_shard(exp);
 	ENTRY;
 
 	/* get space accounted in tot_pending for the I/O, set in
@@ -1271,7 +1398,7 @@ void ofd_grant_commit(struct obd_export *exp, unsigned long pending,
 	if (pending == 0)
 		RETURN_EXIT;
 
-	spin_lock(&ofd->ofd_grant_lock);
+	ofd_grant_lock(exp, false);
 	/* Don't update statfs data for errors raised before commit (e.g.
 	 * bulk transfer failed, ...) since we know those writes have not been
 	 * processed. For other errors hit during commit, we cannot really tell
@@ -1295,29 +1422,29 @@ void ofd_grant_commit(struct obd_export *exp, unsigned long pending,
 		CERROR("%s: cli %s/%p fed_pending(%lu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       exp->exp_filter_data.fed_pending, pending);
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
 	exp->exp_filter_data.fed_pending -= pending;
 
-	if (ofd->ofd_tot_granted < pending) {
+	if (ogs->ogs_tot_granted < pending) {
 		CERROR("%s: cli %s/%p tot_granted(%llu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       ofd->ofd_tot_granted, pending);
-		spin_unlock(&ofd->ofd_grant_lock);
+		       ogs->ogs_tot_granted, pending);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
-	ofd->ofd_tot_granted -= pending;
+	ogs->ogs_tot_granted -= pending;
 
-	if (ofd->ofd_tot_pending < pending) {
+	if (ogs->ogs_tot_pending < pending) {
 		CERROR("%s: cli %s/%p tot_pending(%llu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       ofd->ofd_tot_pending, pending);
-		spin_unlock(&ofd->ofd_grant_lock);
+		       ogs->ogs_tot_pending, pending);
+		ofd_grant_unlock(exp, false);
 		LBUG();
 	}
-	ofd->ofd_tot_pending -= pending;
-	spin_unlock(&ofd->ofd_grant_lock);
+	ogs->ogs_tot_pending -= pending;
+	ofd_grant_unlock(exp, false);
 	EXIT;
 }
 
@@ -65,6 +65,9 @@ struct ofd_mod_data {
 
 #define OFD_SOFT_SYNC_LIMIT_DEFAULT 16
 
+/* bytes copied per preprw/commitrw cycle of an OST_COPY request */
+#define OFD_COPY_CHUNK (1024 * 1024)
+
 /* request stats */
 enum {
 	LPROC_OFD_STATS_READ = 0,
@@ -150,16 +153,12 @@ struct ofd_device {
 	u64			 ofd_osfs_inflight;
 
 	/* grants: all values in bytes */
-	/* grant lock to protect all grant counters */
-	spinlock_t		 ofd_grant_lock;
-	/* total amount of dirty data reported by clients in incoming obdo */
-	u64			 ofd_tot_dirty;
-	/* sum of filesystem space granted to clients for async writes */
-	u64			 ofd_tot_granted;
-	/* grant used by I/Os in progress (between prepare and commit) */
-	u64			 ofd_tot_pending;
+	/* per-CPT grant locks, protecting the shards below */
+	struct cfs_percpt_lock	*ofd_grant_lock;
+	/* per-CPT grant counters, see ofd_grant.c */
+	struct ofd_grant_shard	**ofd_grant_shards;
 	/* number of clients using grants */
-	int			 ofd_tot_granted_clients;
+	atomic_t		 ofd_tot_granted_clients;
 
 	/* preferred BRW size, decided by storage type and capability */
 	__u32			 ofd_brw_size;
@@ -191,6 +190,16 @@ struct ofd_device {
 	spinlock_t		 ofd_inconsistency_lock;
 };
 
+/* grant counters of the exports with fed_grant_cpt set to a CPT */
+struct ofd_grant_shard {
+	/* total amount of dirty data reported by clients in incoming obdo */
+	u64			 ogs_tot_dirty;
+	/* sum of filesystem space granted to clients for async writes */
+	u64			 ogs_tot_granted;
+	/* grant used by I/Os in progress (between prepare and commit) */
+	u64			 ogs_tot_pending;
+};
+
 static inline struct ofd_device *ofd_dev(struct lu_device *d)
 {
 	return container_of0(d, struct ofd_device, ofd_dt_dev.dd_lu_dev);
@@ -450,6 +459,10 @@ static inline int ofd_grant_prohibit(struct obd_export *exp,
 		  !ofd_grant_param_supp(exp) && ofd->ofd_grant_compat_disable);
 }
 
+void ofd_grant_totals(struct ofd_device *ofd, u64 *dirty, u64 *granted,
+		      u64 *pending);
+int ofd_grant_init(struct ofd_device *ofd);
+void ofd_grant_fini(struct ofd_device *ofd);
 void ofd_grant_sanity_check(struct obd_device *obd, const char *func);
 void ofd_grant_connect(const struct lu_env *env, struct obd_export *exp,
 		       struct obd_connect_data *data, bool new_conn);
@@ -46,6 +46,7 @@
 #include <lustre/lustre_idl.h>
 #include "ofd_internal.h"
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <lustre_ioctl.h>
 #include <lustre_quota.h>
 #include <lustre_lfsck.h>
@@ -269,6 +270,24 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 		       exp->exp_obd->obd_name, obd_export_nid2str(exp));
 	}
 
+	if (data->ocd_connect_flags & OBD_CONNECT_FLAGS2 &&
+	    data->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS) {
+		__u32 compr_types = data->ocd_compr_types;
+
+		/* as for checksums, mask off the compression algorithms
+		 * this node can not decompress */
+		data->ocd_compr_types &= ptlrpc_compr_types_supported();
+		if (data->ocd_compr_types == 0)
+			data->ocd_connect_flags2 &= ~OBD_CONNECT2_COMPRESS;
+		/* best effort, decompression allocates a context if the
+		 * pool is empty */
+		ptlrpc_compr_pool_setup(data->ocd_compr_types);
+
+		CDEBUG(D_RPCTRACE, "%s: cli %s supports compr type %x, return "
+		       "%x\n", exp->exp_obd->obd_name, obd_export_nid2str(exp),
+		       compr_types, data->ocd_compr_types);
+	}
+
 	if (data->ocd_connect_flags & OBD_CONNECT_MAXBYTES)
 		data->ocd_maxbytes = ofd->ofd_dt_conf.ddp_maxbytes;
 
@@ -468,6 +487,8 @@ static int ofd_init_export(struct obd_export *exp)
 
 	spin_lock_init(&exp->exp_filter_data.fed_lock);
 	INIT_LIST_HEAD(&exp->exp_filter_data.fed_mod_list);
+	/* account grant of the client on the CPT its requests arrive on */
+	exp->exp_filter_data.fed_grant_cpt = cfs_cpt_current(cfs_cpt_table, 1);
 	atomic_set(&exp->exp_filter_data.fed_soft_sync_count, 0);
 	spin_lock(&exp->exp_lock);
 	exp->exp_connecting = 1;
@@ -716,6 +737,9 @@ int ofd_statfs_internal(const struct lu_env *env, struct ofd_device *ofd,
 	spin_lock(&ofd->ofd_osfs_lock);
 	if (cfs_time_before_64(ofd->ofd_osfs_age, max_age) || max_age == 0) {
 		u64 unstable;
+		u64 tot_dirty;
+		u64 tot_granted;
+		u64 tot_pending;
 
 		/* statfs data are too old, get up-to-date one.
 		 * we must be cautious here since multiple threads might be
@@ -740,7 +764,7 @@ int ofd_statfs_internal(const struct lu_env *env, struct ofd_device *ofd,
 		if (unlikely(rc))
 			GOTO(out, rc);
 
-		spin_lock(&ofd->ofd_grant_lock);
+		ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
 		spin_lock(&ofd->ofd_osfs_lock);
 		/* calculate how much space was written while we released the
 		 * ofd_osfs_lock */
@@ -764,8 +788,7 @@ int ofd_statfs_internal(const struct lu_env *env, struct ofd_device *ofd,
 		}
 		/* similarly, there is some uncertainty on write requests
 		 * between prepare & commit */
-		ofd->ofd_osfs_unstable += ofd->ofd_tot_pending;
-		spin_unlock(&ofd->ofd_grant_lock);
+		ofd->ofd_osfs_unstable += tot_pending;
 
 		/* finally udpate cached statfs data */
 		ofd->ofd_osfs = *osfs;
@@ -817,6 +840,9 @@ int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 {
         struct obd_device	*obd = class_exp2obd(exp);
 	struct ofd_device	*ofd = ofd_exp(exp);
+	u64			 tot_dirty;
+	u64			 tot_granted;
+	u64			 tot_pending;
 	int			 rc;
 
 	ENTRY;
@@ -829,14 +855,15 @@ int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	 * might be under-reporting if clients haven't announced their
 	 * caches with brw recently */
 
+	ofd_grant_totals(ofd, &tot_dirty, &tot_granted, &tot_pending);
 	CDEBUG(D_SUPER | D_CACHE, "blocks cached %llu granted %llu"
 	       " pending %llu free %llu avail %llu\n",
-	       ofd->ofd_tot_dirty, ofd->ofd_tot_granted, ofd->ofd_tot_pending,
+	       tot_dirty, tot_granted, tot_pending,
 	       osfs->os_bfree << ofd->ofd_blockbits,
 	       osfs->os_bavail << ofd->ofd_blockbits);
 
 	osfs->os_bavail -= min_t(u64, osfs->os_bavail,
-				 ((ofd->ofd_tot_dirty + ofd->ofd_tot_pending +
+				 ((tot_dirty + tot_pending +
 				   osfs->os_bsize - 1) >> ofd->ofd_blockbits));
 
 	/* The QoS code on the MDS does not care about space reserved for
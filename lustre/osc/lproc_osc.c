@@ -34,6 +34,7 @@
 #include <linux/version.h>
 #include <asm/statfs.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 #include <lprocfs_status.h>
 #include <linux/seq_file.h>
@@ -234,6 +235,28 @@ osc_cached_mb_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(osc_cached_mb);
 
+/* pages of each per-CPT LRU partition, they add up to in_list */
+static int osc_lru_partitions_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+	struct client_obd *cli = &dev->u.cli;
+	struct cl_lru_part *clp;
+	int i;
+
+	seq_printf(m, "in_list: %ld\n",
+		   atomic_long_read(&cli->cl_lru_in_list));
+	if (cli->cl_lru_parts == NULL)
+		return 0;
+
+	cfs_percpt_for_each(clp, i, cli->cl_lru_parts) {
+		spin_lock(&clp->clp_lock);
+		seq_printf(m, "cpt%d: %ld\n", i, clp->clp_count);
+		spin_unlock(&clp->clp_lock);
+	}
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(osc_lru_partitions);
+
 static int osc_cur_dirty_bytes_seq_show(struct seq_file *m, void *v)
 {
 	struct obd_device *dev = m->private;
@@ -439,6 +462,110 @@ static ssize_t osc_checksum_type_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(osc_checksum_type);
 
+static int osc_compress_type_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct client_obd *cli;
+	int i;
+	DECLARE_COMPR_NAME;
+
+	if (obd == NULL)
+		return 0;
+
+	cli = &obd->u.cli;
+	for (i = 0; i < ARRAY_SIZE(compr_name); i++) {
+		if (i != OBD_COMPR_NONE &&
+		    (obd_compr_type2mask(i) & cli->cl_supp_compr_types) == 0)
+			continue;
+		if (cli->cl_compr_type == i)
+			seq_printf(m, "[%s] ", compr_name[i]);
+		else
+			seq_printf(m, "%s ", compr_name[i]);
+	}
+	seq_printf(m, "\n");
+	return 0;
+}
+
+static ssize_t osc_compress_type_seq_write(struct file *file,
+					   const char __user *buffer,
+					   size_t count, loff_t *off)
+{
+	struct obd_device *obd = ((struct seq_file *)file->private_data)->private;
+	struct client_obd *cli;
+	int i;
+	DECLARE_COMPR_NAME;
+	char kernbuf[10];
+
+	if (obd == NULL)
+		return 0;
+
+	if (count > sizeof(kernbuf) - 1)
+		return -EINVAL;
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	if (count > 0 && kernbuf[count - 1] == '\n')
+		kernbuf[count - 1] = '\0';
+	else
+		kernbuf[count] = '\0';
+
+	cli = &obd->u.cli;
+	for (i = 0; i < ARRAY_SIZE(compr_name); i++) {
+		if (i != OBD_COMPR_NONE &&
+		    (obd_compr_type2mask(i) & cli->cl_supp_compr_types) == 0)
+			continue;
+		if (!strcmp(kernbuf, compr_name[i])) {
+			int rc;
+
+			/* the write path does not allocate contexts */
+			rc = ptlrpc_compr_pool_setup(obd_compr_type2mask(i));
+			if (rc != 0)
+				return rc;
+			cli->cl_compr_type = i;
+			return count;
+		}
+	}
+	return -EINVAL;
+}
+LPROC_SEQ_FOPS(osc_compress_type);
+
+static int osc_rpc_autotune_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+
+	if (obd == NULL)
+		return 0;
+
+	seq_printf(m, "%d\n", obd->u.cli.cl_rpc_autotune ? 1 : 0);
+	return 0;
+}
+
+static ssize_t osc_rpc_autotune_seq_write(struct file *file,
+					  const char __user *buffer,
+					  size_t count, loff_t *off)
+{
+	struct obd_device *obd = ((struct seq_file *)file->private_data)->private;
+	struct client_obd *cli;
+	int rc;
+	__s64 val;
+
+	if (obd == NULL)
+		return 0;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	cli = &obd->u.cli;
+	spin_lock(&cli->cl_loi_list_lock);
+	if (val && !cli->cl_rpc_autotune)
+		osc_rpc_tune_init(cli);
+	cli->cl_rpc_autotune = !!val;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(osc_rpc_autotune);
+
 static int osc_resend_count_seq_show(struct seq_file *m, void *v)
 {
 	struct obd_device *obd = m->private;
@@ -653,6 +780,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_max_dirty_mb_fops		},
 	{ .name	=	"osc_cached_mb",
 	  .fops	=	&osc_cached_mb_fops		},
+	{ .name	=	"lru_partitions",
+	  .fops	=	&osc_lru_partitions_fops	},
 	{ .name	=	"cur_dirty_bytes",
 	  .fops	=	&osc_cur_dirty_bytes_fops	},
 	{ .name	=	"cur_grant_bytes",
@@ -667,6 +796,10 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_checksum_fops		},
 	{ .name	=	"checksum_type",
 	  .fops	=	&osc_checksum_type_fops		},
+	{ .name	=	"compress_type",
+	  .fops	=	&osc_compress_type_fops		},
+	{ .name	=	"rpc_autotune",
+	  .fops	=	&osc_rpc_autotune_fops		},
 	{ .name	=	"resend_count",
 	  .fops	=	&osc_resend_count_fops		},
 	{ .name	=	"timeouts",
@@ -838,6 +971,96 @@ static ssize_t osc_stats_seq_write(struct file *file,
 
 LPROC_SEQ_FOPS(osc_stats);
 
+static int osc_compress_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct timeval now;
+	struct obd_device *dev = seq->private;
+	struct cl_compr_stats *stats = &dev->u.cli.cl_compr_stats;
+
+	do_gettimeofday(&now);
+
+	seq_printf(seq, "snapshot_time:         %lu.%lu (secs.usecs)\n",
+		   now.tv_sec, now.tv_usec);
+	spin_lock(&stats->ccs_lock);
+	seq_printf(seq, "compressed_rpcs\t\t%llu\n", stats->ccs_rpcs);
+	seq_printf(seq, "uncompressed_rpcs\t%llu\n", stats->ccs_rpcs_raw);
+	seq_printf(seq, "compressed_chunks\t%llu\n",
+		   stats->ccs_chunks - stats->ccs_chunks_raw);
+	seq_printf(seq, "uncompressed_chunks\t%llu\n", stats->ccs_chunks_raw);
+	seq_printf(seq, "bytes_in\t\t%llu\n", stats->ccs_bytes_in);
+	seq_printf(seq, "bytes_out\t\t%llu\n", stats->ccs_bytes_out);
+	seq_printf(seq, "bytes_saved\t\t%llu\n",
+		   stats->ccs_bytes_in - stats->ccs_bytes_out);
+	seq_printf(seq, "compress_usecs\t\t%llu\n", stats->ccs_usec);
+	spin_unlock(&stats->ccs_lock);
+	return 0;
+}
+
+static ssize_t osc_compress_stats_seq_write(struct file *file,
+					    const char __user *buf,
+					    size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *dev = seq->private;
+	struct cl_compr_stats *stats = &dev->u.cli.cl_compr_stats;
+
+	spin_lock(&stats->ccs_lock);
+	stats->ccs_rpcs = 0;
+	stats->ccs_rpcs_raw = 0;
+	stats->ccs_chunks = 0;
+	stats->ccs_chunks_raw = 0;
+	stats->ccs_bytes_in = 0;
+	stats->ccs_bytes_out = 0;
+	stats->ccs_usec = 0;
+	spin_unlock(&stats->ccs_lock);
+
+	return len;
+}
+LPROC_SEQ_FOPS(osc_compress_stats);
+
+static int osc_rpc_autotune_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct timeval now;
+	struct obd_device *dev = seq->private;
+	struct client_obd *cli = &dev->u.cli;
+	struct cl_rpc_tune *crt = &cli->cl_rpc_tune;
+
+	do_gettimeofday(&now);
+
+	seq_printf(seq, "snapshot_time:         %lu.%lu (secs.usecs)\n",
+		   now.tv_sec, now.tv_usec);
+	spin_lock(&cli->cl_loi_list_lock);
+	seq_printf(seq, "enabled\t\t\t%d\n", cli->cl_rpc_autotune ? 1 : 0);
+	seq_printf(seq, "pages_per_rpc\t\t%u\n", osc_rpc_pages(cli));
+	seq_printf(seq, "rpcs_in_flight\t\t%u\n",
+		   osc_rpcs_in_flight_max(cli));
+	seq_printf(seq, "rate_bytes_per_sec\t%llu\n", crt->crt_rate);
+	seq_printf(seq, "base_usec_per_mb\t%llu\n", crt->crt_base_usec);
+	seq_printf(seq, "windows\t\t\t%llu\n", crt->crt_windows);
+	seq_printf(seq, "increases\t\t%llu\n", crt->crt_increases);
+	seq_printf(seq, "decreases\t\t%llu\n", crt->crt_decreases);
+	spin_unlock(&cli->cl_loi_list_lock);
+	return 0;
+}
+
+static ssize_t osc_rpc_autotune_stats_seq_write(struct file *file,
+						const char __user *buf,
+						size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *dev = seq->private;
+	struct client_obd *cli = &dev->u.cli;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_rpc_tune.crt_windows = 0;
+	cli->cl_rpc_tune.crt_increases = 0;
+	cli->cl_rpc_tune.crt_decreases = 0;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return len;
+}
+LPROC_SEQ_FOPS(osc_rpc_autotune_stats);
+
 int lproc_osc_attach_seqstat(struct obd_device *dev)
 {
 	int rc;
@@ -847,6 +1070,12 @@ int lproc_osc_attach_seqstat(struct obd_device *dev)
 	if (rc == 0)
 		rc = lprocfs_obd_seq_create(dev, "rpc_stats", 0644,
 					    &osc_rpc_stats_fops, dev);
+	if (rc == 0)
+		rc = lprocfs_obd_seq_create(dev, "compress_stats", 0644,
+					    &osc_compress_stats_fops, dev);
+	if (rc == 0)
+		rc = lprocfs_obd_seq_create(dev, "rpc_autotune_stats", 0644,
+					    &osc_rpc_autotune_stats_fops, dev);
 
 	return rc;
 }
@@ -655,7 +655,7 @@ static struct osc_extent *osc_extent_find(const struct lu_env *env,
 	chunk      = index >> ppc_bits;
 
 	/* align end to RPC edge. */
-	max_pages = cli->cl_max_pages_per_rpc;
+	max_pages = osc_rpc_pages(cli);
 	if ((max_pages & ~chunk_mask) != 0) {
 		CERROR("max_pages: %#x chunkbits: %u chunk_mask: %#lx\n",
 		       max_pages, cli->cl_chunkbits, chunk_mask);
@@ -1367,7 +1367,7 @@ static int osc_completion(const struct lu_env *env, struct osc_async_page *oap,
 	CDEBUG(lvl, "%s: grant { dirty: %ld/%ld dirty_pages: %ld/%lu "	\
 	       "dropped: %ld avail: %ld, dirty_grant: %ld, "		\
 	       "reserved: %ld, flight: %d } lru {in list: %ld, "	\
-	       "left: %ld, waiters: %d }" fmt "\n",			\
+	       "busy: %ld }" fmt "\n",					\
 	       cli_name(__tmp),						\
 	       __tmp->cl_dirty_pages, __tmp->cl_dirty_max_pages,	\
 	       atomic_long_read(&obd_dirty_pages), obd_max_dirty_pages,	\
@@ -1375,8 +1375,7 @@ static int osc_completion(const struct lu_env *env, struct osc_async_page *oap,
 	       __tmp->cl_dirty_grant,					\
 	       __tmp->cl_reserved_grant, __tmp->cl_w_in_flight,		\
 	       atomic_long_read(&__tmp->cl_lru_in_list),		\
-	       atomic_long_read(&__tmp->cl_lru_busy),			\
-	       atomic_read(&__tmp->cl_lru_shrinkers), ##args);		\
+	       atomic_long_read(&__tmp->cl_lru_busy), ##args);		\
 } while (0)
 
 /* caller must hold loi_list_lock */
@@ -1702,7 +1701,7 @@ wakeup:
 static int osc_max_rpc_in_flight(struct client_obd *cli, struct osc_object *osc)
 {
 	int hprpc = !!list_empty(&osc->oo_hp_exts);
-	return rpcs_in_flight(cli) >= cli->cl_max_rpcs_in_flight + hprpc;
+	return rpcs_in_flight(cli) >= osc_rpcs_in_flight_max(cli) + hprpc;
 }
 
 /* This maintains the lists of pending pages to read/write for a given object
@@ -2027,7 +2026,7 @@ static unsigned int get_write_extents(struct osc_object *obj,
 	struct extent_rpc_data data = {
 		.erd_rpc_list	= rpclist,
 		.erd_page_count	= 0,
-		.erd_max_pages	= cli->cl_max_pages_per_rpc,
+		.erd_max_pages	= osc_rpc_pages(cli),
 		.erd_max_chunks	= osc_max_write_chunks(cli),
 		.erd_max_extents = 256,
 	};
@@ -2169,7 +2168,7 @@ __must_hold(osc)
 	struct extent_rpc_data data = {
 		.erd_rpc_list	= &rpclist,
 		.erd_page_count	= 0,
-		.erd_max_pages	= cli->cl_max_pages_per_rpc,
+		.erd_max_pages	= osc_rpc_pages(cli),
 		.erd_max_chunks	= UINT_MAX,
 		.erd_max_extents = UINT_MAX,
 	};
@@ -2725,7 +2724,7 @@ int osc_queue_sync_pages(const struct lu_env *env, struct osc_object *obj,
 	struct osc_extent     *ext;
 	struct osc_async_page *oap;
 	int     page_count = 0;
-	int     mppr       = cli->cl_max_pages_per_rpc;
+	int     mppr       = osc_rpc_pages(cli);
 	bool	can_merge   = true;
 	pgoff_t start      = CL_PAGE_EOF;
 	pgoff_t end        = 0;
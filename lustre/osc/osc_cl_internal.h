@@ -315,9 +315,11 @@ struct osc_lock {
          */
                                  ols_glimpse:1,
         /**
-         * For async glimpse lock.
+         * For async glimpse lock and lock ahead: the lock is enqueued
+         * asynchronously and there is no osc_lock associated with the
+         * granted DLM lock.
          */
-                                 ols_agl:1;
+                                 ols_speculative:1;
 };
 
 
@@ -357,6 +359,10 @@ struct osc_page {
 	 * lru page list. See osc_lru_{del|use}() in osc_page.c for usage.
 	 */
 	struct list_head	ops_lru;
+	/**
+	 * CPU partition of client_obd::cl_lru_parts ops_lru is linked into.
+	 */
+	int			ops_lru_cpt;
 	/**
 	 * Submit time - the time when the page is starting RPC. For debugging.
 	 */
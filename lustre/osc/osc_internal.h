@@ -109,7 +109,8 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		     struct ost_lvb *lvb, int kms_valid,
 		     osc_enqueue_upcall_f upcall,
 		     void *cookie, struct ldlm_enqueue_info *einfo,
-		     struct ptlrpc_request_set *rqset, int async, int agl);
+		     struct ptlrpc_request_set *rqset, int async,
+		     int speculative);
 
 int osc_match_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		   enum ldlm_type type, union ldlm_policy_data *policy,
@@ -129,9 +130,19 @@ int osc_ladvise_base(struct obd_export *exp, struct obdo *oa,
 		     struct ladvise_hdr *ladvise_hdr,
 		     obd_enqueue_update_f upcall, void *cookie,
 		     struct ptlrpc_request_set *rqset);
+/* bytes copied by each OST_COPY RPC, to keep the service time of one RPC
+ * close to that of a BRW */
+#define OSC_COPY_RPC_SIZE	(16 << 20)
+
+int osc_copy_base(struct obd_export *exp, struct obdo *oa,
+		  const struct ost_id *src_oi, __u64 src_off, __u64 dst_off,
+		  __u64 *len);
 int osc_process_config_base(struct obd_device *obd, struct lustre_cfg *cfg);
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  struct list_head *ext_list, int cmd);
+int osc_lru_setup(struct client_obd *cli);
+void osc_lru_precleanup(struct client_obd *cli);
+void osc_lru_cleanup(struct client_obd *cli);
 long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		   long target, bool force);
 unsigned long osc_lru_reserve(struct client_obd *cli, unsigned long npages);
@@ -164,6 +175,26 @@ static inline unsigned long rpcs_in_flight(struct client_obd *cli)
 	return cli->cl_r_in_flight + cli->cl_w_in_flight;
 }
 
+/* RPC size to build, as chosen by the auto-tuning if it is enabled */
+static inline __u32 osc_rpc_pages(const struct client_obd *cli)
+{
+	if (cli->cl_rpc_autotune)
+		return min(cli->cl_rpc_tune.crt_pages_per_rpc,
+			   cli->cl_max_pages_per_rpc);
+	return cli->cl_max_pages_per_rpc;
+}
+
+/* RPCs to keep in flight, as chosen by the auto-tuning if it is enabled */
+static inline __u32 osc_rpcs_in_flight_max(const struct client_obd *cli)
+{
+	if (cli->cl_rpc_autotune)
+		return min(cli->cl_rpc_tune.crt_rpcs_in_flight,
+			   cli->cl_max_rpcs_in_flight);
+	return cli->cl_max_rpcs_in_flight;
+}
+
+void osc_rpc_tune_init(struct client_obd *cli);
+
 static inline char *cli_name(struct client_obd *cli)
 {
 	return cli->cl_import->imp_obd->obd_name;
@@ -99,7 +99,7 @@ static int osc_io_read_ahead(const struct lu_env *env,
 			ldlm_lock_decref(&lockh, dlmlock->l_req_mode);
 		}
 
-		ra->cra_rpc_size = osc_cli(osc)->cl_max_pages_per_rpc;
+		ra->cra_rpc_size = osc_rpc_pages(osc_cli(osc));
 		ra->cra_end = cl_index(osc2cl(osc),
 				       dlmlock->l_policy_data.l_extent.end);
 		ra->cra_release = osc_read_ahead_release;
@@ -143,7 +143,7 @@ static int osc_io_submit(const struct lu_env *env,
 
 	osc = cl2osc(ios->cis_obj);
 	cli = osc_cli(osc);
-	max_pages = cli->cl_max_pages_per_rpc;
+	max_pages = osc_rpc_pages(cli);
 
 	cmd = crt == CRT_WRITE ? OBD_BRW_WRITE : OBD_BRW_READ;
 	brw_flags = osc_io_srvlock(cl2osc_io(env, ios)) ? OBD_BRW_SRVLOCK : 0;
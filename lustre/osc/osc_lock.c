@@ -171,6 +171,10 @@ static __u64 osc_enq2ldlm_flags(__u32 enqflags)
 		result |= LDLM_FL_TEST_LOCK;
 	if (enqflags & CEF_LOCK_MATCH)
 		result |= LDLM_FL_MATCH_LOCK;
+	if (enqflags & CEF_SPECULATIVE)
+		result |= LDLM_FL_SPECULATIVE;
+	if (enqflags & CEF_LOCK_NO_EXPAND)
+		result |= LDLM_FL_NO_EXPANSION;
 	return result;
 }
 
@@ -350,8 +354,9 @@ static int osc_lock_upcall(void *cookie, struct lustre_handle *lockh,
 	RETURN(rc);
 }
 
-static int osc_lock_upcall_agl(void *cookie, struct lustre_handle *lockh,
-			       int errcode)
+static int osc_lock_upcall_speculative(void *cookie,
+				       struct lustre_handle *lockh,
+				       int errcode)
 {
 	struct osc_object	*osc = cookie;
 	struct ldlm_lock	*dlmlock;
@@ -374,7 +379,7 @@ static int osc_lock_upcall_agl(void *cookie, struct lustre_handle *lockh,
 	lock_res_and_lock(dlmlock);
 	LASSERT(dlmlock->l_granted_mode == dlmlock->l_req_mode);
 
-	/* there is no osc_lock associated with AGL lock */
+	/* there is no osc_lock associated with AGL or lock ahead lock */
 	osc_lock_lvb_update(env, osc, dlmlock, NULL);
 
 	unlock_res_and_lock(dlmlock);
@@ -943,11 +948,16 @@ static int osc_lock_enqueue(const struct lu_env *env,
 	if (oscl->ols_state == OLS_GRANTED)
 		RETURN(0);
 
+	/* an old server would expand the lock and revoke conflicting locks */
+	if ((oscl->ols_flags & LDLM_FL_SPECULATIVE) &&
+	    !(exp_connect_flags(osc_export(osc)) & OBD_CONNECT_LOCK_AHEAD))
+		RETURN(-EOPNOTSUPP);
+
 	if (oscl->ols_flags & LDLM_FL_TEST_LOCK)
 		GOTO(enqueue_base, 0);
 
-	if (oscl->ols_glimpse) {
-		LASSERT(equi(oscl->ols_agl, anchor == NULL));
+	if (oscl->ols_glimpse || oscl->ols_speculative) {
+		LASSERT(equi(oscl->ols_speculative, anchor == NULL));
 		async = true;
 		GOTO(enqueue_base, 0);
 	}
@@ -973,17 +983,18 @@ enqueue_base:
 
 	/**
 	 * DLM lock's ast data must be osc_object;
-	 * if glimpse or AGL lock, async of osc_enqueue_base() must be true,
+	 * if glimpse, AGL or lock ahead lock, async of osc_enqueue_base()
+	 * must be true,
 	 * DLM's enqueue callback set to osc_lock_upcall() with cookie as
 	 * osc_lock.
 	 */
 	ostid_build_res_name(&osc->oo_oinfo->loi_oi, resname);
 	osc_lock_build_policy(env, lock, policy);
-	if (oscl->ols_agl) {
+	if (oscl->ols_speculative) {
 		oscl->ols_einfo.ei_cbdata = NULL;
 		/* hold a reference for callback */
 		cl_object_get(osc2cl(osc));
-		upcall = osc_lock_upcall_agl;
+		upcall = osc_lock_upcall_speculative;
 		cookie = osc;
 	}
 	result = osc_enqueue_base(osc_export(osc), resname, &oscl->ols_flags,
@@ -991,7 +1002,7 @@ enqueue_base:
 				  osc->oo_oinfo->loi_kms_valid,
 				  upcall, cookie,
 				  &oscl->ols_einfo, PTLRPCD_SET, async,
-				  oscl->ols_agl);
+				  oscl->ols_speculative);
 	if (result == 0) {
 		if (osc_lock_is_lockless(oscl)) {
 			oio->oi_lockless = 1;
@@ -1000,9 +1011,12 @@ enqueue_base:
 			LASSERT(oscl->ols_hold);
 			LASSERT(oscl->ols_dlmlock != NULL);
 		}
-	} else if (oscl->ols_agl) {
+	} else if (oscl->ols_speculative) {
 		cl_object_put(env, osc2cl(osc));
-		result = 0;
+		/* hide the error for AGL, lock ahead reports it to the
+		 * application, e.g. -ECANCELED if the lock is cached */
+		if (oscl->ols_glimpse)
+			result = 0;
 	}
 
 out:
@@ -1174,8 +1188,8 @@ int osc_lock_init(const struct lu_env *env,
 	INIT_LIST_HEAD(&oscl->ols_nextlock_oscobj);
 
 	oscl->ols_flags = osc_enq2ldlm_flags(enqflags);
-	oscl->ols_agl = !!(enqflags & CEF_AGL);
-	if (oscl->ols_agl)
+	oscl->ols_speculative = !!(enqflags & (CEF_AGL | CEF_SPECULATIVE));
+	if (enqflags & CEF_AGL)
 		oscl->ols_flags |= LDLM_FL_BLOCK_NOWAIT;
 	if (oscl->ols_flags & LDLM_FL_HAS_INTENT) {
 		oscl->ols_flags |= LDLM_FL_BLOCK_GRANTED;
@@ -412,6 +412,59 @@ static void osc_req_attr_set(const struct lu_env *env, struct cl_object *obj,
 	}
 }
 
+static int osc_object_copy(const struct lu_env *env, struct cl_object *obj,
+			   struct cl_object *src, loff_t src_off,
+			   loff_t dst_off, size_t *len)
+{
+	struct osc_object	*dst_osc = cl2osc(obj);
+	struct osc_object	*src_osc;
+	struct obd_export	*exp = osc_export(dst_osc);
+	struct lu_object	*lo;
+	struct obdo		*oa;
+	size_t			 done = 0;
+	int			 rc = 0;
+	ENTRY;
+
+	if (!(exp_connect_flags2(exp) & OBD_CONNECT2_SERVER_COPY))
+		RETURN(-EOPNOTSUPP);
+
+	lo = lu_object_locate(src->co_lu.lo_header, obj->co_lu.lo_dev->ld_type);
+	if (lo == NULL)
+		RETURN(-EOPNOTSUPP);
+	src_osc = cl2osc(lu2cl(lo));
+	if (osc_export(src_osc) != exp)
+		RETURN(-EOPNOTSUPP);
+
+	OBDO_ALLOC(oa);
+	if (oa == NULL)
+		RETURN(-ENOMEM);
+
+	oa->o_oi = dst_osc->oo_oinfo->loi_oi;
+	oa->o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+
+	while (done < *len) {
+		__u64 nob = min_t(size_t, *len - done, OSC_COPY_RPC_SIZE);
+		__u64 want = nob;
+
+		rc = osc_copy_base(exp, oa, &src_osc->oo_oinfo->loi_oi,
+				   src_off + done, dst_off + done, &nob);
+		if (rc != 0)
+			break;
+
+		done += nob;
+		if (nob < want)
+			break;
+	}
+	OBDO_FREE(oa);
+
+	CDEBUG(D_INODE, "copied %zu/%zu bytes to "DOSTID": rc = %d\n",
+	       done, *len, POSTID(&dst_osc->oo_oinfo->loi_oi), rc);
+
+	/* report a partial copy, the error shows up on the next call */
+	*len = done;
+	RETURN(done > 0 ? 0 : rc);
+}
+
 static const struct cl_object_operations osc_ops = {
 	.coo_page_init    = osc_page_init,
 	.coo_lock_init    = osc_lock_init,
@@ -421,6 +474,7 @@ static const struct cl_object_operations osc_ops = {
 	.coo_glimpse      = osc_object_glimpse,
 	.coo_prune        = osc_object_prune,
 	.coo_fiemap       = osc_object_fiemap,
+	.coo_copy         = osc_object_copy,
 	.coo_req_attr_set = osc_req_attr_set
 };
 
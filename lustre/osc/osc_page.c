@@ -393,33 +393,141 @@ static int osc_cache_too_much(struct client_obd *cli)
 	return 0;
 }
 
+static long osc_lru_shrink_part(const struct lu_env *env,
+				struct client_obd *cli,
+				struct cl_lru_part *clp, long target,
+				bool force);
+
+/**
+ * Shrink one LRU partition, queued by lru_queue_work() for each partition
+ * so that they are shrunk in parallel by the ptlrpcd threads.
+ */
+static int lru_part_queue_work(const struct lu_env *env, void *data)
+{
+	struct cl_lru_part *clp = data;
+	struct client_obd *cli = clp->clp_cli;
+	long target = atomic_long_xchg(&clp->clp_target, 0);
+	long rc;
+
+	if (target <= 0)
+		RETURN(0);
+
+	rc = osc_lru_shrink_part(env, cli, clp, target, false);
+	CDEBUG(D_CACHE, "%s: shrank %ld/%ld pages from LRU partition\n",
+	       cli_name(cli), rc, target);
+	if (rc > 0) {
+		atomic_long_add(rc, cli->cl_lru_left);
+		wake_up_all(&osc_lru_waitq);
+	}
+	if (rc >= target) {
+		CDEBUG(D_CACHE, "%s: queue again\n", cli_name(cli));
+		ptlrpcd_queue_work(cli->cl_lru_work);
+	}
+
+	RETURN(0);
+}
+
 int lru_queue_work(const struct lu_env *env, void *data)
 {
 	struct client_obd *cli = data;
-	int count;
+	struct cl_lru_part *clp;
+	long in_list;
+	long count;
+	int i;
 
 	CDEBUG(D_CACHE, "%s: run LRU work for client obd\n", cli_name(cli));
 	count = osc_cache_too_much(cli);
-	if (count > 0) {
-		int rc = osc_lru_shrink(env, cli, count, false);
+	in_list = atomic_long_read(&cli->cl_lru_in_list);
+	if (count <= 0 || in_list <= 0)
+		RETURN(0);
 
-		CDEBUG(D_CACHE, "%s: shrank %d/%d pages from client obd\n",
-		       cli_name(cli), rc, count);
-		if (rc >= count) {
-			CDEBUG(D_CACHE, "%s: queue again\n", cli_name(cli));
-			ptlrpcd_queue_work(cli->cl_lru_work);
-		}
+	/* each partition drops its share of the pages */
+	cfs_percpt_for_each(clp, i, cli->cl_lru_parts) {
+		long nr = clp->clp_count;
+
+		if (nr <= 0)
+			continue;
+
+		atomic_long_add(max(count * nr / in_list, 1L),
+				&clp->clp_target);
+		ptlrpcd_queue_work(clp->clp_work);
 	}
 
 	RETURN(0);
 }
 
+int osc_lru_setup(struct client_obd *cli)
+{
+	struct cl_lru_part *clp;
+	void *handler;
+	int i;
+
+	cli->cl_lru_parts = cfs_percpt_alloc(cfs_cpt_table, sizeof(*clp));
+	if (cli->cl_lru_parts == NULL)
+		return -ENOMEM;
+
+	cfs_percpt_for_each(clp, i, cli->cl_lru_parts) {
+		spin_lock_init(&clp->clp_lock);
+		INIT_LIST_HEAD(&clp->clp_list);
+		clp->clp_count = 0;
+		atomic_set(&clp->clp_shrinkers, 0);
+		clp->clp_cli = cli;
+		atomic_long_set(&clp->clp_target, 0);
+
+		handler = ptlrpcd_alloc_work(cli->cl_import,
+					     lru_part_queue_work, clp);
+		if (IS_ERR(handler)) {
+			osc_lru_cleanup(cli);
+			return PTR_ERR(handler);
+		}
+		clp->clp_work = handler;
+	}
+
+	return 0;
+}
+
+/* the works use the import, so they are stopped in osc_precleanup() */
+void osc_lru_precleanup(struct client_obd *cli)
+{
+	struct cl_lru_part *clp;
+	int i;
+
+	if (cli->cl_lru_parts == NULL)
+		return;
+
+	cfs_percpt_for_each(clp, i, cli->cl_lru_parts) {
+		if (clp->clp_work != NULL) {
+			ptlrpcd_destroy_work(clp->clp_work);
+			clp->clp_work = NULL;
+		}
+	}
+}
+
+void osc_lru_cleanup(struct client_obd *cli)
+{
+	struct cl_lru_part *clp;
+	int i;
+
+	if (cli->cl_lru_parts == NULL)
+		return;
+
+	osc_lru_precleanup(cli);
+	cfs_percpt_for_each(clp, i, cli->cl_lru_parts)
+		LASSERT(list_empty(&clp->clp_list));
+
+	cfs_percpt_free(cli->cl_lru_parts);
+	cli->cl_lru_parts = NULL;
+}
+
 void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 {
 	struct list_head lru = LIST_HEAD_INIT(lru);
 	struct osc_async_page *oap;
+	struct cl_lru_part *clp;
 	long npages = 0;
+	int cpt;
 
+	cpt = cfs_cpt_current(cfs_cpt_table, 1);
 	list_for_each_entry(oap, plist, oap_pending_item) {
 		struct osc_page *opg = oap2osc_page(oap);
 
@@ -429,25 +537,37 @@ void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 		++npages;
 		LASSERT(list_empty(&opg->ops_lru));
 		list_add(&opg->ops_lru, &lru);
+		opg->ops_lru_cpt = cpt;
 	}
 
 	if (npages > 0) {
-		spin_lock(&cli->cl_lru_list_lock);
-		list_splice_tail(&lru, &cli->cl_lru_list);
+		clp = cli->cl_lru_parts[cpt];
+		spin_lock(&clp->clp_lock);
+		list_splice_tail(&lru, &clp->clp_list);
+		clp->clp_count += npages;
+		spin_unlock(&clp->clp_lock);
+
 		atomic_long_sub(npages, &cli->cl_lru_busy);
 		atomic_long_add(npages, &cli->cl_lru_in_list);
 		cli->cl_lru_last_used = ktime_get_real_seconds();
-		spin_unlock(&cli->cl_lru_list_lock);
 
 		if (waitqueue_active(&osc_lru_waitq))
 			(void)ptlrpcd_queue_work(cli->cl_lru_work);
 	}
 }
 
-static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
+static inline struct cl_lru_part *osc_lru_part(struct client_obd *cli,
+					       struct osc_page *opg)
 {
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) > 0);
+	return cli->cl_lru_parts[opg->ops_lru_cpt];
+}
+
+static void __osc_lru_del(struct client_obd *cli, struct cl_lru_part *clp,
+			  struct osc_page *opg)
+{
+	LASSERT(clp->clp_count > 0);
 	list_del_init(&opg->ops_lru);
+	clp->clp_count--;
 	atomic_long_dec(&cli->cl_lru_in_list);
 }
 
@@ -458,14 +578,20 @@ static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
-		if (!list_empty(&opg->ops_lru)) {
-			__osc_lru_del(cli, opg);
-		} else {
+		struct cl_lru_part *clp = osc_lru_part(cli, opg);
+		bool busy = false;
+
+		spin_lock(&clp->clp_lock);
+		if (!list_empty(&opg->ops_lru))
+			__osc_lru_del(cli, clp, opg);
+		else
+			busy = true;
+		spin_unlock(&clp->clp_lock);
+
+		if (busy) {
 			LASSERT(atomic_long_read(&cli->cl_lru_busy) > 0);
 			atomic_long_dec(&cli->cl_lru_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
 
 		atomic_long_inc(cli->cl_lru_left);
 		/* this is a great place to release more LRU pages if
@@ -489,9 +615,11 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 	/* If page is being transferred for the first time,
 	 * ops_lru should be empty */
 	if (opg->ops_in_lru && !list_empty(&opg->ops_lru)) {
-		spin_lock(&cli->cl_lru_list_lock);
-		__osc_lru_del(cli, opg);
-		spin_unlock(&cli->cl_lru_list_lock);
+		struct cl_lru_part *clp = osc_lru_part(cli, opg);
+
+		spin_lock(&clp->clp_lock);
+		__osc_lru_del(cli, clp, opg);
+		spin_unlock(&clp->clp_lock);
 		atomic_long_inc(&cli->cl_lru_busy);
 	}
 }
@@ -537,61 +665,57 @@ static inline bool lru_page_busy(struct client_obd *cli, struct cl_page *page)
 }
 
 /**
- * Drop @target of pages from LRU at most.
+ * Drop @target of pages from LRU partition @clp at most.
  */
-long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
-		   long target, bool force)
+static long osc_lru_shrink_part(const struct lu_env *env,
+				struct client_obd *cli,
+				struct cl_lru_part *clp, long target,
+				bool force)
 {
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
 	struct cl_page **pvec;
 	struct osc_page *opg;
 	long count = 0;
-	int maxscan = 0;
+	long maxscan = 0;
 	int index = 0;
 	int rc = 0;
 	ENTRY;
 
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) >= 0);
-	if (atomic_long_read(&cli->cl_lru_in_list) == 0 || target <= 0)
+	if (clp->clp_count == 0)
 		RETURN(0);
 
-	CDEBUG(D_CACHE, "%s: shrinkers: %d, force: %d\n",
-	       cli_name(cli), atomic_read(&cli->cl_lru_shrinkers), force);
 	if (!force) {
-		if (atomic_read(&cli->cl_lru_shrinkers) > 0)
+		if (atomic_read(&clp->clp_shrinkers) > 0)
 			RETURN(-EBUSY);
 
-		if (atomic_inc_return(&cli->cl_lru_shrinkers) > 1) {
-			atomic_dec(&cli->cl_lru_shrinkers);
+		if (atomic_inc_return(&clp->clp_shrinkers) > 1) {
+			atomic_dec(&clp->clp_shrinkers);
 			RETURN(-EBUSY);
 		}
 	} else {
-		atomic_inc(&cli->cl_lru_shrinkers);
+		atomic_inc(&clp->clp_shrinkers);
 	}
 
 	pvec = (struct cl_page **)osc_env_info(env)->oti_pvec;
 	io = &osc_env_info(env)->oti_io;
 
-	spin_lock(&cli->cl_lru_list_lock);
-	if (force)
-		cli->cl_lru_reclaim++;
-	maxscan = min(target << 1, atomic_long_read(&cli->cl_lru_in_list));
-	while (!list_empty(&cli->cl_lru_list)) {
+	spin_lock(&clp->clp_lock);
+	maxscan = min(target << 1, clp->clp_count);
+	while (!list_empty(&clp->clp_list)) {
 		struct cl_page *page;
 		bool will_free = false;
 
-		if (!force && atomic_read(&cli->cl_lru_shrinkers) > 1)
+		if (!force && atomic_read(&clp->clp_shrinkers) > 1)
 			break;
 
 		if (--maxscan < 0)
 			break;
 
-		opg = list_entry(cli->cl_lru_list.next, struct osc_page,
-				 ops_lru);
+		opg = list_entry(clp->clp_list.next, struct osc_page, ops_lru);
 		page = opg->ops_cl.cpl_page;
 		if (lru_page_busy(cli, page)) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &clp->clp_list);
 			continue;
 		}
 
@@ -600,7 +724,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			struct cl_object *tmp = page->cp_obj;
 
 			cl_object_get(tmp);
-			spin_unlock(&cli->cl_lru_list_lock);
+			spin_unlock(&clp->clp_lock);
 
 			if (clobj != NULL) {
 				discard_pagevec(env, io, pvec, index);
@@ -616,7 +740,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			io->ci_ignore_layout = 1;
 			rc = cl_io_init(env, io, CIT_MISC, clobj);
 
-			spin_lock(&cli->cl_lru_list_lock);
+			spin_lock(&clp->clp_lock);
 
 			if (rc != 0)
 				break;
@@ -629,7 +753,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			if (!lru_page_busy(cli, page)) {
 				/* remove it from lru list earlier to avoid
 				 * lock contention */
-				__osc_lru_del(cli, opg);
+				__osc_lru_del(cli, clp, opg);
 				opg->ops_in_lru = 0; /* will be discarded */
 
 				cl_page_get(page);
@@ -640,24 +764,24 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		}
 
 		if (!will_free) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &clp->clp_list);
 			continue;
 		}
 
-		/* Don't discard and free the page with cl_lru_list held */
+		/* Don't discard and free the page with clp_lock held */
 		pvec[index++] = page;
 		if (unlikely(index == OTI_PVEC_SIZE)) {
-			spin_unlock(&cli->cl_lru_list_lock);
+			spin_unlock(&clp->clp_lock);
 			discard_pagevec(env, io, pvec, index);
 			index = 0;
 
-			spin_lock(&cli->cl_lru_list_lock);
+			spin_lock(&clp->clp_lock);
 		}
 
 		if (++count >= target)
 			break;
 	}
-	spin_unlock(&cli->cl_lru_list_lock);
+	spin_unlock(&clp->clp_lock);
 
 	if (clobj != NULL) {
 		discard_pagevec(env, io, pvec, index);
@@ -666,7 +790,52 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		cl_object_put(env, clobj);
 	}
 
-	atomic_dec(&cli->cl_lru_shrinkers);
+	atomic_dec(&clp->clp_shrinkers);
+	RETURN(count > 0 ? count : rc);
+}
+
+/**
+ * Drop @target of pages from LRU at most.
+ *
+ * Partitions are scanned starting from the one of the current CPT, so that
+ * threads on different CPTs mostly shrink different partitions in parallel.
+ * A non-forced shrinker skips partitions already being shrunk, and returns
+ * -EBUSY if it could not scan any. The background shrink of an OSC using
+ * too many LRU slots shrinks all the partitions at once instead, see
+ * lru_queue_work().
+ */
+long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
+		   long target, bool force)
+{
+	long count = 0;
+	long rc = -EBUSY;
+	int ncpt;
+	int cpt;
+	int i;
+	ENTRY;
+
+	LASSERT(atomic_long_read(&cli->cl_lru_in_list) >= 0);
+	if (atomic_long_read(&cli->cl_lru_in_list) == 0 || target <= 0)
+		RETURN(0);
+
+	CDEBUG(D_CACHE, "%s: target: %ld, force: %d\n",
+	       cli_name(cli), target, force);
+	if (force)
+		cli->cl_lru_reclaim++;
+
+	ncpt = cfs_cpt_number(cfs_cpt_table);
+	cpt = cfs_cpt_current(cfs_cpt_table, 1);
+	for (i = 0; i < ncpt && count < target; i++, cpt = (cpt + 1) % ncpt) {
+		long nr;
+
+		nr = osc_lru_shrink_part(env, cli, cli->cl_lru_parts[cpt],
+					 target - count, force);
+		if (nr > 0)
+			count += nr;
+		else if (nr == 0 || rc == -EBUSY)
+			rc = nr;
+	}
+
 	if (count > 0) {
 		atomic_long_add(count, cli->cl_lru_left);
 		wake_up_all(&osc_lru_waitq);
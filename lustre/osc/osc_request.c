@@ -47,6 +47,7 @@
 #include <lustre_param.h>
 #include <obd.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 
 #include "osc_cl_internal.h"
@@ -70,6 +71,8 @@ struct osc_brw_async_args {
 	struct client_obd	 *aa_cli;
 	struct list_head	  aa_oaps;
 	struct list_head	  aa_exts;
+	/* when the RPC was built, for the RPC auto-tuning */
+	ktime_t			  aa_start;
 };
 
 #define osc_grant_args osc_brw_async_args
@@ -102,7 +105,7 @@ struct osc_enqueue_args {
 	void			*oa_cookie;
 	struct ost_lvb		*oa_lvb;
 	struct lustre_handle	oa_lockh;
-	unsigned int		oa_agl:1;
+	unsigned int		oa_speculative:1;
 };
 
 static void osc_release_ppga(struct brw_page **ppga, size_t count);
@@ -359,6 +362,62 @@ int osc_ladvise_base(struct obd_export *exp, struct obdo *oa,
 	RETURN(0);
 }
 
+/**
+ * Copy \a len bytes at \a src_off of object \a src_oi to \a dst_off of the
+ * object of \a oa with an OST_COPY RPC, and wait for the reply.
+ *
+ * \a len is set to the bytes copied, which is less than requested only at
+ * the end of the source object.
+ */
+int osc_copy_base(struct obd_export *exp, struct obdo *oa,
+		  const struct ost_id *src_oi, __u64 src_off, __u64 dst_off,
+		  __u64 *len)
+{
+	struct ptlrpc_request	*req;
+	struct ost_body		*body;
+	struct ost_copy		*oc;
+	int			 rc;
+	ENTRY;
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_OST_COPY);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_COPY);
+	if (rc != 0) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+	req->rq_request_portal = OST_IO_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body);
+	lustre_set_wire_obdo(&req->rq_import->imp_connect_data, &body->oa,
+			     oa);
+
+	oc = req_capsule_client_get(&req->rq_pill, &RMF_OST_COPY);
+	oc->oc_src_oi = *src_oi;
+	oc->oc_src_offset = src_off;
+	oc->oc_dst_offset = dst_off;
+	oc->oc_length = *len;
+	ptlrpc_request_set_replen(req);
+
+	rc = ptlrpc_queue_wait(req);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	oc = req_capsule_server_get(&req->rq_pill, &RMF_OST_COPY);
+	if (oc == NULL || oc->oc_length > *len)
+		GOTO(out, rc = -EPROTO);
+
+	*len = oc->oc_length;
+	EXIT;
+out:
+	ptlrpc_req_finished(req);
+	return rc;
+}
+
 static int osc_create(const struct lu_env *env, struct obd_export *exp,
 		      struct obdo *oa)
 {
@@ -1053,51 +1112,62 @@ static inline int can_merge_pages(struct brw_page *p1, struct brw_page *p2)
         return (p1->off + p1->count == p2->off);
 }
 
+struct osc_cksum_arg {
+	struct brw_page	**oca_pga;
+	/* the last page may be checksummed partially */
+	int		  oca_last;
+	unsigned int	  oca_last_len;
+};
+
+static void osc_cksum_frag_get(void *data, int idx, struct page **page,
+			       unsigned int *offset, unsigned int *len)
+{
+	struct osc_cksum_arg *arg = data;
+	struct brw_page *pg = arg->oca_pga[idx];
+
+	*page = pg->pg;
+	*offset = pg->off & ~PAGE_MASK;
+	*len = idx == arg->oca_last ? arg->oca_last_len : pg->count;
+}
+
+/**
+ * Checksum the \a nob bytes of \a pga. For T10 PI types the guard tags are
+ * saved in \a guards if it is not NULL.
+ */
 static u32 osc_checksum_bulk(int nob, size_t pg_count,
 			     struct brw_page **pga, int opc,
-			     cksum_type_t cksum_type)
+			     cksum_type_t cksum_type,
+			     __be16 *guards, unsigned int nr_guards)
 {
+	struct osc_cksum_arg		arg = { .oca_pga = pga };
 	u32				cksum;
-	int				i = 0;
-	struct cfs_crypto_hash_desc	*hdesc;
-	unsigned int			bufsize;
-	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
+	int				nr = 0;
+	int				rc;
 
 	LASSERT(pg_count > 0);
 
-	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
-	if (IS_ERR(hdesc)) {
-		CERROR("Unable to initialize checksum hash %s\n",
-		       cfs_crypto_hash_name(cfs_alg));
-		return PTR_ERR(hdesc);
-	}
-
-	while (nob > 0 && pg_count > 0) {
-		unsigned int count = pga[i]->count > nob ? nob : pga[i]->count;
+	/* corrupt the data before we compute the checksum, to
+	 * simulate an OST->client data error */
+	if (nob > 0 && opc == OST_READ &&
+	    OBD_FAIL_CHECK(OBD_FAIL_OSC_CHECKSUM_RECEIVE)) {
+		unsigned char *ptr = kmap(pga[0]->pg);
+		int off = pga[0]->off & ~PAGE_MASK;
 
-		/* corrupt the data before we compute the checksum, to
-		 * simulate an OST->client data error */
-		if (i == 0 && opc == OST_READ &&
-		    OBD_FAIL_CHECK(OBD_FAIL_OSC_CHECKSUM_RECEIVE)) {
-			unsigned char *ptr = kmap(pga[i]->pg);
-			int off = pga[i]->off & ~PAGE_MASK;
+		memcpy(ptr + off, "bad1", min_t(typeof(nob), 4, nob));
+		kunmap(pga[0]->pg);
+	}
 
-			memcpy(ptr + off, "bad1", min_t(typeof(nob), 4, nob));
-			kunmap(pga[i]->pg);
-		}
-		cfs_crypto_hash_update_page(hdesc, pga[i]->pg,
-					    pga[i]->off & ~PAGE_MASK,
-					    count);
-		LL_CDEBUG_PAGE(D_PAGE, pga[i]->pg, "off %d\n",
-			       (int)(pga[i]->off & ~PAGE_MASK));
-
-		nob -= pga[i]->count;
-		pg_count--;
-		i++;
+	while (nob > 0 && nr < pg_count) {
+		arg.oca_last_len = min_t(int, pga[nr]->count, nob);
+		nob -= pga[nr]->count;
+		nr++;
 	}
+	arg.oca_last = nr - 1;
 
-	bufsize = sizeof(cksum);
-	cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
+	rc = obd_cksum_bulk(cksum_type, osc_cksum_frag_get, &arg, nr,
+			    guards, nr_guards, &cksum);
+	if (rc != 0)
+		return rc;
 
 	/* For sending we only compute the wrong checksum instead
 	 * of corrupting the data so it is still correct on a redo */
@@ -1107,6 +1177,157 @@ static u32 osc_checksum_bulk(int nob, size_t pg_count,
 	return cksum;
 }
 
+/**
+ * Compress the \a nob bytes of \a pga into new pages attached to \a desc,
+ * one OBD_COMPR_CHUNK_SIZE chunk at a time. A chunk which doesn't get
+ * smaller is copied raw.
+ *
+ * \retval 1 if the bulk is compressed, \a bch is filled in
+ * \retval 0 if nothing was saved or no compression context was idle, the
+ *	   pages should be sent as they are
+ * \retval negative errno on failure, the pages should be sent as they are
+ */
+static int osc_brw_compress(struct client_obd *cli,
+			    struct ptlrpc_bulk_desc *desc,
+			    struct brw_page **pga, u32 page_count, int nob,
+			    enum obd_compr_type type, struct brw_compr_hdr *bch)
+{
+	struct cl_compr_stats *stats = &cli->cl_compr_stats;
+	struct ptlrpc_compr_ctx *ctx;
+	struct page **spages = NULL;
+	char *src = NULL;
+	char *dst = NULL;
+	unsigned int chunk = OBD_COMPR_CHUNK_SIZE;
+	unsigned int dst_size = OBD_COMPR_BOUND(chunk);
+	unsigned int count = DIV_ROUND_UP(nob, chunk);
+	unsigned int nr_spages = 0;
+	unsigned int nr_raw = 0;
+	unsigned int pgoff = 0;
+	unsigned int done = 0;
+	unsigned int out = 0;
+	unsigned int i;
+	u32 pi = 0;
+	ktime_t start = ktime_get();
+	int rc = 0;
+	ENTRY;
+
+	/* do not allocate a context here, this may run under reclaim */
+	ctx = ptlrpc_compr_get(type, false);
+	if (ctx == NULL) {
+		spin_lock(&stats->ccs_lock);
+		stats->ccs_rpcs_raw++;
+		spin_unlock(&stats->ccs_lock);
+		RETURN(0);
+	}
+
+	OBD_ALLOC_LARGE(src, chunk);
+	OBD_ALLOC_LARGE(dst, dst_size);
+	OBD_ALLOC(spages, page_count * sizeof(*spages));
+	if (src == NULL || dst == NULL || spages == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		unsigned int len = min_t(unsigned int, chunk, nob - done);
+		unsigned int dlen = dst_size;
+		unsigned int n;
+		char *buf;
+
+		/* gather the chunk, pages are contiguous in the file except
+		 * for the first and last one */
+		for (n = 0; n < len; ) {
+			struct brw_page *pg = pga[pi];
+			unsigned int poff = pg->off & ~PAGE_MASK;
+			unsigned int cnt = min(pg->count - pgoff, len - n);
+			char *addr;
+
+			addr = kmap(pg->pg);
+			memcpy(src + n, addr + poff + pgoff, cnt);
+			kunmap(pg->pg);
+			n += cnt;
+			pgoff += cnt;
+			if (pgoff == pg->count) {
+				pi++;
+				pgoff = 0;
+			}
+		}
+		done += len;
+
+		if (ptlrpc_compress(ctx, src, len, dst, &dlen) == 0 &&
+		    dlen < len) {
+			buf = dst;
+		} else {
+			buf = src;
+			dlen = len;
+			nr_raw++;
+		}
+		bch->bch_chunk_len[i] = dlen;
+
+		/* append the chunk to the bulk pages, which can't be more
+		 * than page_count since no chunk grows */
+		for (n = 0; n < dlen; ) {
+			unsigned int soff = out & ~PAGE_MASK;
+			unsigned int cnt = min_t(unsigned int, PAGE_SIZE - soff,
+						 dlen - n);
+
+			if (soff == 0) {
+				LASSERT(nr_spages < page_count);
+				spages[nr_spages] = alloc_page(GFP_NOFS);
+				if (spages[nr_spages] == NULL)
+					GOTO(out, rc = -ENOMEM);
+				nr_spages++;
+			}
+			memcpy(page_address(spages[nr_spages - 1]) + soff,
+			       buf + n, cnt);
+			n += cnt;
+			out += cnt;
+		}
+	}
+
+	if (out >= nob) {
+		spin_lock(&stats->ccs_lock);
+		stats->ccs_rpcs_raw++;
+		spin_unlock(&stats->ccs_lock);
+		GOTO(out, rc = 0);
+	}
+
+	/* the bulk takes its own page references */
+	for (i = 0; i < nr_spages; i++)
+		desc->bd_frag_ops->add_kiov_frag(desc, spages[i], 0,
+				min_t(unsigned int, PAGE_SIZE,
+				      out - i * PAGE_SIZE));
+
+	bch->bch_type = type;
+	bch->bch_chunk_size = chunk;
+	bch->bch_count = count;
+	bch->bch_padding = 0;
+
+	spin_lock(&stats->ccs_lock);
+	stats->ccs_rpcs++;
+	stats->ccs_chunks += count;
+	stats->ccs_chunks_raw += nr_raw;
+	stats->ccs_bytes_in += nob;
+	stats->ccs_bytes_out += out;
+	stats->ccs_usec += ktime_us_delta(ktime_get(), start);
+	spin_unlock(&stats->ccs_lock);
+
+	CDEBUG(D_PAGE, "compressed %d bytes into %u, %u/%u raw chunks\n",
+	       nob, out, nr_raw, count);
+	rc = 1;
+out:
+	if (spages != NULL) {
+		for (i = 0; i < nr_spages; i++)
+			put_page(spages[i]);
+		OBD_FREE(spages, page_count * sizeof(*spages));
+	}
+	if (dst != NULL)
+		OBD_FREE_LARGE(dst, dst_size);
+	if (src != NULL)
+		OBD_FREE_LARGE(src, chunk);
+	ptlrpc_compr_put(ctx);
+
+	RETURN(rc);
+}
+
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 		     u32 page_count, struct brw_page **pga,
@@ -1121,6 +1342,15 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         struct osc_brw_async_args *aa;
         struct req_capsule      *pill;
         struct brw_page *pg_prev;
+	/* store cl_compr_type in a local variable since it can be changed
+	 * via lprocfs */
+	enum obd_compr_type compr_type = cli->cl_compr_type;
+	bool compressed = false;
+	int compr_nob = 0;
+	/* store cl_cksum_type in a local variable since it can be changed
+	 * via lprocfs */
+	cksum_type_t cksum_type = cli->cl_cksum_type;
+	unsigned int nr_guards = 0;
 
         ENTRY;
         if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ))
@@ -1151,6 +1381,33 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
                              niocount * sizeof(*niobuf));
 
+	if (opc != OST_WRITE ||
+	    !(cli->cl_supp_compr_types & obd_compr_type2mask(compr_type)))
+		compr_type = OBD_COMPR_NONE;
+	if (compr_type != OBD_COMPR_NONE) {
+		for (i = 0; i < page_count; i++)
+			compr_nob += pga[i]->count;
+		req_capsule_set_size(pill, &RMF_BRW_COMPR, RCL_CLIENT,
+				     brw_compr_hdr_size(DIV_ROUND_UP(compr_nob,
+							OBD_COMPR_CHUNK_SIZE)));
+	}
+
+	/* send the T10 PI guard tags, so that the OST can tell which sectors
+	 * are damaged on a checksum error */
+	if (opc == OST_WRITE && cli->cl_checksum &&
+	    cksum_type_is_t10(cksum_type)) {
+		for (i = 0; i < page_count; i++)
+			nr_guards += cksum_t10_guards(cksum_type,
+						      pga[i]->off & ~PAGE_MASK,
+						      pga[i]->count);
+		/* fields before RMF_BRW_GUARDS must be sized */
+		if (compr_type == OBD_COMPR_NONE)
+			req_capsule_set_size(pill, &RMF_BRW_COMPR, RCL_CLIENT,
+					     0);
+		req_capsule_set_size(pill, &RMF_BRW_GUARDS, RCL_CLIENT,
+				     nr_guards * sizeof(__be16));
+	}
+
         rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, opc);
         if (rc) {
                 ptlrpc_request_free(req);
@@ -1179,6 +1436,23 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         niobuf = req_capsule_client_get(pill, &RMF_NIOBUF_REMOTE);
         LASSERT(body != NULL && ioobj != NULL && niobuf != NULL);
 
+	if (compr_type != OBD_COMPR_NONE) {
+		struct brw_compr_hdr *bch;
+
+		bch = req_capsule_client_get(pill, &RMF_BRW_COMPR);
+		LASSERT(bch != NULL);
+		/* bulk security flavors wrap the pages themselves */
+		if (!sptlrpc_flavor_has_bulk(&req->rq_flvr))
+			rc = osc_brw_compress(cli, desc, pga, page_count,
+					      compr_nob, compr_type, bch);
+		if (rc > 0)
+			compressed = true;
+		else
+			req_capsule_shrink(pill, &RMF_BRW_COMPR, 0,
+					   RCL_CLIENT);
+		rc = 0;
+	}
+
 	lustre_set_wire_obdo(&req->rq_import->imp_connect_data, &body->oa, oa);
 
 	obdo_to_ioobj(oa, ioobj);
@@ -1214,7 +1488,9 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                 LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
                         (pg->flag & OBD_BRW_SRVLOCK));
 
-		desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff, pg->count);
+		if (!compressed)
+			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
+							 pg->count);
                 requested_nob += pg->count;
 
                 if (i > 0 && can_merge_pages(pg_prev, pg)) {
@@ -1249,9 +1525,11 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         if (opc == OST_WRITE) {
                 if (cli->cl_checksum &&
                     !sptlrpc_flavor_has_bulk(&req->rq_flvr)) {
-                        /* store cl_cksum_type in a local variable since
-                         * it can be changed via lprocfs */
-                        cksum_type_t cksum_type = cli->cl_cksum_type;
+			__be16 *guards = NULL;
+
+			if (nr_guards > 0)
+				guards = req_capsule_client_get(pill,
+							&RMF_BRW_GUARDS);
 
                         if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
                                 oa->o_flags &= OBD_FL_LOCAL_MASK;
@@ -1262,7 +1540,9 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                         body->oa.o_cksum = osc_checksum_bulk(requested_nob,
                                                              page_count, pga,
                                                              OST_WRITE,
-                                                             cksum_type);
+                                                             cksum_type,
+                                                             guards,
+                                                             nr_guards);
                         CDEBUG(D_PAGE, "checksum at write origin: %x\n",
                                body->oa.o_cksum);
                         /* save this in 'oa', too, for later checking */
@@ -1272,6 +1552,9 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                         /* clear out the checksum flag, in case this is a
                          * resend but cl_checksum is no longer set. b=11238 */
                         oa->o_valid &= ~OBD_MD_FLCKSUM;
+			if (nr_guards > 0)
+				req_capsule_shrink(pill, &RMF_BRW_GUARDS, 0,
+						   RCL_CLIENT);
                 }
                 oa->o_cksum = body->oa.o_cksum;
                 /* 1 RC per niobuf */
@@ -1282,7 +1565,7 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
                     !sptlrpc_flavor_has_bulk(&req->rq_flvr)) {
                         if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0)
                                 body->oa.o_flags = 0;
-                        body->oa.o_flags |= cksum_type_pack(cli->cl_cksum_type);
+                        body->oa.o_flags |= cksum_type_pack(cksum_type);
                         body->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
                 }
         }
@@ -1297,6 +1580,7 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         aa->aa_resends = 0;
         aa->aa_ppga = pga;
         aa->aa_cli = cli;
+	aa->aa_start = ktime_get();
 	INIT_LIST_HEAD(&aa->aa_oaps);
 
 	*reqp = req;
@@ -1328,7 +1612,7 @@ static int check_write_checksum(struct obdo *oa, const lnet_process_id_t *peer,
         cksum_type = cksum_type_unpack(oa->o_valid & OBD_MD_FLFLAGS ?
                                        oa->o_flags : 0);
         new_cksum = osc_checksum_bulk(nob, page_count, pga, OST_WRITE,
-                                      cksum_type);
+                                      cksum_type, NULL, 0);
 
         if (cksum_type != client_cksum_type)
                 msg = "the server did not use the checksum type specified in "
@@ -1404,7 +1688,8 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                         CERROR("Unexpected +ve rc %d\n", rc);
                         RETURN(-EPROTO);
                 }
-                LASSERT(req->rq_bulk->bd_nob == aa->aa_requested_nob);
+		/* a compressed bulk is smaller than the requested bytes */
+		LASSERT(req->rq_bulk->bd_nob <= aa->aa_requested_nob);
 
                 if (sptlrpc_cli_unwrap_bulk_write(req, req->rq_bulk))
                         RETURN(-EAGAIN);
@@ -1454,7 +1739,7 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
                                                body->oa.o_flags : 0);
                 client_cksum = osc_checksum_bulk(rc, aa->aa_page_count,
                                                  aa->aa_ppga, OST_READ,
-                                                 cksum_type);
+                                                 cksum_type, NULL, 0);
 
 		if (peer->nid != req->rq_bulk->bd_sender) {
 			via = " via ";
@@ -1558,6 +1843,7 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
 	INIT_LIST_HEAD(&new_aa->aa_exts);
 	list_splice_init(&aa->aa_exts, &new_aa->aa_exts);
 	new_aa->aa_resends = aa->aa_resends;
+	new_aa->aa_start = aa->aa_start;
 
 	list_for_each_entry(oap, &new_aa->aa_oaps, oap_rpc_item) {
                 if (oap->oap_request) {
@@ -1613,6 +1899,120 @@ static void osc_release_ppga(struct brw_page **ppga, size_t count)
         OBD_FREE(ppga, sizeof(*ppga) * count);
 }
 
+/* BRW RPCs per sampling window of the RPC auto-tuning, at least */
+#define OSC_TUNE_WINDOW_RPCS	8
+/* latency over the lowest one seen which is taken as congestion */
+#define OSC_TUNE_CONGESTION	2
+
+/**
+ * Start the RPC auto-tuning from the configured RPC size and depth.
+ * Called under cl_loi_list_lock.
+ */
+void osc_rpc_tune_init(struct client_obd *cli)
+{
+	struct cl_rpc_tune *crt = &cli->cl_rpc_tune;
+
+	crt->crt_pages_per_rpc = cli->cl_max_pages_per_rpc;
+	crt->crt_rpcs_in_flight = cli->cl_max_rpcs_in_flight;
+	crt->crt_rpcs = 0;
+	crt->crt_bytes = 0;
+	crt->crt_usec = 0;
+	crt->crt_start = ktime_get();
+	crt->crt_rate = 0;
+	crt->crt_base_usec = 0;
+}
+
+/**
+ * Account a completed BRW RPC of \a nob bytes built at \a start, and adjust
+ * the RPC size and depth at the end of each sampling window.
+ *
+ * The controller is AIMD: while the throughput does not drop, it grows the
+ * RPC size by steps of 1/8 of cl_max_pages_per_rpc, then the RPCs in flight
+ * one by one. When the latency per MB rises over OSC_TUNE_CONGESTION times
+ * the lowest one seen without a throughput gain, the target is congested and
+ * the RPCs in flight are halved, then the RPC size once a single RPC is left.
+ * Called under cl_loi_list_lock.
+ */
+static void osc_rpc_tune_update(struct client_obd *cli, int nob,
+				ktime_t start)
+{
+	struct cl_rpc_tune *crt = &cli->cl_rpc_tune;
+	ktime_t now = ktime_get();
+	__u32 chunk = 1 << (cli->cl_chunkbits - PAGE_SHIFT);
+	__u32 step;
+	__u64 elapsed;
+	__u64 usec_mb;
+	__u64 rate;
+	bool increase = false;
+	bool decrease = false;
+
+	crt->crt_rpcs++;
+	crt->crt_bytes += nob;
+	crt->crt_usec += max_t(s64, ktime_us_delta(now, start), 0);
+
+	/* a window covers two rounds of the RPCs in flight */
+	if (crt->crt_rpcs < max_t(__u32, 2 * crt->crt_rpcs_in_flight,
+				  OSC_TUNE_WINDOW_RPCS))
+		return;
+
+	elapsed = max_t(s64, ktime_us_delta(now, crt->crt_start), 1);
+	rate = div64_u64(crt->crt_bytes * USEC_PER_SEC, elapsed);
+	usec_mb = div64_u64(crt->crt_usec << 20,
+			    max_t(__u64, crt->crt_bytes, 1));
+
+	/* let the base follow slow changes of the load of the target */
+	if (crt->crt_base_usec == 0 || usec_mb < crt->crt_base_usec)
+		crt->crt_base_usec = usec_mb;
+	else
+		crt->crt_base_usec = min(usec_mb, crt->crt_base_usec +
+					 (crt->crt_base_usec >> 6) + 1);
+
+	crt->crt_pages_per_rpc = min(crt->crt_pages_per_rpc,
+				     cli->cl_max_pages_per_rpc);
+	crt->crt_rpcs_in_flight = min(crt->crt_rpcs_in_flight,
+				      cli->cl_max_rpcs_in_flight);
+	step = max(chunk, (cli->cl_max_pages_per_rpc >> 3) & ~(chunk - 1));
+
+	if (usec_mb > OSC_TUNE_CONGESTION * crt->crt_base_usec &&
+	    rate <= crt->crt_rate) {
+		if (crt->crt_rpcs_in_flight > 1) {
+			crt->crt_rpcs_in_flight >>= 1;
+			decrease = true;
+		} else if (crt->crt_pages_per_rpc > chunk) {
+			crt->crt_pages_per_rpc = max(chunk,
+				(crt->crt_pages_per_rpc >> 1) & ~(chunk - 1));
+			decrease = true;
+		}
+	} else if (rate >= crt->crt_rate) {
+		/* larger RPCs are of no use if the RPCs are not half full */
+		if (crt->crt_pages_per_rpc < cli->cl_max_pages_per_rpc &&
+		    crt->crt_bytes * 2 >= (__u64)crt->crt_rpcs *
+					  crt->crt_pages_per_rpc << PAGE_SHIFT) {
+			crt->crt_pages_per_rpc = min(cli->cl_max_pages_per_rpc,
+					crt->crt_pages_per_rpc + step);
+			increase = true;
+		} else if (crt->crt_rpcs_in_flight <
+			   cli->cl_max_rpcs_in_flight) {
+			crt->crt_rpcs_in_flight++;
+			increase = true;
+		}
+	}
+
+	CDEBUG(D_CACHE, "%s: %llu B/s, %llu usec/MB (base %llu), "
+	       "%u pages per RPC, %u RPCs in flight\n", cli_name(cli),
+	       rate, usec_mb, crt->crt_base_usec, crt->crt_pages_per_rpc,
+	       crt->crt_rpcs_in_flight);
+
+	crt->crt_windows++;
+	crt->crt_increases += increase;
+	crt->crt_decreases += decrease;
+	crt->crt_rate = rate;
+	crt->crt_rpcs = 0;
+	crt->crt_bytes = 0;
+	crt->crt_usec = 0;
+	crt->crt_start = now;
+}
+
 static int brw_interpret(const struct lu_env *env,
                          struct ptlrpc_request *req, void *data, int rc)
 {
@@ -1723,6 +2123,9 @@ static int brw_interpret(const struct lu_env *env,
 		cli->cl_w_in_flight--;
 	else
 		cli->cl_r_in_flight--;
+	if (cli->cl_rpc_autotune && rc == 0)
+		osc_rpc_tune_update(cli, req->rq_bulk->bd_nob_transferred,
+				    aa->aa_start);
 	osc_wake_cache_waiters(cli);
 	spin_unlock(&cli->cl_loi_list_lock);
 
@@ -1945,7 +2348,7 @@ static int osc_set_lock_data(struct ldlm_lock *lock, void *data)
 static int osc_enqueue_fini(struct ptlrpc_request *req,
 			    osc_enqueue_upcall_f upcall, void *cookie,
 			    struct lustre_handle *lockh, enum ldlm_mode mode,
-			    __u64 *flags, int agl, int errcode)
+			    __u64 *flags, int speculative, int errcode)
 {
 	bool intent = *flags & LDLM_FL_HAS_INTENT;
 	int rc;
@@ -1962,7 +2365,7 @@ static int osc_enqueue_fini(struct ptlrpc_request *req,
 			ptlrpc_status_ntoh(rep->lock_policy_res1);
 		if (rep->lock_policy_res1)
 			errcode = rep->lock_policy_res1;
-		if (!agl)
+		if (!speculative)
 			*flags |= LDLM_FL_LVB_READY;
 	} else if (errcode == ELDLM_OK) {
 		*flags |= LDLM_FL_LVB_READY;
@@ -2012,7 +2415,7 @@ static int osc_enqueue_interpret(const struct lu_env *env,
 	/* Let CP AST to grant the lock first. */
 	OBD_FAIL_TIMEOUT(OBD_FAIL_OSC_CP_ENQ_RACE, 1);
 
-	if (aa->oa_agl) {
+	if (aa->oa_speculative) {
 		LASSERT(aa->oa_lvb == NULL);
 		LASSERT(aa->oa_flags == NULL);
 		aa->oa_flags = &flags;
@@ -2024,7 +2427,7 @@ static int osc_enqueue_interpret(const struct lu_env *env,
 				   lockh, rc);
 	/* Complete osc stuff. */
 	rc = osc_enqueue_fini(req, aa->oa_upcall, aa->oa_cookie, lockh, mode,
-			      aa->oa_flags, aa->oa_agl, rc);
+			      aa->oa_flags, aa->oa_speculative, rc);
 
         OBD_FAIL_TIMEOUT(OBD_FAIL_OSC_CP_CANCEL_RACE, 10);
 
@@ -2047,7 +2450,8 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 		     struct ost_lvb *lvb, int kms_valid,
 		     osc_enqueue_upcall_f upcall, void *cookie,
 		     struct ldlm_enqueue_info *einfo,
-		     struct ptlrpc_request_set *rqset, int async, int agl)
+		     struct ptlrpc_request_set *rqset, int async,
+		     int speculative)
 {
 	struct obd_device *obd = exp->exp_obd;
 	struct lustre_handle lockh = { 0 };
@@ -2087,7 +2491,7 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
         mode = einfo->ei_mode;
         if (einfo->ei_mode == LCK_PR)
                 mode |= LCK_PW;
-	if (agl == 0)
+	if (speculative == 0)
 		match_flags |= LDLM_FL_LVB_READY;
 	if (intent != 0)
 		match_flags |= LDLM_FL_BLOCK_GRANTED;
@@ -2100,10 +2504,11 @@ int osc_enqueue_base(struct obd_export *exp, struct ldlm_res_id *res_id,
 			RETURN(ELDLM_OK);
 
 		matched = ldlm_handle2lock(&lockh);
-		if (agl) {
-			/* AGL enqueues DLM locks speculatively. Therefore if
-			 * it already exists a DLM lock, it wll just inform the
-			 * caller to cancel the AGL process for this stripe. */
+		if (speculative) {
+			/* AGL and lock ahead enqueue DLM locks speculatively.
+			 * Therefore if it already exists a DLM lock, it will
+			 * just inform the caller to cancel the speculative
+			 * enqueue for this stripe. */
 			ldlm_lock_decref(&lockh, mode);
 			LDLM_LOCK_PUT(matched);
 			RETURN(-ECANCELED);
@@ -2159,14 +2564,14 @@ no_match:
 			lustre_handle_copy(&aa->oa_lockh, &lockh);
 			aa->oa_upcall = upcall;
 			aa->oa_cookie = cookie;
-			aa->oa_agl    = !!agl;
-			if (!agl) {
+			aa->oa_speculative = !!speculative;
+			if (!speculative) {
 				aa->oa_flags  = flags;
 				aa->oa_lvb    = lvb;
 			} else {
-				/* AGL is essentially to enqueue an DLM lock
-				 * in advance, so we don't care about the
-				 * result of AGL enqueue. */
+				/* AGL and lock ahead are essentially to
+				 * enqueue a DLM lock in advance, so we don't
+				 * care about the result of the enqueue. */
 				aa->oa_lvb    = NULL;
 				aa->oa_flags  = NULL;
 			}
@@ -2184,7 +2589,7 @@ no_match:
 	}
 
 	rc = osc_enqueue_fini(req, upcall, cookie, &lockh, einfo->ei_mode,
-			      flags, agl, rc);
+			      flags, speculative, rc);
 	if (intent)
 		ptlrpc_req_finished(req);
 
@@ -2757,10 +3162,14 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 		GOTO(out_ptlrpcd_work, rc = PTR_ERR(handler));
 	cli->cl_lru_work = handler;
 
-	rc = osc_quota_setup(obd);
+	rc = osc_lru_setup(cli);
 	if (rc)
 		GOTO(out_ptlrpcd_work, rc);
 
+	rc = osc_quota_setup(obd);
+	if (rc)
+		GOTO(out_lru, rc);
+
 	cli->cl_grant_shrink_interval = GRANT_SHRINK_INTERVAL;
 
 #ifdef CONFIG_PROC_FS
@@ -2817,6 +3226,8 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 
 	RETURN(0);
 
+out_lru:
+	osc_lru_cleanup(cli);
 out_ptlrpcd_work:
 	if (cli->cl_writeback_work != NULL) {
 		ptlrpcd_destroy_work(cli->cl_writeback_work);
@@ -2857,6 +3268,7 @@ static int osc_precleanup(struct obd_device *obd)
 		ptlrpcd_destroy_work(cli->cl_lru_work);
 		cli->cl_lru_work = NULL;
 	}
+	osc_lru_precleanup(cli);
 
 	obd_cleanup_client_import(obd);
 	ptlrpc_lprocfs_unregister_obd(obd);
@@ -2886,6 +3298,8 @@ int osc_cleanup(struct obd_device *obd)
 		cli->cl_cache = NULL;
 	}
 
+	osc_lru_cleanup(cli);
+
 	/* free memory of osc quota cache */
 	osc_quota_cleanup(obd);
 
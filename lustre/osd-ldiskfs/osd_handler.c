@@ -344,6 +344,7 @@ static struct lu_object *osd_object_alloc(const struct lu_env *env,
 		init_rwsem(&mo->oo_ext_idx_sem);
 		spin_lock_init(&mo->oo_guard);
 		INIT_LIST_HEAD(&mo->oo_xattr_list);
+		INIT_LIST_HEAD(&mo->oo_prealloc_list);
                 return l;
         } else {
                 return NULL;
@@ -3173,6 +3174,8 @@ static int osd_object_destroy(const struct lu_env *env,
 	if (unlikely(fid_is_acct(fid)))
 		RETURN(-EPERM);
 
+	osd_read_set_drop(env, obj);
+
 	if (S_ISDIR(inode->i_mode)) {
 		LASSERT(osd_inode_unlinked(inode) || inode->i_nlink == 1 ||
 			inode->i_nlink == 2);
@@ -6682,6 +6685,13 @@ static int osd_shutdown(const struct lu_env *env, struct osd_device *o)
 {
 	ENTRY;
 
+	/* drop the references on the streamed objects and of the read page
+	 * sets before the site is purged */
+	cancel_delayed_work_sync(&o->od_prealloc_work);
+	osd_prealloc_release(env, o, true);
+	osd_read_set_shrink(env, o, 0);
+	osd_prefetch_fini(o);
+
 	/* shutdown quota slave instance associated with the device */
 	if (o->od_quota_slave != NULL) {
 		qsd_fini(env, o->od_quota_slave);
@@ -6930,6 +6940,18 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_read_cache = 1;
 	o->od_writethrough_cache = 1;
 	o->od_readcache_max_filesize = OSD_MAX_CACHE_SIZE;
+	o->od_readcache_small_filesize = OSD_CACHE_SMALL_SIZE;
+	o->od_cache_policy = OSD_CACHE_ADAPTIVE;
+	spin_lock_init(&o->od_prealloc_lock);
+	INIT_LIST_HEAD(&o->od_prealloc_list);
+	INIT_DELAYED_WORK(&o->od_prealloc_work, osd_prealloc_work);
+	spin_lock_init(&o->od_read_set_lock);
+	INIT_LIST_HEAD(&o->od_read_set_lru);
+	o->od_read_set_max = OSD_READ_SET_SIZE >> PAGE_SHIFT;
+	spin_lock_init(&o->od_prefetch_lock);
+	INIT_LIST_HEAD(&o->od_prefetch_list);
+	o->od_prefetch_delay = OSD_PREFETCH_DELAY;
+	INIT_DELAYED_WORK(&o->od_prefetch_work, osd_prefetch_work);
 
 	cplen = strlcpy(o->od_svname, lustre_cfg_string(cfg, 4),
 			sizeof(o->od_svname));
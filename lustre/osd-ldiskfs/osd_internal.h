@@ -146,6 +146,62 @@ struct osd_object {
 #endif
 
 	struct list_head	oo_xattr_list;
+
+	/* access history for the adaptive OSS cache, see osd_cache_admit(),
+	 * protected by oo_guard */
+	__u64			oo_cache_next;	/* end of the last I/O */
+	__u64			oo_cache_high;	/* highest offset read */
+	time64_t		oo_cache_time;	/* last access, in seconds */
+	unsigned short		oo_cache_heat;	/* number of re-reads */
+	unsigned short		oo_cache_seq;	/* sequential I/Os in a row */
+
+	/* block allocation of streamed objects, see osd_prealloc_update(),
+	 * protected by oo_guard */
+	__u64			oo_alloc_next;	 /* block after the last write */
+	sector_t		oo_alloc_pblk;	 /* last block written */
+	__u64			oo_prealloc_end; /* end of the reservation */
+	time64_t		oo_alloc_time;	 /* last write, in seconds */
+	unsigned int		oo_alloc_extents; /* extents of the stream */
+	unsigned short		oo_alloc_seq;	 /* sequential writes in a row */
+	/* linkage to od_prealloc_list, protected by od_prealloc_lock */
+	struct list_head	oo_prealloc_list;
+
+	/* pages of the last read of a hot object, protected by oo_guard */
+	struct osd_read_set	*oo_read_set;
+
+	/* pages announced by LU_LADVISE_WILLREAD and not read by a client
+	 * yet, see osd_prefetch_used(), protected by oo_guard */
+	pgoff_t			oo_prefetch_start;
+	pgoff_t			oo_prefetch_end;
+};
+
+/**
+ * Pages of a read kept pinned so the next reads of the same extent of a hot
+ * object reuse them without looking up and locking each page again, see
+ * osd_read_set_add().
+ *
+ * A set is referenced by its object and by od_read_set_lru.
+ */
+struct osd_read_set {
+	struct list_head	 ors_lru;	/* od_read_set_lru */
+	struct osd_object	*ors_obj;
+	atomic_t		 ors_ref;
+	pgoff_t			 ors_index;	/* index of the first page */
+	int			 ors_npages;
+	int			 ors_referenced; /* used since the last scan */
+	struct page		*ors_pages[0];
+};
+
+/**
+ * Extent of an object to read ahead for LU_LADVISE_WILLREAD, queued on
+ * od_prefetch_list until od_prefetch_work issues it, see osd_prefetch_add().
+ */
+struct osd_prefetch {
+	struct list_head	 opf_list;	/* od_prefetch_list */
+	struct inode		*opf_inode;	/* referenced */
+	pgoff_t			 opf_start;	/* first page */
+	pgoff_t			 opf_end;	/* page after the last one */
+	sector_t		 opf_block;	/* disk block of opf_start */
 };
 
 struct osd_obj_seq {
@@ -230,6 +286,14 @@ struct osd_obj_orphan {
 	__u32 oor_ino;
 };
 
+/* how the page cache of the OSS is used for bulk I/O */
+enum osd_cache_policy {
+	/* cache everything smaller than readcache_max_filesize */
+	OSD_CACHE_ALL		= 0,
+	/* cache only small or frequently re-read objects */
+	OSD_CACHE_ADAPTIVE	= 1,
+};
+
 /*
  * osd device.
  */
@@ -267,8 +331,31 @@ struct osd_device {
 	struct osd_mdobj_map	*od_mdt_map;
 
 	unsigned long long	od_readcache_max_filesize;
+	unsigned long long	od_readcache_small_filesize;
 	int			od_read_cache;
 	int			od_writethrough_cache;
+	enum osd_cache_policy	od_cache_policy;
+
+	/* blocks reserved ahead of streaming writers, 0 to disable */
+	unsigned long long	od_prealloc_size;
+	/* streamed objects, released by od_prealloc_work once idle */
+	spinlock_t		od_prealloc_lock;
+	struct list_head	od_prealloc_list;
+	struct delayed_work	od_prealloc_work;
+
+	/* read page sets, the most recently added first */
+	spinlock_t		od_read_set_lock;
+	struct list_head	od_read_set_lru;
+	unsigned long		od_read_set_pages; /* pages in the sets */
+	unsigned long		od_read_set_max;   /* limit, 0 to disable */
+
+	/* WILLREAD extents, issued in disk order by od_prefetch_work after
+	 * od_prefetch_delay ms so that the advices of all clients are merged */
+	spinlock_t		od_prefetch_lock;
+	struct list_head	od_prefetch_list;
+	unsigned int		od_prefetch_count; /* extents queued */
+	unsigned int		od_prefetch_delay;
+	struct delayed_work	od_prefetch_work;
 
 	struct brw_stats	od_brw_stats;
 	atomic_t		od_r_in_flight;
@@ -398,6 +485,15 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+	LPROC_OSD_CACHE_ADMIT	= 7,
+	LPROC_OSD_CACHE_BYPASS	= 8,
+	LPROC_OSD_PREALLOC	= 9,
+	LPROC_OSD_PREALLOC_RELEASE = 10,
+	LPROC_OSD_STREAM_EXTENTS = 11,
+	LPROC_OSD_READ_SET_HIT	= 12,
+	LPROC_OSD_PREFETCH	= 13,
+	LPROC_OSD_PREFETCH_MERGED = 14,
+	LPROC_OSD_PREFETCH_USED	= 15,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
@@ -778,6 +874,12 @@ static inline void i_gid_write(struct inode *inode, gid_t gid)
 # define osd_attach_jinode(inode) 0
 #endif /* HAVE_LDISKFS_INFO_JINODE */
 
+/* uninitialized extents were renamed unwritten extents in 3.15 */
+#ifndef HAVE_EXT4_GET_BLOCKS_UNWRIT
+# define LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT \
+		LDISKFS_GET_BLOCKS_CREATE_UNINIT_EXT
+#endif
+
 #ifdef LDISKFS_HT_MISC
 # define osd_journal_start_sb(sb, type, nblock) \
 		ldiskfs_journal_start_sb(sb, type, nblock)
@@ -854,6 +956,30 @@ static inline int osd_invariant(const struct osd_object *obj)
 #endif
 
 #define OSD_MAX_CACHE_SIZE OBD_OBJECT_EOF
+/* objects up to this size are always cached by the adaptive policy */
+#define OSD_CACHE_SMALL_SIZE	(1ULL << 20)
+/* re-reads after which an object is considered hot */
+#define OSD_CACHE_HOT_READS	2
+/* consecutive sequential I/Os after which an object is streamed */
+#define OSD_CACHE_STREAM_IOS	4
+/* the heat of an object is halved every OSD_CACHE_DECAY seconds */
+#define OSD_CACHE_DECAY		30
+/* maximum size of the block reservation of a streaming writer */
+#define OSD_PREALLOC_MAX	(64ULL << 20)
+/* sequential writes after which blocks are reserved for an object */
+#define OSD_PREALLOC_STREAM	2
+/* seconds without writes after which a reservation is released */
+#define OSD_PREALLOC_IDLE	5
+/* default size of the read page sets */
+#define OSD_READ_SET_SIZE	(64ULL << 20)
+/* the read page sets pin at most this fraction of the free memory */
+#define OSD_READ_SET_FREE_SHARE	16
+/* default delay in ms before the queued WILLREAD extents are issued */
+#define OSD_PREFETCH_DELAY	10
+/* WILLREAD extents queued at most, further advices are ignored */
+#define OSD_PREFETCH_MAX	1024
+/* pages read by each read ahead of a WILLREAD extent */
+#define OSD_PREFETCH_CHUNK	((1024 * 1024) >> PAGE_SHIFT)
 
 extern const struct dt_index_operations osd_otable_ops;
 
@@ -1251,6 +1377,14 @@ void ldiskfs_inc_count(handle_t *handle, struct inode *inode);
 void ldiskfs_dec_count(handle_t *handle, struct inode *inode);
 
 void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf);
+void osd_prealloc_work(struct work_struct *work);
+void osd_prealloc_release(const struct lu_env *env, struct osd_device *osd,
+			  bool all);
+void osd_read_set_drop(const struct lu_env *env, struct osd_object *obj);
+void osd_read_set_shrink(const struct lu_env *env, struct osd_device *osd,
+			 unsigned long target);
+void osd_prefetch_work(struct work_struct *work);
+void osd_prefetch_fini(struct osd_device *osd);
 
 
 #endif /* _OSD_INTERNAL_H */
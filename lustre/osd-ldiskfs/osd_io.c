@@ -44,6 +44,8 @@
 #include <linux/types.h>
 /* prerequisite for linux/xattr.h */
 #include <linux/fs.h>
+/* list_sort() */
+#include <linux/list_sort.h>
 
 /*
  * struct OBD_{ALLOC,FREE}*()
@@ -433,6 +435,249 @@ static struct page *osd_get_page(struct dt_object *dt, loff_t offset, int rw)
         return page;
 }
 
+static void osd_read_set_put(const struct lu_env *env,
+			     struct osd_read_set *set)
+{
+	int i;
+
+	if (!atomic_dec_and_test(&set->ors_ref))
+		return;
+
+	for (i = 0; i < set->ors_npages; i++)
+		put_page(set->ors_pages[i]);
+	lu_object_put(env, &set->ors_obj->oo_dt.do_lu);
+	OBD_FREE_LARGE(set, offsetof(struct osd_read_set,
+				     ors_pages[set->ors_npages]));
+}
+
+/* drop the references of a set just detached from its object */
+static void osd_read_set_unlink(const struct lu_env *env,
+				struct osd_device *osd,
+				struct osd_read_set *set)
+{
+	bool lru = false;
+
+	spin_lock(&osd->od_read_set_lock);
+	if (!list_empty(&set->ors_lru)) {
+		list_del_init(&set->ors_lru);
+		osd->od_read_set_pages -= set->ors_npages;
+		lru = true;
+	}
+	spin_unlock(&osd->od_read_set_lock);
+
+	if (lru)
+		osd_read_set_put(env, set);
+	osd_read_set_put(env, set);
+}
+
+/**
+ * Drop the read page set of \a obj, as its pages may not be those of the
+ * object after a write, a truncate or a cache invalidation.
+ */
+void osd_read_set_drop(const struct lu_env *env, struct osd_object *obj)
+{
+	struct osd_read_set *set;
+
+	if (obj->oo_read_set == NULL)
+		return;
+
+	spin_lock(&obj->oo_guard);
+	set = obj->oo_read_set;
+	obj->oo_read_set = NULL;
+	spin_unlock(&obj->oo_guard);
+
+	if (set != NULL)
+		osd_read_set_unlink(env, osd_obj2dev(obj), set);
+}
+
+/**
+ * Free read page sets until at most \a target pages are pinned.
+ *
+ * The oldest sets are freed first, unless they were used since the last
+ * scan, in which case they are given another round.
+ */
+void osd_read_set_shrink(const struct lu_env *env, struct osd_device *osd,
+			 unsigned long target)
+{
+	struct osd_read_set *set;
+	struct osd_object *obj;
+	bool owner;
+
+	spin_lock(&osd->od_read_set_lock);
+	while (osd->od_read_set_pages > target) {
+		set = list_entry(osd->od_read_set_lru.prev,
+				 struct osd_read_set, ors_lru);
+		if (set->ors_referenced && target != 0) {
+			set->ors_referenced = 0;
+			list_move(&set->ors_lru, &osd->od_read_set_lru);
+			continue;
+		}
+		list_del_init(&set->ors_lru);
+		osd->od_read_set_pages -= set->ors_npages;
+		spin_unlock(&osd->od_read_set_lock);
+
+		/* the reference of the LRU keeps the set and its object */
+		obj = set->ors_obj;
+		spin_lock(&obj->oo_guard);
+		owner = obj->oo_read_set == set;
+		if (owner)
+			obj->oo_read_set = NULL;
+		spin_unlock(&obj->oo_guard);
+
+		if (owner)
+			osd_read_set_put(env, set);
+		osd_read_set_put(env, set);
+
+		spin_lock(&osd->od_read_set_lock);
+	}
+	spin_unlock(&osd->od_read_set_lock);
+}
+
+/* pages the read page sets may pin, within a share of the free memory */
+static unsigned long osd_read_set_limit(struct osd_device *osd)
+{
+	return min_t(unsigned long, osd->od_read_set_max,
+		     global_page_state(NR_FREE_PAGES) / OSD_READ_SET_FREE_SHARE);
+}
+
+/**
+ * Keep the pages of a read of a hot object pinned for the next readers.
+ *
+ * The set covers the contiguous pages from the start of the read which are
+ * up to date and below EOF, and replaces the previous set of the object.
+ * Only objects read again under the adaptive cache policy get a set, so
+ * streaming readers do not pin pages.
+ */
+static void osd_read_set_add(const struct lu_env *env, struct osd_device *osd,
+			     struct osd_object *obj, struct niobuf_local *lnb,
+			     int npages)
+{
+	struct osd_read_set *set;
+	struct osd_read_set *old;
+	pgoff_t index = lnb[0].lnb_page->index;
+	unsigned long limit;
+	bool hot;
+	int n;
+
+	if (osd->od_read_set_max == 0)
+		return;
+
+	spin_lock(&obj->oo_guard);
+	hot = obj->oo_cache_heat >= OSD_CACHE_HOT_READS;
+	spin_unlock(&obj->oo_guard);
+	if (!hot)
+		return;
+
+	for (n = 0; n < npages; n++) {
+		if (lnb[n].lnb_rc <= 0 || !PageUptodate(lnb[n].lnb_page) ||
+		    lnb[n].lnb_page->index != index + n)
+			break;
+	}
+	limit = osd_read_set_limit(osd);
+	if (n == 0 || n > limit)
+		return;
+
+	OBD_ALLOC_LARGE(set, offsetof(struct osd_read_set, ors_pages[n]));
+	if (set == NULL)
+		return;
+
+	INIT_LIST_HEAD(&set->ors_lru);
+	/* references of the object and of the LRU */
+	atomic_set(&set->ors_ref, 2);
+	set->ors_obj = obj;
+	set->ors_index = index;
+	set->ors_npages = n;
+	while (n-- > 0) {
+		set->ors_pages[n] = lnb[n].lnb_page;
+		get_page(set->ors_pages[n]);
+	}
+	lu_object_get(&obj->oo_dt.do_lu);
+
+	/* publish the set before adding it to the LRU, so a set found in
+	 * the LRU is either attached to its object or already dropped */
+	spin_lock(&obj->oo_guard);
+	old = obj->oo_read_set;
+	obj->oo_read_set = set;
+	spin_unlock(&obj->oo_guard);
+
+	spin_lock(&osd->od_read_set_lock);
+	list_add(&set->ors_lru, &osd->od_read_set_lru);
+	osd->od_read_set_pages += set->ors_npages;
+	spin_unlock(&osd->od_read_set_lock);
+
+	if (old != NULL)
+		osd_read_set_unlink(env, osd, old);
+
+	if (osd->od_read_set_pages > limit)
+		osd_read_set_shrink(env, osd, limit);
+}
+
+/**
+ * Fill \a lnb with the pages of the read page set of \a obj if the set
+ * covers all of them. The pages are referenced but not locked.
+ *
+ * A page of the set may have been truncated or invalidated by a local path
+ * which does not drop the set, like reclaim or an ldiskfs truncate, so each
+ * page is checked under its lock. The set is dropped if one is not valid
+ * any more, and the caller looks the pages up again.
+ */
+static bool osd_read_set_get(const struct lu_env *env, struct osd_device *osd,
+			     struct osd_object *obj, struct niobuf_local *lnb,
+			     int npages)
+{
+	struct inode *inode = obj->oo_inode;
+	struct osd_read_set *set;
+	pgoff_t index = lnb[0].lnb_file_offset >> PAGE_SHIFT;
+	struct page *page;
+	bool found = false;
+	bool valid;
+	int i;
+
+	if (obj->oo_read_set == NULL)
+		return false;
+
+	spin_lock(&obj->oo_guard);
+	set = obj->oo_read_set;
+	if (set != NULL && index >= set->ors_index &&
+	    index + npages <= set->ors_index + set->ors_npages) {
+		for (i = 0; i < npages; i++) {
+			lnb[i].lnb_page =
+				set->ors_pages[index - set->ors_index + i];
+			lnb[i].lnb_locked = 0;
+			get_page(lnb[i].lnb_page);
+		}
+		set->ors_referenced = 1;
+		found = true;
+	}
+	spin_unlock(&obj->oo_guard);
+
+	if (!found)
+		return false;
+
+	for (i = 0; i < npages; i++) {
+		page = lnb[i].lnb_page;
+		lock_page(page);
+		valid = page->mapping == inode->i_mapping &&
+			PageUptodate(page);
+		unlock_page(page);
+		if (!valid)
+			break;
+	}
+
+	if (i < npages) {
+		for (i = 0; i < npages; i++) {
+			put_page(lnb[i].lnb_page);
+			lnb[i].lnb_page = NULL;
+		}
+		osd_read_set_drop(env, obj);
+		return false;
+	}
+
+	lprocfs_counter_add(osd->od_stats, LPROC_OSD_READ_SET_HIT, npages);
+
+	return true;
+}
+
 /*
  * there are following "locks":
  * journal_start
@@ -472,8 +717,11 @@ static int osd_bufs_put(const struct lu_env *env, struct dt_object *dt,
 	for (i = 0; i < npages; i++) {
 		if (lnb[i].lnb_page == NULL)
 			continue;
-		LASSERT(PageLocked(lnb[i].lnb_page));
-		unlock_page(lnb[i].lnb_page);
+		if (lnb[i].lnb_locked) {
+			LASSERT(PageLocked(lnb[i].lnb_page));
+			unlock_page(lnb[i].lnb_page);
+			lnb[i].lnb_locked = 0;
+		}
 		put_page(lnb[i].lnb_page);
 		lu_object_put(env, &dt->do_lu);
 		lnb[i].lnb_page = NULL;
@@ -486,7 +734,8 @@ static int osd_bufs_put(const struct lu_env *env, struct dt_object *dt,
  * Load and lock pages undergoing IO
  *
  * Pages as described in the \a lnb array are fetched (from disk or cache)
- * and locked for IO by the caller.
+ * and locked for IO by the caller. The pages of a read covered by the read
+ * page set of the object are only referenced, see osd_read_set_get().
  *
  * DLM locking protects us from write and truncate competing for same region,
  * but partial-page truncate can leave dirty pages in the cache for ldiskfs.
@@ -517,10 +766,18 @@ static int osd_bufs_get(const struct lu_env *env, struct dt_object *dt,
 
 	osd_map_remote_to_local(pos, len, &npages, lnb);
 
+	if (rw == 0 && osd_obj2dev(obj)->od_read_cache &&
+	    osd_read_set_get(env, osd_obj2dev(obj), obj, lnb, npages)) {
+		for (i = 0; i < npages; i++)
+			lu_object_get(&dt->do_lu);
+		RETURN(npages);
+	}
+
 	for (i = 0; i < npages; i++, lnb++) {
 		lnb->lnb_page = osd_get_page(dt, lnb->lnb_file_offset, rw);
 		if (lnb->lnb_page == NULL)
 			GOTO(cleanup, rc = -ENOMEM);
+		lnb->lnb_locked = 1;
 
 		wait_on_page_writeback(lnb->lnb_page);
 		BUG_ON(PageWriteback(lnb->lnb_page));
@@ -934,6 +1191,11 @@ cont_map:
 					*(blocks + total) = 0;
 					total++;
 					break;
+				} else if (!create && (map.m_flags &
+						       LDISKFS_MAP_UNWRITTEN)) {
+					/* reserved by osd_prealloc_reserve(),
+					 * read as a hole */
+					*(blocks + total) = 0;
 				} else {
 					*(blocks + total) = map.m_pblk + c;
 					/* unmap any possible underlying
@@ -965,6 +1227,75 @@ cleanup:
 }
 #endif /* HAVE_LDISKFS_MAP_BLOCKS */
 
+/**
+ * Decide whether the pages of a bulk I/O should be kept in the page cache.
+ *
+ * With the OSD_CACHE_ALL policy every object below readcache_max_filesize is
+ * cached, as long as the read or writethrough cache is enabled. With the
+ * OSD_CACHE_ADAPTIVE policy, the access history of the object is updated
+ * and only small objects, or objects which are read again and are not being
+ * streamed sequentially, are admitted. Other pages are dropped once the I/O
+ * is done, as with direct I/O, so large streaming I/O does not evict the
+ * hot working set from the cache.
+ *
+ * \param[in] osd	OSD device
+ * \param[in] obj	object accessed
+ * \param[in] isize	size of the object
+ * \param[in] start	offset of the I/O
+ * \param[in] end	end of the I/O
+ * \param[in] write	true for a write, false for a read
+ *
+ * 
+etval		true if the pages should be cached
+ */
+static bool osd_cache_admit(struct osd_device *osd, struct osd_object *obj,
+			    loff_t isize, __u64 start, __u64 end, bool write)
+{
+	time64_t now;
+	time64_t age;
+	bool admit;
+
+	if (!(write ? osd->od_writethrough_cache : osd->od_read_cache))
+		return false;
+	if (isize > osd->od_readcache_max_filesize)
+		return false;
+	if (osd->od_cache_policy != OSD_CACHE_ADAPTIVE)
+		return true;
+
+	now = ktime_get_seconds();
+	spin_lock(&obj->oo_guard);
+	age = now - obj->oo_cache_time;
+	if (age >= OSD_CACHE_DECAY) {
+		age /= OSD_CACHE_DECAY;
+		obj->oo_cache_heat = age >= 16 ? 0 : obj->oo_cache_heat >> age;
+	}
+	obj->oo_cache_time = now;
+
+	if (start != 0 && start == obj->oo_cache_next) {
+		if (obj->oo_cache_seq < OSD_CACHE_STREAM_IOS)
+			obj->oo_cache_seq++;
+	} else {
+		obj->oo_cache_seq = 0;
+	}
+	obj->oo_cache_next = end;
+
+	if (!write) {
+		/* reading data already read before */
+		if (start < obj->oo_cache_high &&
+		    obj->oo_cache_heat < USHRT_MAX)
+			obj->oo_cache_heat++;
+		if (end > obj->oo_cache_high)
+			obj->oo_cache_high = end;
+	}
+
+	admit = isize <= osd->od_readcache_small_filesize ||
+		(obj->oo_cache_seq < OSD_CACHE_STREAM_IOS &&
+		 obj->oo_cache_heat >= OSD_CACHE_HOT_READS);
+	spin_unlock(&obj->oo_guard);
+
+	return admit;
+}
+
 static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
                           struct niobuf_local *lnb, int npages)
 {
@@ -977,9 +1308,10 @@ static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
 	s64 timediff;
         ssize_t                 isize;
         __s64                   maxidx;
+	__u64			io_end;
         int                     rc = 0;
         int                     i;
-        int                     cache = 0;
+        bool			cache;
 
         LASSERT(inode);
 
@@ -987,18 +1319,22 @@ static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
 	if (unlikely(rc != 0))
 		RETURN(rc);
 
+	osd_read_set_drop(env, osd_dt_obj(dt));
+
 	isize = i_size_read(inode);
 	maxidx = ((isize + PAGE_SIZE - 1) >> PAGE_SHIFT) - 1;
 
-        if (osd->od_writethrough_cache)
-                cache = 1;
-        if (isize > osd->od_readcache_max_filesize)
-                cache = 0;
+	io_end = lnb[npages - 1].lnb_file_offset + lnb[npages - 1].lnb_len;
+	cache = osd_cache_admit(osd, osd_dt_obj(dt),
+				max_t(loff_t, isize, io_end),
+				lnb[0].lnb_file_offset, io_end, true);
+	lprocfs_counter_add(osd->od_stats, cache ? LPROC_OSD_CACHE_ADMIT :
+			    LPROC_OSD_CACHE_BYPASS, npages);
 
 	start = ktime_get();
 	for (i = 0; i < npages; i++) {
 
-		if (cache == 0)
+		if (!cache)
 			generic_error_remove_page(inode->i_mapping,
 						  lnb[i].lnb_page);
 
@@ -1163,6 +1499,10 @@ static int osd_declare_write_commit(const struct lu_env *env,
                 newblocks += depth;
 		credits++; /* inode */
 		credits += depth * 2 * extents;
+		/* the reservation of a streaming writer, a new extent plus
+		 * a bitmap and a group descriptor */
+		if (osd->od_prealloc_size > 0)
+			credits += depth * 2 + 2;
 	} else {
 		depth = 3;
 		newblocks += depth;
@@ -1210,6 +1550,257 @@ static int osd_declare_write_commit(const struct lu_env *env,
 	RETURN(rc);
 }
 
+#ifdef HAVE_LDISKFS_MAP_BLOCKS
+/**
+ * Reserve \a count blocks from \a start as an unwritten extent of \a obj.
+ *
+ * The reservation is best effort, it is skipped if the transaction has no
+ * credits left for it and allocation failures are ignored.
+ */
+static void osd_prealloc_reserve(struct osd_device *osd,
+				 struct osd_object *obj, handle_t *handle,
+				 __u64 start, __u64 count)
+{
+	struct inode *inode = obj->oo_inode;
+	struct ldiskfs_map_blocks map = { 0 };
+	int credits;
+	int rc;
+
+	if (start + count >= inode->i_sb->s_maxbytes >> inode->i_blkbits)
+		return;
+
+	/* see osd_declare_write_commit() */
+	credits = (max(ext_depth(inode), 1) + 1) * 2 + 2;
+	if (handle->h_buffer_credits < credits)
+		return;
+
+	map.m_lblk = start;
+	map.m_len = count;
+	rc = ldiskfs_map_blocks(handle, inode, &map,
+				LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT);
+	if (rc <= 0) {
+		CDEBUG(D_INODE, "%s: cannot reserve %llu blocks at %llu for "
+		       "inode %lu: rc = %d\n", osd_name(osd), count, start,
+		       inode->i_ino, rc);
+		return;
+	}
+
+	spin_lock(&obj->oo_guard);
+	if (obj->oo_prealloc_end < start + rc)
+		obj->oo_prealloc_end = start + rc;
+	spin_unlock(&obj->oo_guard);
+
+	lprocfs_counter_add(osd->od_stats, LPROC_OSD_PREALLOC, rc);
+}
+#else
+/* the extents are not mapped with ldiskfs_map_blocks(), see
+ * ldiskfs_ext_new_extent_cb() */
+static inline void osd_prealloc_reserve(struct osd_device *osd,
+					struct osd_object *obj,
+					handle_t *handle,
+					__u64 start, __u64 count)
+{
+}
+#endif
+
+/**
+ * Track the block allocation of an object written sequentially.
+ *
+ * A write starting at the block following the previous write of the object
+ * continues a stream. The physical extents written by a stream are counted
+ * and reported in the "stream_extents" stats once the object is idle, to
+ * measure the fragmentation of the objects written this way.
+ *
+ * If prealloc_size is set, the blocks following the writes of a stream are
+ * reserved as an unwritten extent, so that concurrent streaming writers do
+ * not interleave their allocations. The reservation is refilled when less
+ * than half of it is left. Its blocks are read as holes until they are
+ * written, and those left beyond EOF are freed by osd_prealloc_release()
+ * once the object is idle.
+ */
+static void osd_prealloc_update(struct osd_device *osd,
+				struct osd_object *obj,
+				struct osd_iobuf *iobuf,
+				struct thandle *thandle)
+{
+	struct inode *inode = obj->oo_inode;
+	int blocks_per_page = PAGE_SIZE >> inode->i_blkbits;
+	struct page **pages = iobuf->dr_pages;
+	sector_t *blocks = iobuf->dr_blocks;
+	int npages = iobuf->dr_npages;
+	__u64 start = (__u64)pages[0]->index * blocks_per_page;
+	__u64 end = (__u64)(pages[npages - 1]->index + 1) * blocks_per_page;
+	__u64 rstart = 0;
+	__u64 reserve = 0;
+	unsigned int extents = 0;
+	sector_t last = 0;
+	bool track = false;
+	int i;
+	int j;
+
+	for (i = 0; i < npages; i++) {
+		if (i > 0 && pages[i]->index != pages[i - 1]->index + 1)
+			last = 0;
+		for (j = 0; j < blocks_per_page; j++, blocks++) {
+			if (last == 0 || *blocks != last + 1)
+				extents++;
+			last = *blocks;
+		}
+	}
+
+	spin_lock(&obj->oo_guard);
+	if (start == obj->oo_alloc_next) {
+		if (obj->oo_alloc_pblk != 0 &&
+		    iobuf->dr_blocks[0] == obj->oo_alloc_pblk + 1)
+			extents--;
+		if (obj->oo_alloc_seq < USHRT_MAX)
+			obj->oo_alloc_seq++;
+	} else {
+		obj->oo_alloc_seq = 0;
+	}
+	obj->oo_alloc_next = end;
+	obj->oo_alloc_pblk = last;
+	obj->oo_alloc_extents += extents;
+	obj->oo_alloc_time = ktime_get_seconds();
+
+	if (obj->oo_alloc_seq >= OSD_PREALLOC_STREAM) {
+		__u64 size = osd->od_prealloc_size >> inode->i_blkbits;
+
+		track = list_empty(&obj->oo_prealloc_list);
+		if (size > 0 && end + size / 2 > obj->oo_prealloc_end) {
+			rstart = max(end, obj->oo_prealloc_end);
+			reserve = end + size - rstart;
+		}
+	}
+	spin_unlock(&obj->oo_guard);
+
+	if (reserve > 0 && LDISKFS_I(inode)->i_flags & LDISKFS_EXTENTS_FL) {
+		struct osd_thandle *oh = container_of(thandle,
+						      struct osd_thandle,
+						      ot_super);
+
+		osd_prealloc_reserve(osd, obj, oh->ot_handle, rstart, reserve);
+	}
+
+	if (track) {
+		spin_lock(&osd->od_prealloc_lock);
+		if (list_empty(&obj->oo_prealloc_list)) {
+			lu_object_get(&obj->oo_dt.do_lu);
+			list_add_tail(&obj->oo_prealloc_list,
+				      &osd->od_prealloc_list);
+		}
+		spin_unlock(&osd->od_prealloc_lock);
+		schedule_delayed_work(&osd->od_prealloc_work,
+				      cfs_time_seconds(OSD_PREALLOC_IDLE));
+	}
+}
+
+/**
+ * Free the blocks reserved beyond EOF of \a obj and report its extents.
+ *
+ * \retval false	if the object is being written, try again later
+ */
+static bool osd_prealloc_trim(struct osd_device *osd, struct osd_object *obj)
+{
+	struct inode *inode = obj->oo_inode;
+	unsigned int extents;
+	blkcnt_t blocks;
+	__u64 end;
+
+	/* OFD holds oo_sem across a write, from preprw to commitrw */
+	if (!down_write_trylock(&obj->oo_sem))
+		return false;
+
+	spin_lock(&obj->oo_guard);
+	end = obj->oo_prealloc_end;
+	extents = obj->oo_alloc_extents;
+	obj->oo_prealloc_end = 0;
+	obj->oo_alloc_extents = 0;
+	obj->oo_alloc_seq = 0;
+	spin_unlock(&obj->oo_guard);
+
+	if (end != 0 && inode != NULL && !obj->oo_destroyed &&
+	    end > (i_size_read(inode) + (1 << inode->i_blkbits) - 1) >>
+		  inode->i_blkbits) {
+		blocks = inode->i_blocks;
+		/* truncate to the current size frees the blocks beyond it */
+#ifdef HAVE_INODEOPS_TRUNCATE
+		if (inode->i_op->truncate)
+			inode->i_op->truncate(inode);
+		else
+#endif
+			ldiskfs_truncate(inode);
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_PREALLOC_RELEASE,
+				    (blocks - inode->i_blocks) >>
+				    (inode->i_blkbits - 9));
+	}
+	up_write(&obj->oo_sem);
+
+	if (extents > 0)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_STREAM_EXTENTS,
+				    extents);
+
+	return true;
+}
+
+/**
+ * Release the streamed objects of \a osd idle for OSD_PREALLOC_IDLE
+ * seconds, or all of them if \a all is set.
+ */
+void osd_prealloc_release(const struct lu_env *env, struct osd_device *osd,
+			  bool all)
+{
+	struct osd_object *obj;
+	struct osd_object *next;
+	time64_t now = ktime_get_seconds();
+	LIST_HEAD(idle);
+	bool done;
+
+	spin_lock(&osd->od_prealloc_lock);
+	list_for_each_entry_safe(obj, next, &osd->od_prealloc_list,
+				 oo_prealloc_list) {
+		if (all || obj->oo_alloc_time + OSD_PREALLOC_IDLE <= now)
+			list_move_tail(&obj->oo_prealloc_list, &idle);
+	}
+	spin_unlock(&osd->od_prealloc_lock);
+
+	list_for_each_entry_safe(obj, next, &idle, oo_prealloc_list) {
+		done = osd_prealloc_trim(osd, obj) || all;
+
+		spin_lock(&osd->od_prealloc_lock);
+		if (done)
+			list_del_init(&obj->oo_prealloc_list);
+		else
+			list_move_tail(&obj->oo_prealloc_list,
+				       &osd->od_prealloc_list);
+		spin_unlock(&osd->od_prealloc_lock);
+
+		if (done)
+			lu_object_put(env, &obj->oo_dt.do_lu);
+	}
+}
+
+void osd_prealloc_work(struct work_struct *work)
+{
+	struct osd_device *osd = container_of(work, struct osd_device,
+					      od_prealloc_work.work);
+	struct lu_env env;
+	int rc;
+
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc == 0) {
+		osd_prealloc_release(&env, osd, false);
+		lu_env_fini(&env);
+	} else {
+		CERROR("%s: cannot release block reservations: rc = %d\n",
+		       osd_name(osd), rc);
+	}
+
+	if (!list_empty(&osd->od_prealloc_list))
+		schedule_delayed_work(&osd->od_prealloc_work,
+				      cfs_time_seconds(OSD_PREALLOC_IDLE));
+}
+
 /* Check if a block is allocated or not */
 static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
                             struct niobuf_local *lnb, int npages,
@@ -1291,6 +1882,8 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 			spin_unlock(&inode->i_lock);
 		}
 
+		osd_prealloc_update(osd, osd_dt_obj(dt), iobuf, thandle);
+
 		rc = osd_do_bio(osd, inode, iobuf);
 		/* we don't do stats here as in read path because
 		 * write is async: we'll do this in osd_put_bufs() */
@@ -1314,6 +1907,208 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 	RETURN(rc);
 }
 
+static int osd_prefetch_cmp(void *priv, struct list_head *a,
+			    struct list_head *b)
+{
+	struct osd_prefetch *pa = list_entry(a, struct osd_prefetch, opf_list);
+	struct osd_prefetch *pb = list_entry(b, struct osd_prefetch, opf_list);
+
+	if (pa->opf_block < pb->opf_block)
+		return -1;
+	return pa->opf_block > pb->opf_block;
+}
+
+/**
+ * Queue the read ahead of bytes [\a start, \a end) of \a obj for
+ * LU_LADVISE_WILLREAD.
+ *
+ * The advices are kept for od_prefetch_delay ms before they are issued, so
+ * that those of all clients for the same object are merged into a single
+ * extent. The extent is also remembered in the object, to account the pages
+ * later read by clients in the "prefetch_used" stats.
+ *
+ * \retval 0		the extent is queued, merged, or beyond EOF
+ * \retval -ENOMEM	allocation failure
+ */
+static int osd_prefetch_add(struct osd_device *osd, struct osd_object *obj,
+			    __u64 start, __u64 end)
+{
+	struct inode		*inode = obj->oo_inode;
+	struct osd_prefetch	*opf;
+	struct osd_prefetch	*tmp;
+	loff_t			 isize = i_size_read(inode);
+	bool			 queued = false;
+
+	if (!osd->od_read_cache || start >= isize)
+		return 0;
+	if (end > isize)
+		end = isize;
+
+	OBD_ALLOC_PTR(opf);
+	if (opf == NULL)
+		return -ENOMEM;
+
+	opf->opf_start = start >> PAGE_SHIFT;
+	opf->opf_end = (end + PAGE_SIZE - 1) >> PAGE_SHIFT;
+	/* holes sort first, they are not read anyway */
+	opf->opf_block = bmap(inode, (sector_t)opf->opf_start <<
+				     (PAGE_SHIFT - inode->i_blkbits));
+
+	spin_lock(&obj->oo_guard);
+	if (opf->opf_start > obj->oo_prefetch_end ||
+	    opf->opf_end < obj->oo_prefetch_start ||
+	    obj->oo_prefetch_end == 0) {
+		obj->oo_prefetch_start = opf->opf_start;
+		obj->oo_prefetch_end = opf->opf_end;
+	} else {
+		obj->oo_prefetch_start = min(obj->oo_prefetch_start,
+					     opf->opf_start);
+		obj->oo_prefetch_end = max(obj->oo_prefetch_end,
+					   opf->opf_end);
+	}
+	spin_unlock(&obj->oo_guard);
+
+	spin_lock(&osd->od_prefetch_lock);
+	list_for_each_entry(tmp, &osd->od_prefetch_list, opf_list) {
+		if (tmp->opf_inode != inode ||
+		    opf->opf_start > tmp->opf_end ||
+		    opf->opf_end < tmp->opf_start)
+			continue;
+
+		if (opf->opf_start < tmp->opf_start) {
+			tmp->opf_start = opf->opf_start;
+			tmp->opf_block = opf->opf_block;
+		}
+		if (opf->opf_end > tmp->opf_end)
+			tmp->opf_end = opf->opf_end;
+		queued = true;
+		break;
+	}
+	if (!queued && osd->od_prefetch_count < OSD_PREFETCH_MAX) {
+		opf->opf_inode = igrab(inode);
+		if (opf->opf_inode != NULL) {
+			list_add_tail(&opf->opf_list, &osd->od_prefetch_list);
+			osd->od_prefetch_count++;
+			opf = NULL;
+		}
+	}
+	spin_unlock(&osd->od_prefetch_lock);
+
+	if (queued)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_PREFETCH_MERGED, 1);
+	if (opf != NULL)
+		OBD_FREE_PTR(opf);
+	else
+		schedule_delayed_work(&osd->od_prefetch_work,
+				      msecs_to_jiffies(osd->od_prefetch_delay));
+
+	return 0;
+}
+
+/**
+ * Account the pages of a WILLREAD extent of \a obj found in the cache by a
+ * read of pages [\a start, \a end).
+ *
+ * The pages read at either end of the extent are removed from it, so that
+ * the pages of an extent read sequentially are counted once.
+ */
+static void osd_prefetch_used(struct osd_device *osd, struct osd_object *obj,
+			      pgoff_t start, pgoff_t end, int hits)
+{
+	spin_lock(&obj->oo_guard);
+	if (start <= obj->oo_prefetch_start && end > obj->oo_prefetch_start)
+		obj->oo_prefetch_start = min(end, obj->oo_prefetch_end);
+	else if (start < obj->oo_prefetch_end && end >= obj->oo_prefetch_end)
+		obj->oo_prefetch_end = start;
+	if (obj->oo_prefetch_start >= obj->oo_prefetch_end)
+		obj->oo_prefetch_start = obj->oo_prefetch_end = 0;
+	spin_unlock(&obj->oo_guard);
+
+	if (hits != 0)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_PREFETCH_USED,
+				    hits);
+}
+
+static void osd_prefetch_read(struct osd_device *osd, struct osd_prefetch *opf)
+{
+	struct address_space	*mapping = opf->opf_inode->i_mapping;
+	struct file_ra_state	 ra;
+	loff_t			 isize = i_size_read(opf->opf_inode);
+	pgoff_t			 end;
+	pgoff_t			 index;
+	unsigned long		 nr;
+
+	end = min_t(pgoff_t, opf->opf_end,
+		    (isize + PAGE_SIZE - 1) >> PAGE_SHIFT);
+	if (end <= opf->opf_start)
+		return;
+
+	file_ra_state_init(&ra, mapping);
+	ra.ra_pages = OSD_PREFETCH_CHUNK;
+	for (index = opf->opf_start; index < end; index += nr) {
+		nr = min_t(pgoff_t, end - index, OSD_PREFETCH_CHUNK);
+		/* pages already cached are skipped, the others are read
+		 * by large bios without waiting for the I/O */
+		page_cache_sync_readahead(mapping, &ra, NULL, index, nr);
+	}
+	lprocfs_counter_add(osd->od_stats, LPROC_OSD_PREFETCH,
+			    end - opf->opf_start);
+}
+
+/**
+ * Issue the WILLREAD extents queued by osd_prefetch_add() sorted by disk
+ * block, under a single plug so that neighbouring extents are merged by
+ * the block layer.
+ */
+void osd_prefetch_work(struct work_struct *work)
+{
+	struct osd_device	*osd = container_of(work, struct osd_device,
+						    od_prefetch_work.work);
+	struct osd_prefetch	*opf;
+	struct osd_prefetch	*tmp;
+	struct blk_plug		 plug;
+	LIST_HEAD(list);
+
+	spin_lock(&osd->od_prefetch_lock);
+	list_splice_init(&osd->od_prefetch_list, &list);
+	osd->od_prefetch_count = 0;
+	spin_unlock(&osd->od_prefetch_lock);
+
+	list_sort(NULL, &list, osd_prefetch_cmp);
+
+	blk_start_plug(&plug);
+	list_for_each_entry_safe(opf, tmp, &list, opf_list) {
+		list_del(&opf->opf_list);
+		osd_prefetch_read(osd, opf);
+		iput(opf->opf_inode);
+		OBD_FREE_PTR(opf);
+	}
+	blk_finish_plug(&plug);
+}
+
+/* drop the WILLREAD extents not issued yet, on umount */
+void osd_prefetch_fini(struct osd_device *osd)
+{
+	struct osd_prefetch *opf;
+
+	cancel_delayed_work_sync(&osd->od_prefetch_work);
+
+	spin_lock(&osd->od_prefetch_lock);
+	while (!list_empty(&osd->od_prefetch_list)) {
+		opf = list_entry(osd->od_prefetch_list.next,
+				 struct osd_prefetch, opf_list);
+		list_del(&opf->opf_list);
+		spin_unlock(&osd->od_prefetch_lock);
+
+		iput(opf->opf_inode);
+		OBD_FREE_PTR(opf);
+
+		spin_lock(&osd->od_prefetch_lock);
+	}
+	osd->od_prefetch_count = 0;
+	spin_unlock(&osd->od_prefetch_lock);
+}
+
 static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
                          struct niobuf_local *lnb, int npages)
 {
@@ -1321,7 +2116,10 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
         struct osd_iobuf *iobuf = &oti->oti_iobuf;
         struct inode *inode = osd_dt_obj(dt)->oo_inode;
         struct osd_device *osd = osd_obj2dev(osd_dt_obj(dt));
+	struct osd_object *obj = osd_dt_obj(dt);
 	int rc = 0, i, cache = 0, cache_hits = 0, cache_misses = 0;
+	int prefetch_hits = 0;
+	pgoff_t prefetch_start = 0, prefetch_end = 0;
 	ktime_t start, end;
 	s64 timediff;
 	loff_t isize;
@@ -1332,12 +2130,19 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 	if (unlikely(rc != 0))
 		RETURN(rc);
 
+	if (obj->oo_prefetch_end != 0) {
+		spin_lock(&obj->oo_guard);
+		prefetch_start = obj->oo_prefetch_start;
+		prefetch_end = obj->oo_prefetch_end;
+		spin_unlock(&obj->oo_guard);
+	}
+
 	isize = i_size_read(inode);
 
-	if (osd->od_read_cache)
-		cache = 1;
-	if (isize > osd->od_readcache_max_filesize)
-		cache = 0;
+	cache = osd_cache_admit(osd, osd_dt_obj(dt), isize,
+				lnb[0].lnb_file_offset,
+				lnb[npages - 1].lnb_file_offset +
+				lnb[npages - 1].lnb_len, false);
 
 	start = ktime_get();
 	for (i = 0; i < npages; i++) {
@@ -1354,12 +2159,22 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 
 		if (PageUptodate(lnb[i].lnb_page)) {
 			cache_hits++;
+			if (lnb[i].lnb_page->index >= prefetch_start &&
+			    lnb[i].lnb_page->index < prefetch_end)
+				prefetch_hits++;
 		} else {
+			/* a page of a read set was up to date when it was
+			 * found, it is only read again if it was invalidated
+			 * since */
+			if (!lnb[i].lnb_locked) {
+				lock_page(lnb[i].lnb_page);
+				lnb[i].lnb_locked = 1;
+			}
 			cache_misses++;
 			osd_iobuf_add_page(iobuf, lnb[i].lnb_page);
 		}
 
-		if (cache == 0)
+		if (cache == 0 && lnb[i].lnb_locked)
 			generic_error_remove_page(inode->i_mapping,
 						  lnb[i].lnb_page);
 	}
@@ -1373,9 +2188,18 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 	if (cache_misses != 0)
 		lprocfs_counter_add(osd->od_stats, LPROC_OSD_CACHE_MISS,
 				    cache_misses);
-	if (cache_hits + cache_misses != 0)
+	if (cache_hits + cache_misses != 0) {
 		lprocfs_counter_add(osd->od_stats, LPROC_OSD_CACHE_ACCESS,
 				    cache_hits + cache_misses);
+		lprocfs_counter_add(osd->od_stats, cache ?
+				    LPROC_OSD_CACHE_ADMIT :
+				    LPROC_OSD_CACHE_BYPASS,
+				    cache_hits + cache_misses);
+	}
+	if (prefetch_end != 0)
+		osd_prefetch_used(osd, obj, lnb[0].lnb_page->index,
+				  lnb[npages - 1].lnb_page->index + 1,
+				  prefetch_hits);
 
         if (iobuf->dr_npages) {
 		rc = osd_ldiskfs_map_inode_pages(inode, iobuf->dr_pages,
@@ -1386,6 +2210,19 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
                 /* IO stats will be done in osd_bufs_put() */
         }
 
+	if (rc == 0 && cache && lnb[0].lnb_locked)
+		osd_read_set_add(env, osd, osd_dt_obj(dt), lnb, npages);
+
+	/* the pages are not modified before the bulk is sent, as writers
+	 * conflict with the DLM lock of the reader, so concurrent readers
+	 * of the same pages do not wait for each other */
+	for (i = 0; i < npages; i++) {
+		if (lnb[i].lnb_locked) {
+			unlock_page(lnb[i].lnb_page);
+			lnb[i].lnb_locked = 0;
+		}
+	}
+
         RETURN(rc);
 }
 
@@ -1756,6 +2593,8 @@ static ssize_t osd_write(const struct lu_env *env, struct dt_object *dt,
         LASSERT(oh->ot_handle->h_transaction != NULL);
 	osd_trans_exec_op(env, handle, OSD_OT_WRITE);
 
+	osd_read_set_drop(env, osd_dt_obj(dt));
+
 	/* Write small symlink to inode body as we need to maintain correct
 	 * on-disk symlinks for ldiskfs.
 	 * Note: the buf->lb_buf contains a NUL terminator while buf->lb_len
@@ -1829,6 +2668,8 @@ static int osd_punch(const struct lu_env *env, struct dt_object *dt,
 
 	osd_trans_exec_op(env, th, OSD_OT_PUNCH);
 
+	osd_read_set_drop(env, obj);
+
 	tid = oh->ot_handle->h_transaction->t_tid;
 
 	spin_lock(&inode->i_lock);
@@ -1940,13 +2781,20 @@ static int osd_ladvise(const struct lu_env *env, struct dt_object *dt,
 		       __u64 start, __u64 end, enum lu_ladvise_type advice)
 {
 	int		 rc = 0;
-	struct inode	*inode = osd_dt_obj(dt)->oo_inode;
+	struct osd_object *obj = osd_dt_obj(dt);
+	struct inode	*inode = obj->oo_inode;
 	ENTRY;
 
 	switch (advice) {
+	case LU_LADVISE_WILLREAD:
+		if (end <= start)
+			break;
+		rc = osd_prefetch_add(osd_obj2dev(obj), obj, start, end);
+		break;
 	case LU_LADVISE_DONTNEED:
 		if (end == 0)
 			break;
+		osd_read_set_drop(env, obj);
 		invalidate_mapping_pages(inode->i_mapping,
 					 start >> PAGE_CACHE_SHIFT,
 					 (end - 1) >> PAGE_CACHE_SHIFT);
@@ -216,6 +216,33 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_ADMIT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "cache_admit", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_BYPASS,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "cache_bypass", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_PREALLOC,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "prealloc", "blocks");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_PREALLOC_RELEASE,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "prealloc_release", "blocks");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_STREAM_EXTENTS,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "stream_extents", "extents");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_READ_SET_HIT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "read_set_hit", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_PREFETCH,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "prefetch", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_PREFETCH_MERGED,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "prefetch_merged", "reqs");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_PREFETCH_USED,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "prefetch_used", "pages");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
@@ -566,6 +593,221 @@ ldiskfs_osd_readcache_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(ldiskfs_osd_readcache);
 
+static int ldiskfs_osd_readcache_small_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%llu\n", osd->od_readcache_small_filesize);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_readcache_small_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	__s64 val;
+	int rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_str_with_units_to_s64(buffer, count, &val, '1');
+	if (rc)
+		return rc;
+	if (val < 0)
+		return -ERANGE;
+
+	osd->od_readcache_small_filesize = val > OSD_MAX_CACHE_SIZE ?
+					   OSD_MAX_CACHE_SIZE : val;
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_readcache_small);
+
+static const char *osd_cache_policy_names[] = {
+	[OSD_CACHE_ALL]		= "all",
+	[OSD_CACHE_ADAPTIVE]	= "adaptive",
+};
+
+static int ldiskfs_osd_cache_policy_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%s\n", osd_cache_policy_names[osd->od_cache_policy]);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_cache_policy_seq_write(struct file *file,
+				   const char __user *buffer,
+				   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	char kernbuf[16];
+	int i;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	if (count == 0 || count >= sizeof(kernbuf))
+		return -EINVAL;
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	kernbuf[count] = '\0';
+	if (kernbuf[count - 1] == '\n')
+		kernbuf[count - 1] = '\0';
+
+	for (i = 0; i < ARRAY_SIZE(osd_cache_policy_names); i++) {
+		if (strcmp(kernbuf, osd_cache_policy_names[i]) == 0) {
+			osd->od_cache_policy = i;
+			return count;
+		}
+	}
+
+	return -EINVAL;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_cache_policy);
+
+static int ldiskfs_osd_prealloc_size_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%llu\n", osd->od_prealloc_size);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_prealloc_size_seq_write(struct file *file,
+				    const char __user *buffer,
+				    size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	__s64 val;
+	int rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_str_with_units_to_s64(buffer, count, &val, '1');
+	if (rc)
+		return rc;
+	if (val < 0 || val > OSD_PREALLOC_MAX)
+		return -ERANGE;
+
+	osd->od_prealloc_size = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_prealloc_size);
+
+static int ldiskfs_osd_read_set_cache_size_seq_show(struct seq_file *m,
+						    void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%llu\n",
+		   (unsigned long long)osd->od_read_set_max << PAGE_SHIFT);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_read_set_cache_size_seq_write(struct file *file,
+					  const char __user *buffer,
+					  size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	struct lu_env env;
+	__s64 val;
+	int rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_str_with_units_to_s64(buffer, count, &val, '1');
+	if (rc)
+		return rc;
+	if (val < 0)
+		return -ERANGE;
+
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc)
+		return rc;
+
+	osd->od_read_set_max = val >> PAGE_SHIFT;
+	osd_read_set_shrink(&env, osd, osd->od_read_set_max);
+	lu_env_fini(&env);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_read_set_cache_size);
+
+static int ldiskfs_osd_prefetch_delay_ms_seq_show(struct seq_file *m,
+						  void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%u\n", osd->od_prefetch_delay);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_prefetch_delay_ms_seq_write(struct file *file,
+					const char __user *buffer,
+					size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	__s64 val;
+	int rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_str_to_s64(buffer, count, &val);
+	if (rc)
+		return rc;
+	if (val < 0 || val > MSEC_PER_SEC)
+		return -ERANGE;
+
+	osd->od_prefetch_delay = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_prefetch_delay_ms);
+
 #if LUSTRE_VERSION_CODE < OBD_OCD_VERSION(3, 0, 52, 0)
 static int ldiskfs_osd_index_in_idif_seq_show(struct seq_file *m, void *data)
 {
@@ -687,6 +929,16 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	  .fops	=	&ldiskfs_osd_wcache_fops	},
 	{ .name	=	"readcache_max_filesize",
 	  .fops	=	&ldiskfs_osd_readcache_fops	},
+	{ .name	=	"readcache_small_filesize",
+	  .fops	=	&ldiskfs_osd_readcache_small_fops	},
+	{ .name	=	"cache_policy",
+	  .fops	=	&ldiskfs_osd_cache_policy_fops	},
+	{ .name	=	"prealloc_size",
+	  .fops	=	&ldiskfs_osd_prealloc_size_fops	},
+	{ .name	=	"read_set_cache_size",
+	  .fops	=	&ldiskfs_osd_read_set_cache_size_fops	},
+	{ .name	=	"prefetch_delay_ms",
+	  .fops	=	&ldiskfs_osd_prefetch_delay_ms_fops	},
 	{ NULL }
 };
 
@@ -1125,15 +1125,15 @@ void ptlrpc_set_add_new_req(struct ptlrpcd_ctl *pc,
 	spin_unlock(&set->set_new_req_lock);
 
 	/* Only need to call wakeup once for the first entry. */
-	if (count == 1) {
+	if (count == 1)
 		wake_up(&set->set_waitq);
 
-		/* XXX: It maybe unnecessary to wakeup all the partners. But to
-		 *      guarantee the async RPC can be processed ASAP, we have
-		 *      no other better choice. It maybe fixed in future. */
+	/* The partners are only woken up when a second request is queued
+	 * before the thread took the first one, i.e. it is busy, so that the
+	 * requests stay on the NUMA node they were placed on otherwise. */
+	if (count == 2)
 		for (i = 0; i < pc->pc_npartners; i++)
 			wake_up(&pc->pc_partners[i]->pc_set->set_waitq);
-	}
 }
 
 /**
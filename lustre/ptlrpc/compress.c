@@ -0,0 +1,255 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/ptlrpc/compress.c
+ *
+ * Compression of BRW bulk data through the kernel crypto API.
+ *
+ * A crypto_comp transform keeps its work memory in the transform itself, so
+ * it can not be used by two threads at once. Allocating one is expensive
+ * (deflate needs a few hundred KB of workspace) and may enter reclaim, so
+ * idle transforms are kept in a small per-algorithm pool, which is filled
+ * by ptlrpc_compr_pool_setup() before an algorithm is used.
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+
+#include <linux/crypto.h>
+#include <obd_support.h>
+#include <obd_compress.h>
+
+#include "ptlrpc_internal.h"
+
+struct ptlrpc_compr_ctx {
+	struct list_head	 pcc_list;
+	enum obd_compr_type	 pcc_type;
+	struct crypto_comp	*pcc_tfm;
+};
+
+struct ptlrpc_compr_pool {
+	spinlock_t		 pcp_lock;
+	struct list_head	 pcp_idle;
+	int			 pcp_nr_idle;
+};
+
+static const char *ptlrpc_compr_alg[OBD_COMPR_MAX] = {
+	[OBD_COMPR_LZ4]		= "lz4",
+	[OBD_COMPR_LZO]		= "lzo",
+	[OBD_COMPR_DEFLATE]	= "deflate",
+};
+
+static struct ptlrpc_compr_pool ptlrpc_compr_pools[OBD_COMPR_MAX];
+static __u32 ptlrpc_compr_supported;
+
+/**
+ * Mask of the OBD_COMPR_* algorithms available on this node, to be
+ * negotiated in ocd_compr_types.
+ */
+__u32 ptlrpc_compr_types_supported(void)
+{
+	return ptlrpc_compr_supported;
+}
+EXPORT_SYMBOL(ptlrpc_compr_types_supported);
+
+static struct ptlrpc_compr_ctx *
+ptlrpc_compr_ctx_alloc(enum obd_compr_type type)
+{
+	struct ptlrpc_compr_ctx *ctx;
+
+	OBD_ALLOC_PTR(ctx);
+	if (ctx == NULL)
+		return NULL;
+
+	ctx->pcc_tfm = crypto_alloc_comp(ptlrpc_compr_alg[type], 0, 0);
+	if (IS_ERR(ctx->pcc_tfm)) {
+		CERROR("cannot allocate %s compressor: rc = %ld\n",
+		       ptlrpc_compr_alg[type], PTR_ERR(ctx->pcc_tfm));
+		OBD_FREE_PTR(ctx);
+		return NULL;
+	}
+	INIT_LIST_HEAD(&ctx->pcc_list);
+	ctx->pcc_type = type;
+
+	return ctx;
+}
+
+static void ptlrpc_compr_ctx_free(struct ptlrpc_compr_ctx *ctx)
+{
+	crypto_free_comp(ctx->pcc_tfm);
+	OBD_FREE_PTR(ctx);
+}
+
+/**
+ * Fill the pools of the algorithms in the \a types mask up to one idle
+ * context per online CPU. It must be called from a context which may
+ * allocate, before the algorithms are used for I/O.
+ *
+ * \retval -ENOMEM if the pool of one of the algorithms is still empty
+ */
+int ptlrpc_compr_pool_setup(__u32 types)
+{
+	struct ptlrpc_compr_pool *pool;
+	struct ptlrpc_compr_ctx *ctx;
+	int rc = 0;
+	int i;
+
+	for (i = 0; i < OBD_COMPR_MAX; i++) {
+		if (!(types & ptlrpc_compr_supported &
+		      obd_compr_type2mask(i)))
+			continue;
+
+		pool = &ptlrpc_compr_pools[i];
+		while (ACCESS_ONCE(pool->pcp_nr_idle) < num_online_cpus()) {
+			ctx = ptlrpc_compr_ctx_alloc(i);
+			if (ctx == NULL)
+				break;
+			ptlrpc_compr_put(ctx);
+		}
+		if (ACCESS_ONCE(pool->pcp_nr_idle) == 0)
+			rc = -ENOMEM;
+	}
+
+	return rc;
+}
+EXPORT_SYMBOL(ptlrpc_compr_pool_setup);
+
+/**
+ * Get a compression context for \a type from the pool.
+ *
+ * If the pool is empty, a new context is only allocated if \a alloc is set.
+ * The client write path may run under memory reclaim, so it does not
+ * allocate and sends the data uncompressed instead. The server can not
+ * decompress a bulk without a context, so it allocates one.
+ *
+ * \retval NULL if the algorithm is not supported, if the pool is empty and
+ *	   \a alloc is not set, or on allocation failure
+ */
+struct ptlrpc_compr_ctx *ptlrpc_compr_get(enum obd_compr_type type,
+					  bool alloc)
+{
+	struct ptlrpc_compr_pool *pool;
+	struct ptlrpc_compr_ctx *ctx = NULL;
+
+	if (!(ptlrpc_compr_supported & obd_compr_type2mask(type)))
+		return NULL;
+
+	pool = &ptlrpc_compr_pools[type];
+	spin_lock(&pool->pcp_lock);
+	if (!list_empty(&pool->pcp_idle)) {
+		ctx = list_entry(pool->pcp_idle.next, struct ptlrpc_compr_ctx,
+				 pcc_list);
+		list_del_init(&ctx->pcc_list);
+		pool->pcp_nr_idle--;
+	}
+	spin_unlock(&pool->pcp_lock);
+	if (ctx == NULL && alloc)
+		ctx = ptlrpc_compr_ctx_alloc(type);
+
+	return ctx;
+}
+EXPORT_SYMBOL(ptlrpc_compr_get);
+
+/**
+ * Return a context got from ptlrpc_compr_get(). At most one idle context
+ * per online CPU is kept.
+ */
+void ptlrpc_compr_put(struct ptlrpc_compr_ctx *ctx)
+{
+	struct ptlrpc_compr_pool *pool = &ptlrpc_compr_pools[ctx->pcc_type];
+
+	spin_lock(&pool->pcp_lock);
+	if (pool->pcp_nr_idle < num_online_cpus()) {
+		list_add(&ctx->pcc_list, &pool->pcp_idle);
+		pool->pcp_nr_idle++;
+		ctx = NULL;
+	}
+	spin_unlock(&pool->pcp_lock);
+
+	if (ctx != NULL)
+		ptlrpc_compr_ctx_free(ctx);
+}
+EXPORT_SYMBOL(ptlrpc_compr_put);
+
+/**
+ * Compress \a slen bytes of \a src into \a dst.
+ *
+ * \a dst must be at least OBD_COMPR_BOUND(\a slen) bytes, \a dlen is set to
+ * the compressed length on return.
+ */
+int ptlrpc_compress(struct ptlrpc_compr_ctx *ctx, const void *src,
+		    unsigned int slen, void *dst, unsigned int *dlen)
+{
+	LASSERT(*dlen >= OBD_COMPR_BOUND(slen));
+
+	return crypto_comp_compress(ctx->pcc_tfm, src, slen, dst, dlen);
+}
+EXPORT_SYMBOL(ptlrpc_compress);
+
+/**
+ * Decompress \a slen bytes of \a src into \a dst of \a dlen bytes.
+ *
+ * \a dlen is set to the decompressed length on return.
+ */
+int ptlrpc_decompress(struct ptlrpc_compr_ctx *ctx, const void *src,
+		      unsigned int slen, void *dst, unsigned int *dlen)
+{
+	return crypto_comp_decompress(ctx->pcc_tfm, src, slen, dst, dlen);
+}
+EXPORT_SYMBOL(ptlrpc_decompress);
+
+void ptlrpc_compr_init(void)
+{
+	int i;
+
+	for (i = 0; i < OBD_COMPR_MAX; i++) {
+		spin_lock_init(&ptlrpc_compr_pools[i].pcp_lock);
+		INIT_LIST_HEAD(&ptlrpc_compr_pools[i].pcp_idle);
+		ptlrpc_compr_pools[i].pcp_nr_idle = 0;
+
+		if (ptlrpc_compr_alg[i] != NULL &&
+		    crypto_has_comp(ptlrpc_compr_alg[i], 0, 0))
+			ptlrpc_compr_supported |= obd_compr_type2mask(i);
+	}
+	CDEBUG(D_INFO, "supported bulk compression types %#x\n",
+	       ptlrpc_compr_supported);
+}
+
+void ptlrpc_compr_fini(void)
+{
+	struct ptlrpc_compr_ctx *ctx;
+	int i;
+
+	for (i = 0; i < OBD_COMPR_MAX; i++) {
+		struct ptlrpc_compr_pool *pool = &ptlrpc_compr_pools[i];
+
+		while (!list_empty(&pool->pcp_idle)) {
+			ctx = list_entry(pool->pcp_idle.next,
+					 struct ptlrpc_compr_ctx, pcc_list);
+			list_del(&ctx->pcc_list);
+			ptlrpc_compr_ctx_free(ctx);
+		}
+		pool->pcp_nr_idle = 0;
+	}
+	ptlrpc_compr_supported = 0;
+}
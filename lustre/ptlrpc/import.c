@@ -44,6 +44,7 @@
 #include <lustre_export.h>
 #include <obd.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 
 #include "ptlrpc_internal.h"
@@ -886,6 +887,18 @@ static int ptlrpc_connect_set_flags(struct obd_import *imp,
 	}
 	cli->cl_cksum_type = cksum_type_select(cli->cl_supp_cksum_types);
 
+	/* The server masked off the compression types it doesn't support.
+	 * Keep the configured type if it is still usable after reconnect. */
+	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2 &&
+	    ocd->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS)
+		cli->cl_supp_compr_types = ocd->ocd_compr_types &
+					   ptlrpc_compr_types_supported();
+	else
+		cli->cl_supp_compr_types = 0;
+	if (!(cli->cl_supp_compr_types &
+	      obd_compr_type2mask(cli->cl_compr_type)))
+		cli->cl_compr_type = OBD_COMPR_NONE;
+
 	if (ocd->ocd_connect_flags & OBD_CONNECT_BRW_SIZE)
 		cli->cl_max_pages_per_rpc =
 			min(ocd->ocd_brw_size >> PAGE_SHIFT,
@@ -328,6 +328,17 @@ static const struct req_msg_field *mdt_swap_layouts[] = {
 	&RMF_DLM_REQ
 };
 
+static const struct req_msg_field *mds_batch_getattr_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_BATCH_GETATTR
+};
+
+static const struct req_msg_field *mds_batch_getattr_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_BATCH_GETATTR_REPLY
+};
+
 static const struct req_msg_field *obd_connect_client[] = {
         &RMF_PTLRPC_BODY,
         &RMF_TGTUUID,
@@ -397,6 +408,11 @@ static const struct req_msg_field *ldlm_gl_callback_server[] = {
         &RMF_DLM_LVB
 };
 
+static const struct req_msg_field *ldlm_bl_callback_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_DLM_BL_RC
+};
+
 static const struct req_msg_field *ldlm_intent_basic_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -619,6 +635,16 @@ static const struct req_msg_field *ost_brw_client[] = {
         &RMF_CAPA1
 };
 
+static const struct req_msg_field *ost_brw_write_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_OBD_IOOBJ,
+	&RMF_NIOBUF_REMOTE,
+	&RMF_CAPA1,
+	&RMF_BRW_COMPR,
+	&RMF_BRW_GUARDS
+};
+
 static const struct req_msg_field *ost_brw_read_server[] = {
         &RMF_PTLRPC_BODY,
         &RMF_OST_BODY
@@ -669,6 +695,12 @@ static const struct req_msg_field *ost_ladvise[] = {
 	&RMF_OST_LADVISE,
 };
 
+static const struct req_msg_field *ost_copy[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_OST_COPY,
+};
+
 static const struct req_msg_field *ost_get_fiemap_server[] = {
         &RMF_PTLRPC_BODY,
         &RMF_FIEMAP_VAL
@@ -774,6 +806,7 @@ static struct req_format *req_formats[] = {
 	&RQF_MDS_HSM_ACTION,
 	&RQF_MDS_HSM_REQUEST,
 	&RQF_MDS_SWAP_LAYOUTS,
+	&RQF_MDS_BATCH_GETATTR,
 	&RQF_OUT_UPDATE,
         &RQF_OST_CONNECT,
         &RQF_OST_DISCONNECT,
@@ -794,6 +827,7 @@ static struct req_format *req_formats[] = {
 	&RQF_OST_SET_INFO_LAST_FID,
 	&RQF_OST_GET_INFO_FIEMAP,
 	&RQF_OST_LADVISE,
+	&RQF_OST_COPY,
 	&RQF_LDLM_ENQUEUE,
 	&RQF_LDLM_ENQUEUE_LVB,
 	&RQF_LDLM_CONVERT,
@@ -801,6 +835,7 @@ static struct req_format *req_formats[] = {
 	&RQF_LDLM_CALLBACK,
         &RQF_LDLM_CP_CALLBACK,
         &RQF_LDLM_BL_CALLBACK,
+	&RQF_LDLM_BL_CALLBACK_BATCH,
         &RQF_LDLM_GL_CALLBACK,
 	&RQF_LDLM_GL_DESC_CALLBACK,
         &RQF_LDLM_INTENT,
@@ -1072,6 +1107,12 @@ struct req_msg_field RMF_DLM_GL_DESC =
 		    lustre_swab_gl_desc, NULL);
 EXPORT_SYMBOL(RMF_DLM_GL_DESC);
 
+/* one status per lock handle of a batched blocking AST */
+struct req_msg_field RMF_DLM_BL_RC =
+	DEFINE_MSGF("dlm_bl_rc", RMF_F_STRUCT_ARRAY, sizeof(__u32),
+		    lustre_swab_generic_32s, NULL);
+EXPORT_SYMBOL(RMF_DLM_BL_RC);
+
 struct req_msg_field RMF_MDT_MD =
         DEFINE_MSGF("mdt_md", RMF_F_NO_SIZE_CHECK, MIN_MD_SIZE, NULL, NULL);
 EXPORT_SYMBOL(RMF_MDT_MD);
@@ -1136,6 +1177,17 @@ struct req_msg_field RMF_NIOBUF_REMOTE =
                     dump_rniobuf);
 EXPORT_SYMBOL(RMF_NIOBUF_REMOTE);
 
+/* optional, chunk lengths are swabbed by tgt_brw_write() */
+struct req_msg_field RMF_BRW_COMPR =
+	DEFINE_MSGF("brw_compr", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_BRW_COMPR);
+
+/* optional, T10 PI guard tags are big-endian */
+struct req_msg_field RMF_BRW_GUARDS =
+	DEFINE_MSGF("brw_guards", RMF_F_STRUCT_ARRAY, sizeof(__be16),
+		    NULL, NULL);
+EXPORT_SYMBOL(RMF_BRW_GUARDS);
+
 struct req_msg_field RMF_RCS =
         DEFINE_MSGF("niobuf_remote", RMF_F_STRUCT_ARRAY, sizeof(__u32),
                     lustre_swab_generic_32s, dump_rcs);
@@ -1224,6 +1276,17 @@ struct req_msg_field RMF_SWAP_LAYOUTS =
 		    lustre_swab_swap_layouts, NULL);
 EXPORT_SYMBOL(RMF_SWAP_LAYOUTS);
 
+/* items are variable-sized and swabbed one by one by the MDT handler */
+struct req_msg_field RMF_BATCH_GETATTR =
+	DEFINE_MSGF("batch_getattr", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_BATCH_GETATTR);
+
+struct req_msg_field RMF_BATCH_GETATTR_REPLY =
+	DEFINE_MSGF("batch_getattr_reply", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct mdt_batch_getattr_reply),
+		    lustre_swab_mdt_batch_getattr_reply, NULL);
+EXPORT_SYMBOL(RMF_BATCH_GETATTR_REPLY);
+
 struct req_msg_field RMF_LFSCK_REQUEST =
 	DEFINE_MSGF("lfsck_request", 0, sizeof(struct lfsck_request),
 		    lustre_swab_lfsck_request, NULL);
@@ -1246,6 +1309,11 @@ struct req_msg_field RMF_OST_LADVISE =
 		    lustre_swab_ladvise, NULL);
 EXPORT_SYMBOL(RMF_OST_LADVISE);
 
+struct req_msg_field RMF_OST_COPY =
+	DEFINE_MSGF("ost_copy", 0, sizeof(struct ost_copy),
+		    lustre_swab_ost_copy, NULL);
+EXPORT_SYMBOL(RMF_OST_COPY);
+
 struct req_msg_field RMF_OUT_UPDATE_HEADER = DEFINE_MSGF("out_update_header", 0,
 				-1, lustre_swab_out_update_header, NULL);
 EXPORT_SYMBOL(RMF_OUT_UPDATE_HEADER);
@@ -1504,6 +1572,11 @@ struct req_format RQF_LDLM_BL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_BL_CALLBACK", ldlm_enqueue_client, empty);
 EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK);
 
+struct req_format RQF_LDLM_BL_CALLBACK_BATCH =
+	DEFINE_REQ_FMT0("LDLM_BL_CALLBACK_BATCH", ldlm_enqueue_client,
+			ldlm_bl_callback_batch_server);
+EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK_BATCH);
+
 struct req_format RQF_LDLM_GL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_GL_CALLBACK", ldlm_enqueue_client,
                         ldlm_gl_callback_server);
@@ -1604,6 +1677,11 @@ struct req_format RQF_MDS_SWAP_LAYOUTS =
 			mdt_swap_layouts, empty);
 EXPORT_SYMBOL(RQF_MDS_SWAP_LAYOUTS);
 
+struct req_format RQF_MDS_BATCH_GETATTR =
+	DEFINE_REQ_FMT0("MDS_BATCH_GETATTR",
+			mds_batch_getattr_client, mds_batch_getattr_server);
+EXPORT_SYMBOL(RQF_MDS_BATCH_GETATTR);
+
 struct req_format RQF_LLOG_ORIGIN_HANDLE_CREATE =
         DEFINE_REQ_FMT0("LLOG_ORIGIN_HANDLE_CREATE",
                         llog_origin_handle_create_client, llogd_body_only);
@@ -1675,7 +1753,8 @@ struct req_format RQF_OST_BRW_READ =
 EXPORT_SYMBOL(RQF_OST_BRW_READ);
 
 struct req_format RQF_OST_BRW_WRITE =
-        DEFINE_REQ_FMT0("OST_BRW_WRITE", ost_brw_client, ost_brw_write_server);
+        DEFINE_REQ_FMT0("OST_BRW_WRITE", ost_brw_write_client,
+			ost_brw_write_server);
 EXPORT_SYMBOL(RQF_OST_BRW_WRITE);
 
 struct req_format RQF_OST_STATFS =
@@ -1724,6 +1803,10 @@ struct req_format RQF_OST_LADVISE =
 	DEFINE_REQ_FMT0("OST_LADVISE", ost_ladvise, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_LADVISE);
 
+struct req_format RQF_OST_COPY =
+	DEFINE_REQ_FMT0("OST_COPY", ost_copy, ost_copy);
+EXPORT_SYMBOL(RQF_OST_COPY);
+
 /* Convenience macro */
 #define FMT_FIELD(fmt, i, j) (fmt)->rf_fields[(i)].d[(j)]
 
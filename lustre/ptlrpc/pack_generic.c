@@ -1680,9 +1680,11 @@ void lustre_swab_connect(struct obd_connect_data *ocd)
 	if (ocd->ocd_connect_flags & OBD_CONNECT_MULTIMODRPCS)
 		__swab16s(&ocd->ocd_maxmodrpcs);
 	CLASSERT(offsetof(typeof(*ocd), padding0) != 0);
-	CLASSERT(offsetof(typeof(*ocd), padding1) != 0);
-	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2)
+	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) {
 		__swab64s(&ocd->ocd_connect_flags2);
+		if (ocd->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS)
+			__swab32s(&ocd->ocd_compr_types);
+	}
         CLASSERT(offsetof(typeof(*ocd), padding3) != 0);
         CLASSERT(offsetof(typeof(*ocd), padding4) != 0);
         CLASSERT(offsetof(typeof(*ocd), padding5) != 0);
@@ -1775,6 +1777,16 @@ void lustre_swab_ost_body (struct ost_body *b)
         lustre_swab_obdo (&b->oa);
 }
 
+void lustre_swab_ost_copy(struct ost_copy *oc)
+{
+	lustre_swab_ost_id(&oc->oc_src_oi);
+	__swab64s(&oc->oc_src_offset);
+	__swab64s(&oc->oc_dst_offset);
+	__swab64s(&oc->oc_length);
+	__swab64s(&oc->oc_flags);
+	CLASSERT(offsetof(typeof(*oc), oc_padding) != 0);
+}
+
 void lustre_swab_ost_last_id(u64 *id)
 {
         __swab64s(id);
@@ -1871,6 +1883,25 @@ void lustre_swab_mdt_ioepoch(struct mdt_ioepoch *b)
 	CLASSERT(offsetof(typeof(*b), mio_padding) != 0);
 }
 
+void lustre_swab_mdt_batch_getattr_item(struct mdt_batch_getattr_item *mgi)
+{
+	/* mgi_lockh is opaque */
+	lustre_swab_lu_fid(&mgi->mgi_fid);
+	__swab16s(&mgi->mgi_namelen);
+	CLASSERT(offsetof(typeof(*mgi), mgi_padding0) != 0);
+	CLASSERT(offsetof(typeof(*mgi), mgi_padding1) != 0);
+}
+
+void lustre_swab_mdt_batch_getattr_reply(struct mdt_batch_getattr_reply *mgr)
+{
+	__swab32s(&mgr->mgr_status);
+	CLASSERT(offsetof(typeof(*mgr), mgr_padding) != 0);
+	/* mgr_lockh is opaque */
+	__swab64s(&mgr->mgr_bits);
+	__swab64s(&mgr->mgr_flags);
+	lustre_swab_mdt_body(&mgr->mgr_body);
+}
+
 void lustre_swab_mgs_target_info(struct mgs_target_info *mti)
 {
         int i;
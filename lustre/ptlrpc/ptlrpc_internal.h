@@ -313,6 +313,10 @@ int lustre_rename(struct dentry *dir, struct vfsmount *mnt, char *old_name,
 int  sptlrpc_init(void);
 void sptlrpc_fini(void);
 
+/* compress.c */
+void ptlrpc_compr_init(void);
+void ptlrpc_compr_fini(void);
+
 static inline bool ptlrpc_recoverable_error(int rc)
 {
 	return (rc == -ENOTCONN || rc == -ENODEV);
@@ -60,6 +60,7 @@ static __init int ptlrpc_init(void)
 	mutex_init(&pinger_mutex);
 	mutex_init(&ptlrpcd_mutex);
 	ptlrpc_init_xid();
+	ptlrpc_compr_init();
 
 	rc = req_layout_init();
 	if (rc)
@@ -128,6 +129,7 @@ err_tgt:
 	tgt_mod_exit();
 err_layout:
 	req_layout_fini();
+	ptlrpc_compr_fini();
 	return rc;
 }
 
@@ -144,6 +146,7 @@ static void __exit ptlrpc_exit(void)
 	ptlrpc_connection_fini();
 	tgt_mod_exit();
 	req_layout_fini();
+	ptlrpc_compr_fini();
 }
 
 MODULE_AUTHOR("OpenSFS, Inc. <http://www.lustre.org/>");
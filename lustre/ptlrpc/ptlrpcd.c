@@ -71,9 +71,18 @@ struct ptlrpcd {
 	int			pd_cursor;
 	int			pd_nthreads;
 	int			pd_groupsize;
+	/* requests added to the threads of this CPT */
+	atomic_t		pd_added;
+	/* requests placed here for the NUMA node of their bulk pages rather
+	 * than the CPT of the submitting task */
+	atomic_t		pd_moved;
 	struct ptlrpcd_ctl	pd_threads[0];
 };
 
+/* A request sitting alone in the new queue of a thread for this long may
+ * be stolen by a partner, see ptlrpcd_steal_rqset(). */
+#define PTLRPCD_STEAL_DELAY	(HZ / 100 + 1)
+
 /*
  * max_ptlrpcds is obsolete, but retained to ensure that the kernel
  * module will load on a system where it has been tuned.
@@ -156,6 +165,8 @@ static struct ptlrpcd_ctl ptlrpcd_rcv;
 struct mutex ptlrpcd_mutex;
 static int ptlrpcd_users = 0;
 
+static struct proc_dir_entry *ptlrpcd_proc_root;
+
 void ptlrpcd_wake(struct ptlrpc_request *req)
 {
 	struct ptlrpc_request_set *set = req->rq_set;
@@ -165,23 +176,62 @@ void ptlrpcd_wake(struct ptlrpc_request *req)
 }
 EXPORT_SYMBOL(ptlrpcd_wake);
 
+/**
+ * CPT to handle \a req on. This is the CPT of the submitting task, unless
+ * the bulk pages of the request are on another NUMA node: the pages are
+ * then checksummed, (de)compressed and released by the ptlrpcd thread
+ * which completes the request, so it should be close to them.
+ */
+static int ptlrpcd_req_cpt(struct ptlrpc_request *req, bool *moved)
+{
+	struct ptlrpc_bulk_desc	*desc;
+	int			cpt = cfs_cpt_current(cfs_cpt_table, 1);
+	int			node_cpt;
+	int			node;
+
+	*moved = false;
+	if (req == NULL || req->rq_bulk == NULL)
+		return cpt;
+
+	desc = req->rq_bulk;
+	if (!ptlrpc_is_bulk_desc_kiov(desc->bd_type) ||
+	    desc->bd_iov_count == 0)
+		return cpt;
+
+	node = page_to_nid(BD_GET_KIOV(desc, 0).kiov_page);
+	if (node_isset(node, *cfs_cpt_nodemask(cfs_cpt_table, cpt)))
+		return cpt;
+
+	node_cpt = cfs_cpt_of_node(cfs_cpt_table, node);
+	if (node_cpt < 0)
+		return cpt;
+
+	*moved = true;
+	return node_cpt;
+}
+
 static struct ptlrpcd_ctl *
 ptlrpcd_select_pc(struct ptlrpc_request *req)
 {
 	struct ptlrpcd	*pd;
+	bool		moved;
 	int		cpt;
 	int		idx;
 
 	if (req != NULL && req->rq_send_state != LUSTRE_IMP_FULL)
 		return &ptlrpcd_rcv;
 
-	cpt = cfs_cpt_current(cfs_cpt_table, 1);
+	cpt = ptlrpcd_req_cpt(req, &moved);
 	if (ptlrpcds_cpt_idx == NULL)
 		idx = cpt;
 	else
 		idx = ptlrpcds_cpt_idx[cpt];
 	pd = ptlrpcds[idx];
 
+	atomic_inc(&pd->pd_added);
+	if (moved)
+		atomic_inc(&pd->pd_moved);
+
 	/* We do not care whether it is strict load balance. */
 	idx = pd->pd_cursor;
 	if (++idx == pd->pd_nthreads)
@@ -221,15 +271,33 @@ void ptlrpcd_add_rqset(struct ptlrpc_request_set *set)
 	count = atomic_add_return(i, &new->set_new_count);
 	atomic_set(&set->set_remaining, 0);
 	spin_unlock(&new->set_new_req_lock);
-	if (count == i) {
+	if (count == i)
 		wake_up(&new->set_waitq);
 
-		/* XXX: It maybe unnecessary to wakeup all the partners. But to
-		 *      guarantee the async RPC can be processed ASAP, we have
-		 *      no other better choice. It maybe fixed in future. */
+	/* the partners share the work only if there is more than one request
+	 * waiting, a single one is left to its thread and NUMA node */
+	if (count > 1 && count - i <= 1)
 		for (i = 0; i < pc->pc_npartners; i++)
 			wake_up(&pc->pc_partners[i]->pc_set->set_waitq);
-	}
+}
+
+/**
+ * Whether the new requests of \a set can be taken by a partner thread. The
+ * owner of the set is woken up for the first request, so a lone request is
+ * only stolen if the owner is too busy to get it in time.
+ */
+static bool ptlrpcd_may_steal(struct ptlrpc_request_set *set)
+{
+	struct ptlrpc_request *req;
+
+	if (atomic_read(&set->set_new_count) > 1)
+		return true;
+
+	req = list_entry(set->set_new_requests.next, struct ptlrpc_request,
+			 rq_set_chain);
+	return cfs_time_aftereq(cfs_time_current(),
+				cfs_time_add(req->rq_queued_time,
+					     PTLRPCD_STEAL_DELAY));
 }
 
 /**
@@ -243,7 +311,8 @@ static int ptlrpcd_steal_rqset(struct ptlrpc_request_set *des,
 	int rc = 0;
 
 	spin_lock(&src->set_new_req_lock);
-	if (likely(!list_empty(&src->set_new_requests))) {
+	if (likely(!list_empty(&src->set_new_requests)) &&
+	    ptlrpcd_may_steal(src)) {
 		list_for_each_safe(pos, tmp, &src->set_new_requests) {
 			req = list_entry(pos, struct ptlrpc_request,
 					 rq_set_chain);
@@ -402,11 +471,13 @@ static int ptlrpcd_check(struct lu_env *env, struct ptlrpcd_ctl *pc)
 
 				if (atomic_read(&ps->set_new_count)) {
 					rc = ptlrpcd_steal_rqset(set, ps);
-					if (rc > 0)
+					if (rc > 0) {
+						pc->pc_stolen += rc;
 						CDEBUG(D_RPCTRACE, "transfer %d"
 						       " async RPCs [%d->%d]\n",
 						       rc, partner->pc_index,
 						       pc->pc_index);
+					}
 				}
 				ptlrpc_reqset_put(ps);
 			} while (rc == 0 && pc->pc_cursor != first);
@@ -527,6 +598,7 @@ static void ptlrpcd_ctl_init(struct ptlrpcd_ctl *pc, int index, int cpt)
 
 	pc->pc_index = index;
 	pc->pc_cpt = cpt;
+	pc->pc_stolen = 0;
 	init_completion(&pc->pc_starting);
 	init_completion(&pc->pc_finishing);
 	spin_lock_init(&pc->pc_lock);
@@ -684,6 +756,65 @@ out:
         EXIT;
 }
 
+static int ptlrpcd_stats_seq_show(struct seq_file *m, void *v)
+{
+	int i;
+	int j;
+
+	seq_printf(m, "%-5s %-8s %-8s %-8s %-8s %-12s %-12s %-12s\n",
+		   "cpt", "nodes", "threads", "queued", "inflight", "added",
+		   "moved", "stolen");
+
+	/* ptlrpcds are freed after this file is removed */
+	for (i = 0; ptlrpcds != NULL && i < ptlrpcds_num; i++) {
+		struct ptlrpcd *pd = ptlrpcds[i];
+		unsigned long stolen = 0;
+		int queued = 0;
+		int inflight = 0;
+		char nodes[8] = "";
+		int len = 0;
+		int node;
+
+		if (pd == NULL)
+			break;
+
+		for (j = 0; j < pd->pd_nthreads; j++) {
+			struct ptlrpcd_ctl *pc = &pd->pd_threads[j];
+
+			spin_lock(&pc->pc_lock);
+			if (pc->pc_set != NULL) {
+				queued += atomic_read(&pc->pc_set->set_new_count);
+				inflight +=
+					atomic_read(&pc->pc_set->set_remaining);
+			}
+			spin_unlock(&pc->pc_lock);
+			stolen += pc->pc_stolen;
+		}
+
+		for_each_node_mask(node, *cfs_cpt_nodemask(cfs_cpt_table,
+							   pd->pd_cpt))
+			len += snprintf(nodes + len, len < sizeof(nodes) ?
+					sizeof(nodes) - len : 0,
+					len == 0 ? "%d" : ",%d", node);
+		if (len >= sizeof(nodes))
+			strcpy(nodes + sizeof(nodes) - 4, "...");
+
+		seq_printf(m, "%-5d %-8s %-8d %-8d %-8d %-12d %-12d %-12lu\n",
+			   pd->pd_cpt, nodes, pd->pd_nthreads, queued,
+			   inflight, atomic_read(&pd->pd_added),
+			   atomic_read(&pd->pd_moved), stolen);
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(ptlrpcd_stats);
+
+static struct lprocfs_vars ptlrpcd_lprocfs_vars[] = {
+	{ .name	=	"stats",
+	  .fops	=	&ptlrpcd_stats_fops	},
+	{ NULL }
+};
+
 static void ptlrpcd_fini(void)
 {
 	int	i;
@@ -691,6 +822,10 @@ static void ptlrpcd_fini(void)
 	int	ncpts;
 	ENTRY;
 
+	/* this waits for the readers of the stats, if any */
+	if (ptlrpcd_proc_root != NULL)
+		lprocfs_remove(&ptlrpcd_proc_root);
+
 	if (ptlrpcds != NULL) {
 		for (i = 0; i < ptlrpcds_num; i++) {
 			if (ptlrpcds[i] == NULL)
@@ -767,17 +902,28 @@ static int ptlrpcd_init(void)
 
 		/*
 		 * Create the cpt-to-index map. When there is no match
-		 * in the cpt table, pick a cpt at random. This could
-		 * be changed to take the topology of the system into
-		 * account.
+		 * in the cpt table, pick the nearest cpt in NUMA distance,
+		 * spreading the cpts at the same distance.
 		 */
 		for (cpt = 0; cpt < ncpts; cpt++) {
-			for (i = 0; i < rc; i++)
-				if (cpts[i] == cpt)
+			unsigned int best = UINT_MAX;
+			int best_idx = cpt % rc;
+
+			for (i = 0; i < rc; i++) {
+				unsigned int dist;
+
+				if (cpts[i] == cpt) {
+					best_idx = i;
 					break;
-			if (i >= rc)
-				i = cpt % rc;
-			ptlrpcds_cpt_idx[cpt] = i;
+				}
+				dist = cfs_cpt_distance(cptable, cpt, cpts[i]);
+				if (dist < best ||
+				    (dist == best && i == cpt % rc)) {
+					best = dist;
+					best_idx = i;
+				}
+			}
+			ptlrpcds_cpt_idx[cpt] = best_idx;
 		}
 
 		cfs_expr_list_values_free(cpts, rc);
@@ -892,6 +1038,8 @@ static int ptlrpcd_init(void)
 		pd->pd_cursor    = 0;
 		pd->pd_nthreads  = nthreads;
 		pd->pd_groupsize = groupsize;
+		atomic_set(&pd->pd_added, 0);
+		atomic_set(&pd->pd_moved, 0);
 		ptlrpcds[i] = pd;
 
 		/*
@@ -931,6 +1079,14 @@ static int ptlrpcd_init(void)
 				GOTO(out, rc);
 		}
 	}
+
+	ptlrpcd_proc_root = lprocfs_register("ptlrpcd", proc_lustre_root,
+					     ptlrpcd_lprocfs_vars, NULL);
+	if (IS_ERR(ptlrpcd_proc_root)) {
+		CWARN("cannot register ptlrpcd stats: rc = %ld\n",
+		      PTR_ERR(ptlrpcd_proc_root));
+		ptlrpcd_proc_root = NULL;
+	}
 out:
 	if (rc != 0)
 		ptlrpcd_fini();
@@ -42,6 +42,7 @@
 #include <obd.h>
 #include <obd_class.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <md_object.h>
 #include <lustre_lfsck.h>
 #include <lustre_nodemap.h>
@@ -1639,82 +1640,83 @@ void tgt_brw_unlock(struct obd_ioobj *obj, struct niobuf_remote *niob,
 	EXIT;
 }
 
+static void tgt_cksum_frag_get(void *data, int idx, struct page **page,
+			       unsigned int *offset, unsigned int *len)
+{
+	struct ptlrpc_bulk_desc *desc = data;
+
+	*page = BD_GET_KIOV(desc, idx).kiov_page;
+	*offset = BD_GET_KIOV(desc, idx).kiov_offset & ~PAGE_MASK;
+	*len = BD_GET_KIOV(desc, idx).kiov_len;
+}
+
+/**
+ * Checksum the pages of \a desc. For T10 PI types the guard tags are saved in
+ * \a guards if it is not NULL.
+ */
 static __u32 tgt_checksum_bulk(struct lu_target *tgt,
 			       struct ptlrpc_bulk_desc *desc, int opc,
-			       cksum_type_t cksum_type)
+			       cksum_type_t cksum_type,
+			       __be16 *guards, unsigned int nr_guards)
 {
-	struct cfs_crypto_hash_desc	*hdesc;
-	unsigned int			bufsize;
-	int				i, err;
 	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
 	__u32				cksum;
+	int				rc;
 
 	LASSERT(ptlrpc_is_bulk_desc_kiov(desc->bd_type));
 
-	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
-	if (IS_ERR(hdesc)) {
-		CERROR("%s: unable to initialize checksum hash %s\n",
-		       tgt_name(tgt), cfs_crypto_hash_name(cfs_alg));
-		return PTR_ERR(hdesc);
+	/* corrupt the data before we compute the checksum, to
+	 * simulate a client->OST data error */
+	if (desc->bd_iov_count > 0 && opc == OST_WRITE &&
+	    OBD_FAIL_CHECK(OBD_FAIL_OST_CHECKSUM_RECEIVE)) {
+		int off = BD_GET_KIOV(desc, 0).kiov_offset & ~PAGE_MASK;
+		int len = BD_GET_KIOV(desc, 0).kiov_len;
+		struct page *np = tgt_page_to_corrupt;
+		char *ptr = kmap(BD_GET_KIOV(desc, 0).kiov_page) + off;
+
+		if (np) {
+			char *ptr2 = kmap(np) + off;
+
+			memcpy(ptr2, ptr, len);
+			memcpy(ptr2, "bad3", min(4, len));
+			kunmap(np);
+			BD_GET_KIOV(desc, 0).kiov_page = np;
+		} else {
+			CERROR("%s: can't alloc page for corruption\n",
+			       tgt_name(tgt));
+		}
 	}
 
 	CDEBUG(D_INFO, "Checksum for algo %s\n", cfs_crypto_hash_name(cfs_alg));
-	for (i = 0; i < desc->bd_iov_count; i++) {
-		/* corrupt the data before we compute the checksum, to
-		 * simulate a client->OST data error */
-		if (i == 0 && opc == OST_WRITE &&
-		    OBD_FAIL_CHECK(OBD_FAIL_OST_CHECKSUM_RECEIVE)) {
-			int off = BD_GET_KIOV(desc, i).kiov_offset &
-				~PAGE_MASK;
-			int len = BD_GET_KIOV(desc, i).kiov_len;
-			struct page *np = tgt_page_to_corrupt;
-			char *ptr = kmap(BD_GET_KIOV(desc, i).kiov_page) + off;
-
-			if (np) {
-				char *ptr2 = kmap(np) + off;
-
-				memcpy(ptr2, ptr, len);
-				memcpy(ptr2, "bad3", min(4, len));
-				kunmap(np);
-				BD_GET_KIOV(desc, i).kiov_page = np;
-			} else {
-				CERROR("%s: can't alloc page for corruption\n",
-				       tgt_name(tgt));
-			}
-		}
-		cfs_crypto_hash_update_page(hdesc,
-				  BD_GET_KIOV(desc, i).kiov_page,
-				  BD_GET_KIOV(desc, i).kiov_offset &
-					~PAGE_MASK,
-				  BD_GET_KIOV(desc, i).kiov_len);
-
-		 /* corrupt the data after we compute the checksum, to
-		 * simulate an OST->client data error */
-		if (i == 0 && opc == OST_READ &&
-		    OBD_FAIL_CHECK(OBD_FAIL_OST_CHECKSUM_SEND)) {
-			int off = BD_GET_KIOV(desc, i).kiov_offset
-			  & ~PAGE_MASK;
-			int len = BD_GET_KIOV(desc, i).kiov_len;
-			struct page *np = tgt_page_to_corrupt;
-			char *ptr =
-			  kmap(BD_GET_KIOV(desc, i).kiov_page) + off;
-
-			if (np) {
-				char *ptr2 = kmap(np) + off;
-
-				memcpy(ptr2, ptr, len);
-				memcpy(ptr2, "bad4", min(4, len));
-				kunmap(np);
-				BD_GET_KIOV(desc, i).kiov_page = np;
-			} else {
-				CERROR("%s: can't alloc page for corruption\n",
-				       tgt_name(tgt));
-			}
-		}
+	rc = obd_cksum_bulk(cksum_type, tgt_cksum_frag_get, desc,
+			    desc->bd_iov_count, guards, nr_guards, &cksum);
+	if (rc != 0) {
+		CERROR("%s: unable to compute checksum %s: rc = %d\n",
+		       tgt_name(tgt), cfs_crypto_hash_name(cfs_alg), rc);
+		return rc;
 	}
 
-	bufsize = sizeof(cksum);
-	err = cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
+	/* corrupt the data after we compute the checksum, to
+	 * simulate an OST->client data error */
+	if (desc->bd_iov_count > 0 && opc == OST_READ &&
+	    OBD_FAIL_CHECK(OBD_FAIL_OST_CHECKSUM_SEND)) {
+		int off = BD_GET_KIOV(desc, 0).kiov_offset & ~PAGE_MASK;
+		int len = BD_GET_KIOV(desc, 0).kiov_len;
+		struct page *np = tgt_page_to_corrupt;
+		char *ptr = kmap(BD_GET_KIOV(desc, 0).kiov_page) + off;
+
+		if (np) {
+			char *ptr2 = kmap(np) + off;
+
+			memcpy(ptr2, ptr, len);
+			memcpy(ptr2, "bad4", min(4, len));
+			kunmap(np);
+			BD_GET_KIOV(desc, 0).kiov_page = np;
+		} else {
+			CERROR("%s: can't alloc page for corruption\n",
+			       tgt_name(tgt));
+		}
+	}
 
 	return cksum;
 }
@@ -1851,7 +1853,8 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 		repbody->oa.o_flags = cksum_type_pack(cksum_type);
 		repbody->oa.o_valid = OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
 		repbody->oa.o_cksum = tgt_checksum_bulk(tsi->tsi_tgt, desc,
-							OST_READ, cksum_type);
+							OST_READ, cksum_type,
+							NULL, 0);
 		CDEBUG(D_PAGE, "checksum at read origin: %x\n",
 		       repbody->oa.o_cksum);
 	} else {
@@ -1954,6 +1957,280 @@ static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			   client_cksum, server_cksum);
 }
 
+/**
+ * Compare the T10 PI guard tags sent by the client with the ones computed
+ * on the received pages, and report the sectors which were damaged in
+ * transit, so that a bad page or router can be told from a bad buffer.
+ *
+ * \retval number of pages with damaged sectors, 0 if only the RPC checksum
+ *	   itself was damaged and the data can be written
+ */
+static int tgt_warn_on_guards(struct ptlrpc_request *req,
+			       struct niobuf_local *local_nb, int npages,
+			       cksum_type_t cksum_type,
+			       __be16 *client_guards, __be16 *server_guards,
+			       unsigned int nr_guards)
+{
+	unsigned int sector = cksum_t10_sector_size(cksum_type);
+	unsigned int used = 0;
+	int bad_pages = 0;
+	int i, j, n;
+
+	for (i = 0; i < npages && used < nr_guards; i++) {
+		int bad = 0;
+
+		n = cksum_t10_guards(cksum_type, local_nb[i].lnb_page_offset,
+				     local_nb[i].lnb_len);
+		n = min_t(int, n, nr_guards - used);
+		for (j = 0; j < n; j++)
+			if (client_guards[used + j] != server_guards[used + j])
+				bad++;
+		if (bad > 0) {
+			CERROR("%s: page at offset %llu len %u: %d of %d "
+			       "%u-byte sectors damaged\n",
+			       req->rq_export->exp_obd->obd_name,
+			       local_nb[i].lnb_file_offset,
+			       local_nb[i].lnb_len, bad, n, sector);
+			bad_pages++;
+		}
+		used += n;
+	}
+	if (bad_pages == 0)
+		CERROR("%s: all sector guards match, the RPC checksum "
+		       "itself is damaged\n",
+		       req->rq_export->exp_obd->obd_name);
+
+	return bad_pages;
+}
+
+/**
+ * Get and check the compression header of a BRW write, if any.
+ *
+ * \retval NULL if the bulk is not compressed
+ * \retval ERR_PTR(-EPROTO) if the header is inconsistent with the niobufs
+ */
+static struct brw_compr_hdr *tgt_brw_compr_unpack(struct ptlrpc_request *req,
+						  struct niobuf_remote *rnb,
+						  int niocount, int *nob)
+{
+	struct req_capsule *pill = &req->rq_pill;
+	struct brw_compr_hdr *bch;
+	__u32 size;
+	int i;
+
+	*nob = 0;
+	if (!req_capsule_field_present(pill, &RMF_BRW_COMPR, RCL_CLIENT))
+		return NULL;
+	size = req_capsule_get_size(pill, &RMF_BRW_COMPR, RCL_CLIENT);
+	if (size == 0)
+		return NULL;
+	if (size < sizeof(*bch))
+		return ERR_PTR(-EPROTO);
+
+	bch = req_capsule_client_get(pill, &RMF_BRW_COMPR);
+	if (bch == NULL)
+		return ERR_PTR(-EPROTO);
+
+	if (ptlrpc_req_need_swab(req)) {
+		__swab32s(&bch->bch_type);
+		__swab32s(&bch->bch_chunk_size);
+		__swab32s(&bch->bch_count);
+		CLASSERT(offsetof(typeof(*bch), bch_padding) != 0);
+		if (size == brw_compr_hdr_size(bch->bch_count))
+			for (i = 0; i < bch->bch_count; i++)
+				__swab32s(&bch->bch_chunk_len[i]);
+	}
+
+	if (bch->bch_type == OBD_COMPR_NONE)
+		return NULL;
+
+	for (i = 0; i < niocount; i++)
+		*nob += rnb[i].rnb_len;
+
+	if (!(ptlrpc_compr_types_supported() &
+	      obd_compr_type2mask(bch->bch_type)) ||
+	    bch->bch_chunk_size == 0 ||
+	    bch->bch_chunk_size > OBD_COMPR_CHUNK_MAX ||
+	    bch->bch_count != DIV_ROUND_UP(*nob, bch->bch_chunk_size) ||
+	    size != brw_compr_hdr_size(bch->bch_count)) {
+		DEBUG_REQ(D_ERROR, req, "bad compression header: type %u, "
+			  "chunk %u, count %u, size %u, nob %d",
+			  bch->bch_type, bch->bch_chunk_size, bch->bch_count,
+			  size, *nob);
+		return ERR_PTR(-EPROTO);
+	}
+
+	for (i = 0; i < bch->bch_count; i++) {
+		int len = min_t(int, bch->bch_chunk_size,
+				*nob - i * bch->bch_chunk_size);
+
+		if (bch->bch_chunk_len[i] == 0 || bch->bch_chunk_len[i] > len) {
+			DEBUG_REQ(D_ERROR, req, "bad compressed chunk %d: "
+				  "%u > %d", i, bch->bch_chunk_len[i], len);
+			return ERR_PTR(-EPROTO);
+		}
+	}
+
+	return bch;
+}
+
+/**
+ * Decompress the chunks of \a spages into the \a local_nb pages.
+ */
+static int tgt_brw_decompress(struct ptlrpc_request *req,
+			      struct brw_compr_hdr *bch, int nob,
+			      struct page **spages,
+			      struct niobuf_local *local_nb, int npages)
+{
+	struct ptlrpc_compr_ctx *ctx;
+	unsigned int chunk = bch->bch_chunk_size;
+	char *src = NULL;
+	char *dst = NULL;
+	unsigned int loff = 0;
+	unsigned int done = 0;
+	unsigned int in = 0;
+	int li = 0;
+	int rc = 0;
+	int i;
+	ENTRY;
+
+	ctx = ptlrpc_compr_get(bch->bch_type, true);
+	if (ctx == NULL)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC_LARGE(src, chunk);
+	OBD_ALLOC_LARGE(dst, chunk);
+	if (src == NULL || dst == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < bch->bch_count; i++) {
+		unsigned int len = min_t(unsigned int, chunk, nob - done);
+		unsigned int clen = bch->bch_chunk_len[i];
+		unsigned int n;
+		char *buf;
+
+		for (n = 0; n < clen; ) {
+			unsigned int soff = in & ~PAGE_MASK;
+			unsigned int cnt = min_t(unsigned int, PAGE_SIZE - soff,
+						 clen - n);
+
+			memcpy(src + n, page_address(spages[in >> PAGE_SHIFT]) +
+			       soff, cnt);
+			n += cnt;
+			in += cnt;
+		}
+
+		if (clen == len) {
+			buf = src;
+		} else {
+			unsigned int dlen = chunk;
+
+			rc = ptlrpc_decompress(ctx, src, clen, dst, &dlen);
+			if (rc != 0 || dlen != len) {
+				DEBUG_REQ(D_ERROR, req, "cannot decompress "
+					  "chunk %d: %u -> %u/%u: rc = %d",
+					  i, clen, dlen, len, rc);
+				GOTO(out, rc = -EIO);
+			}
+			buf = dst;
+		}
+
+		for (n = 0; n < len; ) {
+			struct niobuf_local *lnb = &local_nb[li];
+			unsigned int cnt = min(lnb->lnb_len - loff, len - n);
+			char *addr;
+
+			LASSERT(li < npages);
+			addr = kmap(lnb->lnb_page);
+			memcpy(addr + lnb->lnb_page_offset + loff, buf + n, cnt);
+			kunmap(lnb->lnb_page);
+			n += cnt;
+			loff += cnt;
+			if (loff == lnb->lnb_len) {
+				li++;
+				loff = 0;
+			}
+		}
+		done += len;
+	}
+out:
+	if (dst != NULL)
+		OBD_FREE_LARGE(dst, chunk);
+	if (src != NULL)
+		OBD_FREE_LARGE(src, chunk);
+	ptlrpc_compr_put(ctx);
+
+	RETURN(rc);
+}
+
+/**
+ * Receive a compressed write bulk into staging pages, then decompress it
+ * into the \a local_nb pages prepared by obd_preprw().
+ *
+ * \a no_reply is set if the transfer itself failed.
+ */
+static int tgt_brw_recv_compressed(struct ptlrpc_request *req,
+				   struct obd_ioobj *ioo,
+				   struct brw_compr_hdr *bch, int nob,
+				   struct niobuf_local *local_nb, int npages,
+				   bool *no_reply)
+{
+	struct ptlrpc_bulk_desc *desc;
+	struct l_wait_info lwi;
+	struct page **spages;
+	unsigned int total = 0;
+	int nr_spages;
+	int rc;
+	int i;
+	ENTRY;
+
+	for (i = 0; i < bch->bch_count; i++)
+		total += bch->bch_chunk_len[i];
+	nr_spages = DIV_ROUND_UP(total, PAGE_SIZE);
+
+	OBD_ALLOC(spages, nr_spages * sizeof(*spages));
+	if (spages == NULL)
+		RETURN(-ENOMEM);
+
+	desc = ptlrpc_prep_bulk_exp(req, nr_spages, ioobj_max_brw_get(ioo),
+				    PTLRPC_BULK_GET_SINK | PTLRPC_BULK_BUF_KIOV,
+				    OST_BULK_PORTAL,
+				    &ptlrpc_bulk_kiov_nopin_ops);
+	if (desc == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	/* the pages must be laid out as the client's ones */
+	for (i = 0; i < nr_spages; i++) {
+		spages[i] = alloc_page(GFP_NOFS);
+		if (spages[i] == NULL)
+			GOTO(out, rc = -ENOMEM);
+		desc->bd_frag_ops->add_kiov_frag(desc, spages[i], 0,
+				min_t(unsigned int, PAGE_SIZE,
+				      total - i * PAGE_SIZE));
+	}
+
+	rc = sptlrpc_svc_prep_bulk(req, desc);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	rc = target_bulk_io(req->rq_export, desc, &lwi);
+	if (rc != 0) {
+		*no_reply = true;
+		GOTO(out, rc);
+	}
+
+	rc = tgt_brw_decompress(req, bch, nob, spages, local_nb, npages);
+out:
+	if (desc != NULL)
+		ptlrpc_free_bulk(desc);
+	for (i = 0; i < nr_spages; i++)
+		if (spages[i] != NULL)
+			__free_page(spages[i]);
+	OBD_FREE(spages, nr_spages * sizeof(*spages));
+
+	RETURN(rc);
+}
+
 int tgt_brw_write(struct tgt_session_info *tsi)
 {
 	struct ptlrpc_request	*req = tgt_ses_req(tsi);
@@ -1972,6 +2249,11 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	bool			 no_reply = false, mmap;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
 	bool wait_sync = false;
+	struct brw_compr_hdr	*bch;
+	int			 compr_nob;
+	__be16			*client_guards = NULL;
+	__be16			*server_guards = NULL;
+	unsigned int		 nr_guards = 0;
 
 	ENTRY;
 
@@ -2024,6 +2306,10 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 			sizeof(*remote_nb))
 		RETURN(err_serious(-EPROTO));
 
+	bch = tgt_brw_compr_unpack(req, remote_nb, niocount, &compr_nob);
+	if (IS_ERR(bch))
+		RETURN(err_serious(PTR_ERR(bch)));
+
 	if ((remote_nb[0].rnb_flags & OBD_BRW_MEMALLOC) &&
 	    (exp->exp_connection->c_peer.nid == exp->exp_connection->c_self))
 		memory_pressure_set();
@@ -2093,6 +2379,14 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 						 local_nb[i].lnb_page_offset,
 						 local_nb[i].lnb_len);
 
+	/* a compressed bulk is received aside, desc is only used to
+	 * checksum the decompressed pages below */
+	if (bch != NULL) {
+		rc = tgt_brw_recv_compressed(req, ioo, bch, compr_nob,
+					     local_nb, npages, &no_reply);
+		GOTO(skip_transfer, rc);
+	}
+
 	rc = sptlrpc_svc_prep_bulk(req, desc);
 	if (rc != 0)
 		GOTO(skip_transfer, rc);
@@ -2110,8 +2404,28 @@ skip_transfer:
 		repbody->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
 		repbody->oa.o_flags &= ~OBD_FL_CKSUM_ALL;
 		repbody->oa.o_flags |= cksum_type_pack(cksum_type);
+
+		if (cksum_type_is_t10(cksum_type) &&
+		    req_capsule_field_present(&req->rq_pill, &RMF_BRW_GUARDS,
+					      RCL_CLIENT)) {
+			nr_guards = req_capsule_get_size(&req->rq_pill,
+							 &RMF_BRW_GUARDS,
+							 RCL_CLIENT) /
+				    sizeof(*client_guards);
+			if (nr_guards > 0)
+				client_guards = req_capsule_client_get(
+						&req->rq_pill, &RMF_BRW_GUARDS);
+			/* best effort, the checksum is verified anyway */
+			if (client_guards != NULL)
+				OBD_ALLOC_LARGE(server_guards,
+						nr_guards *
+						sizeof(*server_guards));
+		}
+
 		repbody->oa.o_cksum = tgt_checksum_bulk(tsi->tsi_tgt, desc,
-							OST_WRITE, cksum_type);
+							OST_WRITE, cksum_type,
+							server_guards,
+							nr_guards);
 		cksum_counter++;
 
 		if (unlikely(body->oa.o_cksum != repbody->oa.o_cksum)) {
@@ -2121,6 +2435,13 @@ skip_transfer:
 			tgt_warn_on_cksum(req, desc, local_nb, npages,
 					  body->oa.o_cksum,
 					  repbody->oa.o_cksum, mmap);
+			/* do not write damaged sectors, the client resends
+			 * the whole RPC on -EAGAIN */
+			if (!mmap && server_guards != NULL &&
+			    tgt_warn_on_guards(req, local_nb, npages,
+					       cksum_type, client_guards,
+					       server_guards, nr_guards) > 0)
+				rc = -EAGAIN;
 			cksum_counter = 0;
 		} else if ((cksum_counter & (-cksum_counter)) ==
 			   cksum_counter) {
@@ -2128,6 +2449,10 @@ skip_transfer:
 			       cksum_counter, libcfs_id2str(req->rq_peer),
 			       repbody->oa.o_cksum);
 		}
+
+		if (server_guards != NULL)
+			OBD_FREE_LARGE(server_guards,
+				       nr_guards * sizeof(*server_guards));
 	}
 
 	/* Must commit after prep above in all cases */
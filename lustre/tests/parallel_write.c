@@ -0,0 +1,193 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Measure the write throughput of several threads of one process writing
+ * disjoint regions of a single shared file, to compare the scalability of
+ * the client range lock for a growing number of threads.
+ *
+ * Thread i writes blocks i, i + nthreads, i + 2 * nthreads, ... so that the
+ * writers are interleaved over the whole file, as with a strided N-1 job.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+struct pw_thread {
+	pthread_t	 pt_thread;
+	int		 pt_index;
+	int		 pt_rc;
+};
+
+static const char *pw_file;
+static int pw_fd;
+static int pw_nthreads = 1;
+static size_t pw_bsize = 64 * 1024;
+static size_t pw_count = 256;
+static int pw_direct;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-b block_size] [-c blocks_per_thread] [-d] "
+		"[-t threads] file\n"
+		"  -b  size of each write in bytes (default 65536)\n"
+		"  -c  number of writes of each thread (default 256)\n"
+		"  -d  open the file with O_DIRECT\n"
+		"  -t  number of writing threads (default 1)\n", prog);
+	exit(EXIT_FAILURE);
+}
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void *pw_writer(void *arg)
+{
+	struct pw_thread *pt = arg;
+	void *buf;
+	size_t i;
+	int rc;
+
+	rc = posix_memalign(&buf, 4096, pw_bsize);
+	if (rc != 0) {
+		pt->pt_rc = -rc;
+		return NULL;
+	}
+	memset(buf, 'a' + pt->pt_index % 26, pw_bsize);
+
+	for (i = 0; i < pw_count; i++) {
+		off_t off = ((off_t)i * pw_nthreads + pt->pt_index) * pw_bsize;
+		ssize_t nob;
+
+		nob = pwrite(pw_fd, buf, pw_bsize, off);
+		if (nob != (ssize_t)pw_bsize) {
+			pt->pt_rc = nob < 0 ? -errno : -EIO;
+			fprintf(stderr, "thread %d: write at %lld: %s\n",
+				pt->pt_index, (long long)off,
+				strerror(-pt->pt_rc));
+			break;
+		}
+	}
+	free(buf);
+
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	struct pw_thread *threads;
+	double start;
+	double elapsed;
+	int flags = O_WRONLY | O_CREAT;
+	int rc = 0;
+	int c;
+	int i;
+
+	while ((c = getopt(argc, argv, "b:c:dt:")) != -1) {
+		switch (c) {
+		case 'b':
+			pw_bsize = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			pw_count = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			pw_direct = 1;
+			break;
+		case 't':
+			pw_nthreads = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1 || pw_bsize == 0 || pw_count == 0 ||
+	    pw_nthreads <= 0)
+		usage(argv[0]);
+	pw_file = argv[optind];
+
+	if (pw_direct)
+		flags |= O_DIRECT;
+	pw_fd = open(pw_file, flags, 0644);
+	if (pw_fd < 0) {
+		fprintf(stderr, "cannot open %s: %s\n", pw_file,
+			strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	threads = calloc(pw_nthreads, sizeof(*threads));
+	if (threads == NULL) {
+		fprintf(stderr, "cannot allocate %d threads\n", pw_nthreads);
+		return EXIT_FAILURE;
+	}
+
+	start = now();
+	for (i = 0; i < pw_nthreads; i++) {
+		threads[i].pt_index = i;
+		rc = pthread_create(&threads[i].pt_thread, NULL, pw_writer,
+				    &threads[i]);
+		if (rc != 0) {
+			fprintf(stderr, "cannot create thread %d: %s\n", i,
+				strerror(rc));
+			pw_nthreads = i;
+			break;
+		}
+	}
+	for (i = 0; i < pw_nthreads; i++) {
+		pthread_join(threads[i].pt_thread, NULL);
+		if (threads[i].pt_rc != 0)
+			rc = threads[i].pt_rc;
+	}
+	if (rc == 0 && fsync(pw_fd) < 0)
+		rc = -errno;
+	elapsed = now() - start;
+	close(pw_fd);
+
+	if (rc == 0)
+		printf("threads: %d bsize: %zu total: %zu MiB time: %.3f s "
+		       "rate: %.2f MiB/s\n", pw_nthreads, pw_bsize,
+		       pw_bsize * pw_count * pw_nthreads >> 20, elapsed,
+		       (double)(pw_bsize * pw_count * pw_nthreads) /
+		       (1 << 20) / elapsed);
+	free(threads);
+
+	return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -55,6 +55,7 @@ SOCKETSERVER=${SOCKETSERVER:-socketserver}
 SOCKETCLIENT=${SOCKETCLIENT:-socketclient}
 MEMHOG=${MEMHOG:-memhog}
 DIRECTIO=${DIRECTIO:-directio}
+PARALLEL_WRITE=${PARALLEL_WRITE:-parallel_write}
 ACCEPTOR_PORT=${ACCEPTOR_PORT:-988}
 STRIPES_PER_OBJ=-1
 CHECK_GRANT=${CHECK_GRANT:-"yes"}
@@ -5498,6 +5499,30 @@ test_64c() {
 }
 run_test 64c "verify grant shrink ========================------"
 
+test_64d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local nthreads=$(($(grep -c ^processor /proc/cpuinfo) * 2))
+	local pids=""
+	local i
+
+	# concurrent writers update the per-CPT grant shards of the OST at once,
+	# the totals must still match the grant held by the clients
+	test_mkdir -p $DIR/$tdir
+	$SETSTRIPE -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	for i in $(seq $nthreads); do
+		dd if=/dev/zero of=$DIR/$tdir/$tfile.$i bs=1M count=4 \
+			conv=fsync 2>/dev/null &
+		pids="$pids $!"
+	done
+	for i in $pids; do
+		wait $i || error "dd $i failed"
+	done
+
+	GCHECK_ONLY_64=true check_grant 64d || error "grant mismatch"
+	rm -rf $DIR/$tdir
+}
+run_test 64d "verify grant totals with parallel writers ========"
+
 # bug 1414 - set/get directories' stripe info
 test_65a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
@@ -6123,6 +6148,119 @@ test_77j() { # bug 13805
 }
 run_test 77j "client only supporting ADLER32"
 
+test_77k() { # compressed write bulk
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$GSS && skip "could not run with gss" && return
+	local param=osc.*osc-[^mM]*
+	local types=$($LCTL get_param -n $param.compress_type | head -n1 |
+		      sed 's/[][]//g')
+
+	[ "$types" = "none " -o -z "$types" ] &&
+		skip "server does not support compression" && return
+
+	local src=$TMP/$tfile.src
+	local type
+	local saved
+
+	# compressible data, with an incompressible part in the middle
+	yes "$(uname -a)" | head -c 4M > $src
+	dd if=/dev/urandom of=$src bs=64k count=4 seek=16 conv=notrunc ||
+		error "dd urandom failed"
+	for type in $types; do
+		[ $type = none ] && continue
+		$LCTL set_param -n $param.compress_type $type
+		$LCTL set_param -n $param.compress_stats=0
+		cp $src $DIR/$tfile || error "cp with $type failed"
+		cancel_lru_locks osc
+		cmp $src $DIR/$tfile || error "data mismatch with $type"
+		saved=$($LCTL get_param -n $param.compress_stats |
+			awk '/bytes_saved/ { sum += $2 } END { print sum }')
+		echo "$type saved $saved bytes"
+		[ ${saved:-0} -gt 0 ] || error "nothing saved with $type"
+		rm -f $DIR/$tfile
+	done
+	$LCTL set_param -n $param.compress_type none
+	rm -f $src
+}
+run_test 77k "compressed write bulk"
+
+test_77l() { # T10 PI checksum types
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$GSS && skip "could not run with gss" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	local types=$($LCTL get_param -n osc.*osc-[^mM]*.checksum_type |
+		      head -n1 | tr -d '[]')
+	local algo
+
+	[[ "$types" == *t10* ]] ||
+		{ skip "T10 PI checksums not supported"; return; }
+
+	[ ! -f $F77_TMP ] && setup_f77
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile
+	set_checksums 1
+	for algo in $types; do
+		[[ $algo == t10* ]] || continue
+		set_checksum_type $algo
+		dd if=$F77_TMP of=$DIR/$tfile bs=1M count=$F77SZ ||
+			error "write with $algo failed"
+		cancel_lru_locks osc
+		cmp $F77_TMP $DIR/$tfile || error "data mismatch with $algo"
+
+		# the damaged sectors are reported on a write checksum error
+		do_facet ost1 $LCTL clear
+		#define OBD_FAIL_OST_CHECKSUM_RECEIVE       0x21a
+		do_facet ost1 $LCTL set_param fail_loc=0x8000021a
+		dd if=$F77_TMP of=$DIR/$tfile bs=1M count=1 conv=notrunc ||
+			error "write error with $algo"
+		do_facet ost1 $LCTL set_param fail_loc=0
+		do_facet ost1 $LCTL dk | grep -q "sectors damaged" ||
+			error "damaged sectors not reported with $algo"
+		# the damaged write is refused and resent by the client
+		cancel_lru_locks osc
+		cmp $F77_TMP $DIR/$tfile ||
+			error "damaged data written with $algo"
+	done
+	set_checksum_type $ORIG_CSUM_TYPE
+	set_checksums 0
+	rm -f $DIR/$tfile
+}
+run_test 77l "T10 PI checksum read/write"
+
+test_77m() { # parallel checksum of large RPCs
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$GSS && skip "could not run with gss" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	local osc1_mppc=osc.$(get_osc_import_name client ost1).max_pages_per_rpc
+	local orig_mppc=$($LCTL get_param -n $osc1_mppc)
+	local orig_min=$($LCTL get_param -n checksum_parallel_min_kb)
+	local ost_min=$(do_facet ost1 $LCTL get_param -n \
+			checksum_parallel_min_kb)
+	local algo
+
+	[ ! -f $F77_TMP ] && setup_f77
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile
+	# 4MB RPCs are split into 1MB pieces on both sides
+	$LCTL set_param $osc1_mppc=4M
+	$LCTL set_param checksum_parallel_min_kb=1024
+	do_facet ost1 $LCTL set_param checksum_parallel_min_kb=1024
+	set_checksums 1
+	for algo in $CKSUM_TYPES; do
+		set_checksum_type $algo
+		$DIRECTIO write $DIR/$tfile 0 $((F77SZ / 4)) $((4 << 20)) ||
+			error "direct write with $algo failed"
+		cancel_lru_locks osc
+		$DIRECTIO read $DIR/$tfile 0 $((F77SZ / 4)) $((4 << 20)) ||
+			error "direct read with $algo failed"
+	done
+	set_checksum_type $ORIG_CSUM_TYPE
+	set_checksums 0
+	do_facet ost1 $LCTL set_param checksum_parallel_min_kb=$ost_min
+	$LCTL set_param checksum_parallel_min_kb=$orig_min
+	$LCTL set_param $osc1_mppc=$orig_mppc
+	rm -f $DIR/$tfile
+}
+run_test 77m "parallel checksum of large RPCs"
+
 [ "$ORIG_CSUM" ] && set_checksums $ORIG_CSUM || true
 rm -f $F77_TMP
 unset F77_TMP
@@ -6744,6 +6882,186 @@ test_101g() {
 }
 run_test 101g "Big bulk(4/16 MiB) readahead"
 
+ra_misses_101h() {
+	$LCTL get_param -n llite.*.read_ahead_stats |
+		get_named_value 'misses' | cut -d" " -f1 | calc_total
+}
+
+# read $nstreams interleaved regions of $DIR/$tfile through one fd
+ra_streams_read_101h() {
+	local nstreams=$1
+	local region_mb=$2
+	local cmd="o"
+	local i
+	local s
+
+	for ((i = 0; i < region_mb; i++)); do
+		for ((s = 0; s < nstreams; s++)); do
+			cmd+="z$(((s * region_mb + i) * 1048576))r1048576"
+		done
+	done
+	cmd+="c"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats 0
+	$MULTIOP $DIR/$tfile $cmd || error "multiop $DIR/$tfile failed"
+}
+
+test_101h() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local nstreams=4
+	local region_mb=16
+	local old_streams=$($LCTL get_param -n llite.*.max_read_ahead_streams |
+			    head -n 1)
+	local single
+	local multi
+
+	[ -z "$old_streams" ] &&
+		skip "no multi-stream read-ahead support" && return
+
+	$SETSTRIPE -c 1 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=$((nstreams * region_mb)) ||
+		error "dd $DIR/$tfile failed"
+
+	$LCTL set_param -n llite.*.max_read_ahead_streams 1
+	ra_streams_read_101h $nstreams $region_mb
+	single=$(ra_misses_101h)
+
+	$LCTL set_param -n llite.*.max_read_ahead_streams $nstreams
+	ra_streams_read_101h $nstreams $region_mb
+	multi=$(ra_misses_101h)
+	$LCTL get_param llite.*.read_ahead_stream_stats
+
+	$LCTL set_param -n llite.*.max_read_ahead_streams $old_streams
+	rm -f $DIR/$tfile
+
+	echo "misses with 1 stream: $single, with $nstreams streams: $multi"
+	[ $multi -lt $single ] ||
+		error "multi-stream read-ahead misses $multi >= $single"
+}
+run_test 101h "check read-ahead of interleaved streams on one fd"
+
+test_101i() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local old_threads=$($LCTL get_param -n \
+			    llite.*.read_ahead_async_threads | head -n 1)
+	local async
+
+	[ -z "$old_threads" ] &&
+		skip "no async read-ahead support" && return
+
+	$SETSTRIPE -c 1 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=64 ||
+		error "dd $DIR/$tfile failed"
+
+	$LCTL set_param -n llite.*.read_ahead_async_threads 0 ||
+		error "cannot disable async read-ahead"
+	$LCTL set_param -n llite.*.read_ahead_async_threads 4 ||
+		error "cannot start async read-ahead threads"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats 0
+	dd if=$DIR/$tfile of=/dev/null bs=4k || error "dd read failed"
+
+	$LCTL get_param llite.*.read_ahead_stats
+	async=$($LCTL get_param -n llite.*.read_ahead_stats |
+		get_named_value 'async readahead' | cut -d" " -f1 | calc_total)
+
+	$LCTL set_param -n llite.*.read_ahead_async_threads $old_threads
+	rm -f $DIR/$tfile
+
+	[ $async -gt 0 ] || error "no async read-ahead issued"
+}
+run_test 101i "check async read-ahead threads"
+
+page_arena_stat() {
+	$LCTL get_param -n llite.*.site |
+		awk -v name=$1 '/^arena:/ { for (i = 2; i < NF; i += 2)
+				if ($i == name) sum += $(i + 1) }
+			END { print sum + 0 }'
+}
+
+test_101j() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local orig_batch=$($LCTL get_param -n page_arena_batch 2>/dev/null)
+	local hit_before
+	local hit_after
+	local slab_before
+	local slab_after
+
+	[ -z "$orig_batch" ] && skip "no cl_page arena support" && return
+
+	$SETSTRIPE -c 1 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 ||
+		error "dd $DIR/$tfile failed"
+
+	$LCTL set_param page_arena_batch=16
+	cancel_lru_locks osc
+	hit_before=$(page_arena_stat hit)
+	dd if=$DIR/$tfile of=/dev/null bs=1M || error "dd read failed"
+	hit_after=$(page_arena_stat hit)
+	echo "arena hits: $hit_before -> $hit_after"
+	[ $hit_after -gt $hit_before ] ||
+		error "no page descriptor taken from the arena"
+
+	$LCTL set_param page_arena_batch=0
+	cancel_lru_locks osc
+	hit_before=$(page_arena_stat hit)
+	slab_before=$(page_arena_stat slab)
+	dd if=$DIR/$tfile of=/dev/null bs=1M || error "dd read failed"
+	hit_after=$(page_arena_stat hit)
+	slab_after=$(page_arena_stat slab)
+	$LCTL set_param page_arena_batch=$orig_batch
+	$LCTL get_param llite.*.site
+	rm -f $DIR/$tfile
+
+	[ $hit_after -eq $hit_before ] ||
+		error "arena used with page_arena_batch=0"
+	[ $slab_after -gt $slab_before ] ||
+		error "no page descriptor allocated from slab"
+}
+run_test 101j "batched cl_page allocation"
+
+test_101k() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local parts="osc.*-OST0000-osc-[^M]*.lru_partitions"
+	local ncpus=$(grep -c ^processor /proc/cpuinfo)
+	local taskset=$(which taskset 2> /dev/null)
+	local in_list
+	local sum
+	local cpu
+
+	$LCTL get_param -n $parts &> /dev/null ||
+		{ skip "no per-CPT LRU partitions" && return; }
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe $DIR/$tfile failed"
+	cancel_lru_locks osc
+
+	# write from several CPUs so that pages land in several partitions
+	for ((cpu = 0; cpu < ncpus && cpu < 8; cpu++)); do
+		${taskset:+$taskset -c $cpu} dd if=/dev/zero of=$DIR/$tfile \
+			bs=1M count=4 seek=$((cpu * 4)) conv=notrunc ||
+			error "dd on cpu $cpu failed"
+	done
+	sync
+
+	$LCTL get_param $parts
+	in_list=$($LCTL get_param -n $parts | awk '/^in_list:/ { print $2 }')
+	sum=$($LCTL get_param -n $parts |
+	      awk '/^cpt[0-9]+:/ { sum += $2 } END { print sum + 0 }')
+	(( in_list > 0 )) || error "no page in the LRU"
+	(( sum == in_list )) ||
+		error "partitions hold $sum pages, in_list is $in_list"
+
+	cancel_lru_locks osc
+	$LCTL get_param $parts
+	sum=$($LCTL get_param -n $parts |
+	      awk '/^cpt[0-9]+:/ { sum += $2 } END { print sum + 0 }')
+	rm -f $DIR/$tfile
+	(( sum == 0 )) || error "$sum pages left in the partitions"
+}
+run_test 101k "per-CPT osc LRU partitions add up to in_list"
+
 setup_test102() {
 	test_mkdir -p $DIR/$tdir
 	chown $RUNAS_ID $DIR/$tdir
@@ -8562,6 +8880,43 @@ test_123b () { # statahead(bug 15027)
 }
 run_test 123b "not panic with network error in statahead enqueue (bug 15027)"
 
+test_123c() { # batched statahead getattr
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ -z "$($LCTL get_param -n mdc.*.connect_flags | grep batch_getattr)" ] &&
+		skip "no batched getattr on server" && return
+
+	local batch_max=$($LCTL get_param -n llite.*.statahead_batch_max |
+			  head -n 1)
+	local before
+	local after
+
+	test_mkdir $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile-%d 1000 ||
+		error "create files under $DIR/$tdir failed"
+
+	$LCTL set_param -n llite.*.statahead_batch_max=0
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > $TMP/$tfile.unbatched
+	$LCTL set_param -n llite.*.statahead_batch_max=$batch_max
+	[ -s $TMP/$tfile.unbatched ] ||
+		error "ls -l without batched statahead failed"
+
+	before=$($LCTL get_param -n llite.*.statahead_stats |
+		 awk '/statahead batch:/ { sum += $3 } END { print sum }')
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > $TMP/$tfile.batched ||
+		error "ls -l with batched statahead failed"
+	after=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/statahead batch:/ { sum += $3 } END { print sum }')
+	$LCTL get_param -n llite.*.statahead_stats
+
+	diff -u $TMP/$tfile.unbatched $TMP/$tfile.batched ||
+		error "ls -l differs with batched statahead"
+	rm -f $TMP/$tfile.unbatched $TMP/$tfile.batched
+	[ $after -gt $before ] || error "no batched statahead RPC sent"
+}
+run_test 123c "statahead batches getattr of uncached entries"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	[ -z "$($LCTL get_param -n mdc.*.connect_flags | grep lru_resize)" ] &&
@@ -9644,6 +9999,27 @@ test_133e() {
 }
 run_test 133e "Verifying OST {read,write}_bytes nid stats ================="
 
+test_133h() {
+	local added_before
+	local added_after
+
+	$LCTL get_param -n ptlrpcd.stats ||
+		{ skip "no ptlrpcd stats"; return; }
+
+	added_before=$($LCTL get_param -n ptlrpcd.stats |
+		awk 'NR > 1 { sum += $6 } END { print sum + 0 }')
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=8 ||
+		error "dd failed"
+	sync
+	added_after=$($LCTL get_param -n ptlrpcd.stats |
+		awk 'NR > 1 { sum += $6 } END { print sum + 0 }')
+	echo "ptlrpcd requests added: $added_before -> $added_after"
+	[ $added_after -gt $added_before ] ||
+		error "no request accounted in ptlrpcd stats"
+	rm -f $DIR/$tfile
+}
+run_test 133h "Verifying ptlrpcd per-CPT stats ==========================="
+
 proc_dirs=""
 for dir in /proc/fs/lustre/ /proc/sys/lnet/ /proc/sys/lustre/ \
 	   /sys/fs/lustre/ /sys/fs/lnet/ /sys/kernel/debug/lnet/ \
@@ -10711,6 +11087,124 @@ test_156() {
 }
 run_test 156 "Verification of tunables"
 
+osd_cache_stat() {
+	local list=$(comma_list $(osts_nodes))
+
+	get_osd_param $list '' stats |
+		awk '$1 == "'$1'" {sum += $7} END { printf("%0.0f", sum) }'
+}
+
+test_157() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local list=$(comma_list $(osts_nodes))
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local CPAGES=3
+	local npages=$((16 * 1048576 / $(get_page_size ost1)))
+	local before
+	local after
+
+	save_lustre_params $(get_facets OST) "osd-*.*.cache_policy" > $p
+	save_lustre_params $(get_facets OST) \
+		"osd-*.*.readcache_small_filesize" >> $p
+	save_writethrough $p
+
+	set_osd_param $list '' cache_policy bogus
+	[[ "$(get_osd_param $list '' cache_policy | sort -u)" != "bogus" ]] ||
+		error "bad cache_policy accepted"
+
+	set_cache read on
+	set_cache writethrough on
+	set_osd_param $list '' cache_policy adaptive
+	set_osd_param $list '' readcache_small_filesize 64K
+	roc_hit_init
+
+	log "small file should be cached"
+	dd if=/dev/urandom of=$DIR/$tfile bs=4k count=$CPAGES ||
+		error "dd failed"
+	before=$(roc_hit)
+	cancel_lru_locks osc
+	cat $DIR/$tfile > /dev/null
+	after=$(roc_hit)
+	(( after - before == CPAGES )) ||
+		error "small file not cached: before $before, after $after"
+
+	log "streaming write of a large file should bypass the cache"
+	before=$(osd_cache_stat cache_bypass)
+	dd if=/dev/zero of=$DIR/$tfile.big bs=1M count=16 conv=fsync ||
+		error "dd failed"
+	after=$(osd_cache_stat cache_bypass)
+	(( after - before >= npages / 2 )) ||
+		error "large write cached: bypass before $before, after $after"
+
+	log "with the 'all' policy the large file is cached"
+	set_osd_param $list '' cache_policy all
+	before=$(osd_cache_stat cache_admit)
+	dd if=/dev/zero of=$DIR/$tfile.big bs=1M count=16 conv=fsync ||
+		error "dd failed"
+	after=$(osd_cache_stat cache_admit)
+	(( after - before >= npages )) ||
+		error "large write not cached: admit before $before, after $after"
+
+	rm -f $DIR/$tfile $DIR/$tfile.big
+	restore_lustre_params < $p
+	rm -f $p
+}
+run_test 157 "adaptive OSS cache policy"
+
+test_159() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local list=$(comma_list $(osts_nodes))
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local before
+	local after
+	local released
+	local blocks
+	local i
+
+	save_lustre_params $(get_facets OST) "osd-*.*.prealloc_size" > $p
+	set_osd_param $list '' prealloc_size 4M
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	before=$(osd_cache_stat prealloc)
+	released=$(osd_cache_stat prealloc_release)
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=8 || error "dd failed"
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=1M oflag=direct ||
+		error "streaming write failed"
+	after=$(osd_cache_stat prealloc)
+	(( after > before )) ||
+		error "no blocks reserved: before $before, after $after"
+
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data mismatch"
+
+	# the blocks beyond EOF are released once the object is idle
+	for i in $(seq 30); do
+		(( $(osd_cache_stat prealloc_release) > released )) && break
+		sleep 1
+	done
+	(( $(osd_cache_stat prealloc_release) > released )) ||
+		error "reserved blocks not released"
+	cancel_lru_locks osc
+	blocks=$(stat -c %b $DIR/$tfile)
+	(( blocks * 512 <= 8 * 1048576 + 65536 )) ||
+		error "$blocks blocks allocated for 8MB"
+	(( $(osd_cache_stat stream_extents) > 0 )) ||
+		error "no extents reported for the streamed object"
+
+	rm -f $DIR/$tfile $TMP/$tfile
+	restore_lustre_params < $p
+	rm -f $p
+}
+run_test 159 "reserve blocks ahead of streaming writers"
+
 #Changelogs
 cleanup_changelog () {
 	trap 0
@@ -11251,6 +11745,221 @@ test_162c() {
 }
 run_test 162c "fid2path works with paths 100 or more directories deep"
 
+test_163() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local before
+	local after
+	local sum
+	local i
+
+	save_lustre_params $(get_facets OST) "osd-*.*.read_cache_enable" > $p
+	save_lustre_params $(get_facets OST) \
+		"osd-*.*.read_set_cache_size" >> $p
+	set_cache read on
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$TMP/$tfile bs=64k count=16 || error "dd failed"
+	cp $TMP/$tfile $DIR/$tfile || error "cp failed"
+	sync
+
+	# the pages of a hot object are shared by the following reads
+	before=$(osd_cache_stat read_set_hit)
+	for i in $(seq 4); do
+		cancel_lru_locks osc
+		cmp $TMP/$tfile $DIR/$tfile || error "data mismatch on read $i"
+	done
+	after=$(osd_cache_stat read_set_hit)
+	(( after > before )) ||
+		error "no read page set hit: before $before, after $after"
+
+	# an overwrite invalidates the read page set
+	dd if=/dev/urandom of=$TMP/$tfile bs=64k count=16 || error "dd failed"
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=64k conv=notrunc ||
+		error "overwrite failed"
+	sum=$(md5sum < $TMP/$tfile)
+	cancel_lru_locks osc
+	[[ "$(md5sum < $DIR/$tfile)" == "$sum" ]] ||
+		error "stale data read after overwrite"
+
+	# no sets are kept once the cache is disabled
+	set_osd_param $(comma_list $(osts_nodes)) '' read_set_cache_size 0
+	before=$(osd_cache_stat read_set_hit)
+	for i in $(seq 4); do
+		cancel_lru_locks osc
+		cmp $TMP/$tfile $DIR/$tfile || error "data mismatch on read $i"
+	done
+	after=$(osd_cache_stat read_set_hit)
+	(( after == before )) ||
+		error "read page set hit with no cache: $before != $after"
+
+	rm -f $DIR/$tfile $TMP/$tfile
+	restore_lustre_params < $p
+	rm -f $p
+}
+run_test 163 "shared read page sets for hot objects"
+
+test_164() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local param=osc.$FSNAME-OST0000-osc-[^mM]*
+	local max_pages=$($LCTL get_param -n $param.max_pages_per_rpc)
+	local max_rif=$($LCTL get_param -n $param.max_rpcs_in_flight)
+	local windows
+	local pages
+	local rif
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	$LCTL set_param -n $param.rpc_autotune_stats=0
+	$LCTL set_param -n $param.rpc_autotune=1
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=64 || error "dd failed"
+	cp $TMP/$tfile $DIR/$tfile || error "cp failed"
+	sync
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data mismatch"
+
+	$LCTL get_param $param.rpc_autotune_stats
+	windows=$($LCTL get_param -n $param.rpc_autotune_stats |
+		  awk '/^windows/ { print $2 }')
+	pages=$($LCTL get_param -n $param.rpc_autotune_stats |
+		awk '/^pages_per_rpc/ { print $2 }')
+	rif=$($LCTL get_param -n $param.rpc_autotune_stats |
+	      awk '/^rpcs_in_flight/ { print $2 }')
+	$LCTL set_param -n $param.rpc_autotune=0
+
+	(( ${windows:-0} > 0 )) || error "no RPC sampled by the auto-tuning"
+	(( pages > 0 && pages <= max_pages )) ||
+		error "pages_per_rpc $pages out of 1..$max_pages"
+	(( rif > 0 && rif <= max_rif )) ||
+		error "rpcs_in_flight $rif out of 1..$max_rif"
+
+	rm -f $DIR/$tfile $TMP/$tfile
+}
+run_test 164 "auto-tuning of the OSC RPC size and depth"
+
+test_166() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local imp=$($LCTL get_param -n osc.$FSNAME-OST0000-osc-[^M]*.import)
+	local before
+	local after
+	local sum
+
+	echo "$imp" | grep -q server_copy ||
+		{ skip "OST does not support OST_COPY" && return; }
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$DIR/$tfile bs=1M count=20 ||
+		error "write of $tfile failed"
+	sum=$(md5sum < $DIR/$tfile)
+
+	before=$(do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.stats |
+		 awk '/^ost_copy/ { print $2 }')
+	$LFS migrate -n -c 1 -i 0 $DIR/$tfile || error "migrate failed"
+	after=$(do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.stats |
+		awk '/^ost_copy/ { print $2 }')
+	(( ${after:-0} > ${before:-0} )) ||
+		error "migrate on the same OST did not use OST_COPY"
+
+	cancel_lru_locks osc
+	[[ "$(md5sum < $DIR/$tfile)" == "$sum" ]] ||
+		error "data mismatch after the server side copy"
+	[ $($LFS getstripe -i $DIR/$tfile) -eq 0 ] ||
+		error "file moved away from OST0000"
+	rm -f $DIR/$tfile
+}
+run_test 166 "server side copy of a single stripe file"
+
+test_167() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+	[ "$(facet_fstype ost1)" != "ldiskfs" ] &&
+		skip "ldiskfs only test" && return
+
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local prefetch
+	local merged
+	local used
+	local sum
+
+	save_lustre_params $(get_facets OST) "osd-*.*.read_cache_enable" > $p
+	save_lustre_params $(get_facets OST) \
+		"osd-*.*.prefetch_delay_ms" >> $p
+	set_cache read on
+	# keep the advices long enough for them to be merged
+	set_osd_param $(comma_list $(osts_nodes)) '' prefetch_delay_ms 1000
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	dd if=/dev/urandom of=$DIR/$tfile bs=1M count=16 || error "dd failed"
+	sum=$(md5sum < $DIR/$tfile)
+	$LFS ladvise -a dontneed $DIR/$tfile || error "dontneed failed"
+
+	prefetch=$(osd_cache_stat prefetch)
+	merged=$(osd_cache_stat prefetch_merged)
+	used=$(osd_cache_stat prefetch_used)
+
+	$LFS ladvise -a willread -s 0 -e 8M $DIR/$tfile ||
+		error "willread of the first half failed"
+	$LFS ladvise -a willread -s 4M -e 16M $DIR/$tfile ||
+		error "willread of the second half failed"
+	sleep 2
+
+	(( $(osd_cache_stat prefetch_merged) > merged )) ||
+		error "overlapping advices were not merged"
+	(( $(osd_cache_stat prefetch) > prefetch )) ||
+		error "no pages were read ahead"
+
+	cancel_lru_locks osc
+	[[ "$(md5sum < $DIR/$tfile)" == "$sum" ]] ||
+		error "data mismatch after the read ahead"
+	(( $(osd_cache_stat prefetch_used) > used )) ||
+		error "the pages read ahead were not used"
+
+	restore_lustre_params < $p
+	rm -f $p $DIR/$tfile
+}
+run_test 167 "merged WILLREAD read ahead on the OSS"
+
+test_168() {
+	$LCTL get_param -n osc.*-OST0000-osc-[^M]*.connect_flags |
+		grep -q lock_ahead || { skip "no lock ahead support" && return; }
+
+	local ns="ldlm.namespaces.*-OST0000-osc-[^M]*.lock_count"
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+	(( $($LCTL get_param -n $ns) == 0 )) || error "locks left after cancel"
+
+	$LFS ladvise -a lockahead -m WRITE -s 0 -e 1M $DIR/$tfile ||
+		error "lockahead of [0, 1M) failed"
+	# the locks are requested asynchronously
+	sleep 1
+	(( $($LCTL get_param -n $ns) == 1 )) || error "no lock was granted"
+
+	# a lock expanded to the whole file would cover this range as well
+	$LFS ladvise -a lockahead -m WRITE -s 4M -e 5M $DIR/$tfile ||
+		error "lockahead of [4M, 5M) failed"
+	sleep 1
+	(( $($LCTL get_param -n $ns) == 2 )) ||
+		error "the lock of [0, 1M) was expanded"
+
+	# the writes use the locks taken ahead
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 conv=notrunc ||
+		error "write of [0, 1M) failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 seek=4 conv=notrunc ||
+		error "write of [4M, 5M) failed"
+	(( $($LCTL get_param -n $ns) == 2 )) ||
+		error "the writes did not use the locks taken ahead"
+
+	$LFS ladvise -a lockahead -s 0 -e 1M $DIR/$tfile 2>/dev/null &&
+		error "lockahead without a mode succeeded"
+
+	rm -f $DIR/$tfile
+}
+run_test 168 "lock ahead of extent locks with ladvise"
+
 test_169() {
 	# do directio so as not to populate the page cache
 	log "creating a 10 Mb file"
@@ -11341,6 +12050,333 @@ test_171() { # bug20592
 }
 run_test 171 "test libcfs_debug_dumplog_thread stuck in do_exit() ======"
 
+# average enqueue latency in usec of the lock of $2 through namespace $1,
+# each of the $3 locks is enqueued again after the LRU is cleared
+dir_enqueue_usec() {
+	local name=$1
+	local dir=$2
+	local rounds=$3
+	local i
+
+	$LCTL set_param -n mdc.$name.stats=clear
+	for ((i = 0; i < rounds; i++)); do
+		$LCTL set_param -n ldlm.namespaces.$name.lru_size=clear
+		stat $dir > /dev/null || return 1
+	done
+	$LCTL get_param -n mdc.$name.stats |
+		awk '/^ldlm_enqueue / { print int($7 / $2) }'
+}
+
+test_172() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+
+	local steps="16"
+	local rounds=100
+	local inst=$($LFS getname $MOUNT | cut -d' ' -f1)
+	local name=$FSNAME-MDT0000-mdc-${inst##*-}
+	local submnt=${MOUNT}_$tdir
+	local mounts=0
+	local report
+	local locks
+	local few
+	local many
+	local step
+	local rc=0
+	local i
+
+	# Each granted lock on the directory needs its own export: the locks
+	# of one client on a resource are matched and reused instead of being
+	# granted again, so the lock count only grows with the client mounts.
+	# That keeps it far below what would show a walk of all the locks in
+	# the enqueue latency; the slow run goes 4 times further.
+	[ "$SLOW" = "yes" ] && steps="16 64"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	few=$(dir_enqueue_usec $name $DIR/$tdir $rounds) ||
+		error "stat $DIR/$tdir failed"
+	(( few > 0 )) || error "no enqueue latency measured"
+	report="$few usec alone"
+
+	for step in $steps; do
+		# each mount holds its own granted lookup and update locks
+		for ((; mounts < step; mounts++)); do
+			mkdir -p $submnt$mounts &&
+				mount_client $submnt$mounts > /dev/null &&
+				stat $submnt$mounts/$tdir > /dev/null &&
+				ls $submnt$mounts/$tdir > /dev/null ||
+				{ rc=1; break 2; }
+		done
+		locks=$(do_facet mds1 $LCTL get_param -n \
+			ldlm.namespaces.mdt-*-MDT0000_UUID.lock_count)
+		(( locks >= mounts )) || { rc=2; break; }
+		many=$(dir_enqueue_usec $name $DIR/$tdir $rounds) ||
+			{ rc=1; break; }
+		report+=", $many usec with $mounts more clients ($locks locks)"
+		# with the index, the latency must not follow the lock count
+		(( many * 2 <= few * 3 )) || { rc=3; break; }
+	done
+
+	for ((i = 0; i <= mounts; i++)); do
+		umount_client $submnt$i > /dev/null 2>&1
+		rmdir $submnt$i 2> /dev/null
+	done
+	echo "enqueue: $report"
+	(( rc != 1 )) || error "cannot build $mounts locks on $DIR/$tdir"
+	(( rc != 2 )) || error "only $locks locks on the MDT"
+	(( rc != 3 )) || error "enqueue latency grew by over half: $report"
+	rm -rf $DIR/$tdir
+}
+run_test 172 "enqueue latency with many locks on one resource"
+
+test_173() {
+	$LCTL get_param -n osc.*-OST0000-osc-[^M]*.connect_flags |
+		grep -q batch_bl_ast ||
+		{ skip "no batched blocking AST support" && return; }
+	$LCTL get_param -n osc.*-OST0000-osc-[^M]*.connect_flags |
+		grep -q lock_ahead || { skip "no lock ahead support" && return; }
+
+	local ns="ldlm.namespaces.*-OST0000-osc-[^M]*.lock_count"
+	local stats="ldlm.services.ldlm_cbd.stats"
+	local count=100
+	local bl1
+	local bl2
+	local i
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+
+	# disjoint locks which are not expanded into each other
+	for (( i = 0; i < count; i++ )); do
+		$LFS ladvise -a lockahead -m WRITE -s $((i * 2))M \
+			-e $((i * 2 + 1))M $DIR/$tfile ||
+			error "lockahead of lock $i failed"
+	done
+	sleep 1
+	(( $($LCTL get_param -n $ns) == count )) ||
+		error "$($LCTL get_param -n $ns) locks granted, not $count"
+
+	bl1=$($LCTL get_param -n $stats | awk '/ldlm_bl_callback/ {print $2}')
+	# the PR lock of willread on the OST conflicts with all of them
+	$LFS ladvise -a willread -s 0 -e $((count * 2))M $DIR/$tfile ||
+		error "willread failed"
+	bl2=$($LCTL get_param -n $stats | awk '/ldlm_bl_callback/ {print $2}')
+
+	(( $($LCTL get_param -n $ns) == 0 )) ||
+		error "$($LCTL get_param -n $ns) locks left after revoke"
+	echo "$count locks revoked with $((bl2 - bl1)) blocking AST RPCs"
+	(( bl2 - bl1 < count )) || error "the blocking ASTs were not batched"
+
+	rm -f $DIR/$tfile
+}
+run_test 173 "blocking ASTs of one export are batched"
+
+test_174() {
+	$LCTL get_param -n osc.*-OST0000-osc-[^M]*.connect_flags |
+		grep -q lock_ahead || { skip "no lock ahead support" && return; }
+
+	local wl="ldlm.waiting_locks"
+	local ns="ldlm.namespaces.*-OST0000-osc-[^M]*.lock_count"
+	local count=100
+	local cpts
+	local timeouts
+	local waiting
+	local i
+
+	cpts=$(do_facet ost1 $LCTL get_param -n cpu_partition_table | wc -l)
+	(( $(do_facet ost1 $LCTL get_param -n $wl | wc -l) == cpts )) ||
+		error "not one waiting lock wheel per CPT"
+	timeouts=$(do_facet ost1 $LCTL get_param -n $wl |
+		   awk '{ sum += $6 } END { print sum }')
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+
+	for (( i = 0; i < count; i++ )); do
+		$LFS ladvise -a lockahead -m WRITE -s $((i * 2))M \
+			-e $((i * 2 + 1))M $DIR/$tfile ||
+			error "lockahead of lock $i failed"
+	done
+	sleep 1
+	(( $($LCTL get_param -n $ns) == count )) ||
+		error "$($LCTL get_param -n $ns) locks granted, not $count"
+
+	# the locks wait in the wheels until the client cancels them
+	$LFS ladvise -a willread -s 0 -e $((count * 2))M $DIR/$tfile ||
+		error "willread failed"
+	do_facet ost1 $LCTL get_param $wl
+
+	waiting=$(do_facet ost1 $LCTL get_param -n $wl |
+		  awk '{ sum += $4 } END { print sum }')
+	(( waiting == 0 )) || error "$waiting locks left waiting"
+	(( $(do_facet ost1 $LCTL get_param -n $wl |
+	     awk '{ sum += $6 } END { print sum }') == timeouts )) ||
+		error "lock callback timers expired"
+
+	rm -f $DIR/$tfile
+}
+run_test 174 "waiting lock wheels of the CPTs"
+
+test_175() {
+	$LCTL get_param -n ldlm.namespaces.*-MDT0000-mdc-*.lru_policy \
+		&> /dev/null || { skip "no lock LRU policy support" && return; }
+
+	local ns="ldlm.namespaces.*-MDT0000-mdc-*"
+	local stats="mdc.*-MDT0000-mdc-*.stats"
+	local hot=50
+	local cold=1000
+	local enq
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/hot- $hot || error "create hot files failed"
+	createmany -o $DIR/$tdir/cold- $cold || error "create cold files failed"
+
+	cancel_lru_locks mdc
+	$LCTL set_param -n $ns.lru_size=200
+	$LCTL set_param -n $ns.lru_policy=2q ||
+		{ lru_resize_enable mdc; error "cannot select 2q"; }
+	$LCTL set_param -n $ns.stats=clear
+
+	# the working set is used twice, then a scan over many more files
+	# than the LRU can hold must not push it out
+	ls -l $DIR/$tdir/hot-* > /dev/null
+	ls -l $DIR/$tdir/hot-* > /dev/null
+	ls -l $DIR/$tdir/cold-* > /dev/null
+
+	$LCTL set_param -n $stats=clear
+	ls -l $DIR/$tdir/hot-* > /dev/null
+	enq=$($LCTL get_param -n $stats |
+	      awk '/^ldlm_enqueue / { print $2 }')
+	$LCTL get_param $ns.stats
+
+	$LCTL set_param -n $ns.lru_policy=lru
+	lru_resize_enable mdc
+	rm -rf $DIR/$tdir
+
+	(( ${enq:-0} < hot / 2 )) ||
+		error "$enq enqueues to use $hot hot files again"
+}
+run_test 175 "2Q policy of the client lock LRU"
+
+mdt_site_busy() {
+	do_facet mds1 $LCTL get_param -n mdt.$FSNAME-MDT0000.site_stats |
+		awk '{ split($1, busy, "/"); print busy[1] }'
+}
+
+test_176() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local nr=200
+	local procs=4
+	local loops=5
+	local ready=$TMP/$tfile.ready
+	local busy_base
+	local busy_held
+	local busy_after
+	local holder
+	local pids=""
+	local p
+	local i
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f- $nr || error "create files failed"
+	cancel_lru_locks mdc
+	busy_base=$(mdt_site_busy)
+	rm -f $ready
+
+	# the readers find and put the same MDT objects concurrently, while
+	# another process looks them up once more and keeps them open
+	for ((p = 0; p < procs; p++)); do
+		( for ((i = 0; i < loops; i++)); do
+			cat $DIR/$tdir/f-* > /dev/null || exit 1
+		  done ) &
+		pids+=" $!"
+	done
+	( for f in $DIR/$tdir/f-*; do exec {fd}>>$f || exit 1; done
+	  touch $ready; sleep 300 ) &
+	holder=$!
+
+	for p in $pids; do
+		wait $p || error "concurrent reads failed"
+	done
+	for ((i = 0; i < 60; i++)); do
+		[ -f $ready ] && break
+		sleep 1
+	done
+	[ -f $ready ] || { kill $holder; error "files not opened"; }
+	busy_held=$(mdt_site_busy)
+	kill $holder
+	wait $holder 2> /dev/null
+
+	for ((i = 0; i < 10; i++)); do
+		busy_after=$(mdt_site_busy)
+		(( busy_after <= busy_held - nr )) && break
+		sleep 1
+	done
+	do_facet mds1 $LCTL get_param mdt.$FSNAME-MDT0000.site_stats
+	echo "busy objects: $busy_base, open: $busy_held, closed: $busy_after"
+	rm -rf $DIR/$tdir $ready
+
+	(( busy_held >= busy_base + nr )) ||
+		error "$nr open files, only $((busy_held - busy_base)) busy"
+	(( busy_after <= busy_held - nr )) ||
+		error "$((busy_held - busy_after)) objects idle after close"
+}
+run_test 176 "concurrent lu_object lookups keep the busy count exact"
+
+# open/close rate of $3 processes reopening the files $1-0 to $1-($2 - 1)
+open_rate() {
+	local prefix=$1
+	local nr=$2
+	local procs=$3
+	local start
+	local end
+	local rc=0
+	local pids=""
+	local p
+
+	start=$(date +%s%N)
+	for ((p = 0; p < procs; p++)); do
+		createmany -o $prefix $nr > /dev/null &
+		pids+=" $!"
+	done
+	for p in $pids; do
+		wait $p || rc=1
+	done
+	end=$(date +%s%N)
+	(( rc == 0 )) || return 1
+	echo $((procs * nr * 1000000000 / (end - start)))
+}
+
+test_177() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+
+	local nr=2000
+	local procs=$(grep -c ^processor /proc/cpuinfo)
+	local single
+	local many
+
+	(( procs > 8 )) && procs=8
+	(( procs < 2 )) && procs=2
+	[ "$SLOW" = "yes" ] && nr=10000
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f- $nr || error "create files failed"
+
+	# every open looks up the cached MDT objects of the parent and of
+	# the file, so the aggregate rate shows whether the lookups of
+	# concurrent requests serialize in the site hash
+	open_rate $DIR/$tdir/f- $nr 1 > /dev/null || error "warm-up failed"
+	single=$(open_rate $DIR/$tdir/f- $nr 1) || error "open failed"
+	many=$(open_rate $DIR/$tdir/f- $nr $procs) || error "open failed"
+	rm -rf $DIR/$tdir
+
+	echo "open/close: $single/s with 1 process, $many/s with $procs"
+	(( many >= single )) ||
+		error "$procs processes open slower than one: $many < $single"
+}
+run_test 177 "open rate of concurrent lookups of cached MDT objects"
+
 # it would be good to share it with obdfilter-survey/iokit-libecho code
 setup_obdecho_osc () {
         local rc=0
@@ -15428,6 +16464,43 @@ test_313() {
 }
 run_test 313 "io should fail after last_rcvd update fail"
 
+test_314() {
+	which $PARALLEL_WRITE > /dev/null 2>&1 ||
+		{ skip "$PARALLEL_WRITE not found"; return; }
+
+	local bsize=$((64 * 1024))
+	local count=64
+	local threads
+	local flag
+	local blk
+
+	# disjoint writes of one file from a growing number of threads, the
+	# range lock must not serialize them nor let them corrupt each other
+	for flag in "" "-d"; do
+		for threads in 1 2 4 8; do
+			rm -f $DIR/$tfile
+			$SETSTRIPE -c -1 $DIR/$tfile ||
+				error "setstripe $DIR/$tfile failed"
+			$PARALLEL_WRITE $flag -t $threads -b $bsize -c $count \
+				$DIR/$tfile || error "$threads writers failed"
+		done
+	done
+
+	cancel_lru_locks osc
+	$CHECKSTAT -t file -s $((bsize * count * threads)) $DIR/$tfile ||
+		error "$tfile size not $((bsize * count * threads))"
+	for blk in 0 1 7 $((count * threads - 1)); do
+		local expect=$(printf "\\$(printf %o $((97 + blk % threads)))")
+		local bad=$(dd if=$DIR/$tfile bs=$bsize skip=$blk count=1 \
+			    2>/dev/null | tr -d "$expect" | wc -c)
+
+		[ $bad -eq 0 ] ||
+			error "block $blk not written by thread $((blk % threads))"
+	done
+	rm -f $DIR/$tfile
+}
+run_test 314 "parallel writes of disjoint regions of one file"
+
 test_399() { # LU-7655 for OST fake write
 	# turn off debug for performance testing
 	local saved_debug=$($LCTL get_param -n debug)
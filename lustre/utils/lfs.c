@@ -53,6 +53,7 @@
 #include <grp.h>
 #include <sys/ioctl.h>
 #include <sys/quota.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -385,9 +386,10 @@ command_t cmdlist[] = {
 	{"ladvise", lfs_ladvise, 0,
 	 "Provide servers with advice about access patterns for a file.\n"
 	 "usage: ladvise [--advice|-a ADVICE] [--start|-s START[kMGT]]\n"
-	 "               [--background|-b]\n"
+	 "               [--background|-b] [--mode|-m {READ|WRITE}]\n"
 	 "               {[--end|-e END[kMGT]] | [--length|-l LENGTH[kMGT]]}\n"
-	 "               <file> ..."},
+	 "               <file> ...\n"
+	 "\tmode: lock mode of the lockahead advice, READ or WRITE"},
 	{"help", Parser_help, 0, "help"},
 	{"exit", Parser_quit, 0, "quit"},
 	{"quit", Parser_quit, 0, "quit"},
@@ -437,6 +439,54 @@ static int check_lease(int fd, bool *lease_broken, bool group_locked,
 	return rc;
 }
 
+/* OST index of the single stripe of the file of \a fd, or -1 */
+static int64_t migrate_single_ost(int fd)
+{
+	struct llapi_layout	*layout;
+	uint64_t		 count;
+	uint64_t		 index;
+	int64_t			 ost = -1;
+
+	layout = llapi_layout_get_by_fd(fd, 0);
+	if (layout == NULL)
+		return -1;
+
+	if (llapi_layout_stripe_count_get(layout, &count) == 0 && count == 1 &&
+	    llapi_layout_ost_index_get(layout, 0, &index) == 0)
+		ost = index;
+	llapi_layout_free(layout);
+
+	return ost;
+}
+
+/* Copy the data of \a fd_src into \a fd_dst on the OST with
+ * copy_file_range(), when both files have their only stripe on the same
+ * OST. Return the number of bytes copied, the caller copies the rest, if
+ * any, through the client. */
+static off_t migrate_copy_server(int fd_src, int fd_dst, size_t buf_size)
+{
+	off_t	pos = 0;
+#ifdef __NR_copy_file_range
+	int64_t	ost = migrate_single_ost(fd_src);
+
+	if (ost < 0 || migrate_single_ost(fd_dst) != ost)
+		return 0;
+
+	while (1) {
+		loff_t	off_in = pos;
+		loff_t	off_out = pos;
+		ssize_t	nob;
+
+		nob = syscall(__NR_copy_file_range, fd_src, &off_in, fd_dst,
+			      &off_out, buf_size, 0);
+		if (nob <= 0)
+			break;
+		pos += nob;
+	}
+#endif
+	return pos;
+}
+
 static int migrate_copy_data(int fd_src, int fd_dst, size_t buf_size,
 			     bool group_locked, const char *fname)
 {
@@ -449,6 +499,20 @@ static int migrate_copy_data(int fd_src, int fd_dst, size_t buf_size,
 	int	 rc;
 	bool	 lease_broken = false;
 
+	/* The OST takes an extent lock on the source for the copy, which
+	 * would wait for our own group lock. */
+	if (!group_locked) {
+		rpos = wpos = migrate_copy_server(fd_src, fd_dst, buf_size);
+		if (rpos > 0 &&
+		    (lseek(fd_src, rpos, SEEK_SET) < 0 ||
+		     lseek(fd_dst, wpos, SEEK_SET) < 0)) {
+			rc = -errno;
+			fprintf(stderr, "%s: %s: seek failed: %s\n",
+				progname, fname, strerror(-rc));
+			return rc;
+		}
+	}
+
 	/* Use a page-aligned buffer for direct I/O */
 	rc = posix_memalign(&buf, getpagesize(), buf_size);
 	if (rc != 0)
@@ -4393,6 +4457,22 @@ static int lfs_swap_layouts(int argc, char **argv)
 
 static const char *const ladvise_names[] = LU_LADVISE_NAMES;
 
+static const char *const lock_mode_names[] = LOCK_MODE_NAMES;
+
+static int lfs_get_mode(const char *string)
+{
+	int mode;
+
+	for (mode = 0; mode < ARRAY_SIZE(lock_mode_names); mode++) {
+		if (lock_mode_names[mode] == NULL)
+			continue;
+		if (strcasecmp(string, lock_mode_names[mode]) == 0)
+			return mode;
+	}
+
+	return -EINVAL;
+}
+
 static enum lu_ladvise_type lfs_get_ladvice(const char *string)
 {
 	enum lu_ladvise_type advice;
@@ -4416,9 +4496,10 @@ static int lfs_ladvise(int argc, char **argv)
 		{"end",		required_argument,	0, 'e'},
 		{"start",	required_argument,	0, 's'},
 		{"length",	required_argument,	0, 'l'},
+		{"mode",	required_argument,	0, 'm'},
 		{0, 0, 0, 0}
 	};
-	char			 short_opts[] = "a:be:l:s:";
+	char			 short_opts[] = "a:be:l:m:s:";
 	int			 c;
 	int			 rc = 0;
 	const char		*path;
@@ -4430,6 +4511,7 @@ static int lfs_ladvise(int argc, char **argv)
 	unsigned long long	 length = 0;
 	unsigned long long	 size_units;
 	unsigned long long	 flags = 0;
+	int			 mode = 0;
 
 	optind = 0;
 	while ((c = getopt_long(argc, argv, short_opts,
@@ -4488,6 +4570,15 @@ static int lfs_ladvise(int argc, char **argv)
 				return CMD_HELP;
 			}
 			break;
+		case 'm':
+			mode = lfs_get_mode(optarg);
+			if (mode < 0) {
+				fprintf(stderr, "%s: bad mode '%s', valid "
+					"modes are READ or WRITE\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			break;
 		case '?':
 			return CMD_HELP;
 		default:
@@ -4516,6 +4607,18 @@ static int lfs_ladvise(int argc, char **argv)
 		return CMD_HELP;
 	}
 
+	if (advice_type == LU_LADVISE_LOCKAHEAD && mode == 0) {
+		fprintf(stderr, "%s: please give a lock mode for lockahead\n",
+			argv[0]);
+		return CMD_HELP;
+	}
+
+	if (advice_type != LU_LADVISE_LOCKAHEAD && mode != 0) {
+		fprintf(stderr, "%s: lock mode is only valid for lockahead\n",
+			argv[0]);
+		return CMD_HELP;
+	}
+
 	if (end != LUSTRE_EOF && length != 0 && end != start + length) {
 		fprintf(stderr, "%s: conflicting arguments of -l and -e\n",
 			argv[0]);
@@ -4547,7 +4650,8 @@ static int lfs_ladvise(int argc, char **argv)
 		advice.lla_start = start;
 		advice.lla_end = end;
 		advice.lla_advice = advice_type;
-		advice.lla_value1 = 0;
+		/* zero unless the advice is lockahead */
+		advice.lla_lockahead_mode = mode;
 		advice.lla_value2 = 0;
 		advice.lla_value3 = 0;
 		advice.lla_value4 = 0;
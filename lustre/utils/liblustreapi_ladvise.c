@@ -44,7 +44,8 @@
  * Give file access advices
  *
  * \param fd       File to give advice on.
- * \param ladvise  Advice to give.
+ * \param ladvise  Advice to give. The results of LU_LADVISE_LOCKAHEAD
+ *                 advices are returned in lla_lockahead_result.
  *
  * \retval 0 on success.
  * \retval -1 on failure, errno set
@@ -76,9 +77,16 @@ int llapi_ladvise(int fd, unsigned long long flags, int num_advise,
 
 	rc = ioctl(fd, LL_IOC_LADVISE, ladvise_hdr);
 	if (rc < 0) {
-		llapi_error(LLAPI_MSG_ERROR, -errno, "cannot give advice");
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot give advice");
+		free(ladvise_hdr);
+		errno = -rc;
 		return -1;
 	}
+
+	memcpy(ladvise, ladvise_hdr->lah_advise,
+	       sizeof(*ladvise) * num_advise);
+	free(ladvise_hdr);
 	return 0;
 }
 
@@ -321,6 +321,7 @@ check_lu_ladvise(void)
 	CHECK_MEMBER(lu_ladvise, lla_value4);
 	CHECK_VALUE(LU_LADVISE_WILLREAD);
 	CHECK_VALUE(LU_LADVISE_DONTNEED);
+	CHECK_VALUE(LU_LADVISE_LOCKAHEAD);
 }
 
 static void
@@ -499,7 +500,7 @@ check_obd_connect_data(void)
 	CHECK_MEMBER(obd_connect_data, ocd_maxbytes);
 	CHECK_MEMBER(obd_connect_data, ocd_maxmodrpcs);
 	CHECK_MEMBER(obd_connect_data, padding0);
-	CHECK_MEMBER(obd_connect_data, padding1);
+	CHECK_MEMBER(obd_connect_data, ocd_compr_types);
 	CHECK_MEMBER(obd_connect_data, ocd_connect_flags2);
 	CHECK_MEMBER(obd_connect_data, padding3);
 	CHECK_MEMBER(obd_connect_data, padding4);
@@ -578,10 +579,18 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_OBDOPACK);
 	CHECK_DEFINE_64X(OBD_CONNECT_FLAGS2);
 	CHECK_DEFINE_64X(OBD_CONNECT2_FILE_SECCTX);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_GETATTR);
+	CHECK_DEFINE_64X(OBD_CONNECT2_COMPRESS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_SERVER_COPY);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_BL_AST);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
 	CHECK_VALUE_X(OBD_CKSUM_CRC32C);
+	CHECK_VALUE_X(OBD_CKSUM_T10IP512);
+	CHECK_VALUE_X(OBD_CKSUM_T10IP4K);
+	CHECK_VALUE_X(OBD_CKSUM_T10CRC512);
+	CHECK_VALUE_X(OBD_CKSUM_T10CRC4K);
 }
 
 static void
@@ -675,7 +684,10 @@ check_obdo(void)
 	CHECK_CVALUE_X(OBD_FL_CKSUM_CRC32);
 	CHECK_CVALUE_X(OBD_FL_CKSUM_ADLER);
 	CHECK_CVALUE_X(OBD_FL_CKSUM_CRC32C);
-	CHECK_CVALUE_X(OBD_FL_CKSUM_RSVD2);
+	CHECK_CVALUE_X(OBD_FL_CKSUM_T10IP512);
+	CHECK_CVALUE_X(OBD_FL_CKSUM_T10IP4K);
+	CHECK_CVALUE_X(OBD_FL_CKSUM_T10CRC512);
+	CHECK_CVALUE_X(OBD_FL_CKSUM_T10CRC4K);
 	CHECK_CVALUE_X(OBD_FL_CKSUM_RSVD3);
 	CHECK_CVALUE_X(OBD_FL_SHRINK_GRANT);
 	CHECK_CVALUE_X(OBD_FL_MMAP);
@@ -922,6 +934,23 @@ check_niobuf_remote(void)
 	CHECK_DEFINE_X(OBD_BRW_SOFT_SYNC);
 }
 
+static void
+check_brw_compr_hdr(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(brw_compr_hdr);
+	CHECK_MEMBER(brw_compr_hdr, bch_type);
+	CHECK_MEMBER(brw_compr_hdr, bch_chunk_size);
+	CHECK_MEMBER(brw_compr_hdr, bch_count);
+	CHECK_MEMBER(brw_compr_hdr, bch_padding);
+	CHECK_MEMBER(brw_compr_hdr, bch_chunk_len[0]);
+
+	CHECK_VALUE(OBD_COMPR_NONE);
+	CHECK_VALUE(OBD_COMPR_LZ4);
+	CHECK_VALUE(OBD_COMPR_LZO);
+	CHECK_VALUE(OBD_COMPR_DEFLATE);
+}
+
 static void
 check_ost_body(void)
 {
@@ -930,6 +959,19 @@ check_ost_body(void)
 	CHECK_MEMBER(ost_body, oa);
 }
 
+static void
+check_ost_copy(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(ost_copy);
+	CHECK_MEMBER(ost_copy, oc_src_oi);
+	CHECK_MEMBER(ost_copy, oc_src_offset);
+	CHECK_MEMBER(ost_copy, oc_dst_offset);
+	CHECK_MEMBER(ost_copy, oc_length);
+	CHECK_MEMBER(ost_copy, oc_flags);
+	CHECK_MEMBER(ost_copy, oc_padding);
+}
+
 static void
 check_ll_fid(void)
 {
@@ -1032,6 +1074,32 @@ check_mdt_ioepoch(void)
 	CHECK_MEMBER(mdt_ioepoch, mio_padding);
 }
 
+static void
+check_mdt_batch_getattr_item(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_getattr_item);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_lockh);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_fid);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_namelen);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_padding0);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_padding1);
+	CHECK_MEMBER(mdt_batch_getattr_item, mgi_name[0]);
+}
+
+static void
+check_mdt_batch_getattr_reply(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(mdt_batch_getattr_reply);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_status);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_padding);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_lockh);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_bits);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_flags);
+	CHECK_MEMBER(mdt_batch_getattr_reply, mgr_body);
+}
+
 static void
 check_mdt_rec_setattr(void)
 {
@@ -2432,6 +2500,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(OST_QUOTACTL);
 	CHECK_VALUE(OST_QUOTA_ADJUST_QUNIT);
 	CHECK_VALUE(OST_LADVISE);
+	CHECK_VALUE(OST_COPY);
 	CHECK_VALUE(OST_LAST_OPC);
 
 	CHECK_DEFINE_64X(OBD_OBJECT_EOF);
@@ -2472,6 +2541,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(MDS_HSM_CT_REGISTER);
 	CHECK_VALUE(MDS_HSM_CT_UNREGISTER);
 	CHECK_VALUE(MDS_SWAP_LAYOUTS);
+	CHECK_VALUE(MDS_BATCH_GETATTR);
 	CHECK_VALUE(MDS_LAST_OPC);
 
 	CHECK_VALUE(REINT_SETATTR);
@@ -2643,10 +2713,14 @@ main(int argc, char **argv)
 	check_obd_quotactl();
 	check_obd_idx_read();
 	check_niobuf_remote();
+	check_brw_compr_hdr();
 	check_ost_body();
+	check_ost_copy();
 	check_ll_fid();
 	check_mdt_body();
 	check_mdt_ioepoch();
+	check_mdt_batch_getattr_item();
+	check_mdt_batch_getattr_reply();
 	check_mdt_rec_setattr();
 	check_mdt_rec_create();
 	check_mdt_rec_link();
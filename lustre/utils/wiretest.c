@@ -122,7 +122,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)OST_QUOTA_ADJUST_QUNIT);
 	LASSERTF(OST_LADVISE == 21, "found %lld\n",
 		 (long long)OST_LADVISE);
-	LASSERTF(OST_LAST_OPC == 22, "found %lld\n",
+	LASSERTF(OST_COPY == 22, "found %lld\n",
+		 (long long)OST_COPY);
+	LASSERTF(OST_LAST_OPC == 23, "found %lld\n",
 		 (long long)OST_LAST_OPC);
 	LASSERTF(OBD_OBJECT_EOF == 0xffffffffffffffffULL, "found 0x%.16llxULL\n",
 		 OBD_OBJECT_EOF);
@@ -194,7 +196,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)MDS_HSM_CT_UNREGISTER);
 	LASSERTF(MDS_SWAP_LAYOUTS == 61, "found %lld\n",
 		 (long long)MDS_SWAP_LAYOUTS);
-	LASSERTF(MDS_LAST_OPC == 62, "found %lld\n",
+	LASSERTF(MDS_BATCH_GETATTR == 62, "found %lld\n",
+		 (long long)MDS_BATCH_GETATTR);
+	LASSERTF(MDS_LAST_OPC == 63, "found %lld\n",
 		 (long long)MDS_LAST_OPC);
 	LASSERTF(REINT_SETATTR == 1, "found %lld\n",
 		 (long long)REINT_SETATTR);
@@ -1038,10 +1042,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_connect_data, padding0));
 	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->padding0) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_connect_data *)0)->padding0));
-	LASSERTF((int)offsetof(struct obd_connect_data, padding1) == 76, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_connect_data, padding1));
-	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->padding1) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_connect_data *)0)->padding1));
+	LASSERTF((int)offsetof(struct obd_connect_data, ocd_compr_types) == 76, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_connect_data, ocd_compr_types));
+	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->ocd_compr_types) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_connect_data *)0)->ocd_compr_types));
 	LASSERTF((int)offsetof(struct obd_connect_data, ocd_connect_flags2) == 80, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_connect_data, ocd_connect_flags2));
 	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->ocd_connect_flags2) == 8, "found %lld\n",
@@ -1224,12 +1228,28 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT_FLAGS2);
 	LASSERTF(OBD_CONNECT2_FILE_SECCTX == 0x1ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_FILE_SECCTX);
+	LASSERTF(OBD_CONNECT2_BATCH_GETATTR == 0x0100000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_GETATTR);
+	LASSERTF(OBD_CONNECT2_COMPRESS == 0x0200000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_COMPRESS);
+	LASSERTF(OBD_CONNECT2_SERVER_COPY == 0x0400000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_SERVER_COPY);
+	LASSERTF(OBD_CONNECT2_BATCH_BL_AST == 0x0800000000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_BL_AST);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_ADLER);
 	LASSERTF(OBD_CKSUM_CRC32C == 0x00000004UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32C);
+	LASSERTF(OBD_CKSUM_T10IP512 == 0x00000008UL, "found 0x%.8xUL\n",
+		(unsigned)OBD_CKSUM_T10IP512);
+	LASSERTF(OBD_CKSUM_T10IP4K == 0x00000010UL, "found 0x%.8xUL\n",
+		(unsigned)OBD_CKSUM_T10IP4K);
+	LASSERTF(OBD_CKSUM_T10CRC512 == 0x00000020UL, "found 0x%.8xUL\n",
+		(unsigned)OBD_CKSUM_T10CRC512);
+	LASSERTF(OBD_CKSUM_T10CRC4K == 0x00000040UL, "found 0x%.8xUL\n",
+		(unsigned)OBD_CKSUM_T10CRC4K);
 
 	/* Checks for struct obdo */
 	LASSERTF((int)sizeof(struct obdo) == 208, "found %lld\n",
@@ -1444,7 +1464,10 @@ void lustre_assert_wire_constants(void)
 	CLASSERT(OBD_FL_CKSUM_CRC32 == 0x00001000);
 	CLASSERT(OBD_FL_CKSUM_ADLER == 0x00002000);
 	CLASSERT(OBD_FL_CKSUM_CRC32C == 0x00004000);
-	CLASSERT(OBD_FL_CKSUM_RSVD2 == 0x00008000);
+	CLASSERT(OBD_FL_CKSUM_T10IP512 == 0x00005000);
+	CLASSERT(OBD_FL_CKSUM_T10IP4K == 0x00006000);
+	CLASSERT(OBD_FL_CKSUM_T10CRC512 == 0x00007000);
+	CLASSERT(OBD_FL_CKSUM_T10CRC4K == 0x00008000);
 	CLASSERT(OBD_FL_CKSUM_RSVD3 == 0x00010000);
 	CLASSERT(OBD_FL_SHRINK_GRANT == 0x00020000);
 	CLASSERT(OBD_FL_MMAP == 0x00040000);
@@ -1981,6 +2004,38 @@ void lustre_assert_wire_constants(void)
 	LASSERTF(OBD_BRW_SOFT_SYNC == 0x4000, "found 0x%.8x\n",
 		OBD_BRW_SOFT_SYNC);
 
+	/* Checks for struct brw_compr_hdr */
+	LASSERTF((int)sizeof(struct brw_compr_hdr) == 16, "found %lld\n",
+		 (long long)(int)sizeof(struct brw_compr_hdr));
+	LASSERTF((int)offsetof(struct brw_compr_hdr, bch_type) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_hdr, bch_type));
+	LASSERTF((int)sizeof(((struct brw_compr_hdr *)0)->bch_type) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_hdr *)0)->bch_type));
+	LASSERTF((int)offsetof(struct brw_compr_hdr, bch_chunk_size) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_hdr, bch_chunk_size));
+	LASSERTF((int)sizeof(((struct brw_compr_hdr *)0)->bch_chunk_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_hdr *)0)->bch_chunk_size));
+	LASSERTF((int)offsetof(struct brw_compr_hdr, bch_count) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_hdr, bch_count));
+	LASSERTF((int)sizeof(((struct brw_compr_hdr *)0)->bch_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_hdr *)0)->bch_count));
+	LASSERTF((int)offsetof(struct brw_compr_hdr, bch_padding) == 12, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_hdr, bch_padding));
+	LASSERTF((int)sizeof(((struct brw_compr_hdr *)0)->bch_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_hdr *)0)->bch_padding));
+	LASSERTF((int)offsetof(struct brw_compr_hdr, bch_chunk_len[0]) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_hdr, bch_chunk_len[0]));
+	LASSERTF((int)sizeof(((struct brw_compr_hdr *)0)->bch_chunk_len[0]) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_hdr *)0)->bch_chunk_len[0]));
+	LASSERTF(OBD_COMPR_NONE == 0, "found %lld\n",
+		 (long long)OBD_COMPR_NONE);
+	LASSERTF(OBD_COMPR_LZ4 == 1, "found %lld\n",
+		 (long long)OBD_COMPR_LZ4);
+	LASSERTF(OBD_COMPR_LZO == 2, "found %lld\n",
+		 (long long)OBD_COMPR_LZO);
+	LASSERTF(OBD_COMPR_DEFLATE == 3, "found %lld\n",
+		 (long long)OBD_COMPR_DEFLATE);
+
 	/* Checks for struct ost_body */
 	LASSERTF((int)sizeof(struct ost_body) == 208, "found %lld\n",
 		 (long long)(int)sizeof(struct ost_body));
@@ -1989,6 +2044,34 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct ost_body *)0)->oa) == 208, "found %lld\n",
 		 (long long)(int)sizeof(((struct ost_body *)0)->oa));
 
+	/* Checks for struct ost_copy */
+	LASSERTF((int)sizeof(struct ost_copy) == 56, "found %lld\n",
+		 (long long)(int)sizeof(struct ost_copy));
+	LASSERTF((int)offsetof(struct ost_copy, oc_src_oi) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_src_oi));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_src_oi) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_src_oi));
+	LASSERTF((int)offsetof(struct ost_copy, oc_src_offset) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_src_offset));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_src_offset) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_src_offset));
+	LASSERTF((int)offsetof(struct ost_copy, oc_dst_offset) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_dst_offset));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_dst_offset) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_dst_offset));
+	LASSERTF((int)offsetof(struct ost_copy, oc_length) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_length));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_length) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_length));
+	LASSERTF((int)offsetof(struct ost_copy, oc_flags) == 40, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_flags));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_flags) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_flags));
+	LASSERTF((int)offsetof(struct ost_copy, oc_padding) == 48, "found %lld\n",
+		 (long long)(int)offsetof(struct ost_copy, oc_padding));
+	LASSERTF((int)sizeof(((struct ost_copy *)0)->oc_padding) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct ost_copy *)0)->oc_padding));
+
 	/* Checks for struct ll_fid */
 	LASSERTF((int)sizeof(struct ll_fid) == 16, "found %lld\n",
 		 (long long)(int)sizeof(struct ll_fid));
@@ -2231,6 +2314,62 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct mdt_ioepoch *)0)->mio_padding) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct mdt_ioepoch *)0)->mio_padding));
 
+	/* Checks for struct mdt_batch_getattr_item */
+	LASSERTF((int)sizeof(struct mdt_batch_getattr_item) == 32, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_getattr_item));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_lockh) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_lockh));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_lockh) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_lockh));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_fid) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_fid));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_fid) == 16, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_fid));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_namelen) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_namelen));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_namelen) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_namelen));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_padding0) == 26, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_padding0));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_padding0) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_padding0));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_padding1) == 28, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_padding1));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_padding1) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_padding1));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_item, mgi_name[0]) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_item, mgi_name[0]));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_name[0]) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_item *)0)->mgi_name[0]));
+
+	/* Checks for struct mdt_batch_getattr_reply */
+	LASSERTF((int)sizeof(struct mdt_batch_getattr_reply) == 248, "found %lld\n",
+		 (long long)(int)sizeof(struct mdt_batch_getattr_reply));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_status) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_status));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_status) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_status));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_padding) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_padding));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_padding));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_lockh) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_lockh));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_lockh) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_lockh));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_bits) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_bits));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_bits) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_bits));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_flags) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_flags));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_flags) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_flags));
+	LASSERTF((int)offsetof(struct mdt_batch_getattr_reply, mgr_body) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct mdt_batch_getattr_reply, mgr_body));
+	LASSERTF((int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_body) == 216, "found %lld\n",
+		 (long long)(int)sizeof(((struct mdt_batch_getattr_reply *)0)->mgr_body));
+
 	/* Checks for struct mdt_rec_setattr */
 	LASSERTF((int)sizeof(struct mdt_rec_setattr) == 136, "found %lld\n",
 		 (long long)(int)sizeof(struct mdt_rec_setattr));
@@ -5029,6 +5168,8 @@ void lustre_assert_wire_constants(void)
 		 (long long)LU_LADVISE_WILLREAD);
 	LASSERTF(LU_LADVISE_DONTNEED == 2, "found %lld\n",
 		 (long long)LU_LADVISE_DONTNEED);
+	LASSERTF(LU_LADVISE_LOCKAHEAD == 3, "found %lld\n",
+		 (long long)LU_LADVISE_LOCKAHEAD);
 
 	/* Checks for struct ladvise_hdr */
 	LASSERTF(LADVISE_MAGIC == 0x1ADF1CE0, "found 0x%.8x\n",